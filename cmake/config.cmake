@@ -75,6 +75,12 @@ elseif (SHAD_RUNTIME_SYSTEM STREQUAL "GMT")
   include_directories(${GMT_INCLUDE_DIR})
   set(HAVE_GMT 1)
   set(SHAD_RUNTIME_LIB ${GMT_LIBRARIES})
+elseif (SHAD_RUNTIME_SYSTEM STREQUAL "SHM")
+  message(STATUS "Using forked processes on shared memory as backend of the Abstract Runtime API.")
+  find_package(Threads REQUIRED)
+  include_directories(${THREADS_PTHREADS_INCLUDE_DIR})
+  set(HAVE_SHM 1)
+  set(SHAD_RUNTIME_LIB ${CMAKE_THREAD_LIBS_INIT})
 else()
   message(FATAL_ERROR "${SHAD_RUNTIME_SYSTEM} is not a supported runtime system.")
 endif()
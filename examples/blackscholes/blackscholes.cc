@@ -65,6 +65,7 @@ price_t reference(const shad::array<option_t, n_options> &in) {
 price_t std_algorithms(const shad::array<option_t, n_options> &in) {
   price_t max_price;
   shad::array<price_t, n_options> prices;
+  prices.enable_read_cache();
   std::transform(in.begin(), in.end(), prices.begin(), black_scholes);
   auto max_price_it = std::max_element(prices.begin(), prices.end());
   return *max_price_it;
@@ -90,6 +91,8 @@ int main(int argc, char **argv) {
 
   // read input data
   auto in = read_options(argv[1]);
+  // sequential scans read remote options in bulk
+  in.enable_read_cache();
 
   // sequential reference
   price_t max_price;
@@ -105,6 +108,7 @@ int main(int argc, char **argv) {
             << " ns (res = " << max_price << ")" << std::endl;
 
   // shad algorithms
+  in.disable_read_cache();
   exec_time = shad::measure<std::chrono::nanoseconds>::duration(
       [&]() { max_price = shad_algorithms(in); });
   std::cout << "> reference took " << exec_time.count()
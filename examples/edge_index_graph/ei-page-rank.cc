@@ -22,141 +22,16 @@
 //
 //===----------------------------------------------------------------------===//
 
-#include <atomic>
-#include <cmath>
-#include <fstream>
 #include <iostream>
-#include <sstream>
-#include <utility>
 
 #include "shad/data_structures/array.h"
+#include "shad/extensions/graph_library/algorithms/page_rank.h"
 #include "shad/extensions/graph_library/edge_index.h"
+#include "shad/extensions/graph_library/edge_list_loader.h"
 #include "shad/runtime/runtime.h"
 #include "shad/util/measure.h"
 
-// Phase synchronous implementation of PageRank
-
-const float kDamp = 0.85;
-
-shad::rt::Lock errorLock;
-static double error(0);
-
-void PageRank(shad::EdgeIndex<uint64_t, uint64_t>::ObjectID &G, int maxIters,
-              double epsilon) {
-  auto GraphPtr = shad::EdgeIndex<uint64_t, uint64_t>::GetPtr(G);
-
-  float initialScore = 1.0f / GraphPtr->Size();
-  auto scores = shad::Array<float>::Create(GraphPtr->Size(), initialScore);
-  auto outgoinContrib = shad::Array<float>::Create(GraphPtr->Size(), 0);
-  auto incomingTotal = shad::Array<float>::Create(GraphPtr->Size(), 0);
-
-  auto scoresID = scores->GetGlobalID();
-  auto outgoingContribID = outgoinContrib->GetGlobalID();
-  auto incomingTotalID = incomingTotal->GetGlobalID();
-
-  for (int iteration = 0; iteration < maxIters; ++iteration) {
-    shad::rt::Handle handle;
-
-    GraphPtr->AsyncForEachVertex(
-        handle,
-        [](shad::rt::Handle &handle, const uint64_t &i,
-           shad::EdgeIndex<uint64_t, uint64_t>::ObjectID &eoid,
-           shad::Array<float>::ObjectID &oid1,
-           shad::Array<float>::ObjectID &oid2,
-           shad::Array<float>::ObjectID &oid3) {
-          auto GraphPtr = shad::EdgeIndex<uint64_t, uint64_t>::GetPtr(eoid);
-
-          auto scores = shad::Array<float>::GetPtr(oid1);
-          auto outgoingContrib = shad::Array<float>::GetPtr(oid2);
-          auto incomingTotal = shad::Array<float>::GetPtr(oid3);
-
-          size_t outDegree = GraphPtr->GetDegree(i);
-
-          outgoingContrib->InsertAt(i, scores->At(i) / outDegree);
-
-          incomingTotal->InsertAt(i, 0);
-          GraphPtr->ForEachNeighbor(
-              i,
-              [](const uint64_t &src, const uint64_t &dst,
-                 shad::Array<float>::ObjectID &oid1,
-                 shad::Array<float>::ObjectID &oid2) {
-                auto outgoingContrib = shad::Array<float>::GetPtr(oid1);
-                auto incomingTotal = shad::Array<float>::GetPtr(oid2);
-
-                size_t value = outgoingContrib->At(dst);
-                value += incomingTotal->At(src);
-                incomingTotal->InsertAt(src, value);
-              },
-              oid2, oid3);
-
-          float baseScore = (1.0f - kDamp) / GraphPtr->Size();
-
-          float oldScore = scores->At(i);
-          float score = baseScore + kDamp * incomingTotal->At(i);
-          scores->InsertAt(i, score);
-
-          std::lock_guard<shad::rt::Lock> _(errorLock);
-          error += fabs(score - oldScore);
-        },
-        G, scoresID, outgoingContribID, incomingTotalID);
-
-    shad::rt::waitForCompletion(handle);
-
-    // This performs a reduction into a single counter.
-    std::vector<double> reducer(shad::rt::numLocalities());
-
-    for (auto &locality : shad::rt::allLocalities()) {
-      shad::rt::asyncExecuteAtWithRet(
-          handle, locality,
-          [](shad::rt::Handle &, const size_t &, double *value) {
-            *value = error;
-          },
-          size_t(0), &reducer[static_cast<uint32_t>(locality)]);
-    }
-    shad::rt::waitForCompletion(handle);
-
-    for (double i : reducer) error += i;
-
-    if (error < epsilon) break;
-
-    shad::rt::asyncExecuteOnAll(
-        handle, [](shad::rt::Handle &, const size_t &) { error = 0; },
-        size_t(0));
-
-    shad::rt::waitForCompletion(handle);
-  }
-}
-
-// The GraphReader expects an input file in METIS dump format
-shad::EdgeIndex<uint64_t, uint64_t>::ObjectID GraphReader(std::ifstream &GFS) {
-  std::string line;
-  unsigned long EdgeNumber, VertexNumber;
-
-  std::getline(GFS, line);
-
-  std::istringstream headlineStream(line);
-
-  headlineStream >> VertexNumber >> EdgeNumber;
-  EdgeNumber <<= 1;
-
-  auto eiGraph = shad::EdgeIndex<uint64_t, uint64_t>::Create(VertexNumber);
-  shad::rt::Handle handle;
-
-  for (size_t i = 0L; i < VertexNumber; i++) {
-    size_t destination;
-
-    std::getline(GFS, line);
-    std::istringstream lineStream(line);
-    std::vector<uint64_t> edges;
-    while (!lineStream.eof()) {
-      lineStream >> destination;
-      edges.push_back(destination - 1);
-    }
-    eiGraph->AsyncInsertEdgeList(handle, i, edges.data(), edges.size());
-  }
-  shad::rt::waitForCompletion(handle);
-  return eiGraph->GetGlobalID();
-}
+const double kDamp = 0.85;
 
 namespace shad {
 
@@ -165,10 +40,10 @@ int main(int argc, char **argv) {
 
   shad::EdgeIndex<uint64_t, uint64_t>::ObjectID OID(-1);
   auto loadingTime = shad::measure<std::chrono::seconds>::duration([&]() {
-    std::ifstream inputFile;
-    // The GraphReader expects an input file in METIS dump format
-    inputFile.open(argv[1], std::ifstream::in);
-    OID = GraphReader(inputFile);
+    // The input file is expected in METIS dump format
+    OID = shad::LoadEdgeIndex<shad::EdgeIndex<uint64_t, uint64_t>>(
+              argv[1], shad::EdgeListFormat::kMETIS)
+              ->GetGlobalID();
   });
 
   std::cout << "Graph loaded in " << loadingTime.count()
@@ -177,11 +52,15 @@ int main(int argc, char **argv) {
   std::cout << "NumVertices: " << eiPtr->Size()
             << " Num Edges: " << eiPtr->NumEdges() << std::endl;
 
-  auto duration = shad::measure<std::chrono::seconds>::duration(
-      [&]() { PageRank(OID, 20, 1e-4); });
+  shad::Array<double>::ShadArrayPtr scores;
+  auto duration = shad::measure<std::chrono::seconds>::duration([&]() {
+    scores = shad::PageRank<shad::EdgeIndex<uint64_t, uint64_t>>(
+        OID, eiPtr->Size(), kDamp, 20, 1e-4);
+  });
 
   std::cout << "Computed PageRank in " << duration.count() << " seconds"
             << std::endl;
+  shad::Array<double>::Destroy(scores->GetGlobalID());
 
   return 0;
 }
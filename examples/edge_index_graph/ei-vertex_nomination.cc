@@ -23,10 +23,8 @@
 //===----------------------------------------------------------------------===//
 
 #include <atomic>
-#include <fstream>
 #include <iostream>
 #include <mutex>
-#include <sstream>
 #include <utility>
 
 #include "./ei-vertex_nomination.h"
@@ -34,6 +32,7 @@
 #include "shad/data_structures/set.h"
 #include "shad/extensions/graph_library/algorithms/sssp.h"
 #include "shad/extensions/graph_library/edge_index.h"
+#include "shad/extensions/graph_library/edge_list_loader.h"
 #include "shad/runtime/runtime.h"
 #include "shad/util/measure.h"
 
@@ -69,38 +68,6 @@ Score vertex_nomination(shad::EdgeIndex<size_t, size_t>::ObjectID GID) {
   return bestScore;
 };
 
-// The GraphReader expects an input file in METIS dump format
-shad::EdgeIndex<size_t, size_t>::ObjectID GraphReader(std::ifstream &GFS) {
-  std::string line;
-  unsigned long EdgeNumber, VertexNumber;
-
-  std::getline(GFS, line);
-
-  std::istringstream headlineStream(line);
-
-  headlineStream >> VertexNumber >> EdgeNumber;
-  EdgeNumber <<= 1;
-
-  auto eiGraph = shad::EdgeIndex<size_t, size_t>::Create(VertexNumber);
-  shad::rt::Handle handle;
-
-  for (size_t i = 0L; i < VertexNumber; i++) {
-    size_t destination;
-
-    std::getline(GFS, line);
-    std::istringstream lineStream(line);
-    std::vector<size_t> edges;
-    while (!lineStream.eof()) {
-      lineStream >> destination;
-      destination--;
-      edges.push_back(destination);
-    }
-    eiGraph->AsyncInsertEdgeList(handle, i, edges.data(), edges.size());
-  }
-  shad::rt::waitForCompletion(handle);
-  return eiGraph->GetGlobalID();
-}
-
 void printHelp(const std::string programName) {
   std::cerr << "Usage: " << programName << " --inpath FILENAME [options]\n"
             << "Options:\n"
@@ -157,10 +124,10 @@ int main(int argc, char **argv) {
 
   shad::EdgeIndex<size_t, size_t>::ObjectID OID(-1);
   auto loadingTime = shad::measure<std::chrono::seconds>::duration([&]() {
-    // The GraphReader expects an input file in METIS dump format
-    std::ifstream inputFile;
-    inputFile.open(inpath.c_str(), std::ifstream::in);
-    OID = GraphReader(inputFile);
+    // The input file is expected in METIS dump format
+    OID = shad::LoadEdgeIndex<shad::EdgeIndex<size_t, size_t>>(
+              inpath, shad::EdgeListFormat::kMETIS)
+              ->GetGlobalID();
   });
 
   std::cout << "Graph loaded in " << loadingTime.count()
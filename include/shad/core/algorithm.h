@@ -38,6 +38,7 @@
 #include "shad/core/impl/minimum_maximum_ops.h"
 #include "shad/core/impl/modifyng_sequence_ops.h"
 #include "shad/core/impl/non_modifyng_sequence_ops.h"
+#include "shad/core/impl/sorting_ops.h"
 #include "shad/distributed_iterator_traits.h"
 #include "shad/runtime/runtime.h"
 
@@ -376,6 +377,133 @@ bool lexicographical_compare(ExecutionPolicy&& policy, ForwardIt1 first1,
   return impl::lexicographical_compare(std::forward<ExecutionPolicy>(policy),
                                        first1, last1, first2, last2, comp);
 }
+
+// ---------------------------------------------//
+//                                              //
+//                  sorting_ops                 //
+//                                              //
+// ---------------------------------------------//
+
+//  ------------------  //
+//  |      sort      |  //
+//  ------------------  //
+
+template <class RandomIt>
+void sort(RandomIt first, RandomIt last) {
+  impl::sort(distributed_sequential_tag{}, first, last,
+             std::less<typename RandomIt::value_type>());
+}
+
+template <class ExecutionPolicy, class RandomIt>
+std::enable_if_t<shad::is_execution_policy<ExecutionPolicy>::value> sort(
+    ExecutionPolicy&& policy, RandomIt first, RandomIt last) {
+  impl::sort(std::forward<ExecutionPolicy>(policy), first, last,
+             std::less<typename RandomIt::value_type>());
+}
+
+template <class RandomIt, class Compare>
+std::enable_if_t<!shad::is_execution_policy<RandomIt>::value> sort(
+    RandomIt first, RandomIt last, Compare comp) {
+  impl::sort(distributed_sequential_tag{}, first, last, comp);
+}
+
+template <class ExecutionPolicy, class RandomIt, class Compare>
+void sort(ExecutionPolicy&& policy, RandomIt first, RandomIt last,
+          Compare comp) {
+  impl::sort(std::forward<ExecutionPolicy>(policy), first, last, comp);
+}
+
+//  ------------------  //
+//  |   stable_sort  |  //
+//  ------------------  //
+
+template <class RandomIt>
+void stable_sort(RandomIt first, RandomIt last) {
+  impl::stable_sort(distributed_sequential_tag{}, first, last,
+                    std::less<typename RandomIt::value_type>());
+}
+
+template <class ExecutionPolicy, class RandomIt>
+std::enable_if_t<shad::is_execution_policy<ExecutionPolicy>::value>
+stable_sort(ExecutionPolicy&& policy, RandomIt first, RandomIt last) {
+  impl::stable_sort(std::forward<ExecutionPolicy>(policy), first, last,
+                    std::less<typename RandomIt::value_type>());
+}
+
+template <class RandomIt, class Compare>
+std::enable_if_t<!shad::is_execution_policy<RandomIt>::value> stable_sort(
+    RandomIt first, RandomIt last, Compare comp) {
+  impl::stable_sort(distributed_sequential_tag{}, first, last, comp);
+}
+
+template <class ExecutionPolicy, class RandomIt, class Compare>
+void stable_sort(ExecutionPolicy&& policy, RandomIt first, RandomIt last,
+                 Compare comp) {
+  impl::stable_sort(std::forward<ExecutionPolicy>(policy), first, last, comp);
+}
+
+//  ------------------  //
+//  |  partial_sort  |  //
+//  ------------------  //
+
+template <class RandomIt>
+void partial_sort(RandomIt first, RandomIt middle, RandomIt last) {
+  impl::partial_sort(distributed_sequential_tag{}, first, middle, last,
+                     std::less<typename RandomIt::value_type>());
+}
+
+template <class ExecutionPolicy, class RandomIt>
+std::enable_if_t<shad::is_execution_policy<ExecutionPolicy>::value>
+partial_sort(ExecutionPolicy&& policy, RandomIt first, RandomIt middle,
+             RandomIt last) {
+  impl::partial_sort(std::forward<ExecutionPolicy>(policy), first, middle,
+                     last, std::less<typename RandomIt::value_type>());
+}
+
+template <class RandomIt, class Compare>
+std::enable_if_t<!shad::is_execution_policy<RandomIt>::value> partial_sort(
+    RandomIt first, RandomIt middle, RandomIt last, Compare comp) {
+  impl::partial_sort(distributed_sequential_tag{}, first, middle, last, comp);
+}
+
+template <class ExecutionPolicy, class RandomIt, class Compare>
+void partial_sort(ExecutionPolicy&& policy, RandomIt first, RandomIt middle,
+                  RandomIt last, Compare comp) {
+  impl::partial_sort(std::forward<ExecutionPolicy>(policy), first, middle,
+                     last, comp);
+}
+
+//  ------------------  //
+//  |   nth_element  |  //
+//  ------------------  //
+
+template <class RandomIt>
+void nth_element(RandomIt first, RandomIt nth, RandomIt last) {
+  impl::nth_element(distributed_sequential_tag{}, first, nth, last,
+                    std::less<typename RandomIt::value_type>());
+}
+
+template <class ExecutionPolicy, class RandomIt>
+std::enable_if_t<shad::is_execution_policy<ExecutionPolicy>::value>
+nth_element(ExecutionPolicy&& policy, RandomIt first, RandomIt nth,
+            RandomIt last) {
+  impl::nth_element(std::forward<ExecutionPolicy>(policy), first, nth, last,
+                    std::less<typename RandomIt::value_type>());
+}
+
+template <class RandomIt, class Compare>
+std::enable_if_t<!shad::is_execution_policy<RandomIt>::value> nth_element(
+    RandomIt first, RandomIt nth, RandomIt last, Compare comp) {
+  impl::nth_element(distributed_sequential_tag{}, first, nth, last, comp);
+}
+
+template <class ExecutionPolicy, class RandomIt, class Compare>
+void nth_element(ExecutionPolicy&& policy, RandomIt first, RandomIt nth,
+                 RandomIt last, Compare comp) {
+  impl::nth_element(std::forward<ExecutionPolicy>(policy), first, nth, last,
+                    comp);
+}
+
 }  // namespace shad
 
 #endif /* INCLUDE_SHAD_CORE_ALGORITHM_H */
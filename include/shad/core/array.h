@@ -25,15 +25,189 @@
 #ifndef INCLUDE_SHAD_CORE_ARRAY_H_
 #define INCLUDE_SHAD_CORE_ARRAY_H_
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <tuple>
 
 #include "shad/data_structures/abstract_data_structure.h"
+#include "shad/data_structures/buffer.h"
 #include "shad/distributed_iterator_traits.h"
 #include "shad/runtime/runtime.h"
 
 namespace shad {
 
 namespace impl {
+
+/// @brief Read-through cache of blocks of remote array elements.
+///
+/// Blocks are kept in a direct-mapped table.  A miss fetches the missing
+/// block; when consecutive misses walk the blocks of a Locality forward or
+/// backward, the next blocks along the same direction are prefetched
+/// asynchronously, and every first hit on a prefetched block extends the
+/// prefetch window by one block.  The cache is not coherent: writes issued
+/// through the cache update the cached copies, writes from other Localities
+/// become visible only after Invalidate().  The cache is guarded by an
+/// rt::Lock: a thread waiting for a fetch while holding it does not help with
+/// unrelated tasks, which could re-enter the cache.
+///
+/// @tparam T The type of the cached elements.
+template <typename T>
+class ArrayReadCache {
+ public:
+  /// Number of elements of a block, sized to fit in a runtime message.
+  static constexpr size_t kBlockSize =
+      constants::max(constants::kBufferNumBytes / sizeof(T), 1lu);
+  static constexpr size_t kNumSlots = 64;
+
+  /// @brief Function fetching count elements, starting at offset first of
+  /// the chunk of a Locality, into a buffer.
+  ///
+  /// The fetch may complete asynchronously on the handle; the number of
+  /// bytes written must be stored in the last argument.
+  using FetchFunT = std::function<void(rt::Handle &, const rt::Locality &,
+                                       size_t, size_t, uint8_t *,
+                                       uint32_t *)>;
+  /// @brief Function returning the number of elements of a Locality.
+  using ChunkSizeFunT = std::function<size_t(const rt::Locality &)>;
+
+  /// @brief Constructor.
+  ///
+  /// @param fetch The function fetching blocks.
+  /// @param chunkSize The function returning the number of elements of
+  /// every Locality.
+  /// @param prefetchWindow The number of blocks prefetched ahead of a
+  /// sequential scan.
+  ArrayReadCache(FetchFunT fetch, ChunkSizeFunT chunkSize,
+                 size_t prefetchWindow)
+      : fetch_(std::move(fetch)),
+        chunkSize_(std::move(chunkSize)),
+        prefetchWindow_(std::min(prefetchWindow, kNumSlots / 2)),
+        slots_(new Slot[kNumSlots]) {}
+
+  ~ArrayReadCache() { Invalidate(); }
+
+  /// @brief Read the element at offset pos of the chunk of a Locality.
+  T Get(const rt::Locality &loc, size_t pos) {
+    size_t block = pos / kBlockSize;
+    std::lock_guard<rt::Lock> _(lock_);
+    Slot &slot = slots_[SlotIndex(loc, block)];
+    if (slot.Holds(loc, block)) {
+      ++hits_;
+      Wait(slot);
+      if (slot.prefetched) {
+        slot.prefetched = false;
+        if (direction_ != 0)
+          Prefetch(loc, block + direction_ * prefetchWindow_);
+      }
+    } else {
+      ++misses_;
+      Fetch(slot, loc, block);
+      UpdateDirection(loc, block);
+      for (size_t i = 1; direction_ != 0 && i <= prefetchWindow_; ++i)
+        Prefetch(loc, block + direction_ * i);
+      Wait(slot);
+    }
+    return slot.data[pos % kBlockSize];
+  }
+
+  /// @brief Update the cached copy of an element, if any.
+  void Update(const rt::Locality &loc, size_t pos, const T &value) {
+    size_t block = pos / kBlockSize;
+    std::lock_guard<rt::Lock> _(lock_);
+    Slot &slot = slots_[SlotIndex(loc, block)];
+    if (!slot.Holds(loc, block)) return;
+    Wait(slot);
+    slot.data[pos % kBlockSize] = value;
+  }
+
+  /// @brief Drop all the cached blocks.
+  void Invalidate() {
+    std::lock_guard<rt::Lock> _(lock_);
+    for (size_t i = 0; i < kNumSlots; ++i) {
+      Wait(slots_[i]);
+      slots_[i].valid = false;
+    }
+    direction_ = 0;
+  }
+
+  size_t Hits() const { return hits_; }
+  size_t Misses() const { return misses_; }
+
+ private:
+  struct Slot {
+    rt::Locality loc;
+    size_t block = 0;
+    bool valid = false;
+    bool pending = false;
+    bool prefetched = false;
+    rt::Handle handle;
+    uint32_t bytes = 0;
+    T data[kBlockSize];
+
+    bool Holds(const rt::Locality &l, size_t b) const {
+      return valid && loc == l && block == b;
+    }
+  };
+
+  static size_t SlotIndex(const rt::Locality &loc, size_t block) {
+    return (block + static_cast<uint32_t>(loc) * 31) % kNumSlots;
+  }
+
+  void Wait(Slot &slot) {
+    if (!slot.pending) return;
+    rt::waitForCompletion(slot.handle);
+    slot.pending = false;
+  }
+
+  void Fetch(Slot &slot, const rt::Locality &loc, size_t block) {
+    Wait(slot);
+    size_t first = block * kBlockSize;
+    size_t count = std::min(kBlockSize, chunkSize_(loc) - first);
+    slot.loc = loc;
+    slot.block = block;
+    slot.valid = true;
+    slot.pending = true;
+    slot.prefetched = false;
+    fetch_(slot.handle, loc, first, count,
+           reinterpret_cast<uint8_t *>(slot.data), &slot.bytes);
+  }
+
+  void Prefetch(const rt::Locality &loc, size_t block) {
+    // Blocks before the first one wrap around and are rejected here.
+    if (block * kBlockSize >= chunkSize_(loc)) return;
+    Slot &slot = slots_[SlotIndex(loc, block)];
+    if (slot.Holds(loc, block)) return;
+    Fetch(slot, loc, block);
+    slot.prefetched = true;
+  }
+
+  void UpdateDirection(const rt::Locality &loc, size_t block) {
+    if (loc == lastLoc_ && block == lastMiss_ + 1)
+      direction_ = 1;
+    else if (loc == lastLoc_ && block + 1 == lastMiss_)
+      direction_ = -1;
+    else
+      direction_ = 0;
+    lastLoc_ = loc;
+    lastMiss_ = block;
+  }
+
+  FetchFunT fetch_;
+  ChunkSizeFunT chunkSize_;
+  size_t prefetchWindow_;
+  std::unique_ptr<Slot[]> slots_;
+  rt::Lock lock_;
+  rt::Locality lastLoc_;
+  size_t lastMiss_ = 0;
+  int64_t direction_ = 0;
+  size_t hits_ = 0;
+  size_t misses_ = 0;
+};
+
 /// @brief Fixed size distributed array.
 ///
 /// Section 21.3.7.1 of the C++ standard defines the ::array as a fixed-size
@@ -133,6 +307,66 @@ class array : public AbstractDataStructure<array<T, N>> {
         std::make_pair(this->oid_, O.oid_));
   }
 
+  /// @brief Enable the read cache of remote elements on all Localities.
+  ///
+  /// Reads of remote elements through references and iterators are served
+  /// from blocks of elements fetched in bulk, prefetching ahead of
+  /// sequential scans.  Writes issued by a Locality update its own cache;
+  /// writes issued by other Localities are visible only after
+  /// invalidate_read_cache().
+  ///
+  /// @warning Enabling, disabling and invalidating the cache must not run
+  /// concurrently with accesses to the array.
+  ///
+  /// @param prefetch_window The number of blocks prefetched ahead of a
+  /// sequential scan.
+  void enable_read_cache(size_type prefetch_window = 4) {
+    rt::executeOnAll(
+        [](const std::pair<ObjectID, size_type> &args) {
+          auto This = array<T, N>::GetPtr(args.first);
+          ObjectID oid = args.first;
+          auto fetch = [oid](rt::Handle &handle, const rt::Locality &loc,
+                             size_t first, size_t count, uint8_t *out,
+                             uint32_t *bytes) {
+            using FetchArgs = std::tuple<ObjectID, size_t, size_t>;
+            rt::asyncExecuteAtWithRetBuff(
+                handle, loc,
+                [](rt::Handle &, const FetchArgs &args, uint8_t *out,
+                   uint32_t *bytes) {
+                  auto This = array<T, N>::GetPtr(std::get<0>(args));
+                  *bytes = std::get<2>(args) * sizeof(T);
+                  std::memcpy(out, This->chunk_.get() + std::get<1>(args),
+                              *bytes);
+                },
+                std::make_tuple(oid, first, count), out, bytes);
+          };
+          This->cache_.reset(new ArrayReadCache<T>(
+              fetch, [](const rt::Locality &loc) { return local_size(loc); },
+              args.second));
+        },
+        std::make_pair(oid_, prefetch_window));
+  }
+
+  /// @brief Disable the read cache of remote elements on all Localities.
+  void disable_read_cache() {
+    rt::executeOnAll(
+        [](const ObjectID &oid) { array<T, N>::GetPtr(oid)->cache_.reset(); },
+        oid_);
+  }
+
+  /// @brief Drop the cached remote elements on all Localities.
+  ///
+  /// This is the fence making the writes issued since the last
+  /// invalidation visible to cached reads.
+  void invalidate_read_cache() {
+    rt::executeOnAll(
+        [](const ObjectID &oid) {
+          auto This = array<T, N>::GetPtr(oid);
+          if (This->cache_) This->cache_->Invalidate();
+        },
+        oid_);
+  }
+
   /// @defgroup Iterators
   /// @{
 
@@ -407,12 +641,20 @@ class array : public AbstractDataStructure<array<T, N>> {
     return rt::Locality(N % rt::numLocalities());
   }
 
+  /// @brief The number of elements stored on a Locality.
+  static size_t local_size(const rt::Locality &loc) {
+    if (pivot_locality() != rt::Locality(0) && loc >= pivot_locality())
+      return chunk_size() - 1;
+    return chunk_size();
+  }
+
   /// @brief Constructor.
   explicit array(ObjectID oid) : chunk_{new T[chunk_size()]}, oid_{oid} {}
 
  private:
   std::unique_ptr<T[]> chunk_;
   ObjectID oid_;
+  std::unique_ptr<ArrayReadCache<T>> cache_;
 };
 
 template <typename T, std::size_t N>
@@ -472,6 +714,9 @@ class array<T, N>::BaseArrayRef {
       return chunk_[pos_];
     }
 
+    auto This = array<T, N>::GetPtr(oid_);
+    if (This->cache_) return This->cache_->Get(loc_, pos_);
+
     if (chunk_ != nullptr) {
       value_type result;
       rt::executeAtWithRet(
@@ -543,6 +788,9 @@ class alignas(64) array<T, N>::ArrayRef
       return *this;
     }
 
+    auto This = array<T, N>::GetPtr(this->oid_);
+    if (This->cache_) This->cache_->Update(this->loc_, this->pos_, v);
+
     if (this->chunk_ == nullptr) {
       rt::executeAtWithRet(
           this->loc_,
@@ -1134,6 +1382,21 @@ class array {
   void swap(array<T, N> &O) noexcept /* (std::is_nothrow_swappable_v<T>) */ {
     impl()->swap(*O->ptr);
   }
+
+  /// @brief Enable the read cache of remote elements.
+  ///
+  /// @param prefetch_window The number of blocks prefetched ahead of a
+  /// sequential scan.
+  void enable_read_cache(size_type prefetch_window = 4) {
+    impl()->enable_read_cache(prefetch_window);
+  }
+
+  /// @brief Disable the read cache of remote elements.
+  void disable_read_cache() { impl()->disable_read_cache(); }
+
+  /// @brief Drop the cached remote elements, making the writes of other
+  /// Localities visible.
+  void invalidate_read_cache() { impl()->invalidate_read_cache(); }
   /// @}
 
  private:
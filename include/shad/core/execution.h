@@ -25,12 +25,22 @@
 #ifndef INCLUDE_SHAD_CORE_EXECUTION_H
 #define INCLUDE_SHAD_CORE_EXECUTION_H
 
+#include <cstddef>
 #include <type_traits>
 
 namespace shad {
 
 struct distributed_sequential_tag {};
-struct distributed_parallel_tag {};
+
+/// @brief Parallel execution policy.
+///
+/// Each locality processes its portion of the input range with up to
+/// rt::impl::getConcurrency() tasks.  grain_size is the minimum number of
+/// elements handed to a task, and the number of elements a search examines
+/// between two checks for a match found by another task.
+struct distributed_parallel_tag {
+  size_t grain_size = 1024;
+};
 
 template <class ExecutionPolicy>
 struct is_execution_policy :
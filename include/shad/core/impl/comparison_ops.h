@@ -32,6 +32,8 @@
 #include "shad/distributed_iterator_traits.h"
 #include "shad/runtime/runtime.h"
 
+#include "impl_patterns.h"
+
 namespace shad {
 namespace impl {
 
@@ -73,48 +75,46 @@ bool equal(distributed_sequential_tag&&, ForwardIt1 first1, ForwardIt1 last1,
 }
 
 template <class ForwardIt1, class ForwardIt2, class BinaryPredicate>
-bool equal(distributed_parallel_tag&&, ForwardIt1 first1, ForwardIt1 last1,
-           ForwardIt2 first2, BinaryPredicate p) {
+bool equal(distributed_parallel_tag&& policy, ForwardIt1 first1,
+           ForwardIt1 last1, ForwardIt2 first2, BinaryPredicate p) {
   using itr_traits = distributed_iterator_traits<ForwardIt1>;
-  auto localities = itr_traits::localities(first1, last1);
-  auto ls = localities.size();
-  bool res[ls];
-  uint32_t i = 0;
-  rt::Handle h;
-  auto args = std::make_tuple(first1, last1, first2, p);
-  for (auto locality = localities.begin(), end = localities.end();
-       locality != end; ++locality, ++i) {
-    rt::asyncExecuteAtWithRet(
-        h, locality,
-        [](rt::Handle&,
-           const std::tuple<ForwardIt1, ForwardIt1, ForwardIt2,
-                            BinaryPredicate>& args, bool* result) {
-          auto gfirst = std::get<0>(args);
-          auto glast = std::get<1>(args);
-          auto local_range = itr_traits::local_range(gfirst, glast);
-          auto lfirst1 = local_range.begin();
-          auto llast1 = local_range.end();
-          if (lfirst1 == llast1) {
-            *result = true;
-            return;
-          }
-          auto first2 = std::get<2>(args);
-          auto it = itr_traits::iterator_from_local(gfirst, glast, lfirst1);
-          first2 += (std::distance(gfirst, it));
-          auto op = std::get<3>(args);
-          for (; lfirst1 != llast1; ++lfirst1, ++first2) {
-            if (!op(*lfirst1, *first2)) {
-              *result = false;
-              return;
-            }
-          }
-          *result = true;
-        },
-        args, &res[i]);
-  }
-  rt::waitForCompletion(h);
-  std::all_of(&res[0], &res[ls], [](bool v) -> bool { return v; });
-  return true;
+
+  // distributed map
+  auto map_res = distributed_map(
+      // range
+      first1, last1,
+      // kernel
+      [](ForwardIt1 first1, ForwardIt1 last1, ForwardIt2 first2,
+         BinaryPredicate p, size_t grain) -> uint8_t {
+        using local_iterator_t = typename itr_traits::local_iterator_type;
+
+        // align the second range to the local portion of the first one
+        auto lrange = itr_traits::local_range(first1, last1);
+        auto lfirst1 = lrange.begin();
+        auto it = itr_traits::iterator_from_local(first1, last1, lfirst1);
+        std::advance(first2, std::distance(first1, it));
+
+        // local search for the first mismatch
+        auto found = local_find(
+            // range
+            lfirst1, lrange.end(),
+            // kernel
+            [&](local_iterator_t b, local_iterator_t e) {
+              auto b2 = first2;
+              std::advance(b2, std::distance(lfirst1, b));
+              for (; b != e; ++b, ++b2)
+                if (!p(*b, *b2)) return b;
+              return e;
+            },
+            // grain
+            grain);
+        return found == lrange.end();
+      },
+      // map arguments
+      first2, p, policy.grain_size);
+
+  // reduce
+  return std::all_of(map_res.begin(), map_res.end(), [](bool x) { return x; });
 }
 
 template <class ForwardIt1, class ForwardIt2, class BinaryPredicate>
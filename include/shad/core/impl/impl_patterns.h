@@ -25,6 +25,8 @@
 #ifndef INCLUDE_SHAD_CORE_IMPL_IMPL_PATTERNS_H
 #define INCLUDE_SHAD_CORE_IMPL_IMPL_PATTERNS_H
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <iterator>
 #include <tuple>
@@ -33,6 +35,7 @@
 #include <vector>
 
 #include "shad/distributed_iterator_traits.h"
+#include "shad/runtime/collectives.h"
 #include "shad/runtime/runtime.h"
 
 namespace shad {
@@ -168,6 +171,23 @@ struct optional_vector {
   std::vector<entry_t> data;
 };
 
+// optional_combine lifts a binary operation to optional_vector entries, with
+// invalid entries acting as the identity.  It is the combining operation of
+// the collectives over ranges that do not touch every locality.
+template <typename T, typename BinaryOperation>
+struct optional_combine {
+  using entry_t = typename optional_vector<T>::entry_t;
+
+  entry_t operator()(const entry_t& lhs, const entry_t& rhs) const {
+    if (!lhs.valid) return rhs;
+    if (!rhs.valid) return lhs;
+    BinaryOperation f = op;
+    return entry_t{f(lhs.value, rhs.value), true};
+  }
+
+  BinaryOperation op;
+};
+
 /// @brief applies the map pattern over a distributed range
 ///
 /// Applies an operation in parallel to each sub-range (one for each locality on
@@ -269,6 +289,31 @@ void distributed_map_void(ForwardIt first, ForwardIt last, MapF&& map_kernel,
   rt::waitForCompletion(h);
 }
 
+/// @brief number of tasks processing a local range
+///
+/// At most one task per thread, each with at least grain elements.  The grain
+/// is only honored for random-access local iterators, for which the length of
+/// the range is known without walking it.
+///
+/// @param[in] first,last the local range
+/// @param grain the minimum number of elements per task
+///
+/// @return the number of partitions the range should be split into
+template <typename ForwardIt>
+size_t local_num_partitions(ForwardIt first, ForwardIt last, size_t grain) {
+  using category_t =
+      typename std::iterator_traits<ForwardIt>::iterator_category;
+  size_t n = rt::impl::getConcurrency();
+  if constexpr (std::is_base_of<std::random_access_iterator_tag,
+                                category_t>::value) {
+    if (grain > 1) {
+      size_t len = std::distance(first, last);
+      n = std::max<size_t>(1, std::min(n, len / grain));
+    }
+  }
+  return n;
+}
+
 /// @brief applies the map pattern over a local range
 ///
 /// Applies an operation in parallel to each partition of a local range and
@@ -280,6 +325,7 @@ void distributed_map_void(ForwardIt first, ForwardIt last, MapF&& map_kernel,
 /// @param[in] first,last the input range
 /// @param map_kernel the operation function object that will be applied
 /// @param init the initial mapped value
+/// @param grain the minimum number of elements per partition
 ///
 /// @return the collection of mapped values
 ///
@@ -288,7 +334,8 @@ template <typename ForwardIt, typename MapF>
 std::vector<typename std::result_of<MapF&(ForwardIt, ForwardIt)>::type>
 local_map_init(
     ForwardIt first, ForwardIt last, MapF&& map_kernel,
-    const typename std::result_of<MapF&(ForwardIt, ForwardIt)>::type& init) {
+    const typename std::result_of<MapF&(ForwardIt, ForwardIt)>::type& init,
+    size_t grain = 1) {
   using mapped_t = typename std::result_of<MapF&(ForwardIt, ForwardIt)>::type;
   static_assert(
       !std::is_same<mapped_t, bool>::value,
@@ -296,32 +343,17 @@ local_map_init(
 
   // allocate partial results
   auto parts = local_iterator_traits<ForwardIt>::partitions(
-      first, last, rt::impl::getConcurrency());
+      first, last, local_num_partitions(first, last, grain));
 
   std::vector<mapped_t> map_res(parts.size(), init);
 
-  if (parts.size()) {
-    rt::Handle map_h;
-    size_t part_id = 0;
-    for (auto pit = parts.begin(); pit != parts.end(); ++pit) {
-      auto map_args = std::make_tuple(pit->begin(), pit->end(), map_kernel,
-                                      &map_res[part_id]);
-      rt::asyncExecuteAt(
-          map_h, rt::thisLocality(),
-          [](rt::Handle&, const typeof(map_args)& map_args) {
-            auto pfirst = std::get<0>(map_args);
-            auto plast = std::get<1>(map_args);
-            auto map_kernel = std::get<2>(map_args);
-            auto res_unit = std::get<3>(map_args);
-            // map over the partition
-            assert(pfirst != plast);
-            *res_unit = map_kernel(pfirst, plast);
-          },
-          map_args);
-      ++part_id;
-    }
-    rt::waitForCompletion(map_h);
-  }
+  rt::impl::parallelFor(parts.size(), [&](size_t part_id) {
+    auto pfirst = parts[part_id].begin();
+    auto plast = parts[part_id].end();
+    // map over the partition
+    assert(pfirst != plast);
+    map_res[part_id] = map_kernel(pfirst, plast);
+  });
 
   return map_res;
 }
@@ -329,7 +361,8 @@ local_map_init(
 // local_map_init variant with default-constructed initial value
 template <typename ForwardIt, typename MapF>
 std::vector<typename std::result_of<MapF&(ForwardIt, ForwardIt)>::type>
-local_map(ForwardIt first, ForwardIt last, MapF&& map_kernel) {
+local_map(ForwardIt first, ForwardIt last, MapF&& map_kernel,
+          size_t grain = 1) {
   using mapped_t = typename std::result_of<MapF&(ForwardIt, ForwardIt)>::type;
   static_assert(std::is_default_constructible<mapped_t>::value,
                 "local_map requires DefaultConstructible value type");
@@ -337,62 +370,226 @@ local_map(ForwardIt first, ForwardIt last, MapF&& map_kernel) {
       !std::is_same<mapped_t, bool>::value,
       "distributed-map kernels returning bool are not supported (yet)");
 
-  return local_map_init(first, last, map_kernel, mapped_t{});
+  return local_map_init(first, last, map_kernel, mapped_t{}, grain);
 }
 
 // local_map_init variant with void operation
 template <typename ForwardIt, typename MapF>
-void local_map_void(ForwardIt first, ForwardIt last, MapF&& map_kernel) {
+void local_map_void(ForwardIt first, ForwardIt last, MapF&& map_kernel,
+                    size_t grain = 1) {
   auto parts = local_iterator_traits<ForwardIt>::partitions(
-      first, last, rt::impl::getConcurrency());
-
-  if (parts.size()) {
-    rt::Handle map_h;
-    for (auto pit = parts.begin(); pit != parts.end(); ++pit) {
-      auto map_args = std::make_tuple(pit->begin(), pit->end(), map_kernel);
-      rt::asyncExecuteAt(
-          map_h, rt::thisLocality(),
-          [](rt::Handle&, const typeof(map_args)& map_args) {
-            auto pfirst = std::get<0>(map_args);
-            auto plast = std::get<1>(map_args);
-            auto map_kernel = std::get<2>(map_args);
-            // map over the partition
-            assert(pfirst != plast);
-            map_kernel(pfirst, plast);
-          },
-          map_args);
-    }
-    rt::waitForCompletion(map_h);
-  }
+      first, last, local_num_partitions(first, last, grain));
+
+  rt::impl::parallelFor(parts.size(), [&](size_t part_id) {
+    auto pfirst = parts[part_id].begin();
+    auto plast = parts[part_id].end();
+    // map over the partition
+    assert(pfirst != plast);
+    map_kernel(pfirst, plast);
+  });
 }
 
 // local_map_init variant with a void operation that takes in input the offset
 // of the processed partition with respect to the input range
 template <typename ForwardIt, typename MapF>
-void local_map_void_offset(ForwardIt first, ForwardIt last, MapF&& map_kernel) {
+void local_map_void_offset(ForwardIt first, ForwardIt last, MapF&& map_kernel,
+                           size_t grain = 1) {
+  auto parts = local_iterator_traits<ForwardIt>::partitions(
+      first, last, local_num_partitions(first, last, grain));
+
+  rt::impl::parallelFor(parts.size(), [&](size_t part_id) {
+    auto pfirst = parts[part_id].begin();
+    auto plast = parts[part_id].end();
+    auto poffset = std::distance(first, pfirst);
+    // map over the partition
+    assert(pfirst != plast);
+    map_kernel(pfirst, plast, poffset);
+  });
+}
+
+/// @brief applies the scan pattern over a distributed range
+///
+/// Each locality scans its local portion in parallel, one task per local
+/// partition, and writes to the output the scan of each partition in
+/// isolation.  The per-locality totals are then combined by a tree exclusive
+/// scan, and a second parallel pass folds into each partition the prefix of
+/// everything that precedes it.  The first pass is the only one reading the
+/// input, and the exchange between localities takes log2(P) steps.
+///
+/// @tparam T the type of the accumulated values
+/// @tparam InputIt the type of the iterators in the input range
+/// @tparam OutputIt the type of the iterators in the output range
+/// @tparam BinaryOperation the type of the associative scan operation
+/// @tparam UnaryOperation the type of the operation applied to each element
+///
+/// @param[in] first,last the input range
+/// @param d_first the beginning of the output range
+/// @param op the scan operation
+/// @param uop the operation applied to each element before the scan
+/// @param init the initial value, if valid
+/// @param exclusive whether the i-th output excludes the i-th input
+/// @param grain the minimum number of elements per local partition
+///
+/// @return the end of the output range
+template <typename T, typename InputIt, typename OutputIt,
+          typename BinaryOperation, typename UnaryOperation>
+OutputIt distributed_scan(InputIt first, InputIt last, OutputIt d_first,
+                          BinaryOperation op, UnaryOperation uop,
+                          const typename optional_vector<T>::entry_t& init,
+                          bool exclusive, size_t grain = 1) {
+  using itr_traits = distributed_iterator_traits<InputIt>;
+  using local_iterator_t = typename itr_traits::local_iterator_type;
+  using entry_t = typename optional_vector<T>::entry_t;
+  using combine_t = optional_combine<T, BinaryOperation>;
+  using args_t = std::tuple<InputIt, InputIt, OutputIt, combine_t,
+                            UnaryOperation, bool, size_t>;
+
+  rt::treeExclusiveScan(
+      itr_traits::localities(first, last),
+      // local pass
+      [](const args_t& args) {
+        auto gfirst = std::get<0>(args);
+        auto glast = std::get<1>(args);
+        auto lrange = itr_traits::local_range(gfirst, glast);
+        auto lfirst = lrange.begin();
+        if (lfirst == lrange.end()) return entry_t{T{}, false};
+        auto d_lfirst = std::get<2>(args);
+        std::advance(d_lfirst,
+                     std::distance(gfirst, itr_traits::iterator_from_local(
+                                               gfirst, glast, lfirst)));
+        auto combine = std::get<3>(args);
+        auto uop = std::get<4>(args);
+        auto totals = local_map_init(
+            // range
+            lfirst, lrange.end(),
+            // kernel
+            [&](local_iterator_t b, local_iterator_t e) {
+              auto d_it = d_lfirst;
+              std::advance(d_it, std::distance(lfirst, b));
+              T acc = uop(*b);
+              *d_it = acc;
+              while (++b != e) {
+                acc = combine.op(std::move(acc), uop(*b));
+                *++d_it = acc;
+              }
+              return entry_t{acc, true};
+            },
+            entry_t{T{}, false}, std::get<6>(args));
+        entry_t res{T{}, false};
+        for (auto& total : totals) res = combine(res, total);
+        return res;
+      },
+      combine_t{op},
+      // fixup pass
+      [](const args_t& args, const entry_t& prefix) {
+        auto gfirst = std::get<0>(args);
+        auto glast = std::get<1>(args);
+        auto lrange = itr_traits::local_range(gfirst, glast);
+        auto lfirst = lrange.begin();
+        if (lfirst == lrange.end()) return;
+        auto d_lfirst = std::get<2>(args);
+        std::advance(d_lfirst,
+                     std::distance(gfirst, itr_traits::iterator_from_local(
+                                               gfirst, glast, lfirst)));
+        auto combine = std::get<3>(args);
+        bool exclusive = std::get<5>(args);
+        size_t grain = std::get<6>(args);
+
+        // the prefix of each partition, from the last value it produced
+        auto parts = local_iterator_traits<local_iterator_t>::partitions(
+            lfirst, lrange.end(),
+            local_num_partitions(lfirst, lrange.end(), grain));
+        std::vector<size_t> starts;
+        std::vector<entry_t> prefixes;
+        entry_t acc = prefix;
+        for (auto& part : parts) {
+          starts.push_back(std::distance(lfirst, part.begin()));
+          prefixes.push_back(acc);
+          auto d_plast = d_lfirst;
+          std::advance(d_plast, std::distance(lfirst, part.end()) - 1);
+          acc = combine(acc, entry_t{*d_plast, true});
+        }
+
+        local_map_void_offset(
+            // range
+            lfirst, lrange.end(),
+            // kernel
+            [&](local_iterator_t b, local_iterator_t e, size_t poffset) {
+              auto part = std::lower_bound(starts.begin(), starts.end(),
+                                           poffset) -
+                          starts.begin();
+              const entry_t& pprefix = prefixes[part];
+              auto d_it = d_lfirst;
+              std::advance(d_it, poffset);
+              if (exclusive) {
+                T prev = pprefix.value;
+                for (; b != e; ++b, ++d_it) {
+                  T cur = *d_it;
+                  *d_it = prev;
+                  prev = combine.op(pprefix.value, cur);
+                }
+              } else if (pprefix.valid) {
+                for (; b != e; ++b, ++d_it) {
+                  *d_it = combine.op(pprefix.value, *d_it);
+                }
+              }
+            },
+            grain);
+      },
+      init, std::make_tuple(first, last, d_first, combine_t{op}, uop,
+                            exclusive, grain));
+
+  return std::next(d_first, std::distance(first, last));
+}
+
+/// @brief applies the search pattern over a local range
+///
+/// Applies a search operation in parallel to each partition of a local range
+/// and returns the first position it finds.  Each task scans its partition
+/// grain elements at a time and gives up as soon as a task working on a
+/// preceding partition reports a match, so the work past the first match is
+/// bounded by one grain per task.
+///
+/// @tparam ForwardIt the type of the iterators in the input range
+/// @tparam MapF the type of the search function object, returning the first
+/// matching position in the sub-range it is given or the end of the sub-range
+///
+/// @param[in] first,last the input range
+/// @param map_kernel the search function object that will be applied
+/// @param grain the number of elements scanned between two cancellation checks
+///
+/// @return the first matching position, or last if there is none
+template <typename ForwardIt, typename MapF>
+ForwardIt local_find(ForwardIt first, ForwardIt last, MapF&& map_kernel,
+                     size_t grain) {
   auto parts = local_iterator_traits<ForwardIt>::partitions(
-      first, last, rt::impl::getConcurrency());
-
-  if (parts.size()) {
-    rt::Handle map_h;
-    for (auto pit = parts.begin(); pit != parts.end(); ++pit) {
-      auto map_args = std::make_tuple(pit->begin(), pit->end(), map_kernel,
-                                      std::distance(first, pit->begin()));
-      rt::asyncExecuteAt(
-          map_h, rt::thisLocality(),
-          [](rt::Handle&, const typeof(map_args)& map_args) {
-            auto pfirst = std::get<0>(map_args);
-            auto plast = std::get<1>(map_args);
-            auto map_kernel = std::get<2>(map_args);
-            auto poffset = std::get<3>(map_args);
-            // map over the partition
-            assert(pfirst != plast);
-            map_kernel(pfirst, plast, poffset);
-          },
-          map_args);
+      first, last, local_num_partitions(first, last, grain));
+  std::vector<ForwardIt> map_res(parts.size(), last);
+  std::atomic<size_t> first_hit(parts.size());
+  size_t chunk = std::max<size_t>(grain, 1);
+
+  rt::impl::parallelFor(parts.size(), [&](size_t part_id) {
+    auto pfirst = parts[part_id].begin();
+    auto plast = parts[part_id].end();
+    // scan the partition one chunk at a time
+    while (pfirst != plast &&
+           part_id < first_hit.load(std::memory_order_relaxed)) {
+      auto chunk_last = pfirst;
+      for (size_t i = 0; i < chunk && chunk_last != plast; ++i) ++chunk_last;
+      auto res = map_kernel(pfirst, chunk_last);
+      if (res != chunk_last) {
+        map_res[part_id] = res;
+        auto hit = first_hit.load();
+        while (part_id < hit &&
+               !first_hit.compare_exchange_weak(hit, part_id)) {
+        }
+        return;
+      }
+      pfirst = chunk_last;
     }
-    rt::waitForCompletion(map_h);
-  }
+  });
+
+  return first_hit < parts.size() ? map_res[first_hit] : last;
 }
 
 }  // namespace impl
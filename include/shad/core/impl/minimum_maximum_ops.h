@@ -95,7 +95,7 @@ ForwardIt max_element(distributed_parallel_tag&& policy, ForwardIt first,
       // range
       first, last,
       // kernel
-      [](ForwardIt first, ForwardIt last, Compare comp) {
+      [](ForwardIt first, ForwardIt last, Compare comp, size_t grain) {
         using local_iterator_t = typename itr_traits::local_iterator_type;
 
         // local map
@@ -106,7 +106,9 @@ ForwardIt max_element(distributed_parallel_tag&& policy, ForwardIt first,
             // kernel
             [&](local_iterator_t b, local_iterator_t e) {
               return std::max_element(b, e, comp);
-            });
+            },
+            // grain
+            grain);
 
         // local reduce
         auto nil_val = itr_traits::local_range(first, last).end();
@@ -122,7 +124,7 @@ ForwardIt max_element(distributed_parallel_tag&& policy, ForwardIt first,
         return std::make_pair(gres, lmax != nil_val ? *lmax : value_t{});
       },
       // map arguments
-      comp);
+      comp, policy.grain_size);
 
   // reduce
   using map_res_t = typeof(map_res);
@@ -188,7 +190,7 @@ ForwardIt min_element(distributed_parallel_tag&& policy, ForwardIt first,
       // range
       first, last,
       // kernel
-      [](ForwardIt first, ForwardIt last, Compare comp) {
+      [](ForwardIt first, ForwardIt last, Compare comp, size_t grain) {
         using local_iterator_t = typename itr_traits::local_iterator_type;
 
         // local map
@@ -199,7 +201,9 @@ ForwardIt min_element(distributed_parallel_tag&& policy, ForwardIt first,
             // kernel
             [&](local_iterator_t b, local_iterator_t e) {
               return std::min_element(b, e, comp);
-            });
+            },
+            // grain
+            grain);
 
         // local reduce
         auto nil_val = itr_traits::local_range(first, last).end();
@@ -215,7 +219,7 @@ ForwardIt min_element(distributed_parallel_tag&& policy, ForwardIt first,
         return std::make_pair(gres, lmin != nil_val ? *lmin : value_t{});
       },
       // map arguments
-      comp);
+      comp, policy.grain_size);
 
   // reduce
   using map_res_t = typeof(map_res);
@@ -306,7 +310,7 @@ std::pair<ForwardIt, ForwardIt> minmax_element(
       // range
       first, last,
       // kernel
-      [](ForwardIt first, ForwardIt last, Compare comp) {
+      [](ForwardIt first, ForwardIt last, Compare comp, size_t grain) {
         using local_iterator_t = typename itr_traits::local_iterator_type;
 
         // local map
@@ -317,7 +321,9 @@ std::pair<ForwardIt, ForwardIt> minmax_element(
             // kernel
             [&](local_iterator_t b, local_iterator_t e) {
               return std::minmax_element(b, e, comp);
-            });
+            },
+            // grain
+            grain);
 
         // reduce
         auto nil_val = itr_traits::local_range(first, last).end();
@@ -343,7 +349,7 @@ std::pair<ForwardIt, ForwardIt> minmax_element(
                      lmax != nil_val ? *lmax : value_t{}};
       },
       // map arguments
-      comp);
+      comp, policy.grain_size);
 
   // reduce
   auto res_min = std::min_element(
@@ -51,7 +51,7 @@ void fill(distributed_parallel_tag&& policy, ForwardIt first, ForwardIt last,
       // range
       first, last,
       // kernel
-      [](ForwardIt first, ForwardIt last, const T& value) {
+      [](ForwardIt first, ForwardIt last, const T& value, size_t grain) {
         using local_iterator_t = typename itr_traits::local_iterator_type;
 
         // local map
@@ -63,10 +63,12 @@ void fill(distributed_parallel_tag&& policy, ForwardIt first, ForwardIt last,
             // kernel
             [&](local_iterator_t b, local_iterator_t e) {
               std::fill(b, e, value);
-            });
+            },
+            // grain
+            grain);
       },
       // map arguments
-      value);
+      value, policy.grain_size);
 }
 
 template <typename ForwardIt, typename T>
@@ -111,7 +113,8 @@ void block_contiguous_local(ForwardIt1 first, ForwardIt1 last,
 // parallel
 template <class ForwardIt1, class ForwardIt2, class UnaryOperation>
 void block_contiguous_local_par(ForwardIt1 first, ForwardIt1 last,
-                                ForwardIt2 d_first, UnaryOperation op) {
+                                ForwardIt2 d_first, UnaryOperation op,
+                                size_t grain) {
   using itr_traits1 = std::iterator_traits<ForwardIt1>;
   using itr_traits2 = distributed_iterator_traits<ForwardIt2>;
   auto size = std::distance(first, last);
@@ -127,7 +130,9 @@ void block_contiguous_local_par(ForwardIt1 first, ForwardIt1 last,
       // kernel
       [&](ForwardIt1 b, ForwardIt1 e, offset_t offset) {
         std::transform(b, e, local_d_range.begin() + offset, op);
-      });
+      },
+      // grain
+      grain);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -252,7 +257,7 @@ ForwardIt2 dseq_kernel(std::true_type, ForwardIt1 first, ForwardIt1 last,
 // parallel
 template <class ForwardIt1, class ForwardIt2, class UnaryOperation>
 ForwardIt2 dpar_kernel(std::true_type, ForwardIt1 first, ForwardIt1 last,
-                       ForwardIt2 d_first, UnaryOperation op) {
+                       ForwardIt2 d_first, UnaryOperation op, size_t grain) {
   using itr_traits1 = distributed_iterator_traits<ForwardIt1>;
   using itr_traits2 = distributed_random_access_iterator_trait<ForwardIt2>;
   auto loc_range = itr_traits1::local_range(first, last);
@@ -283,7 +288,8 @@ ForwardIt2 dpar_kernel(std::true_type, ForwardIt1 first, ForwardIt1 last,
 
   // process local portion
   if (coloc_first != coloc_last)
-    block_contiguous_local_par(coloc_first, coloc_last, coloc_d_first, op);
+    block_contiguous_local_par(coloc_first, coloc_last, coloc_d_first, op,
+                               grain);
 
   // join
   rt::waitForCompletion(h);
@@ -310,11 +316,24 @@ ForwardIt2 dseq_kernel(std::false_type, ForwardIt1 first, ForwardIt1 last,
 }
 
 // parallel
-// TODO(droccom) in-node parallelism
+// Each local partition inserts through its own copy of the output iterator.
 template <class ForwardIt1, class ForwardIt2, class UnaryOperation>
 ForwardIt2 dpar_kernel(std::false_type, ForwardIt1 first, ForwardIt1 last,
-                       ForwardIt2 d_first, UnaryOperation op) {
-  return dseq_kernel(std::false_type{}, first, last, d_first, op);
+                       ForwardIt2 d_first, UnaryOperation op, size_t grain) {
+  using itr_traits1 = distributed_iterator_traits<ForwardIt1>;
+  using local_iterator_t = typename itr_traits1::local_iterator_type;
+  auto local_range = itr_traits1::local_range(first, last);
+  local_map_void(
+      // range
+      local_range.begin(), local_range.end(),
+      // kernel
+      [&](local_iterator_t b, local_iterator_t e) {
+        auto res = std::transform(b, e, ForwardIt2(d_first), op);
+        flush_iterator(res);
+      },
+      // grain
+      grain);
+  return d_first;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -332,9 +351,9 @@ ForwardIt2 dseq_kernel(ForwardIt1 first, ForwardIt1 last, ForwardIt2 d_first,
 
 template <class ForwardIt1, class ForwardIt2, class UnaryOperation>
 ForwardIt2 dpar_kernel(ForwardIt1 first, ForwardIt1 last, ForwardIt2 d_first,
-                       UnaryOperation op) {
+                       UnaryOperation op, size_t grain) {
   return dpar_kernel(is_block_contiguous<ForwardIt2>::value, first, last,
-                     d_first, op);
+                     d_first, op, grain);
 }
 
 }  // namespace transform_impl
@@ -351,13 +370,14 @@ ForwardIt2 transform(distributed_parallel_tag&& policy, ForwardIt1 first1,
       first1, last1,
       // kernel
       [](ForwardIt1 first1, ForwardIt1 last1, ForwardIt2 d_first,
-         UnaryOperation unary_op) {
-        return transform_impl::dpar_kernel(first1, last1, d_first, unary_op);
+         UnaryOperation unary_op, size_t grain) {
+        return transform_impl::dpar_kernel(first1, last1, d_first, unary_op,
+                                           grain);
       },
       // init value
       d_first,
       // map arguments
-      d_first, unary_op);
+      d_first, unary_op, policy.grain_size);
 
   // reduce
   return map_res.back();
@@ -398,7 +418,7 @@ void generate(distributed_parallel_tag&& policy, ForwardIt first,
       // range
       first, last,
       // kernel
-      [](ForwardIt first, ForwardIt last, Generator generator) {
+      [](ForwardIt first, ForwardIt last, Generator generator, size_t grain) {
         using local_iterator_t = typename itr_traits::local_iterator_type;
 
         // local map
@@ -410,10 +430,12 @@ void generate(distributed_parallel_tag&& policy, ForwardIt first,
             // kernel
             [&](local_iterator_t b, local_iterator_t e) {
               std::generate(b, e, generator);
-            });
+            },
+            // grain
+            grain);
       },
       // map arguments
-      generator);
+      generator, policy.grain_size);
 }
 
 template <typename ForwardIt, typename Generator>
@@ -445,7 +467,7 @@ void replace(distributed_parallel_tag&& policy, ForwardIt first, ForwardIt last,
       first, last,
       // kernel
       [](ForwardIt first, ForwardIt last, const T& old_value,
-         const T& new_value) {
+         const T& new_value, size_t grain) {
         using local_iterator_t = typename itr_traits::local_iterator_type;
 
         // local map
@@ -457,10 +479,12 @@ void replace(distributed_parallel_tag&& policy, ForwardIt first, ForwardIt last,
             // kernel
             [&](local_iterator_t b, local_iterator_t e) {
               std::replace(b, e, old_value, new_value);
-            });
+            },
+            // grain
+            grain);
       },
       // map arguments
-      old_value, new_value);
+      old_value, new_value, policy.grain_size);
 }
 
 template <typename ForwardIt, typename T>
@@ -492,8 +516,8 @@ void replace_if(distributed_parallel_tag&& policy, ForwardIt first,
       // range
       first, last,
       // kernel
-      [](ForwardIt first, ForwardIt last, UnaryPredicate p,
-         const T& new_value) {
+      [](ForwardIt first, ForwardIt last, UnaryPredicate p, const T& new_value,
+         size_t grain) {
         using local_iterator_t = typename itr_traits::local_iterator_type;
 
         // local map
@@ -505,10 +529,12 @@ void replace_if(distributed_parallel_tag&& policy, ForwardIt first,
             // kernel
             [&](local_iterator_t b, local_iterator_t e) {
               std::replace_if(b, e, p, new_value);
-            });
+            },
+            // grain
+            grain);
       },
       // map arguments
-      p, new_value);
+      p, new_value, policy.grain_size);
 }
 
 template <typename ForwardIt, typename UnaryPredicate, typename T>
@@ -69,32 +69,31 @@ template <typename ForwardItr, typename UnaryPredicate>
 bool all_of(distributed_parallel_tag&& policy, ForwardItr first,
             ForwardItr last, UnaryPredicate p) {
   using itr_traits = distributed_iterator_traits<ForwardItr>;
-  using value_t = typename itr_traits::value_type;
 
   // distributed map
   auto map_res = distributed_map(
       // range
       first, last,
       // kernel
-      [](ForwardItr first, ForwardItr last, UnaryPredicate p) -> uint8_t {
+      [](ForwardItr first, ForwardItr last, UnaryPredicate p,
+         size_t grain) -> uint8_t {
         using local_iterator_t = typename itr_traits::local_iterator_type;
 
-        // local map
+        // local search
         auto lrange = itr_traits::local_range(first, last);
-
-        auto map_res = local_map(
+        auto found = local_find(
             // range
             lrange.begin(), lrange.end(),
             // kernel
-            [&](const local_iterator_t& b, const local_iterator_t& e)
-                -> uint8_t { return std::all_of(b, e, p); });
-
-        // local reduce
-        return std::all_of(map_res.begin(), map_res.end(),
-                           [](bool x) { return x; });
+            [&](local_iterator_t b, local_iterator_t e) {
+              return std::find_if_not(b, e, p);
+            },
+            // grain
+            grain);
+        return found == lrange.end();
       },
       // map arguments
-      p);
+      p, policy.grain_size);
 
   // reduce
   return std::all_of(map_res.begin(), map_res.end(), [](bool x) { return x; });
@@ -129,33 +128,31 @@ template <typename ForwardItr, typename UnaryPredicate>
 bool any_of(distributed_parallel_tag&& policy, ForwardItr first,
             ForwardItr last, UnaryPredicate p) {
   using itr_traits = distributed_iterator_traits<ForwardItr>;
-  using value_t = typename itr_traits::value_type;
 
   // distributed map
   auto map_res = distributed_map(
       // range
       first, last,
       // kernel
-      [](ForwardItr first, ForwardItr last, UnaryPredicate p) -> uint8_t {
+      [](ForwardItr first, ForwardItr last, UnaryPredicate p,
+         size_t grain) -> uint8_t {
         using local_iterator_t = typename itr_traits::local_iterator_type;
 
-        // local map
+        // local search
         auto lrange = itr_traits::local_range(first, last);
-
-        auto map_res = local_map(
+        auto found = local_find(
             // range
             lrange.begin(), lrange.end(),
             // kernel
-            [&](local_iterator_t b, local_iterator_t e) -> uint8_t {
-              return std::any_of(b, e, p);
-            });
-
-        // local reduce
-        return std::any_of(map_res.begin(), map_res.end(),
-                           [](bool x) { return x; });
+            [&](local_iterator_t b, local_iterator_t e) {
+              return std::find_if(b, e, p);
+            },
+            // grain
+            grain);
+        return found != lrange.end();
       },
       // map arguments
-      p);
+      p, policy.grain_size);
 
   // reduce
   return std::any_of(map_res.begin(), map_res.end(), [](bool x) { return x; });
@@ -192,38 +189,32 @@ template <typename ForwardItr, typename T>
 ForwardItr find(distributed_parallel_tag&& policy, ForwardItr first,
                 ForwardItr last, const T& value) {
   using itr_traits = distributed_iterator_traits<ForwardItr>;
-  using value_t = typename itr_traits::value_type;
 
   // distributed map
   auto map_res = distributed_map(
       // range
       first, last,
       // kernel
-      [](ForwardItr first, ForwardItr last, const T& value) {
+      [](ForwardItr first, ForwardItr last, const T& value, size_t grain) {
         using local_iterator_t = typename itr_traits::local_iterator_type;
 
-        // local map
+        // local search
         auto lrange = itr_traits::local_range(first, last);
-
-        auto map_res = local_map(
+        auto found = local_find(
             // range
             lrange.begin(), lrange.end(),
             // kernel
             [&](local_iterator_t b, local_iterator_t e) {
-              auto res = std::find(b, e, value);
-              return res != e ? res : lrange.end();
-            });
-
-        // local reduce
-        auto found = std::find_if(
-            map_res.begin(), map_res.end(),
-            [&](const local_iterator_t& i) { return i != lrange.end(); });
-        return found != map_res.end()
-                   ? itr_traits::iterator_from_local(first, last, *found)
+              return std::find(b, e, value);
+            },
+            // grain
+            grain);
+        return found != lrange.end()
+                   ? itr_traits::iterator_from_local(first, last, found)
                    : last;
       },
       // map arguments
-      value);
+      value, policy.grain_size);
 
   // reduce
   auto found = std::find_if(map_res.begin(), map_res.end(),
@@ -262,38 +253,32 @@ template <typename ForwardItr, typename UnaryPredicate>
 ForwardItr find_if(distributed_parallel_tag&& policy, ForwardItr first,
                    ForwardItr last, UnaryPredicate p) {
   using itr_traits = distributed_iterator_traits<ForwardItr>;
-  using value_t = typename itr_traits::value_type;
 
   // distributed map
   auto map_res = distributed_map(
       // range
       first, last,
       // kernel
-      [](ForwardItr first, ForwardItr last, UnaryPredicate p) {
+      [](ForwardItr first, ForwardItr last, UnaryPredicate p, size_t grain) {
         using local_iterator_t = typename itr_traits::local_iterator_type;
 
-        // local map
+        // local search
         auto lrange = itr_traits::local_range(first, last);
-
-        auto map_res = local_map(
+        auto found = local_find(
             // range
             lrange.begin(), lrange.end(),
             // kernel
             [&](local_iterator_t b, local_iterator_t e) {
-              auto res = std::find_if(b, e, p);
-              return res != e ? res : lrange.end();
-            });
-
-        // local reduce
-        auto found = std::find_if(
-            map_res.begin(), map_res.end(),
-            [&](const local_iterator_t& i) { return i != lrange.end(); });
-        return found != map_res.end()
-                   ? itr_traits::iterator_from_local(first, last, *found)
+              return std::find_if(b, e, p);
+            },
+            // grain
+            grain);
+        return found != lrange.end()
+                   ? itr_traits::iterator_from_local(first, last, found)
                    : last;
       },
       // map arguments
-      p);
+      p, policy.grain_size);
 
   // reduce
   auto found = std::find_if(map_res.begin(), map_res.end(),
@@ -332,38 +317,32 @@ template <typename ForwardItr, typename UnaryPredicate>
 ForwardItr find_if_not(distributed_parallel_tag&& policy, ForwardItr first,
                        ForwardItr last, UnaryPredicate p) {
   using itr_traits = distributed_iterator_traits<ForwardItr>;
-  using value_t = typename itr_traits::value_type;
 
   // distributed map
   auto map_res = distributed_map(
       // range
       first, last,
       // kernel
-      [](ForwardItr first, ForwardItr last, UnaryPredicate p) {
+      [](ForwardItr first, ForwardItr last, UnaryPredicate p, size_t grain) {
         using local_iterator_t = typename itr_traits::local_iterator_type;
 
-        // local map
+        // local search
         auto lrange = itr_traits::local_range(first, last);
-
-        auto map_res = local_map(
+        auto found = local_find(
             // range
             lrange.begin(), lrange.end(),
             // kernel
             [&](local_iterator_t b, local_iterator_t e) {
-              auto res = std::find_if_not(b, e, p);
-              return res != e ? res : lrange.end();
-            });
-
-        // local reduce
-        auto found = std::find_if(
-            map_res.begin(), map_res.end(),
-            [&](const local_iterator_t& i) { return i != lrange.end(); });
-        return found != map_res.end()
-                   ? itr_traits::iterator_from_local(first, last, *found)
+              return std::find_if_not(b, e, p);
+            },
+            // grain
+            grain);
+        return found != lrange.end()
+                   ? itr_traits::iterator_from_local(first, last, found)
                    : last;
       },
       // map arguments
-      p);
+      p, policy.grain_size);
 
   // reduce
   auto found = std::find_if(map_res.begin(), map_res.end(),
@@ -399,7 +378,7 @@ void for_each(distributed_parallel_tag&& policy, ForwardItr first,
       // range
       first, last,
       // kernel
-      [](ForwardItr first, ForwardItr last, UnaryPredicate p) {
+      [](ForwardItr first, ForwardItr last, UnaryPredicate p, size_t grain) {
         using local_iterator_t = typename itr_traits::local_iterator_type;
 
         // local map
@@ -411,10 +390,12 @@ void for_each(distributed_parallel_tag&& policy, ForwardItr first,
             // kernel
             [&](local_iterator_t b, local_iterator_t e) {
               std::for_each(b, e, p);
-            });
+            },
+            // grain
+            grain);
       },
       // map arguments
-      p);
+      p, policy.grain_size);
 }
 
 template <typename InputItr, typename T>
@@ -455,7 +436,7 @@ typename shad::distributed_iterator_traits<InputItr>::difference_type count(
       // range
       first, last,
       // kernel
-      [](InputItr first, InputItr last, const T& value) {
+      [](InputItr first, InputItr last, const T& value, size_t grain) {
         using local_iterator_t = typename itr_traits::local_iterator_type;
 
         // local map
@@ -467,7 +448,9 @@ typename shad::distributed_iterator_traits<InputItr>::difference_type count(
             // kernel
             [&](local_iterator_t b, local_iterator_t e) {
               return std::count(b, e, value);
-            });
+            },
+            // grain
+            grain);
 
         // local reduce
         return std::accumulate(
@@ -475,7 +458,7 @@ typename shad::distributed_iterator_traits<InputItr>::difference_type count(
             [](const res_t& acc, const res_t& x) { return acc + x; });
       },
       // map arguments
-      value);
+      value, policy.grain_size);
 
   // reduce
   return std::accumulate(
@@ -521,7 +504,7 @@ typename shad::distributed_iterator_traits<InputItr>::difference_type count_if(
       // range
       first, last,
       // kernel
-      [](InputItr first, InputItr last, UnaryPredicate p) {
+      [](InputItr first, InputItr last, UnaryPredicate p, size_t grain) {
         using local_iterator_t = typename itr_traits::local_iterator_type;
 
         // local map
@@ -533,7 +516,9 @@ typename shad::distributed_iterator_traits<InputItr>::difference_type count_if(
             // kernel
             [&](local_iterator_t b, local_iterator_t e) {
               return std::count_if(b, e, p);
-            });
+            },
+            // grain
+            grain);
 
         // local reduce
         return std::accumulate(
@@ -541,7 +526,7 @@ typename shad::distributed_iterator_traits<InputItr>::difference_type count_if(
             [](const res_t& acc, const res_t& x) { return acc + x; });
       },
       // map arguments
-      p);
+      p, policy.grain_size);
 
   // reduce
   return std::accumulate(
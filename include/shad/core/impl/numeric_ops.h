@@ -39,6 +39,14 @@
 namespace shad {
 namespace impl {
 
+// the element-wise operation of the scans that do not transform the input
+struct identity_op {
+  template <typename T>
+  const T& operator()(const T& value) const {
+    return value;
+  }
+};
+
 template <typename ForwardIterator, typename T>
 void iota(ForwardIterator first, ForwardIterator last, const T& value) {
   using itr_traits = distributed_iterator_traits<ForwardIterator>;
@@ -228,9 +236,8 @@ OutputIt adjacent_difference(distributed_parallel_tag&& policy, InputIt first,
             *d_first = acc;
           } else {
             auto it = itr_traits::iterator_from_local(gbegin, gend, begin);
+            std::advance(d_first, std::distance(gbegin, it));
             --it;
-            std::advance(d_first, (std::distance(gbegin, it)));
-            value_t val = *d_first;
             *d_first = op(*begin, *it);
           }
           while (++begin != end) {
@@ -302,16 +309,20 @@ T reduce(distributed_parallel_tag&& policy, InputIt first, InputIt last, T init,
   static_assert(std::is_default_constructible<T>::value,
                 "reduce requires DefaultConstructible value type");
 
-  // distributed map
-  auto map_res = distributed_map(
-      // range
-      first, last,
+  using entry_t = typename optional_vector<T>::entry_t;
+
+  // distributed map, tree reduce
+  auto res = rt::treeReduce(
+      // localities
+      itr_traits::localities(first, last),
       // kernel
-      [](InputIt first, InputIt last, BinaryOperation op) {
+      [](const std::tuple<InputIt, InputIt, BinaryOperation, size_t>& args) {
         using local_iterator_t = typename itr_traits::local_iterator_type;
+        auto op = std::get<2>(args);
 
         // local map
-        auto lrange = itr_traits::local_range(first, last);
+        auto lrange = itr_traits::local_range(std::get<0>(args),
+                                              std::get<1>(args));
         auto map_res = local_map(
             // range
             lrange.begin(), lrange.end(),
@@ -320,23 +331,20 @@ T reduce(distributed_parallel_tag&& policy, InputIt first, InputIt last, T init,
               auto res = *b;
               while (++b != e) res = op(std::move(res), *b);
               return res;
-            });
+            },
+            std::get<3>(args));
 
         // local reduce
         auto b = map_res.begin(), e = map_res.end();
-        T res;
-        if (b != e) {
-          res = *b++;
-          res = std::accumulate(b, e, std::move(res), op);
-        }
-        return res;
+        if (b == e) return entry_t{T{}, false};
+        T res = *b++;
+        return entry_t{std::accumulate(b, e, std::move(res), op), true};
       },
+      // reduce
+      optional_combine<T, BinaryOperation>{op}, entry_t{init, true},
       // map arguments
-      op);
-
-  // TODO parallel
-  // reduce
-  return std::accumulate(map_res.begin(), map_res.end(), init, op);
+      std::make_tuple(first, last, op, policy.grain_size));
+  return res.value;
 }
 
 template <class InputIt, class OutputIt, class BinaryOperation, class T>
@@ -382,81 +390,8 @@ template <class InputIt, class OutputIt, class BinaryOperation, class T>
 OutputIt exclusive_scan(distributed_parallel_tag&& policy, InputIt first,
                         InputIt last, OutputIt d_first, BinaryOperation op,
                         T init) {
-  using itr_traits = distributed_iterator_traits<InputIt>;
-  auto localities = itr_traits::localities(first, last);
-  auto startingLoc = localities.begin();
-  uint32_t numLoc = localities.size();
-  std::vector<std::pair<OutputIt, T>> res(numLoc);
-  rt::Handle h;
-  size_t i = 0;
-  for (auto locality = startingLoc, end = localities.end(); locality != end;
-       ++locality, ++i) {
-    rt::asyncExecuteAtWithRet(
-        h, locality,
-        [](rt::Handle&,
-           const std::tuple<InputIt, InputIt, OutputIt, BinaryOperation>& args,
-           std::pair<OutputIt, T>* result) {
-          auto d_first = std::get<2>(args);
-          auto df = d_first;
-          auto gbegin = std::get<0>(args);
-          auto gend = std::get<1>(args);
-          auto local_range = itr_traits::local_range(gbegin, gend);
-          auto begin = local_range.begin();
-          auto end = local_range.end();
-          auto it = itr_traits::iterator_from_local(gbegin, gend, begin);
-          auto dist = std::distance(gbegin, it);
-          std::advance(d_first, dist);
-          if (begin == end) {
-            *result = std::make_pair(d_first, T{});
-            return;
-          }
-          BinaryOperation op = std::get<3>(args);
-          T acc = *begin;
-          *d_first = acc;
-          while (++begin != end) {
-            *++d_first = acc;
-            acc = op(std::move(acc), *begin);
-          }
-          *result = std::make_pair(++d_first, acc);
-        },
-        std::make_tuple(first, last, d_first, op), &res[i]);
-  }
-  rt::waitForCompletion(h);
-  auto d_f = d_first;
-  auto acc = init;
-  OutputIt chunk_end = d_first;
-  using outitr_traits = distributed_iterator_traits<OutputIt>;
-  for (i = 0; i < numLoc; ++i) {
-    chunk_end = res[i].first;
-    auto d_localities = outitr_traits::localities(d_f, chunk_end);
-    auto d_startingLoc = d_localities.begin();
-    for (auto locality = d_startingLoc, end = d_localities.end();
-         locality != end; ++locality) {
-      rt::asyncExecuteAt(
-          h, locality,
-          [](rt::Handle&,
-             const std::tuple<OutputIt, OutputIt, BinaryOperation, T>& args) {
-            auto gbegin = std::get<0>(args);
-            auto gend = std::get<1>(args);
-            auto local_range = outitr_traits::local_range(std::get<0>(args),
-                                                          std::get<1>(args));
-            auto begin = local_range.begin();
-            auto end = local_range.end();
-            if (begin == end) return;
-            BinaryOperation op = std::get<2>(args);
-            auto acc = std::get<3>(args);
-            *begin = acc;
-            for (++begin; begin != end; ++begin) {
-              *begin = op(std::move(acc), *begin);
-            }
-          },
-          std::make_tuple(d_f, chunk_end, op, acc));
-    }
-    d_f = chunk_end;
-    acc = op(std::move(acc), res[i].second);
-  }
-  rt::waitForCompletion(h);
-  return chunk_end;
+  return distributed_scan<T>(first, last, d_first, op, identity_op{},
+                             {init, true}, true, policy.grain_size);
 }
 
 template <class InputIt, class OutputIt, class BinaryOperation>
@@ -507,82 +442,10 @@ OutputIt inclusive_scan(distributed_sequential_tag&& policy, InputIt first,
 template <class InputIt, class OutputIt, class BinaryOperation>
 OutputIt inclusive_scan(distributed_parallel_tag&& policy, InputIt first,
                         InputIt last, OutputIt d_first, BinaryOperation op) {
-  using itr_traits = distributed_iterator_traits<InputIt>;
-  using value_t = typename itr_traits::value_type;
-  auto localities = itr_traits::localities(first, last);
-  auto startingLoc = localities.begin();
-  uint32_t numLoc = localities.size();
-  if (numLoc == 0) {
-    return d_first;
-  }
-  std::vector<std::pair<OutputIt, value_t>> res(numLoc);
-  rt::Handle h;
-  size_t i = 0;
-  for (auto locality = startingLoc, end = localities.end(); locality != end;
-       ++locality, ++i) {
-    rt::asyncExecuteAtWithRet(
-        h, locality,
-        [](rt::Handle&,
-           const std::tuple<InputIt, InputIt, OutputIt, BinaryOperation>& args,
-           std::pair<OutputIt, value_t>* result) {
-          auto d_first = std::get<2>(args);
-          auto df = d_first;
-          auto gbegin = std::get<0>(args);
-          auto gend = std::get<1>(args);
-          auto local_range = itr_traits::local_range(gbegin, gend);
-          auto begin = local_range.begin();
-          auto end = local_range.end();
-          auto it = itr_traits::iterator_from_local(gbegin, gend, begin);
-          auto dist = std::distance(gbegin, it);
-          std::advance(d_first, dist);
-          if (begin == end) {
-            *result = std::make_pair(d_first, value_t{});
-            return;
-          }
-          BinaryOperation op = std::get<3>(args);
-          value_t acc = *begin;
-          *d_first = acc;
-          while (++begin != end) {
-            acc = op(std::move(acc), *begin);
-            *++d_first = acc;
-          }
-          *result = std::make_pair(++d_first, acc);
-        },
-        std::make_tuple(first, last, d_first, op), &res[i]);
-  }
-  rt::waitForCompletion(h);
-  auto d_f = res[0].first;
-  value_t acc = res[0].second;
-  OutputIt chunk_end = d_first;
-  for (i = 1; i < numLoc; ++i) {
-    chunk_end = res[i].first;
-    auto d_localities = itr_traits::localities(d_f, chunk_end);
-    auto d_startingLoc = d_localities.begin();
-    for (auto locality = d_startingLoc, end = d_localities.end();
-         locality != end; ++locality) {
-      rt::asyncExecuteAt(
-          h, locality,
-          [](rt::Handle&, const std::tuple<OutputIt, OutputIt, BinaryOperation,
-                                           value_t>& args) {
-            auto gbegin = std::get<0>(args);
-            auto gend = std::get<1>(args);
-            auto local_range =
-                itr_traits::local_range(std::get<0>(args), std::get<1>(args));
-            auto begin = local_range.begin();
-            auto end = local_range.end();
-            BinaryOperation op = std::get<2>(args);
-            auto acc = std::get<3>(args);
-            for (auto it = begin; it != end; ++it) {
-              *it = op(*it, std::move(acc));
-            }
-          },
-          std::make_tuple(d_f, chunk_end, op, acc));
-    }
-    d_f = chunk_end;
-    acc = op(std::move(acc), res[i].second);
-  }
-  rt::waitForCompletion(h);
-  return chunk_end;
+  using value_t = typename distributed_iterator_traits<InputIt>::value_type;
+  return distributed_scan<value_t>(first, last, d_first, op, identity_op{},
+                                   {value_t{}, false}, false,
+                                   policy.grain_size);
 }
 
 template <class InputIt, class OutputIt, class BinaryOperation, class T>
@@ -627,79 +490,8 @@ template <class InputIt, class OutputIt, class BinaryOperation, class T>
 OutputIt inclusive_scan(distributed_parallel_tag&& policy, InputIt first,
                         InputIt last, OutputIt d_first, BinaryOperation op,
                         T init) {
-  using itr_traits = distributed_iterator_traits<InputIt>;
-  auto localities = itr_traits::localities(first, last);
-  auto startingLoc = localities.begin();
-  uint32_t numLoc = localities.size();
-  std::vector<std::pair<OutputIt, T>> res(numLoc);
-  rt::Handle h;
-  size_t i = 0;
-  for (auto locality = startingLoc, end = localities.end(); locality != end;
-       ++locality, ++i) {
-    rt::asyncExecuteAtWithRet(
-        h, locality,
-        [](rt::Handle&,
-           const std::tuple<InputIt, InputIt, OutputIt, BinaryOperation>& args,
-           std::pair<OutputIt, T>* result) {
-          auto d_first = std::get<2>(args);
-          auto df = d_first;
-          auto gbegin = std::get<0>(args);
-          auto gend = std::get<1>(args);
-          auto local_range = itr_traits::local_range(gbegin, gend);
-          auto begin = local_range.begin();
-          auto end = local_range.end();
-          auto it = itr_traits::iterator_from_local(gbegin, gend, begin);
-          auto dist = std::distance(gbegin, it);
-          std::advance(d_first, dist);
-          if (begin == end) {
-            *result = std::make_pair(d_first, T{});
-            return;
-          }
-          BinaryOperation op = std::get<3>(args);
-          T acc = *begin;
-          *d_first = acc;
-          while (++begin != end) {
-            acc = op(std::move(acc), *begin);
-            *++d_first = acc;
-          }
-          *result = std::make_pair(++d_first, acc);
-        },
-        std::make_tuple(first, last, d_first, op), &res[i]);
-  }
-  rt::waitForCompletion(h);
-  auto d_f = d_first;
-  auto acc = init;
-  OutputIt chunk_end = d_first;
-  using outitr_traits = distributed_iterator_traits<OutputIt>;
-  for (i = 0; i < numLoc; ++i) {
-    chunk_end = res[i].first;
-    auto d_localities = outitr_traits::localities(d_f, chunk_end);
-    auto d_startingLoc = d_localities.begin();
-    for (auto locality = d_startingLoc, end = d_localities.end();
-         locality != end; ++locality) {
-      rt::asyncExecuteAt(
-          h, locality,
-          [](rt::Handle&,
-             const std::tuple<OutputIt, OutputIt, BinaryOperation, T>& args) {
-            auto gbegin = std::get<0>(args);
-            auto gend = std::get<1>(args);
-            auto local_range =
-                itr_traits::local_range(std::get<0>(args), std::get<1>(args));
-            auto begin = local_range.begin();
-            auto end = local_range.end();
-            BinaryOperation op = std::get<2>(args);
-            auto acc = std::get<3>(args);
-            for (auto it = begin; it != end; ++it) {
-              *it = op(std::move(acc), *it);
-            }
-          },
-          std::make_tuple(d_f, chunk_end, op, acc));
-    }
-    d_f = chunk_end;
-    acc = op(std::move(acc), res[i].second);
-  }
-  rt::waitForCompletion(h);
-  return chunk_end;
+  return distributed_scan<T>(first, last, d_first, op, identity_op{},
+                             {init, true}, false, policy.grain_size);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -740,16 +532,22 @@ T transform_reduce(distributed_parallel_tag&& policy, ForwardIt first,
       std::is_default_constructible<T>::value,
       "transform_reduce requires DefaultConstructible transformed value type");
 
-  // distributed map
-  auto map_res = distributed_map(
-      // range
-      first, last,
+  using entry_t = typename optional_vector<T>::entry_t;
+
+  // distributed map, tree reduce
+  auto res = rt::treeReduce(
+      // localities
+      itr_traits::localities(first, last),
       // kernel
-      [](ForwardIt first, ForwardIt last, BinaryOp op, UnaryOp uop) {
+      [](const std::tuple<ForwardIt, ForwardIt, BinaryOp, UnaryOp, size_t>&
+             args) {
         using local_iterator_t = typename itr_traits::local_iterator_type;
+        auto op = std::get<2>(args);
+        auto uop = std::get<3>(args);
 
         // local map
-        auto lrange = itr_traits::local_range(first, last);
+        auto lrange = itr_traits::local_range(std::get<0>(args),
+                                              std::get<1>(args));
         auto map_res = local_map(
             // range
             lrange.begin(), lrange.end(),
@@ -758,23 +556,20 @@ T transform_reduce(distributed_parallel_tag&& policy, ForwardIt first,
               auto res = uop(*b++);
               for (; b != e; b++) res = op(std::move(res), uop(*b));
               return res;
-            });
+            },
+            std::get<4>(args));
 
         // local reduce
         auto b = map_res.begin(), e = map_res.end();
-        T res{};
-        if (b != e) {
-          res = *b++;
-          res = std::accumulate(b, e, std::move(res), op);
-        }
-        return res;
+        if (b == e) return entry_t{T{}, false};
+        T res = *b++;
+        return entry_t{std::accumulate(b, e, std::move(res), op), true};
       },
+      // reduce
+      optional_combine<T, BinaryOp>{op}, entry_t{init, true},
       // map arguments
-      op, uop);
-
-  // TODO parallel
-  // reduce
-  return std::accumulate(map_res.begin(), map_res.end(), init, op);
+      std::make_tuple(first, last, op, uop, policy.grain_size));
+  return res.value;
 }
 
 // two ranges - sequential
@@ -904,84 +699,8 @@ OutputIt transform_exclusive_scan(distributed_parallel_tag&& policy,
                                   InputIt first, InputIt last, OutputIt d_first,
                                   T init, BinaryOperation op,
                                   UnaryOperation uop) {
-  using itr_traits = distributed_iterator_traits<InputIt>;
-  auto localities = itr_traits::localities(first, last);
-  auto startingLoc = localities.begin();
-  uint32_t numLoc = localities.size();
-  std::vector<std::pair<OutputIt, T>> res(numLoc);
-  rt::Handle h;
-  size_t i = 0;
-  for (auto locality = startingLoc, end = localities.end(); locality != end;
-       ++locality, ++i) {
-    rt::asyncExecuteAtWithRet(
-        h, locality,
-        [](rt::Handle&,
-           const std::tuple<InputIt, InputIt, OutputIt, BinaryOperation,
-                            UnaryOperation>& args,
-           std::pair<OutputIt, T>* result) {
-          auto d_first = std::get<2>(args);
-          auto df = d_first;
-          auto gbegin = std::get<0>(args);
-          auto gend = std::get<1>(args);
-          auto local_range = itr_traits::local_range(gbegin, gend);
-          auto begin = local_range.begin();
-          auto end = local_range.end();
-          auto it = itr_traits::iterator_from_local(gbegin, gend, begin);
-          auto dist = std::distance(gbegin, it);
-          std::advance(d_first, dist);
-          if (begin == end) {
-            *result = std::make_pair(d_first, T{});
-            return;
-          }
-          auto op = std::get<3>(args);
-          auto uop = std::get<4>(args);
-          T acc = *begin;
-          *d_first = acc;
-          acc = uop(acc);
-          while (++begin != end) {
-            *++d_first = acc;
-            acc = op(std::move(acc), uop(*begin));
-          }
-          *result = std::make_pair(++d_first, acc);
-        },
-        std::make_tuple(first, last, d_first, op, uop), &res[i]);
-  }
-  rt::waitForCompletion(h);
-  auto d_f = d_first;
-  auto acc = init;
-  OutputIt chunk_end = d_first;
-  using outitr_traits = distributed_iterator_traits<OutputIt>;
-  for (i = 0; i < numLoc; ++i) {
-    chunk_end = res[i].first;
-    auto d_localities = outitr_traits::localities(d_f, chunk_end);
-    auto d_startingLoc = d_localities.begin();
-    for (auto locality = d_startingLoc, end = d_localities.end();
-         locality != end; ++locality) {
-      rt::asyncExecuteAt(
-          h, locality,
-          [](rt::Handle&,
-             const std::tuple<OutputIt, OutputIt, BinaryOperation, T>& args) {
-            auto gbegin = std::get<0>(args);
-            auto gend = std::get<1>(args);
-            auto local_range =
-                itr_traits::local_range(std::get<0>(args), std::get<1>(args));
-            auto begin = local_range.begin();
-            auto end = local_range.end();
-            if (begin == end) return;
-            BinaryOperation op = std::get<2>(args);
-            auto acc = std::get<3>(args);
-            *begin = acc;
-            for (++begin; begin != end; ++begin) {
-              *begin = op(std::move(acc), *begin);
-            }
-          },
-          std::make_tuple(d_f, chunk_end, op, acc));
-    }
-    d_f = chunk_end;
-    acc = op(std::move(acc), res[i].second);
-  }
-  rt::waitForCompletion(h);
-  return chunk_end;
+  return distributed_scan<T>(first, last, d_first, op, uop, {init, true},
+                             true, policy.grain_size);
 }
 
 template <class InputIt, class OutputIt, class BinaryOperation,
@@ -1038,85 +757,10 @@ template <class InputIt, class OutputIt, class BinaryOperation,
 OutputIt transform_inclusive_scan(distributed_parallel_tag&& policy,
                                   InputIt first, InputIt last, OutputIt d_first,
                                   BinaryOperation op, UnaryOperation uop) {
-  using itr_traits = distributed_iterator_traits<InputIt>;
-  using value_t = typename itr_traits::value_type;
-  auto localities = itr_traits::localities(first, last);
-  auto startingLoc = localities.begin();
-  uint32_t numLoc = localities.size();
-  if (numLoc == 0) {
-    return d_first;
-  }
-  std::vector<std::pair<OutputIt, value_t>> res(numLoc);
-  rt::Handle h;
-  size_t i = 0;
-  for (auto locality = startingLoc, end = localities.end(); locality != end;
-       ++locality, ++i) {
-    rt::asyncExecuteAtWithRet(
-        h, locality,
-        [](rt::Handle&,
-           const std::tuple<InputIt, InputIt, OutputIt, BinaryOperation,
-                            UnaryOperation>& args,
-           std::pair<OutputIt, value_t>* result) {
-          auto d_first = std::get<2>(args);
-          auto df = d_first;
-          auto gbegin = std::get<0>(args);
-          auto gend = std::get<1>(args);
-          auto local_range = itr_traits::local_range(gbegin, gend);
-          auto begin = local_range.begin();
-          auto end = local_range.end();
-          auto it = itr_traits::iterator_from_local(gbegin, gend, begin);
-          auto dist = std::distance(gbegin, it);
-          std::advance(d_first, dist);
-          if (begin == end) {
-            *result = std::make_pair(d_first, value_t{});
-            return;
-          }
-          BinaryOperation op = std::get<3>(args);
-          UnaryOperation uop = std::get<4>(args);
-          value_t acc = uop(*begin);
-          *d_first = acc;
-          while (++begin != end) {
-            acc = op(std::move(acc), uop(*begin));
-            *++d_first = acc;
-          }
-          *result = std::make_pair(++d_first, acc);
-        },
-        std::make_tuple(first, last, d_first, op, uop), &res[i]);
-  }
-  rt::waitForCompletion(h);
-  auto d_f = res[0].first;
-  value_t acc = res[0].second;
-  OutputIt chunk_end = d_first;
-  using outitr_traits = distributed_iterator_traits<OutputIt>;
-  for (i = 1; i < numLoc; ++i) {
-    chunk_end = res[i].first;
-    auto d_localities = outitr_traits::localities(d_f, chunk_end);
-    auto d_startingLoc = d_localities.begin();
-    for (auto locality = d_startingLoc, end = d_localities.end();
-         locality != end; ++locality) {
-      rt::asyncExecuteAt(
-          h, locality,
-          [](rt::Handle&, const std::tuple<OutputIt, OutputIt, BinaryOperation,
-                                           value_t>& args) {
-            auto gbegin = std::get<0>(args);
-            auto gend = std::get<1>(args);
-            auto local_range =
-                itr_traits::local_range(std::get<0>(args), std::get<1>(args));
-            auto begin = local_range.begin();
-            auto end = local_range.end();
-            BinaryOperation op = std::get<2>(args);
-            auto acc = std::get<3>(args);
-            for (auto it = begin; it != end; ++it) {
-              *it = op(std::move(acc), *it);
-            }
-          },
-          std::make_tuple(d_f, chunk_end, op, acc));
-    }
-    d_f = chunk_end;
-    acc = op(std::move(acc), res[i].second);
-  }
-  rt::waitForCompletion(h);
-  return chunk_end;
+  using value_t = typename distributed_iterator_traits<InputIt>::value_type;
+  return distributed_scan<value_t>(first, last, d_first, op, uop,
+                                   {value_t{}, false}, false,
+                                   policy.grain_size);
 }
 
 template <class InputIt, class OutputIt, class BinaryOperation,
@@ -1166,84 +810,8 @@ OutputIt transform_inclusive_scan(distributed_parallel_tag&& policy,
                                   InputIt first, InputIt last, OutputIt d_first,
                                   BinaryOperation op, UnaryOperation uop,
                                   T init) {
-  using itr_traits = distributed_iterator_traits<InputIt>;
-  auto localities = itr_traits::localities(first, last);
-  auto startingLoc = localities.begin();
-  uint32_t numLoc = localities.size();
-  if (numLoc == 0) {
-    return d_first;
-  }
-  std::vector<std::pair<OutputIt, T>> res(numLoc);
-  rt::Handle h;
-  size_t i = 0;
-  for (auto locality = startingLoc, end = localities.end(); locality != end;
-       ++locality, ++i) {
-    rt::asyncExecuteAtWithRet(
-        h, locality,
-        [](rt::Handle&,
-           const std::tuple<InputIt, InputIt, OutputIt, BinaryOperation,
-                            UnaryOperation>& args,
-           std::pair<OutputIt, T>* result) {
-          auto d_first = std::get<2>(args);
-          auto df = d_first;
-          auto gbegin = std::get<0>(args);
-          auto gend = std::get<1>(args);
-          auto local_range = itr_traits::local_range(gbegin, gend);
-          auto begin = local_range.begin();
-          auto end = local_range.end();
-          auto it = itr_traits::iterator_from_local(gbegin, gend, begin);
-          auto dist = std::distance(gbegin, it);
-          std::advance(d_first, dist);
-          if (begin == end) {
-            *result = std::make_pair(d_first, T{});
-            return;
-          }
-          BinaryOperation op = std::get<3>(args);
-          UnaryOperation uop = std::get<4>(args);
-          T acc = uop(*begin);
-          *d_first = acc;
-          while (++begin != end) {
-            acc = op(std::move(acc), uop(*begin));
-            *++d_first = acc;
-          }
-          *result = std::make_pair(++d_first, acc);
-        },
-        std::make_tuple(first, last, d_first, op, uop), &res[i]);
-  }
-  rt::waitForCompletion(h);
-  auto d_f = res[0].first;
-  auto acc = res[0].second;
-  OutputIt chunk_end = d_first;
-  using outitr_traits = distributed_iterator_traits<OutputIt>;
-  for (i = 1; i < numLoc; ++i) {
-    chunk_end = res[i].first;
-    auto d_localities = outitr_traits::localities(d_f, chunk_end);
-    auto d_startingLoc = d_localities.begin();
-    for (auto locality = d_startingLoc, end = d_localities.end();
-         locality != end; ++locality) {
-      rt::asyncExecuteAt(
-          h, locality,
-          [](rt::Handle&,
-             const std::tuple<OutputIt, OutputIt, BinaryOperation, T>& args) {
-            auto gbegin = std::get<0>(args);
-            auto gend = std::get<1>(args);
-            auto local_range =
-                itr_traits::local_range(std::get<0>(args), std::get<1>(args));
-            auto begin = local_range.begin();
-            auto end = local_range.end();
-            BinaryOperation op = std::get<2>(args);
-            auto acc = std::get<3>(args);
-            for (auto it = begin; it != end; ++it) {
-              *it = op(std::move(acc), *it);
-            }
-          },
-          std::make_tuple(d_f, chunk_end, op, acc));
-    }
-    d_f = chunk_end;
-    acc = op(std::move(acc), res[i].second);
-  }
-  rt::waitForCompletion(h);
-  return chunk_end;
+  return distributed_scan<T>(first, last, d_first, op, uop, {init, true},
+                             false, policy.grain_size);
 }
 
 }  // namespace impl
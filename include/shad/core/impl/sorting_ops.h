@@ -26,15 +26,496 @@
 #define INCLUDE_SHAD_CORE_IMPL_SORTING_OPS_H
 
 #include <algorithm>
+#include <cstring>
 #include <functional>
 #include <iterator>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
 #include "shad/core/execution.h"
+#include "shad/core/impl/impl_patterns.h"
+#include "shad/core/impl/modifyng_sequence_ops.h"
+#include "shad/data_structures/abstract_data_structure.h"
 #include "shad/distributed_iterator_traits.h"
 #include "shad/runtime/runtime.h"
 
 namespace shad {
 namespace impl {
 
+////////////////////////////////////////////////////////////////////////////////
+//
+// Distributed sample sort over block-contiguous random-access ranges.
+//
+// The algorithm proceeds in the following phases:
+//  1. every locality sorts its local portion and draws regular samples;
+//  2. the caller selects one splitter for each locality spanned by the range
+//     and broadcasts them;
+//  3. every locality partitions its (sorted) portion according to the
+//     splitters and ships the j-th partition to the j-th locality (all-to-all);
+//  4. every locality merges the received runs and writes them back to the
+//     portion of the range that starts at the global rank of its bucket.
+//
+// The buckets are ordered by the splitters, so a caller that only needs the
+// elements of ranks [sorted_first, sorted_last) in sorted position (e.g.,
+// partial_sort and nth_element) can skip the merge of the buckets that do not
+// overlap those ranks: their runs are written back as they are.
+//
+////////////////////////////////////////////////////////////////////////////////
+namespace sort_impl {
+
+// per-locality staging area for splitters and received runs
+template <typename T>
+class sort_buffer : public AbstractDataStructure<sort_buffer<T>> {
+  friend class AbstractDataStructure<sort_buffer<T>>;
+
+ public:
+  using ObjectID = typename AbstractDataStructure<sort_buffer<T>>::ObjectID;
+
+  ObjectID GetGlobalID() const { return oid_; }
+
+ private:
+  ObjectID oid_;
+
+ public:
+  std::vector<T> splitters;
+  // one run for each source locality, in range order
+  std::vector<std::vector<T>> runs;
+
+ protected:
+  sort_buffer(ObjectID oid, size_t num_buckets)
+      : oid_(oid), splitters(), runs(num_buckets) {}
+};
+
+template <bool stable>
+struct sorter {
+  template <typename RandomIt, typename Compare>
+  void operator()(RandomIt first, RandomIt last, Compare comp) const {
+    std::sort(first, last, comp);
+  }
+};
+
+template <>
+struct sorter<true> {
+  template <typename RandomIt, typename Compare>
+  void operator()(RandomIt first, RandomIt last, Compare comp) const {
+    std::stable_sort(first, last, comp);
+  }
+};
+
+// merges the adjacent sorted blocks [bounds[i], bounds[i + 1]) of a local
+// range, pairwise and in log(#blocks) rounds
+template <bool parallel, typename T, typename Compare>
+void merge_blocks(T* base, std::vector<size_t> bounds, Compare comp) {
+  while (bounds.size() > 2) {
+    std::vector<size_t> next_bounds;
+    rt::Handle h;
+    size_t i = 0;
+    for (; i + 2 < bounds.size(); i += 2) {
+      next_bounds.push_back(bounds[i]);
+      auto merge_args = std::make_tuple(base + bounds[i], base + bounds[i + 1],
+                                        base + bounds[i + 2], comp);
+      if (parallel) {
+        rt::asyncExecuteAt(
+            h, rt::thisLocality(),
+            [](rt::Handle&, const typeof(merge_args)& merge_args) {
+              std::inplace_merge(std::get<0>(merge_args),
+                                 std::get<1>(merge_args),
+                                 std::get<2>(merge_args),
+                                 std::get<3>(merge_args));
+            },
+            merge_args);
+      } else {
+        std::inplace_merge(base + bounds[i], base + bounds[i + 1],
+                           base + bounds[i + 2], comp);
+      }
+    }
+    for (; i < bounds.size(); ++i) next_bounds.push_back(bounds[i]);
+    rt::waitForCompletion(h);
+    bounds = std::move(next_bounds);
+  }
+}
+
+// sorts a local range, using all the cores of the locality when parallel
+template <bool parallel, bool stable, typename T, typename Compare>
+void local_sort(T* first, T* last, Compare comp) {
+  if (!parallel) {
+    sorter<stable>{}(first, last, comp);
+    return;
+  }
+
+  auto parts = local_iterator_traits<T*>::partitions(
+      first, last, rt::impl::getConcurrency());
+  if (parts.size() < 2) {
+    sorter<stable>{}(first, last, comp);
+    return;
+  }
+
+  local_map_void(
+      // range
+      first, last,
+      // kernel
+      [=](T* b, T* e) { sorter<stable>{}(b, e, comp); });
+
+  std::vector<size_t> bounds;
+  for (auto& p : parts) bounds.push_back(std::distance(first, p.begin()));
+  bounds.push_back(std::distance(first, last));
+  merge_blocks<parallel>(first, std::move(bounds), comp);
+}
+
+// regular samples from a sorted local portion
+template <typename T>
+struct samples_t {
+  static constexpr size_t buf_size = std::max<size_t>((1 << 10) / sizeof(T), 1);
+  T buf[buf_size];
+  size_t size;
+  size_t weight;
+};
+
+// header of the splitters broadcast buffer
+template <typename ObjectID>
+struct splitters_args_t {
+  ObjectID oid;
+  size_t size;
+};
+
+// buffer for announcing the size of an incoming run
+template <typename ObjectID>
+struct run_size_args_t {
+  ObjectID oid;
+  size_t src;
+  size_t size;
+};
+
+// buffer for shipping a portion of a run
+template <typename T, typename ObjectID>
+struct run_chunk_args_t {
+  static constexpr size_t buf_size = std::max<size_t>((2 << 10) / sizeof(T), 1);
+  T buf[buf_size];
+  ObjectID oid;
+  size_t src;
+  size_t offset;
+  size_t size;
+};
+
+template <typename T, typename Compare>
+std::vector<T> select_splitters(const std::vector<samples_t<T>>& samples,
+                                size_t num_buckets, Compare comp) {
+  // each sample stands for weight / size elements of its local portion
+  std::vector<std::pair<T, double>> weighted;
+  double total_weight = 0;
+  for (auto& s : samples) {
+    for (size_t i = 0; i < s.size; ++i)
+      weighted.emplace_back(s.buf[i], static_cast<double>(s.weight) / s.size);
+    total_weight += s.weight;
+  }
+  std::sort(weighted.begin(), weighted.end(),
+            [&](const std::pair<T, double>& a, const std::pair<T, double>& b) {
+              return comp(a.first, b.first);
+            });
+
+  std::vector<T> res;
+  if (weighted.empty()) return res;
+  double acc = 0;
+  auto it = weighted.begin();
+  for (size_t j = 1; j < num_buckets; ++j) {
+    double target = total_weight * j / num_buckets;
+    while (it + 1 != weighted.end() && acc + it->second < target) {
+      acc += it->second;
+      ++it;
+    }
+    res.push_back(it->first);
+  }
+  return res;
+}
+
+template <bool parallel, bool stable, typename RandomIt, typename Compare>
+void sample_sort(RandomIt first, RandomIt last, Compare comp,
+                 size_t sorted_first = 0,
+                 size_t sorted_last = std::numeric_limits<size_t>::max()) {
+  using itr_traits = distributed_random_access_iterator_trait<RandomIt>;
+  using T = typename itr_traits::value_type;
+  using buffer_t = sort_buffer<T>;
+  using ObjectID = typename buffer_t::ObjectID;
+
+  if (first == last) return;
+
+  auto localities = itr_traits::localities(first, last);
+  size_t num_buckets = localities.size();
+  uint32_t first_locality = static_cast<uint32_t>(localities.begin());
+
+  // phase 1: sort the local portions and draw regular samples
+  std::vector<samples_t<T>> samples(num_buckets);
+  auto sort_args = std::make_tuple(first, last, comp);
+  rt::Handle h;
+  size_t i = 0;
+  for (auto locality = localities.begin(), end = localities.end();
+       locality != end; ++locality, ++i) {
+    rt::asyncExecuteAtWithRet(
+        h, locality,
+        [](rt::Handle&, const typeof(sort_args)& sort_args,
+           samples_t<T>* result) {
+          auto lrange = itr_traits::local_range(std::get<0>(sort_args),
+                                                std::get<1>(sort_args));
+          auto lfirst = lrange.begin(), llast = lrange.end();
+          local_sort<parallel, stable>(lfirst, llast, std::get<2>(sort_args));
+
+          size_t n = std::distance(lfirst, llast);
+          result->weight = n;
+          result->size = std::min(n, samples_t<T>::buf_size);
+          for (size_t k = 0; k < result->size; ++k)
+            result->buf[k] = lfirst[((2 * k + 1) * n) / (2 * result->size)];
+        },
+        sort_args, &samples[i]);
+    if (!parallel) rt::waitForCompletion(h);
+  }
+  rt::waitForCompletion(h);
+
+  // a range mapped on a single locality is sorted at this point
+  if (num_buckets == 1) return;
+
+  // phase 2: select and broadcast the splitters
+  auto splitters = select_splitters(samples, num_buckets, comp);
+  auto buffer = buffer_t::Create(num_buckets);
+  ObjectID oid = buffer->GetGlobalID();
+
+  using splitters_args = splitters_args_t<ObjectID>;
+  size_t splitters_size =
+      sizeof(splitters_args) + splitters.size() * sizeof(T);
+  std::shared_ptr<uint8_t> splitters_buf(new uint8_t[splitters_size],
+                                         std::default_delete<uint8_t[]>());
+  splitters_args header{oid, splitters.size()};
+  std::memcpy(splitters_buf.get(), &header, sizeof(splitters_args));
+  std::memcpy(splitters_buf.get() + sizeof(splitters_args), splitters.data(),
+              splitters.size() * sizeof(T));
+  rt::executeOnAll(
+      [](const uint8_t* args_buf, const uint32_t) {
+        const splitters_args& header =
+            *reinterpret_cast<const splitters_args*>(args_buf);
+        auto ptr = buffer_t::GetPtr(header.oid);
+        ptr->splitters.resize(header.size);
+        std::memcpy(ptr->splitters.data(), args_buf + sizeof(splitters_args),
+                    header.size * sizeof(T));
+      },
+      splitters_buf, splitters_size);
+
+  // phase 3: all-to-all exchange of the partitions
+  auto exchange_args =
+      std::make_tuple(oid, first, last, comp, first_locality, num_buckets);
+  for (auto locality = localities.begin(), end = localities.end();
+       locality != end; ++locality) {
+    rt::asyncExecuteAt(
+        h, locality,
+        [](rt::Handle&, const typeof(exchange_args)& args) {
+          using run_size_args = run_size_args_t<ObjectID>;
+          using run_chunk_args = run_chunk_args_t<T, ObjectID>;
+          auto oid = std::get<0>(args);
+          auto comp = std::get<3>(args);
+          auto first_locality = std::get<4>(args);
+          auto num_buckets = std::get<5>(args);
+          auto ptr = buffer_t::GetPtr(oid);
+          auto lrange =
+              itr_traits::local_range(std::get<1>(args), std::get<2>(args));
+          size_t src =
+              static_cast<uint32_t>(rt::thisLocality()) - first_locality;
+
+          // the local portion is sorted: partitions are delimited by the
+          // lower bounds of the splitters
+          std::vector<T*> bounds{lrange.begin()};
+          for (auto& s : ptr->splitters)
+            bounds.push_back(
+                std::lower_bound(bounds.back(), lrange.end(), s, comp));
+          bounds.push_back(lrange.end());
+
+          // announce the size of the runs
+          rt::Handle h;
+          for (size_t j = 0; j < num_buckets; ++j) {
+            rt::Locality dst(first_locality + j);
+            size_t size = std::distance(bounds[j], bounds[j + 1]);
+            if (dst == rt::thisLocality()) {
+              ptr->runs[src].assign(bounds[j], bounds[j + 1]);
+            } else if (size) {
+              rt::asyncExecuteAt(
+                  h, dst,
+                  [](rt::Handle&, const run_size_args& args) {
+                    auto ptr = buffer_t::GetPtr(args.oid);
+                    ptr->runs[args.src].resize(args.size);
+                  },
+                  run_size_args{oid, src, size});
+            }
+          }
+          rt::waitForCompletion(h);
+
+          // ship the runs
+          std::shared_ptr<uint8_t> args_buf(new uint8_t[sizeof(run_chunk_args)],
+                                            std::default_delete<uint8_t[]>());
+          auto typed_args_buf = reinterpret_cast<run_chunk_args*>(args_buf.get());
+          for (size_t j = 0; j < num_buckets; ++j) {
+            rt::Locality dst(first_locality + j);
+            if (dst == rt::thisLocality()) continue;
+            size_t run_size = std::distance(bounds[j], bounds[j + 1]);
+            for (size_t offset = 0; offset < run_size;
+                 offset += typed_args_buf->size) {
+              typed_args_buf->oid = oid;
+              typed_args_buf->src = src;
+              typed_args_buf->offset = offset;
+              typed_args_buf->size =
+                  std::min(run_chunk_args::buf_size, run_size - offset);
+              std::memcpy(typed_args_buf->buf, bounds[j] + offset,
+                          sizeof(T) * typed_args_buf->size);
+              rt::asyncExecuteAt(
+                  h, dst,
+                  [](rt::Handle&, const uint8_t* args_buf, const uint32_t) {
+                    const run_chunk_args& args =
+                        *reinterpret_cast<const run_chunk_args*>(args_buf);
+                    auto ptr = buffer_t::GetPtr(args.oid);
+                    std::memcpy(ptr->runs[args.src].data() + args.offset,
+                                args.buf, sizeof(T) * args.size);
+                  },
+                  args_buf, sizeof(run_chunk_args));
+            }
+          }
+          rt::waitForCompletion(h);
+        },
+        exchange_args);
+    if (!parallel) rt::waitForCompletion(h);
+  }
+  rt::waitForCompletion(h);
+
+  // phase 4: compute the global rank of each bucket
+  std::vector<size_t> bucket_sizes(num_buckets, 0);
+  i = 0;
+  for (auto locality = localities.begin(), end = localities.end();
+       locality != end; ++locality, ++i) {
+    rt::asyncExecuteAtWithRet(
+        h, locality,
+        [](rt::Handle&, const ObjectID& oid, size_t* result) {
+          auto ptr = buffer_t::GetPtr(oid);
+          *result = 0;
+          for (auto& run : ptr->runs) *result += run.size();
+        },
+        oid, &bucket_sizes[i]);
+    if (!parallel) rt::waitForCompletion(h);
+  }
+  rt::waitForCompletion(h);
+
+  // phase 5: merge the runs and write them back to the range
+  size_t offset = 0;
+  i = 0;
+  for (auto locality = localities.begin(), end = localities.end();
+       locality != end; ++locality, ++i) {
+    bool merge =
+        offset < sorted_last && offset + bucket_sizes[i] > sorted_first;
+    auto merge_args = std::make_tuple(oid, first, comp, offset, merge);
+    rt::asyncExecuteAt(
+        h, locality,
+        [](rt::Handle&, const typeof(merge_args)& args) {
+          auto ptr = buffer_t::GetPtr(std::get<0>(args));
+          auto comp = std::get<2>(args);
+
+          std::vector<T> merged;
+          std::vector<size_t> bounds;
+          for (auto& run : ptr->runs) {
+            bounds.push_back(merged.size());
+            merged.insert(merged.end(), run.begin(), run.end());
+            std::vector<T>().swap(run);
+          }
+          bounds.push_back(merged.size());
+          if (merged.empty()) return;
+          if (std::get<4>(args))
+            merge_blocks<parallel>(merged.data(), std::move(bounds), comp);
+
+          auto d_first = std::get<1>(args);
+          std::advance(d_first, std::get<3>(args));
+          auto d_last = d_first;
+          std::advance(d_last, merged.size());
+          auto dmap = itr_traits::distribution(d_first, d_last);
+          auto w_first = merged.data();
+          rt::Handle h;
+          for (auto i : dmap) {
+            auto l = i.first;
+            auto w_last = w_first + i.second;
+            if (rt::thisLocality() == l) {
+              transform_impl::block_contiguous_local(
+                  w_first, w_last, d_first, [](const T& v) { return v; });
+            } else {
+              transform_impl::async_block_contiguous_remote(
+                  l, h, w_first, w_last, d_first,
+                  [](const T& v) { return v; });
+            }
+            w_first = w_last;
+            std::advance(d_first, i.second);
+          }
+          rt::waitForCompletion(h);
+        },
+        merge_args);
+    if (!parallel) rt::waitForCompletion(h);
+    offset += bucket_sizes[i];
+  }
+  rt::waitForCompletion(h);
+
+  buffer_t::Destroy(oid);
+}
+
+}  // namespace sort_impl
+
+template <class RandomIt, class Compare>
+void sort(distributed_parallel_tag&& policy, RandomIt first, RandomIt last,
+          Compare comp) {
+  sort_impl::sample_sort<true, false>(first, last, comp);
+}
+
+template <class RandomIt, class Compare>
+void sort(distributed_sequential_tag&& policy, RandomIt first, RandomIt last,
+          Compare comp) {
+  sort_impl::sample_sort<false, false>(first, last, comp);
+}
+
+template <class RandomIt, class Compare>
+void stable_sort(distributed_parallel_tag&& policy, RandomIt first,
+                 RandomIt last, Compare comp) {
+  sort_impl::sample_sort<true, true>(first, last, comp);
+}
+
+template <class RandomIt, class Compare>
+void stable_sort(distributed_sequential_tag&& policy, RandomIt first,
+                 RandomIt last, Compare comp) {
+  sort_impl::sample_sort<false, true>(first, last, comp);
+}
+
+// Only the buckets holding the ranks in [first, middle) are merged: the other
+// ones are left as the concatenation of their sorted runs.
+template <class RandomIt, class Compare>
+void partial_sort(distributed_parallel_tag&& policy, RandomIt first,
+                  RandomIt middle, RandomIt last, Compare comp) {
+  sort_impl::sample_sort<true, false>(first, last, comp, 0,
+                                      std::distance(first, middle));
+}
+
+template <class RandomIt, class Compare>
+void partial_sort(distributed_sequential_tag&& policy, RandomIt first,
+                  RandomIt middle, RandomIt last, Compare comp) {
+  sort_impl::sample_sort<false, false>(first, last, comp, 0,
+                                       std::distance(first, middle));
+}
+
+// Only the bucket holding the rank of nth is merged: the splitters already
+// partition the other elements around it.
+template <class RandomIt, class Compare>
+void nth_element(distributed_parallel_tag&& policy, RandomIt first,
+                 RandomIt nth, RandomIt last, Compare comp) {
+  size_t n = std::distance(first, nth);
+  sort_impl::sample_sort<true, false>(first, last, comp, n, n + 1);
+}
+
+template <class RandomIt, class Compare>
+void nth_element(distributed_sequential_tag&& policy, RandomIt first,
+                 RandomIt nth, RandomIt last, Compare comp) {
+  size_t n = std::distance(first, nth);
+  sort_impl::sample_sort<false, false>(first, last, comp, n, n + 1);
+}
 
 }  // namespace impl
 }  // namespace shad
@@ -0,0 +1,172 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_SHAD_DATA_STRUCTURES_BATCH_UTILS_H_
+#define INCLUDE_SHAD_DATA_STRUCTURES_BATCH_UTILS_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <vector>
+
+#include "shad/data_structures/compare_and_hash_utils.h"
+#include "shad/data_structures/partitioners.h"
+#include "shad/runtime/runtime.h"
+
+namespace shad {
+namespace impl {
+
+/// @brief Positions of a batch of keys grouped by owner Locality.
+///
+/// The positions of the keys owned by Locality l are
+/// positions[offsets[l]] ... positions[offsets[l + 1] - 1].
+struct LocalityPartition {
+  std::vector<size_t> offsets;
+  std::vector<size_t> positions;
+
+  /// @brief Number of keys owned by a Locality.
+  size_t Count(uint32_t locality) const {
+    return offsets[locality + 1] - offsets[locality];
+  }
+
+  /// @brief Position in the batch of the i-th key owned by a Locality.
+  size_t Position(uint32_t locality, size_t i) const {
+    return positions[offsets[locality] + i];
+  }
+};
+
+/// @brief Group the positions of a batch of keys by owner Locality.
+///
+/// @param owners The owner Locality of each key of the batch.
+/// @return The positions of the keys grouped by owner Locality.
+inline LocalityPartition PartitionByOwner(const std::vector<uint32_t> &owners) {
+  uint32_t numLocalities = rt::numLocalities();
+  LocalityPartition partition;
+  partition.offsets.assign(numLocalities + 1, 0);
+  for (uint32_t owner : owners) ++partition.offsets[owner + 1];
+  for (uint32_t l = 0; l < numLocalities; ++l)
+    partition.offsets[l + 1] += partition.offsets[l];
+
+  std::vector<size_t> next(partition.offsets.begin(),
+                           partition.offsets.end() - 1);
+  partition.positions.resize(owners.size());
+  for (size_t i = 0; i < owners.size(); ++i)
+    partition.positions[next[owners[i]]++] = i;
+  return partition;
+}
+
+/// @brief Group a batch of keys by owner Locality, with the key to Locality
+/// mapping of a partitioner.
+///
+/// @tparam KeyT The type of the keys.
+/// @tparam PartitionerT The type of the partitioner.
+/// @param keys The batch of keys.
+/// @param numKeys The number of keys in the batch.
+/// @param partitioner The partitioner of the container the keys belong to.
+/// @return The positions of the keys grouped by owner Locality.
+template <typename KeyT, typename PartitionerT>
+LocalityPartition PartitionByLocality(const KeyT *keys, size_t numKeys,
+                                      const PartitionerT &partitioner) {
+  uint32_t numLocalities = rt::numLocalities();
+  std::vector<uint32_t> owners(numKeys);
+  for (size_t i = 0; i < numKeys; ++i)
+    owners[i] = partitioner(keys[i], numLocalities);
+  return PartitionByOwner(owners);
+}
+
+/// @brief Group a batch of keys by owner Locality, with the default modulo
+/// hashing of Hashmap and Set.
+///
+/// @tparam KeyT The type of the keys.
+/// @param keys The batch of keys.
+/// @param numKeys The number of keys in the batch.
+/// @return The positions of the keys grouped by owner Locality.
+template <typename KeyT>
+LocalityPartition PartitionByLocality(
+    const KeyT *keys, size_t numKeys,
+    const ModuloPartitioner<KeyT> & = ModuloPartitioner<KeyT>()) {
+  uint32_t numLocalities = rt::numLocalities();
+  std::vector<uint64_t> hashes(numKeys);
+  HashBatch(keys, numKeys, hashes.data());
+  std::vector<uint32_t> owners(numKeys);
+  for (size_t i = 0; i < numKeys; ++i) owners[i] = hashes[i] % numLocalities;
+  return PartitionByOwner(owners);
+}
+
+/// @brief Layout of the payload of a batch message: a header followed by
+/// one array of numEntries elements for each of the types Ts.
+///
+/// @tparam HeaderT The type of the header.
+/// @tparam Ts The types of the arrays.  They must be memcopy-able.
+template <typename HeaderT, typename... Ts>
+class BatchLayout {
+ public:
+  /// @brief Size in bytes of the payload of numEntries entries.
+  static size_t Bytes(size_t numEntries) {
+    constexpr size_t kLast = sizeof...(Ts) - 1;
+    return Offset(kLast, numEntries) + kSizes[kLast] * numEntries;
+  }
+
+  /// @brief Allocate the payload of numEntries entries.
+  static std::shared_ptr<uint8_t> Allocate(size_t numEntries,
+                                           const HeaderT &header) {
+    std::shared_ptr<uint8_t> payload(new uint8_t[Bytes(numEntries)],
+                                     std::default_delete<uint8_t[]>());
+    new (payload.get()) HeaderT(header);
+    return payload;
+  }
+
+  static const HeaderT &Header(const uint8_t *payload) {
+    return *reinterpret_cast<const HeaderT *>(payload);
+  }
+
+  /// @brief The I-th array of the payload.
+  template <size_t I>
+  static auto Array(const uint8_t *payload, size_t numEntries) {
+    using T = std::tuple_element_t<I, std::tuple<Ts...>>;
+    return reinterpret_cast<T *>(const_cast<uint8_t *>(payload) +
+                                 Offset(I, numEntries));
+  }
+
+ private:
+  static constexpr size_t kSizes[] = {sizeof(Ts)...};
+  static constexpr size_t kAligns[] = {alignof(Ts)...};
+
+  static size_t Offset(size_t index, size_t numEntries) {
+    size_t offset = sizeof(HeaderT);
+    for (size_t i = 0;; ++i) {
+      offset = (offset + kAligns[i] - 1) / kAligns[i] * kAligns[i];
+      if (i == index) return offset;
+      offset += kSizes[i] * numEntries;
+    }
+  }
+};
+
+}  // namespace impl
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_DATA_STRUCTURES_BATCH_UTILS_H_
@@ -26,8 +26,13 @@
 #define INCLUDE_SHAD_DATA_STRUCTURES_BUFFER_H_
 
 #include <algorithm>
-#include <array>
 #include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "shad/data_structures/object_identifier.h"
@@ -52,12 +57,36 @@ constexpr static T const min(T const a, T const b) {
 
 namespace impl {
 
+/// @brief Detects the bulk-insert hook of a DataStructure:
+/// @code
+/// void BufferEntriesInsert(const EntryType* entries, size_t numEntries);
+/// @endcode
+template <typename DataStructure, typename EntryType, typename = void>
+struct HasBufferEntriesInsert : std::false_type {};
+
+template <typename DataStructure, typename EntryType>
+struct HasBufferEntriesInsert<
+    DataStructure, EntryType,
+    std::void_t<decltype(std::declval<DataStructure&>().BufferEntriesInsert(
+        std::declval<const EntryType*>(), size_t(0)))>> : std::true_type {};
+
 /// @brief The Buffer utility.
 ///
 /// Buffer used to agregate data transfers in insertion methods.
 /// It is associated to a DataStructure instance, through its
 /// global object identifier, and to the Locality target of the
 /// data transfers.
+///
+/// The Buffer is double-buffered and lock-free: inserting threads reserve a
+/// slot with an atomic increment and write their entry in place.  The thread
+/// reserving the last slot of a chunk switches the insertions to the other
+/// chunk, and the last thread completing its write ships the chunk to the
+/// target Locality as a shared payload, without copying it.  The entries of
+/// a payload are destroyed when the runtime releases it.  On the target,
+/// the entries are applied in bulk through
+/// DataStructure::BufferEntriesInsert(), when available, or one at a time
+/// through DataStructure::BufferEntryInsert().
+///
 /// @tparam EntryType type of the entries stored in the buffer.
 /// @tparam DataStructure DataStructure using the buffer.
 template <typename EntryType, typename DataStructure>
@@ -69,88 +98,46 @@ class Buffer {
   /// Size of the buffer in terms of number of entries.
   constexpr static size_t kBufferSize =
       constants::max(constants::kBufferNumBytes / sizeof(EntryType), 1lu);
-  using EntriesArray = std::array<EntryType, kBufferSize>;
 
-  Buffer(const Buffer& rhs)
-      : data_(rhs.data_),
-        size_(rhs.size_),
-        lock_(),
-        tgtLoc_(rhs.tgtLoc_),
-        oid_(rhs.oid_) {}
+  Buffer(const Buffer& rhs) : Buffer(rhs.tgtLoc_, rhs.oid_) {}
 
-  Buffer()
-      : size_(0),
-        lock_(),
-        tgtLoc_(),
-        oid_(ObjectIdentifier<DataStructure>::kNullID) {}
+  Buffer() : Buffer(rt::Locality(), ObjectIdentifier<DataStructure>::kNullID) {}
 
   Buffer(const rt::Locality& loc, const ObjectIdentifier<DataStructure>& oid)
-      : size_(0), lock_(), tgtLoc_(loc), oid_(oid) {}
-
-  enum State { INSERTED, FLUSH, WAIT_FOR_FLUSH };
+      : active_(0), oid_(oid), tgtLoc_(loc) {
+    for (auto& chunk : chunks_) {
+      chunk.reopened.store(0, std::memory_order_relaxed);
+      chunk.inFlight.store(0, std::memory_order_relaxed);
+      Reset(&chunk);
+    }
+  }
 
-  struct FlushArgs {
-    EntriesArray data;
-    size_t numEntries;
-    ObjectIdentifier<DataStructure> oid;
-  };
+  ~Buffer() {
+    for (auto& chunk : chunks_) {
+      size_t numEntries = chunk.committed.load();
+      for (size_t i = 0; i < numEntries; ++i) chunk.entries[i].~EntryType();
+    }
+  }
 
   void FlushBuffer() {
-    if (size_ == 0) return;
-    FlushArgs args = {data_, size_, oid_};
-    auto InsertBufferLambda = [](const FlushArgs& args) {
-      auto dsPtr = DataStructure::GetPtr(args.oid);
-      for (size_t i = 0; i < args.numEntries; i++) {
-        dsPtr->BufferEntryInsert(args.data[i]);
-      }
-    };
-    rt::executeAt(tgtLoc_, InsertBufferLambda, args);
-    size_ = 0;
+    for (auto& chunk : chunks_) Close(&chunk, nullptr);
   }
 
   void AsyncFlushBuffer(rt::Handle& handle) {
-    if (size_ == 0) return;
-    FlushArgs args = {data_, size_, oid_};
-    auto AsyncInsertLambda = [](rt::Handle&, const FlushArgs& args) {
-      auto dsPtr = DataStructure::GetPtr(args.oid);
-      for (size_t i = 0; i < args.numEntries; i++) {
-        dsPtr->BufferEntryInsert(args.data[i]);
-      }
-    };
-    rt::asyncExecuteAt(handle, tgtLoc_, AsyncInsertLambda, args);
-    size_ = 0;
+    for (auto& chunk : chunks_) Close(&chunk, &handle);
   }
 
-  void Insert(const EntryType entry) {
-    lock_.lock();
-    data_[size_++] = entry;
-    if (size_ == kBufferSize) {
-      FlushBuffer();
-    }
-    lock_.unlock();
-  }
+  void Insert(const EntryType entry) { InsertImpl(entry, nullptr); }
 
   void Insert(const EntryType* entry, const size_t num_entries) {
     if (entry == nullptr) throw std::invalid_argument("elem is null");
     if (num_entries > kBufferSize)
       throw std::invalid_argument("num_entries greater than buffer_size");
-    lock_.lock();
-    size_t pos = size_;
-    size_ += num_entries;
-    memcpy(&data_[pos], entry, num_entries * sizeof(EntryType));
-    if (size_ == kBufferSize) {
-      FlushBuffer();
-    }
-    lock_.unlock();
+    for (size_t i = 0; i < num_entries; ++i) InsertImpl(entry[i], nullptr);
   }
 
   void AsyncInsert(rt::Handle& handle, const EntryType& entry) {
-    lock_.lock();
-    data_[size_++] = entry;
-    if (size_ == kBufferSize) {
-      AsyncFlushBuffer(handle);
-    }
-    lock_.unlock();
+    InsertImpl(entry, &handle);
   }
 
   void AsyncInsert(rt::Handle& handle, const EntryType* entry,
@@ -158,26 +145,157 @@ class Buffer {
     if (entry == nullptr) throw std::invalid_argument("elem is null");
     if (num_entries > kBufferSize)
       throw std::invalid_argument("num_entries greater than buffer_size");
-    lock_.lock();
-    size_t pos = size_;
-    size_ += num_entries;
-    memcpy(&data_[pos], entry, num_entries * sizeof(EntryType));
-    if (size_ == kBufferSize) {
-      AsyncFlushBuffer(handle);
-    }
-    lock_.unlock();
+    for (size_t i = 0; i < num_entries; ++i) InsertImpl(entry[i], &handle);
   }
 
  private:
-  EntriesArray data_;
-  size_t size_;
-  rt::Lock lock_;
+  // The payload starts with the identifier of the DataStructure, followed by
+  // the entries.
+  constexpr static size_t kHeaderBytes =
+      (sizeof(ObjectIdentifier<DataStructure>) + alignof(EntryType) - 1) /
+      alignof(EntryType) * alignof(EntryType);
+  constexpr static size_t kPayloadBytes =
+      kHeaderBytes + kBufferSize * sizeof(EntryType);
+
+  struct Chunk {
+    std::unique_ptr<uint8_t[]> payload;
+    EntryType* entries;
+    // Slots handed out to inserting threads, possibly beyond kBufferSize.
+    std::atomic<size_t> reserved;
+    // Entries completely written.
+    std::atomic<size_t> committed;
+    // Number of times the chunk has been reopened after a ship.
+    std::atomic<size_t> reopened;
+    // Payloads of the chunk taken by a ship and not yet handed to the runtime.
+    std::atomic<size_t> inFlight;
+  };
+
+  // Destroys the entries of a payload once the runtime releases it, both
+  // when it has been applied in place and when it has been sent away.
+  struct PayloadDeleter {
+    size_t numEntries;
+    void operator()(uint8_t* payload) const {
+      auto entries = reinterpret_cast<EntryType*>(payload + kHeaderBytes);
+      for (size_t i = 0; i < numEntries; ++i) entries[i].~EntryType();
+      delete[] payload;
+    }
+  };
+
+  Chunk chunks_[2];
+  std::atomic<size_t> active_;
   ObjectIdentifier<DataStructure> oid_;
 
+  void InsertImpl(const EntryType& entry, rt::Handle* handle) {
+    for (;;) {
+      size_t current = active_.load(std::memory_order_acquire);
+      Chunk* chunk = &chunks_[current];
+      size_t pos = chunk->reserved.fetch_add(1, std::memory_order_acq_rel);
+      if (pos >= kBufferSize) {
+        // The chunk is being shipped: wait for it or for the other one.
+        rt::impl::yield();
+        continue;
+      }
+      if (pos == kBufferSize - 1)
+        active_.store(current ^ 1, std::memory_order_release);
+
+      new (&chunk->entries[pos]) EntryType(entry);
+      if (chunk->committed.fetch_add(1, std::memory_order_acq_rel) + 1 ==
+          kBufferSize)
+        Ship(chunk, kBufferSize, handle);
+      return;
+    }
+  }
+
+  // Flush the entries of a chunk that is not full, closing it to further
+  // insertions.  If the chunk is already being shipped, by its last writer
+  // or by a concurrent Close, wait for that ship to be handed to the
+  // runtime: a synchronous ship has then completed, an asynchronous one
+  // completes with the handle it was issued on.
+  void Close(Chunk* chunk, rt::Handle* handle) {
+    for (;;) {
+      size_t reopened = chunk->reopened.load(std::memory_order_acquire);
+      size_t pos = chunk->reserved.fetch_add(kBufferSize,
+                                             std::memory_order_acq_rel);
+      if (pos < kBufferSize) {
+        while (chunk->committed.load(std::memory_order_acquire) != pos)
+          rt::impl::yield();
+        Ship(chunk, pos, handle);
+        return;
+      }
+      // The chunk was reopened in the meantime: the ship in progress is
+      // not necessarily the one that closed it before this call.
+      if (chunk->reopened.load(std::memory_order_acquire) != reopened)
+        continue;
+      while (chunk->reopened.load(std::memory_order_acquire) == reopened)
+        rt::impl::yield();
+      while (chunk->inFlight.load(std::memory_order_acquire) != 0)
+        rt::impl::yield();
+      return;
+    }
+  }
+
+  // The chunk is reopened before the payload is handed to the runtime:
+  // sending may run other tasks on this thread, including insertions
+  // waiting for the chunk.
+  void Ship(Chunk* chunk, size_t numEntries, rt::Handle* handle) {
+    std::shared_ptr<uint8_t> payload(chunk->payload.release(),
+                                     PayloadDeleter{numEntries});
+    chunk->inFlight.fetch_add(1, std::memory_order_acq_rel);
+    chunk->reopened.fetch_add(1, std::memory_order_release);
+    Reset(chunk);
+    if (numEntries != 0) {
+      uint32_t size =
+          static_cast<uint32_t>(kHeaderBytes + numEntries * sizeof(EntryType));
+      if (handle == nullptr) {
+        auto InsertBufferLambda = [](const uint8_t* payload,
+                                     const uint32_t size) {
+          ApplyPayload(payload, size);
+        };
+        rt::executeAt(tgtLoc_, InsertBufferLambda, payload, size);
+      } else {
+        auto AsyncInsertLambda = [](rt::Handle&, const uint8_t* payload,
+                                    const uint32_t size) {
+          ApplyPayload(payload, size);
+        };
+        rt::asyncExecuteAt(*handle, tgtLoc_, AsyncInsertLambda, payload,
+                           size);
+      }
+    }
+    payload.reset();
+    chunk->inFlight.fetch_sub(1, std::memory_order_release);
+  }
+
+  // Give a fresh payload to the chunk and reopen it to insertions.
+  void Reset(Chunk* chunk) {
+    chunk->payload.reset(new uint8_t[kPayloadBytes]);
+    new (chunk->payload.get()) ObjectIdentifier<DataStructure>(oid_);
+    chunk->entries =
+        reinterpret_cast<EntryType*>(chunk->payload.get() + kHeaderBytes);
+    chunk->committed.store(0, std::memory_order_relaxed);
+    chunk->reserved.store(0, std::memory_order_release);
+  }
+
+  // The entries are applied from the payload, which keeps owning them.
+  static void ApplyPayload(const uint8_t* payload, const uint32_t size) {
+    auto& oid =
+        *reinterpret_cast<const ObjectIdentifier<DataStructure>*>(payload);
+    auto entries = reinterpret_cast<const EntryType*>(payload + kHeaderBytes);
+    size_t numEntries = (size - kHeaderBytes) / sizeof(EntryType);
+
+    auto dsPtr = DataStructure::GetPtr(oid);
+    if constexpr (HasBufferEntriesInsert<DataStructure, EntryType>::value) {
+      dsPtr->BufferEntriesInsert(entries, numEntries);
+    } else {
+      for (size_t i = 0; i < numEntries; i++) {
+        dsPtr->BufferEntryInsert(entries[i]);
+      }
+    }
+  }
+
  protected:
   rt::Locality tgtLoc_;
   explicit Buffer(const ObjectIdentifier<DataStructure>& oid)
-      : size_(0), lock_(), tgtLoc_(), oid_(oid) {}
+      : Buffer(rt::Locality(), oid) {}
 };
 
 /// Vector of buffers, of size NumLocalities-1,
@@ -186,38 +304,38 @@ template <typename EntryType, typename DataStructure>
 class BuffersVector {
  public:
   using BufferType = Buffer<EntryType, DataStructure>;
-  explicit BuffersVector(ObjectIdentifier<DataStructure> oid)
-      : buffers_(rt::numLocalities(), BufferType(oid)) {
+  explicit BuffersVector(ObjectIdentifier<DataStructure> oid) {
+    buffers_.reserve(rt::numLocalities());
     for (size_t i = 0; i < (rt::numLocalities()); i++) {
-      buffers_[i].tgtLoc_ = rt::Locality(i);
+      buffers_.emplace_back(new BufferType(rt::Locality(i), oid));
     }
   }
 
   void Insert(const EntryType& entry, const rt::Locality& tgtLoc) {
     uint32_t tgtId = static_cast<uint32_t>(tgtLoc);
-    buffers_[tgtId].Insert(entry);
+    buffers_[tgtId]->Insert(entry);
   }
 
   void AsyncInsert(rt::Handle& handle, const EntryType& entry,
                    const rt::Locality& tgtLoc) {
     uint32_t tgtId = static_cast<uint32_t>(tgtLoc);
-    buffers_.at(tgtId).AsyncInsert(handle, entry);
+    buffers_.at(tgtId)->AsyncInsert(handle, entry);
   }
 
   void FlushAll() {
     for (auto& buffer : buffers_) {
-      buffer.FlushBuffer();
+      buffer->FlushBuffer();
     }
   }
 
   void AsyncFlushAll(rt::Handle& handle) {
     for (auto& buffer : buffers_) {
-      buffer.AsyncFlushBuffer(handle);
+      buffer->AsyncFlushBuffer(handle);
     }
   }
 
  private:
-  std::vector<BufferType> buffers_;
+  std::vector<std::unique_ptr<BufferType>> buffers_;
 };
 
 }  // namespace impl
@@ -175,6 +175,109 @@ uint64_t HashFunction(const std::vector<KeyTy> &key, uint8_t seed) {
   return hash;
 }
 
+namespace impl {
+
+constexpr uint64_t kWordHashPrime0 = 0xa0761d6478bd642fULL;
+constexpr uint64_t kWordHashPrime1 = 0xe7037ed1a0b428dbULL;
+
+/// @brief Fold the 128-bit product of two words into 64 bits.
+inline uint64_t MultiplyMix(uint64_t a, uint64_t b) {
+  __uint128_t product = static_cast<__uint128_t>(a) * b;
+  return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+}
+
+/// @brief Murmur3 64-bit finalizer.
+inline uint64_t Mix64(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+/// @brief wyhash-style hash of a byte sequence, consumed 16 bytes at time.
+inline uint64_t WordHashBytes(const uint8_t *bytes, size_t length,
+                              uint64_t seed) {
+  uint64_t hash = seed ^ kWordHashPrime0;
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    uint64_t a, b;
+    std::memcpy(&a, bytes + i, sizeof(a));
+    std::memcpy(&b, bytes + i + 8, sizeof(b));
+    hash = MultiplyMix(a ^ kWordHashPrime1, b ^ hash);
+  }
+  if (i < length) {
+    uint64_t a = 0, b = 0;
+    size_t tail = length - i;
+    std::memcpy(&a, bytes + i, std::min(tail, sizeof(a)));
+    if (tail > sizeof(a)) std::memcpy(&b, bytes + i + 8, tail - sizeof(a));
+    hash = MultiplyMix(a ^ kWordHashPrime1, b ^ hash);
+  }
+  return MultiplyMix(hash ^ kWordHashPrime1, length ^ kWordHashPrime0);
+}
+
+/// @brief Bucket of a hash in a table of numBuckets buckets.
+///
+/// Keys are routed to their owner Locality with hash % numLocalities, so all
+/// the keys stored on a Locality share the low bits of their hash.  Buckets
+/// are picked from the high bits of a remix of the hash to keep the two
+/// choices independent.
+inline size_t BucketOf(uint64_t hash, size_t numBuckets) {
+  return static_cast<size_t>(
+      (static_cast<__uint128_t>(Mix64(hash)) * numBuckets) >> 64);
+}
+
+}  // namespace impl
+
+/// @brief Word-at-a-time hash function.
+///
+/// A wyhash-class non-cryptographic hash function that consumes the key 16
+/// bytes at time with one 64x64-bit multiplication per step.  It is the
+/// default hash function of the keys that std::hash does not support.
+///
+/// Typical Usage:
+/// @code
+/// ValueType value;
+/// uint64_t ultimateSeed = 42;
+/// auto hash = shad::WordHashFunction(value, ultimateSeed);
+/// @endcode
+///
+/// @tparam KeyTy The type of the key to hash.
+///
+/// @param[in] key The key to be hashed.
+/// @param[in] seed A random seed for the hashing process.
+/// @return A 8-bytes long hash value.
+template <typename KeyTy>
+uint64_t WordHashFunction(const KeyTy &key, uint64_t seed) {
+  return impl::WordHashBytes(reinterpret_cast<const uint8_t *>(&key),
+                             sizeof(KeyTy), seed);
+}
+
+/// @brief Word-at-a-time hash function for std::vector.
+///
+/// This specialization use the content of the std::vector to produce the
+/// hash value.
+///
+/// @tparam KeyTy The type of the elements of the std::vector.
+///
+/// @param[in] key The std::vector storing the byte sequence to be hashed.
+/// @param[in] seed A random seed for the hashing process.
+/// @return A 8-bytes long hash value.
+template <typename KeyTy>
+uint64_t WordHashFunction(const std::vector<KeyTy> &key, uint64_t seed) {
+  return impl::WordHashBytes(reinterpret_cast<const uint8_t *>(key.data()),
+                             sizeof(KeyTy) * key.size(), seed);
+}
+
+/// @brief The hash policy of SHAD's associative containers.
+///
+/// The same hash decides the Locality owning a key (hash % numLocalities)
+/// and, remixed, the bucket of the key on that Locality.  Keys supported by
+/// std::hash use it; the others use WordHashFunction.  The policy of a key
+/// type can be replaced by specializing shad::hash for it.
+///
+/// @tparam Key The type of the key to hash.
 template <typename Key, bool=is_std_hashable<Key>::value>
 struct hash {
   size_t operator()(const Key &k) const noexcept { return hasher(k); }
@@ -184,10 +287,28 @@ struct hash {
 template <typename Key>
 struct hash<Key, false> {
   size_t operator()(const Key &k) const noexcept {
-    return shad::HashFunction(k, 0u);
+    return shad::WordHashFunction(k, 0u);
   }
 };
 
+/// @brief Hash a batch of keys.
+///
+/// The keys are hashed in independent iterations, so that the compiler can
+/// pipeline or vectorize the loop; the batched insert and lookup paths use
+/// it before grouping the keys by owner Locality.
+///
+/// @tparam Key The type of the keys.
+/// @tparam Hash The hash policy.
+///
+/// @param[in] keys The batch of keys.
+/// @param[in] numKeys The number of keys in the batch.
+/// @param[out] hashes The numKeys hash values.
+template <typename Key, typename Hash = shad::hash<Key>>
+void HashBatch(const Key *keys, size_t numKeys, uint64_t *hashes) {
+  Hash hasher;
+  for (size_t i = 0; i < numKeys; ++i) hashes[i] = hasher(keys[i]);
+}
+
 }  // namespace shad
 
 #endif  // INCLUDE_SHAD_DATA_STRUCTURES_COMPARE_AND_HASH_UTILS_H_
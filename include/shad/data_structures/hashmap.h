@@ -27,15 +27,21 @@
 
 #include <algorithm>
 #include <functional>
+#include <memory>
 #include <tuple>
 #include <utility>
 #include <vector>
 
 #include "shad/data_structures/abstract_data_structure.h"
+#include "shad/data_structures/batch_utils.h"
 #include "shad/data_structures/buffer.h"
 #include "shad/data_structures/compare_and_hash_utils.h"
+#include "shad/data_structures/hot_key_replicas.h"
+#include "shad/data_structures/local_flat_hashmap.h"
 #include "shad/data_structures/local_hashmap.h"
+#include "shad/data_structures/partitioners.h"
 #include "shad/distributed_iterator_traits.h"
+#include "shad/runtime/collectives.h"
 #include "shad/runtime/runtime.h"
 
 namespace shad {
@@ -53,38 +59,46 @@ class map_iterator;
 /// @tparam INSERT_POLICY insertion policy; default is overwrite
 /// (i.e. insertions overwrite previous values
 ///  associated to the same key, if any).
+/// @tparam LOCAL_MAP storage engine of the per-locality entries; default is
+/// the chained LocalHashmap, LocalFlatHashmap selects open addressing.
+/// @tparam PARTITIONER key to locality mapping; default is modulo hashing.
+/// @see Partitioners
 template <typename KTYPE, typename VTYPE, typename KEY_COMPARE = MemCmp<KTYPE>,
-          typename INSERT_POLICY = Overwriter<VTYPE>>
-class Hashmap : public AbstractDataStructure<
-                    Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>> {
+          typename INSERT_POLICY = Overwriter<VTYPE>,
+          template <typename, typename, typename, typename> class LOCAL_MAP =
+              LocalHashmap,
+          typename PARTITIONER = ModuloPartitioner<KTYPE>>
+class Hashmap
+    : public AbstractDataStructure<Hashmap<KTYPE, VTYPE, KEY_COMPARE,
+                                           INSERT_POLICY, LOCAL_MAP,
+                                           PARTITIONER>> {
   template <typename>
   friend class AbstractDataStructure;
-  friend class map_iterator<Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>,
-                            const std::pair<KTYPE, VTYPE>,
-                            std::pair<KTYPE, VTYPE>>;
-  friend class map_iterator<Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>,
-                            const std::pair<KTYPE, VTYPE>,
-                            std::pair<KTYPE, VTYPE>>;
+  friend class map_iterator<
+      Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+              PARTITIONER>,
+      const std::pair<KTYPE, VTYPE>, std::pair<KTYPE, VTYPE>>;
+  friend class map_iterator<
+      Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+              PARTITIONER>,
+      const std::pair<KTYPE, VTYPE>, std::pair<KTYPE, VTYPE>>;
 
  public:
   using value_type = std::pair<KTYPE, VTYPE>;
-  using HmapT = Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>;
-  using LMapT = LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>;
+  using HmapT = Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+                        PARTITIONER>;
+  using LMapT = LOCAL_MAP<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>;
   using ObjectID = typename AbstractDataStructure<HmapT>::ObjectID;
   using ShadHashmapPtr = typename AbstractDataStructure<HmapT>::SharedPtr;
 
-  using iterator =
-      map_iterator<Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>,
-                   const std::pair<KTYPE, VTYPE>, std::pair<KTYPE, VTYPE>>;
-  using const_iterator =
-      map_iterator<Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>,
-                   const std::pair<KTYPE, VTYPE>, std::pair<KTYPE, VTYPE>>;
-  using local_iterator =
-      lmap_iterator<LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>,
-                    const std::pair<KTYPE, VTYPE>>;
-  using const_local_iterator =
-      lmap_iterator<LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>,
-                    const std::pair<KTYPE, VTYPE>>;
+  using iterator = map_iterator<HmapT, const std::pair<KTYPE, VTYPE>,
+                                std::pair<KTYPE, VTYPE>>;
+  using const_iterator = map_iterator<HmapT, const std::pair<KTYPE, VTYPE>,
+                                      std::pair<KTYPE, VTYPE>>;
+  using local_iterator = typename LMapT::template local_iterator_type<
+      const std::pair<KTYPE, VTYPE>>;
+  using const_local_iterator = typename LMapT::template local_iterator_type<
+      const std::pair<KTYPE, VTYPE>>;
   struct EntryT {
     EntryT(const KTYPE &k, const VTYPE &v) : key(k), value(v) {}
     EntryT() = default;
@@ -97,22 +111,43 @@ class Hashmap : public AbstractDataStructure<
   ///
   /// Creates a newhashmap instance.
   /// @param numEntries Expected number of entries.
+  /// @param partitioner The key to locality mapping; it is copied on every
+  /// locality.
   /// @return A shared pointer to the newly created hashmap instance.
 #ifdef DOXYGEN_IS_RUNNING
-  static ShadHashmapPtr Create(const size_t numEntries);
+  static ShadHashmapPtr Create(const size_t numEntries,
+                               const PARTITIONER &partitioner = PARTITIONER());
 #endif
 
+  /// @brief The locality owning a key.
+  /// @param[in] key the key.
+  /// @return the locality where the entry of key is (or would be) stored.
+  rt::Locality GetOwner(const KTYPE &key) const {
+    return rt::Locality(partitioner_(key, rt::numLocalities()));
+  }
+
   /// @brief Getter of the Global Identifier.
   ///
   /// @return The global identifier associated with the hashmap instance.
   ObjectID GetGlobalID() const { return oid_; }
 
   /// @brief Overall size of the hashmap (number of entries).
-  /// @warning Calling the size method may result in one-to-all
-  /// communication among localities to retrieve consinstent information.
+  ///
+  /// Every locality keeps the count of the entries it stores; the counts are
+  /// summed with a single tree reduction over all the localities.
   /// @return the size of the hashmap.
   size_t Size() const;
 
+  /// @brief Approximate size of the hashmap (number of entries).
+  ///
+  /// Extrapolated from the entries stored on the calling locality, so it
+  /// requires no communication.  Keys are spread by hash, hence the estimate
+  /// is close to Size() unless the hashmap holds very few keys.
+  /// @return the approximate size of the hashmap.
+  size_t ApproximateSize() const {
+    return localMap_.size_ * rt::numLocalities();
+  }
+
   /// @brief Insert a key-value pair in the hashmap.
   /// @param[in] key the key.
   /// @param[in] value the value to copy into the hashmap.
@@ -157,6 +192,8 @@ class Hashmap : public AbstractDataStructure<
       ptr->buffers_.FlushAll();
     };
     rt::executeOnAll(flushLambda_, oid_);
+    // The flushed entries drop their replicas on the push handles.
+    if (replicas_) WaitForReplicas();
   }
   /// @brief Remove a key-value pair from the hashmap.
   /// @param[in] key the key.
@@ -175,12 +212,61 @@ class Hashmap : public AbstractDataStructure<
     auto clearLambda = [](const ObjectID &oid) {
       auto mapPtr = HmapT::GetPtr(oid);
       mapPtr->localMap_.Clear();
+      if (mapPtr->replicas_) mapPtr->replicas_->Clear();
     };
     rt::executeOnAll(clearLambda, oid_);
   }
 
-  using LookupResult =
-      typename LocalHashmap<KTYPE, VTYPE, KEY_COMPARE>::LookupResult;
+  /// @brief Enable the read replication of hot keys on all localities.
+  ///
+  /// Owners count the remote Lookup and AsyncLookup of their keys; once a
+  /// key has been read threshold times it is replicated in a small cache on
+  /// every locality, which then serves its lookups without communication.
+  /// Every write drops the replicas of the keys it writes once it has
+  /// completed; replicas still in flight when a key is dropped are discarded
+  /// on arrival.  ForEachEntry and AsyncForEachEntry drop the replicas of
+  /// all the keys.  Buffered inserts drop their replicas by the end of
+  /// WaitForBufferedInsert().
+  ///
+  /// @warning Enabling, disabling and invalidating the replication must not
+  /// run concurrently with accesses to the hashmap.
+  ///
+  /// @param capacity The number of keys replicated on each locality.
+  /// @param threshold The number of remote reads making a key hot.
+  void EnableReplication(size_t capacity = 1024, uint32_t threshold = 64) {
+    auto enableLambda =
+        [](const std::tuple<ObjectID, size_t, uint32_t> &args) {
+          auto mapPtr = HmapT::GetPtr(std::get<0>(args));
+          mapPtr->replicas_.reset(
+              new ReplicasT(std::get<1>(args), std::get<2>(args)));
+        };
+    rt::executeOnAll(enableLambda, std::make_tuple(oid_, capacity, threshold));
+  }
+
+  /// @brief Disable the read replication of hot keys on all localities.
+  void DisableReplication() {
+    WaitForReplicas();
+    auto disableLambda = [](const ObjectID &oid) {
+      HmapT::GetPtr(oid)->replicas_.reset();
+    };
+    rt::executeOnAll(disableLambda, oid_);
+  }
+
+  /// @brief Drop all the replicas and restart counting reads, on all
+  /// localities.
+  ///
+  /// The writes drop the replicas of their keys already: invalidating also
+  /// restarts the selection of the hot keys.
+  void InvalidateReplicas() {
+    WaitForReplicas();
+    auto invalidateLambda = [](const ObjectID &oid) {
+      auto mapPtr = HmapT::GetPtr(oid);
+      if (mapPtr->replicas_) mapPtr->replicas_->Clear();
+    };
+    rt::executeOnAll(invalidateLambda, oid_);
+  }
+
+  using LookupResult = typename LMapT::LookupResult;
 
   /// @brief Get the value associated to a key.
   /// @param[in] key the key.
@@ -198,6 +284,39 @@ class Hashmap : public AbstractDataStructure<
   /// @param[out] res The result of the lookup operation.
   void AsyncLookup(rt::Handle &handle, const KTYPE &key, LookupResult *res);
 
+  /// @brief Insert a batch of key-value pairs.
+  ///
+  /// The pairs are grouped by owner Locality and shipped with one message
+  /// per Locality, where they are inserted in parallel.
+  ///
+  /// @param[in] keys The keys.
+  /// @param[in] values The values, values[i] is associated to keys[i].
+  /// @param[in] numEntries The number of key-value pairs.
+  void InsertBatch(const KTYPE *keys, const VTYPE *values, size_t numEntries);
+
+  /// @brief Asynchronously insert a batch of key-value pairs.
+  /// @warning Asynchronous operations are guaranteed to have completed
+  /// only after calling the rt::waitForCompletion(rt::Handle &handle) method.
+  /// The keys and values are copied: the arrays can be reused on return.
+  /// @param[in,out] handle Reference to the handle
+  /// to be used to wait for completion.
+  /// @param[in] keys The keys.
+  /// @param[in] values The values, values[i] is associated to keys[i].
+  /// @param[in] numEntries The number of key-value pairs.
+  void AsyncInsertBatch(rt::Handle &handle, const KTYPE *keys,
+                        const VTYPE *values, size_t numEntries);
+
+  /// @brief Look up a batch of keys.
+  ///
+  /// The keys are grouped by owner Locality and shipped with one message
+  /// per Locality, where they are looked up in parallel.
+  ///
+  /// @param[in] keys The keys.
+  /// @param[in] numKeys The number of keys.
+  /// @param[out] results The results of the lookups, results[i] is the
+  /// result for keys[i].
+  void LookupBatch(const KTYPE *keys, size_t numKeys, LookupResult *results);
+
   /// @brief Apply a user-defined function to a key-value pair.
   ///
   /// @tparam ApplyFunT User-defined function type.  The function prototype
@@ -303,6 +422,15 @@ class Hashmap : public AbstractDataStructure<
   // FIXME it should be protected
   void BufferEntryInsert(const EntryT &entry) {
     localMap_.Insert(entry.key, entry.value);
+    if (replicas_) AsyncDropReplicas(replicas_->PushHandle(), entry.key);
+  }
+
+  // FIXME it should be protected
+  void BufferEntriesInsert(const EntryT *entries, size_t numEntries) {
+    localMap_.InsertEntries(entries, numEntries);
+    if (!replicas_) return;
+    for (size_t i = 0; i < numEntries; ++i)
+      AsyncDropReplicas(replicas_->PushHandle(), entries[i].key);
   }
 
   iterator begin() { return iterator::map_begin(this); }
@@ -341,8 +469,11 @@ class Hashmap : public AbstractDataStructure<
 
  private:
   ObjectID oid_;
-  LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY> localMap_;
+  LOCAL_MAP<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY> localMap_;
   BuffersVector buffers_;
+  PARTITIONER partitioner_;
+  using ReplicasT = impl::HotKeyReplicas<KTYPE, VTYPE, KEY_COMPARE>;
+  std::unique_ptr<ReplicasT> replicas_;
 
   struct InsertArgs {
     ObjectID oid;
@@ -355,157 +486,419 @@ class Hashmap : public AbstractDataStructure<
     KTYPE key;
   };
 
+  struct BatchHeader {
+    ObjectID oid;
+    size_t numEntries;
+  };
+
+  struct ReplicaArgs {
+    ObjectID oid;
+    uint32_t owner;
+    uint64_t version;
+    KTYPE key;
+    VTYPE value;
+  };
+
+  struct DropArgs {
+    ObjectID oid;
+    uint32_t owner;
+    uint64_t version;
+    KTYPE key;
+  };
+
+  // Result of a remote Insert, with the version of the drop of the replicas
+  // of its key.
+  struct InsertResult {
+    std::pair<iterator, bool> res;
+    uint64_t version;
+  };
+
+  // Wait for the replicas sent by every locality to be stored.
+  void WaitForReplicas() {
+    auto waitLambda = [](const ObjectID &oid) {
+      auto mapPtr = HmapT::GetPtr(oid);
+      if (mapPtr->replicas_)
+        rt::waitForCompletion(mapPtr->replicas_->PushHandle());
+    };
+    rt::executeOnAll(waitLambda, oid_);
+  }
+
+  // Count a remote read on the owner of key, replicating key once hot.  The
+  // value is read again after the version: a write missed by the read either
+  // completed before the key became hot or advances the version past it.
+  void CountRemoteRead(const KTYPE &key) {
+    if (!replicas_ || !replicas_->CountAccess(key)) return;
+    uint64_t version = replicas_->Version();
+    VTYPE value;
+    if (!localMap_.Lookup(key, &value)) return;
+    auto storeLambda = [](rt::Handle &, const ReplicaArgs &args) {
+      auto mapPtr = HmapT::GetPtr(args.oid);
+      if (mapPtr->replicas_ && rt::Locality(args.owner) != rt::thisLocality())
+        mapPtr->replicas_->Store(args.owner, args.version, args.key,
+                                 args.value);
+    };
+    uint32_t owner = static_cast<uint32_t>(rt::thisLocality());
+    rt::asyncExecuteOnAll(
+        replicas_->PushHandle(), storeLambda,
+        ReplicaArgs{oid_, owner, version, key, value});
+  }
+
+  // Forget the replication of key, written on its owner.  Returns the version
+  // of the drop of its replicas, or 0 if key is not replicated.
+  uint64_t Unreplicate(const KTYPE &key) {
+    return replicas_ ? replicas_->Unreplicate(key) : 0;
+  }
+
+  // Drop the replicas of key, unreplicated by owner at version.  The version
+  // of the drop makes the readers discard the replicas of key still in
+  // flight.  Not to be called from a handler: remote writes return the
+  // version to their caller, which drops the replicas.
+  void DropReplicas(uint32_t owner, uint64_t version, const KTYPE &key) {
+    if (version == 0) return;
+    auto dropLambda = [](const DropArgs &args) {
+      auto mapPtr = HmapT::GetPtr(args.oid);
+      if (mapPtr->replicas_)
+        mapPtr->replicas_->Drop(args.owner, args.version, args.key);
+    };
+    rt::executeOnAll(dropLambda, DropArgs{oid_, owner, version, key});
+  }
+
+  // Drop the replicas of key, written on its owner.
+  void DropReplicas(const KTYPE &key) {
+    uint32_t owner = static_cast<uint32_t>(rt::thisLocality());
+    DropReplicas(owner, Unreplicate(key), key);
+  }
+
+  // Drop the replicas of key, written on its owner, accounting the drop in
+  // handle.  The write must have completed.
+  void AsyncDropReplicas(rt::Handle &handle, const KTYPE &key) {
+    uint64_t version = Unreplicate(key);
+    if (version == 0) return;
+    auto dropLambda = [](rt::Handle &, const DropArgs &args) {
+      auto mapPtr = HmapT::GetPtr(args.oid);
+      if (mapPtr->replicas_)
+        mapPtr->replicas_->Drop(args.owner, args.version, args.key);
+    };
+    uint32_t owner = static_cast<uint32_t>(rt::thisLocality());
+    rt::asyncExecuteOnAll(handle, dropLambda,
+                          DropArgs{oid_, owner, version, key});
+  }
+
+  // Drop the replicas of all the keys, after a write to any entry.
+  void DropAllReplicas() {
+    if (!replicas_) return;
+    auto dropAllLambda = [](rt::Handle &handle, const ObjectID &oid) {
+      auto mapPtr = HmapT::GetPtr(oid);
+      if (!mapPtr->replicas_) return;
+      for (const KTYPE &key : mapPtr->replicas_->ReplicatedKeys())
+        mapPtr->AsyncDropReplicas(handle, key);
+    };
+    rt::Handle handle;
+    rt::asyncExecuteOnAll(handle, dropAllLambda, oid_);
+    rt::waitForCompletion(handle);
+  }
+
+  // Entry function of AsyncForEachEntry dropping the replicas of every entry
+  // after applying the user function, which may write it.
+  template <typename FunctionTy>
+  struct AsyncDropAfter {
+    HmapT *mapPtr;
+    FunctionTy fn;
+
+    template <typename... Args>
+    void operator()(rt::Handle &handle, const KTYPE &key, VTYPE &value,
+                    Args &... args) const {
+      fn(handle, key, value, args...);
+      mapPtr->AsyncDropReplicas(handle, key);
+    }
+  };
+
  protected:
-  Hashmap(ObjectID oid, const size_t numEntries)
+  Hashmap(ObjectID oid, const size_t numEntries,
+          const PARTITIONER &partitioner = PARTITIONER())
       : oid_(oid),
         localMap_(std::max(
             numEntries /
                 (constants::kDefaultNumEntriesPerBucket * rt::numLocalities()),
             1lu)),
-        buffers_(oid) {}
+        buffers_(oid),
+        partitioner_(partitioner) {}
 };
 
 template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
-          typename INSERT_POLICY>
-inline size_t Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::Size() const {
-  size_t size = localMap_.size_;
-  size_t remoteSize;
-  auto sizeLambda = [](const ObjectID &oid, size_t *res) {
-    auto mapPtr = HmapT::GetPtr(oid);
-    *res = mapPtr->localMap_.size_;
+          typename INSERT_POLICY,
+          template <typename, typename, typename, typename> class LOCAL_MAP,
+          typename PARTITIONER>
+inline size_t
+Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+        PARTITIONER>::Size() const {
+  auto sizeLambda = [](const ObjectID &oid) -> size_t {
+    return HmapT::GetPtr(oid)->localMap_.size_;
   };
-  for (auto tgtLoc : rt::allLocalities()) {
-    if (tgtLoc != rt::thisLocality()) {
-      rt::executeAtWithRet(tgtLoc, sizeLambda, oid_, &remoteSize);
-      size += remoteSize;
-    }
-  }
-  return size;
+  return rt::treeReduce(rt::localities_range(), sizeLambda,
+                        std::plus<size_t>(), size_t(0), oid_);
 }
 
 template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
-          typename INSERT_POLICY>
-inline std::pair<
-    typename Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::iterator, bool>
-Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::Insert(const KTYPE &key,
-                                                          const VTYPE &value) {
+          typename INSERT_POLICY,
+          template <typename, typename, typename, typename> class LOCAL_MAP,
+          typename PARTITIONER>
+inline std::pair<typename Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY,
+                                  LOCAL_MAP, PARTITIONER>::iterator,
+                 bool>
+Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+        PARTITIONER>::Insert(
+    const KTYPE &key, const VTYPE &value) {
   using itr_traits = distributed_iterator_traits<iterator>;
-  size_t targetId = shad::hash<KTYPE>{}(key) % rt::numLocalities();
+  size_t targetId = partitioner_(key, rt::numLocalities());
   rt::Locality targetLocality(targetId);
   std::pair<iterator, bool> res;
 
   if (targetLocality == rt::thisLocality()) {
     auto lres = localMap_.Insert(key, value);
+    DropReplicas(key);
     res.first = itr_traits::iterator_from_local(begin(), end(), lres.first);
     res.second = lres.second;
   } else {
     auto insertLambda =
         [](const std::tuple<iterator, iterator, InsertArgs> &args_,
-           std::pair<iterator, bool> *res_ptr) {
+           InsertResult *res_ptr) {
           auto &args(std::get<2>(args_));
           auto mapPtr = HmapT::GetPtr(args.oid);
           auto lres = mapPtr->localMap_.Insert(args.key, args.value);
-          res_ptr->first = itr_traits::iterator_from_local(
+          res_ptr->version = mapPtr->Unreplicate(args.key);
+          res_ptr->res.first = itr_traits::iterator_from_local(
               std::get<0>(args_), std::get<1>(args_), lres.first);
-          res_ptr->second = lres.second;
+          res_ptr->res.second = lres.second;
         };
+    InsertResult ires;
     rt::executeAtWithRet(
         targetLocality, insertLambda,
-        std::make_tuple(begin(), end(), InsertArgs{oid_, key, value}), &res);
+        std::make_tuple(begin(), end(), InsertArgs{oid_, key, value}), &ires);
+    DropReplicas(static_cast<uint32_t>(targetId), ires.version, key);
+    res = ires.res;
   }
   return res;
 }
 
 template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
-          typename INSERT_POLICY>
-inline void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::AsyncInsert(
+          typename INSERT_POLICY,
+          template <typename, typename, typename, typename> class LOCAL_MAP,
+          typename PARTITIONER>
+inline void
+Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+        PARTITIONER>::AsyncInsert(
     rt::Handle &handle, const KTYPE &key, const VTYPE &value) {
-  size_t targetId = shad::hash<KTYPE>{}(key) % rt::numLocalities();
+  size_t targetId = partitioner_(key, rt::numLocalities());
   rt::Locality targetLocality(targetId);
 
-  if (targetLocality == rt::thisLocality()) {
-    localMap_.AsyncInsert(handle, key, value);
-  } else {
-    auto insertLambda = [](rt::Handle &handle, const InsertArgs &args) {
-      auto mapPtr = HmapT::GetPtr(args.oid);
-      mapPtr->localMap_.AsyncInsert(handle, args.key, args.value);
-    };
-    InsertArgs args = {oid_, key, value};
-    rt::asyncExecuteAt(handle, targetLocality, insertLambda, args);
+  // The replicas are dropped once the value is written, also on this
+  // locality: the insertion runs in the task instead of spawning its own.
+  auto insertLambda = [](rt::Handle &handle, const InsertArgs &args) {
+    auto mapPtr = HmapT::GetPtr(args.oid);
+    mapPtr->localMap_.Insert(args.key, args.value);
+    mapPtr->AsyncDropReplicas(handle, args.key);
+  };
+  InsertArgs args = {oid_, key, value};
+  rt::asyncExecuteAt(handle, targetLocality, insertLambda, args);
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERT_POLICY,
+          template <typename, typename, typename, typename> class LOCAL_MAP,
+          typename PARTITIONER>
+inline void
+Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+        PARTITIONER>::InsertBatch(
+    const KTYPE *keys, const VTYPE *values, size_t numEntries) {
+  rt::Handle handle;
+  AsyncInsertBatch(handle, keys, values, numEntries);
+  rt::waitForCompletion(handle);
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERT_POLICY,
+          template <typename, typename, typename, typename> class LOCAL_MAP,
+          typename PARTITIONER>
+inline void
+Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+        PARTITIONER>::AsyncInsertBatch(
+    rt::Handle &handle, const KTYPE *keys, const VTYPE *values,
+    size_t numEntries) {
+  using Layout = impl::BatchLayout<BatchHeader, KTYPE, VTYPE>;
+  auto insertBatchLambda = [](rt::Handle &handle, const uint8_t *payload,
+                              const uint32_t) {
+    const BatchHeader &header = Layout::Header(payload);
+    auto mapPtr = HmapT::GetPtr(header.oid);
+    const KTYPE *keys = Layout::template Array<0>(payload, header.numEntries);
+    const VTYPE *values = Layout::template Array<1>(payload, header.numEntries);
+    rt::impl::parallelFor(header.numEntries, [&](size_t i) {
+      mapPtr->localMap_.Insert(keys[i], values[i]);
+    });
+    if (mapPtr->replicas_) {
+      for (size_t i = 0; i < header.numEntries; ++i)
+        mapPtr->AsyncDropReplicas(handle, keys[i]);
+    }
+  };
+
+  auto partition = impl::PartitionByLocality(keys, numEntries, partitioner_);
+  for (uint32_t l = 0; l < rt::numLocalities(); ++l) {
+    size_t count = partition.Count(l);
+    if (count == 0) continue;
+
+    auto payload = Layout::Allocate(count, BatchHeader{oid_, count});
+    KTYPE *batchKeys = Layout::template Array<0>(payload.get(), count);
+    VTYPE *batchValues = Layout::template Array<1>(payload.get(), count);
+    for (size_t i = 0; i < count; ++i) {
+      size_t pos = partition.Position(l, i);
+      new (&batchKeys[i]) KTYPE(keys[pos]);
+      new (&batchValues[i]) VTYPE(values[pos]);
+    }
+    rt::asyncExecuteAt(handle, rt::Locality(l), insertBatchLambda, payload,
+                       Layout::Bytes(count));
+  }
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERT_POLICY,
+          template <typename, typename, typename, typename> class LOCAL_MAP,
+          typename PARTITIONER>
+inline void
+Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+        PARTITIONER>::LookupBatch(
+    const KTYPE *keys, size_t numKeys, LookupResult *results) {
+  using Layout = impl::BatchLayout<BatchHeader, KTYPE>;
+  auto lookupBatchLambda = [](rt::Handle &, const uint8_t *payload,
+                              const uint32_t, uint8_t *resultBuffer,
+                              uint32_t *resultSize) {
+    const BatchHeader &header = Layout::Header(payload);
+    auto mapPtr = HmapT::GetPtr(header.oid);
+    const KTYPE *keys = Layout::template Array<0>(payload, header.numEntries);
+    LookupResult *results = reinterpret_cast<LookupResult *>(resultBuffer);
+    rt::impl::parallelFor(header.numEntries, [&](size_t i) {
+      mapPtr->localMap_.Lookup(keys[i], &results[i]);
+    });
+    *resultSize = header.numEntries * sizeof(LookupResult);
+  };
+
+  auto partition = impl::PartitionByLocality(keys, numKeys, partitioner_);
+  std::vector<std::unique_ptr<uint8_t[]>> resultBuffers(rt::numLocalities());
+  std::vector<uint32_t> resultSizes(rt::numLocalities(), 0);
+  rt::Handle handle;
+  for (uint32_t l = 0; l < rt::numLocalities(); ++l) {
+    size_t count = partition.Count(l);
+    if (count == 0) continue;
+
+    auto payload = Layout::Allocate(count, BatchHeader{oid_, count});
+    KTYPE *batchKeys = Layout::template Array<0>(payload.get(), count);
+    for (size_t i = 0; i < count; ++i)
+      new (&batchKeys[i]) KTYPE(keys[partition.Position(l, i)]);
+    resultBuffers[l].reset(new uint8_t[count * sizeof(LookupResult)]);
+    rt::asyncExecuteAtWithRetBuff(handle, rt::Locality(l), lookupBatchLambda,
+                                  payload, Layout::Bytes(count),
+                                  resultBuffers[l].get(), &resultSizes[l]);
+  }
+  rt::waitForCompletion(handle);
+
+  for (uint32_t l = 0; l < rt::numLocalities(); ++l) {
+    const LookupResult *batchResults =
+        reinterpret_cast<const LookupResult *>(resultBuffers[l].get());
+    for (size_t i = 0; i < partition.Count(l); ++i)
+      results[partition.Position(l, i)] = batchResults[i];
   }
 }
 
 template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
-          typename INSERT_POLICY>
-inline void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::BufferedInsert(
+          typename INSERT_POLICY,
+          template <typename, typename, typename, typename> class LOCAL_MAP,
+          typename PARTITIONER>
+inline void
+Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+        PARTITIONER>::BufferedInsert(
     const KTYPE &key, const VTYPE &value) {
-  size_t targetId = shad::hash<KTYPE>{}(key) % rt::numLocalities();
+  size_t targetId = partitioner_(key, rt::numLocalities());
   rt::Locality targetLocality(targetId);
   buffers_.Insert(EntryT(key, value), targetLocality);
 }
 
 template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
-          typename INSERT_POLICY>
-inline void Hashmap<KTYPE, VTYPE, KEY_COMPARE,
-                    INSERT_POLICY>::BufferedAsyncInsert(rt::Handle &handle,
-                                                        const KTYPE &key,
-                                                        const VTYPE &value) {
-  size_t targetId = shad::hash<KTYPE>{}(key) % rt::numLocalities();
+          typename INSERT_POLICY,
+          template <typename, typename, typename, typename> class LOCAL_MAP,
+          typename PARTITIONER>
+inline void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+                    PARTITIONER>::BufferedAsyncInsert(rt::Handle &handle,
+                                                    const KTYPE &key,
+                                                    const VTYPE &value) {
+  size_t targetId = partitioner_(key, rt::numLocalities());
   rt::Locality targetLocality(targetId);
   buffers_.AsyncInsert(handle, EntryT(key, value), targetLocality);
 }
 
 template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
-          typename INSERT_POLICY>
-inline void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::Erase(
+          typename INSERT_POLICY,
+          template <typename, typename, typename, typename> class LOCAL_MAP,
+          typename PARTITIONER>
+inline void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+                    PARTITIONER>::Erase(
     const KTYPE &key) {
-  size_t targetId = shad::hash<KTYPE>{}(key) % rt::numLocalities();
+  size_t targetId = partitioner_(key, rt::numLocalities());
   rt::Locality targetLocality(targetId);
 
   if (targetLocality == rt::thisLocality()) {
     localMap_.Erase(key);
+    DropReplicas(key);
   } else {
-    auto eraseLambda = [](const LookupArgs &args) {
+    auto eraseLambda = [](const LookupArgs &args, uint64_t *version) {
       auto mapPtr = HmapT::GetPtr(args.oid);
       mapPtr->localMap_.Erase(args.key);
+      *version = mapPtr->Unreplicate(args.key);
     };
     LookupArgs args = {oid_, key};
-    rt::executeAt(targetLocality, eraseLambda, args);
+    uint64_t version;
+    rt::executeAtWithRet(targetLocality, eraseLambda, args, &version);
+    DropReplicas(static_cast<uint32_t>(targetId), version, key);
   }
 }
 
 template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
-          typename INSERT_POLICY>
-inline void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::AsyncErase(
+          typename INSERT_POLICY,
+          template <typename, typename, typename, typename> class LOCAL_MAP,
+          typename PARTITIONER>
+inline void
+Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+        PARTITIONER>::AsyncErase(
     rt::Handle &handle, const KTYPE &key) {
-  size_t targetId = shad::hash<KTYPE>{}(key) % rt::numLocalities();
+  size_t targetId = partitioner_(key, rt::numLocalities());
   rt::Locality targetLocality(targetId);
 
-  if (targetLocality == rt::thisLocality()) {
-    localMap_.AsyncErase(handle, key);
-  } else {
-    auto eraseLambda = [](rt::Handle &handle, const LookupArgs &args) {
-      auto mapPtr = HmapT::GetPtr(args.oid);
-      mapPtr->localMap_.AsyncErase(handle, args.key);
-    };
-    LookupArgs args = {oid_, key};
-    rt::asyncExecuteAt(handle, targetLocality, eraseLambda, args);
-  }
+  auto eraseLambda = [](rt::Handle &handle, const LookupArgs &args) {
+    auto mapPtr = HmapT::GetPtr(args.oid);
+    mapPtr->localMap_.Erase(args.key);
+    mapPtr->AsyncDropReplicas(handle, args.key);
+  };
+  LookupArgs args = {oid_, key};
+  rt::asyncExecuteAt(handle, targetLocality, eraseLambda, args);
 }
 
 template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
-          typename INSERT_POLICY>
-inline bool Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::Lookup(
+          typename INSERT_POLICY,
+          template <typename, typename, typename, typename> class LOCAL_MAP,
+          typename PARTITIONER>
+inline bool
+Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+        PARTITIONER>::Lookup(
     const KTYPE &key, VTYPE *res) {
-  size_t targetId = shad::hash<KTYPE>{}(key) % rt::numLocalities();
+  size_t targetId = partitioner_(key, rt::numLocalities());
   rt::Locality targetLocality(targetId);
 
   if (targetLocality == rt::thisLocality()) {
     return localMap_.Lookup(key, res);
   } else {
+    if (replicas_ && replicas_->Lookup(key, res)) return true;
     auto lookupLambda = [](const LookupArgs &args, LookupResult *res) {
       auto mapPtr = HmapT::GetPtr(args.oid);
       res->found = mapPtr->localMap_.Lookup(args.key, &res->value);
+      if (res->found) mapPtr->CountRemoteRead(args.key);
     };
     LookupArgs args = {oid_, key};
     LookupResult lres;
@@ -519,20 +912,29 @@ inline bool Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::Lookup(
 }
 
 template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
-          typename INSERT_POLICY>
-inline void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::AsyncLookup(
+          typename INSERT_POLICY,
+          template <typename, typename, typename, typename> class LOCAL_MAP,
+          typename PARTITIONER>
+inline void
+Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+        PARTITIONER>::AsyncLookup(
     rt::Handle &handle, const KTYPE &key, LookupResult *res) {
-  size_t targetId = shad::hash<KTYPE>{}(key) % rt::numLocalities();
+  size_t targetId = partitioner_(key, rt::numLocalities());
   rt::Locality targetLocality(targetId);
 
   if (targetLocality == rt::thisLocality()) {
     localMap_.AsyncLookup(handle, key, res);
   } else {
+    if (replicas_ && replicas_->Lookup(key, &res->value)) {
+      res->found = true;
+      return;
+    }
     auto lookupLambda = [](rt::Handle &, const LookupArgs &args,
                            LookupResult *res) {
       auto mapPtr = HmapT::GetPtr(args.oid);
       LookupResult tres;
       mapPtr->localMap_.Lookup(args.key, &tres);
+      if (tres.found) mapPtr->CountRemoteRead(args.key);
       *res = tres;
     };
     LookupArgs args = {oid_, key};
@@ -541,14 +943,16 @@ inline void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::AsyncLookup(
 }
 
 template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
-          typename INSERT_POLICY>
+          typename INSERT_POLICY,
+          template <typename, typename, typename, typename> class LOCAL_MAP,
+          typename PARTITIONER>
 template <typename ApplyFunT, typename... Args>
-void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::ForEachEntry(
+void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+             PARTITIONER>::ForEachEntry(
     ApplyFunT &&function, Args &... args) {
   using FunctionTy = void (*)(const KTYPE &, VTYPE &, Args &...);
   FunctionTy fn = std::forward<decltype(function)>(function);
   using feArgs = std::tuple<ObjectID, FunctionTy, std::tuple<Args...>>;
-  using LMapPtr = LocalHashmap<KTYPE, VTYPE, KEY_COMPARE> *;
   using ArgsTuple = std::tuple<LMapT *, FunctionTy, std::tuple<Args...>>;
   feArgs arguments(oid_, fn, std::tuple<Args...>(args...));
   auto feLambda = [](const feArgs &args) {
@@ -560,21 +964,29 @@ void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::ForEachEntry(
                   argsTuple, mapPtr->localMap_.numBuckets_);
   };
   rt::executeOnAll(feLambda, arguments);
+  DropAllReplicas();
 }
 
 template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
-          typename INSERT_POLICY>
+          typename INSERT_POLICY,
+          template <typename, typename, typename, typename> class LOCAL_MAP,
+          typename PARTITIONER>
 template <typename ApplyFunT, typename... Args>
-void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::AsyncForEachEntry(
+void
+Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+        PARTITIONER>::AsyncForEachEntry(
     rt::Handle &handle, ApplyFunT &&function, Args &... args) {
   using FunctionTy = void (*)(rt::Handle &, const KTYPE &, VTYPE &, Args &...);
   FunctionTy fn = std::forward<decltype(function)>(function);
   using feArgs = std::tuple<ObjectID, FunctionTy, std::tuple<Args...>>;
-  using ArgsTuple = std::tuple<LMapT *, FunctionTy, std::tuple<Args...>>;
+  using ArgsTuple =
+      std::tuple<LMapT *, AsyncDropAfter<FunctionTy>, std::tuple<Args...>>;
   feArgs arguments(oid_, fn, std::tuple<Args...>(args...));
   auto feLambda = [](rt::Handle &handle, const feArgs &args) {
     auto mapPtr = HmapT::GetPtr(std::get<0>(args));
-    ArgsTuple argsTuple(&mapPtr->localMap_, std::get<1>(args),
+    ArgsTuple argsTuple(&mapPtr->localMap_,
+                        AsyncDropAfter<FunctionTy>{mapPtr.get(),
+                                                   std::get<1>(args)},
                         std::get<2>(args));
     rt::asyncForEachAt(
         handle, rt::thisLocality(),
@@ -585,9 +997,12 @@ void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::AsyncForEachEntry(
 }
 
 template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
-          typename INSERT_POLICY>
+          typename INSERT_POLICY,
+          template <typename, typename, typename, typename> class LOCAL_MAP,
+          typename PARTITIONER>
 template <typename ApplyFunT, typename... Args>
-void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::ForEachKey(
+void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+             PARTITIONER>::ForEachKey(
     ApplyFunT &&function, Args &... args) {
   using FunctionTy = void (*)(const KTYPE &, Args &...);
   FunctionTy fn = std::forward<decltype(function)>(function);
@@ -606,9 +1021,13 @@ void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::ForEachKey(
 }
 
 template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
-          typename INSERT_POLICY>
+          typename INSERT_POLICY,
+          template <typename, typename, typename, typename> class LOCAL_MAP,
+          typename PARTITIONER>
 template <typename ApplyFunT, typename... Args>
-void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::AsyncForEachKey(
+void
+Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+        PARTITIONER>::AsyncForEachKey(
     rt::Handle &handle, ApplyFunT &&function, Args &... args) {
   using FunctionTy = void (*)(rt::Handle &, const KTYPE &, Args &...);
   FunctionTy fn = std::forward<decltype(function)>(function);
@@ -628,61 +1047,69 @@ void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::AsyncForEachKey(
 }
 
 template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
-          typename INSERT_POLICY>
+          typename INSERT_POLICY,
+          template <typename, typename, typename, typename> class LOCAL_MAP,
+          typename PARTITIONER>
 template <typename ApplyFunT, typename... Args>
-void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::Apply(
+void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+             PARTITIONER>::Apply(
     const KTYPE &key, ApplyFunT &&function, Args &... args) {
-  size_t targetId = shad::hash<KTYPE>{}(key) % rt::numLocalities();
+  size_t targetId = partitioner_(key, rt::numLocalities());
   rt::Locality targetLocality(targetId);
   if (targetLocality == rt::thisLocality()) {
     localMap_.Apply(key, function, args...);
+    DropReplicas(key);
   } else {
     using FunctionTy = void (*)(const KTYPE &, VTYPE &, Args &...);
     FunctionTy fn = std::forward<decltype(function)>(function);
     using ArgsTuple =
         std::tuple<ObjectID, const KTYPE, FunctionTy, std::tuple<Args...>>;
     ArgsTuple arguments(oid_, key, fn, std::tuple<Args...>(args...));
-    auto feLambda = [](const ArgsTuple &args) {
+    auto feLambda = [](const ArgsTuple &args, uint64_t *version) {
       constexpr auto Size = std::tuple_size<
           typename std::decay<decltype(std::get<3>(args))>::type>::value;
       ArgsTuple &tuple = const_cast<ArgsTuple &>(args);
-      LMapT *mapPtr = &(HmapT::GetPtr(std::get<0>(tuple))->localMap_);
-      LMapT::CallApplyFun(mapPtr, std::get<1>(tuple), std::get<2>(tuple),
-                          std::get<3>(tuple), std::make_index_sequence<Size>{});
+      auto hmapPtr = HmapT::GetPtr(std::get<0>(tuple));
+      LMapT::CallApplyFun(&hmapPtr->localMap_, std::get<1>(tuple),
+                          std::get<2>(tuple), std::get<3>(tuple),
+                          std::make_index_sequence<Size>{});
+      *version = hmapPtr->Unreplicate(std::get<1>(tuple));
     };
-    rt::executeAt(targetLocality, feLambda, arguments);
+    uint64_t version;
+    rt::executeAtWithRet(targetLocality, feLambda, arguments, &version);
+    DropReplicas(static_cast<uint32_t>(targetId), version, key);
   }
 }
 
 template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
-          typename INSERT_POLICY>
+          typename INSERT_POLICY,
+          template <typename, typename, typename, typename> class LOCAL_MAP,
+          typename PARTITIONER>
 template <typename ApplyFunT, typename... Args>
-void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY>::AsyncApply(
+void Hashmap<KTYPE, VTYPE, KEY_COMPARE, INSERT_POLICY, LOCAL_MAP,
+             PARTITIONER>::AsyncApply(
     rt::Handle &handle, const KTYPE &key, ApplyFunT &&function,
     Args &... args) {
-  size_t targetId = shad::hash<KTYPE>{}(key) % rt::numLocalities();
+  size_t targetId = partitioner_(key, rt::numLocalities());
   rt::Locality targetLocality(targetId);
 
-  if (targetLocality == rt::thisLocality()) {
-    localMap_.AsyncApply(handle, key, function, args...);
-  } else {
-    using FunctionTy =
-        void (*)(rt::Handle &, const KTYPE &, VTYPE &, Args &...);
-    FunctionTy fn = std::forward<decltype(function)>(function);
-    using ArgsTuple =
-        std::tuple<ObjectID, const KTYPE, FunctionTy, std::tuple<Args...>>;
-    ArgsTuple arguments(oid_, key, fn, std::tuple<Args...>(args...));
-    auto feLambda = [](rt::Handle &handle, const ArgsTuple &args) {
-      constexpr auto Size = std::tuple_size<
-          typename std::decay<decltype(std::get<3>(args))>::type>::value;
-      ArgsTuple &tuple(const_cast<ArgsTuple &>(args));
-      LMapT *mapPtr = &(HmapT::GetPtr(std::get<0>(tuple))->localMap_);
-      LMapT::AsyncCallApplyFun(handle, mapPtr, std::get<1>(tuple),
-                               std::get<2>(tuple), std::get<3>(tuple),
-                               std::make_index_sequence<Size>{});
-    };
-    rt::asyncExecuteAt(handle, targetLocality, feLambda, arguments);
-  }
+  // As in AsyncInsert, the function runs in the task dropping the replicas.
+  using FunctionTy = void (*)(rt::Handle &, const KTYPE &, VTYPE &, Args &...);
+  FunctionTy fn = std::forward<decltype(function)>(function);
+  using ArgsTuple =
+      std::tuple<ObjectID, const KTYPE, FunctionTy, std::tuple<Args...>>;
+  ArgsTuple arguments(oid_, key, fn, std::tuple<Args...>(args...));
+  auto feLambda = [](rt::Handle &handle, const ArgsTuple &args) {
+    constexpr auto Size = std::tuple_size<
+        typename std::decay<decltype(std::get<3>(args))>::type>::value;
+    ArgsTuple &tuple(const_cast<ArgsTuple &>(args));
+    auto hmapPtr = HmapT::GetPtr(std::get<0>(tuple));
+    LMapT::AsyncCallApplyFun(handle, &hmapPtr->localMap_, std::get<1>(tuple),
+                             std::get<2>(tuple), std::get<3>(tuple),
+                             std::make_index_sequence<Size>{});
+    hmapPtr->AsyncDropReplicas(handle, std::get<1>(tuple));
+  };
+  rt::asyncExecuteAt(handle, targetLocality, feLambda, arguments);
 }
 
 template <typename MapT, typename T, typename NonConstT>
@@ -690,7 +1117,7 @@ class map_iterator : public std::iterator<std::forward_iterator_tag, T> {
  public:
   using OIDT = typename MapT::ObjectID;
   using LMap = typename MapT::LMapT;
-  using local_iterator_type = lmap_iterator<LMap, T>;
+  using local_iterator_type = typename LMap::template local_iterator_type<T>;
   using value_type = NonConstT;
 
   map_iterator() {}
@@ -762,24 +1189,11 @@ class map_iterator : public std::iterator<std::forward_iterator_tag, T> {
         data_.element_ = *(data_.lmapIt_);
         return *this;
       } else {
-        // find the local begin on next localities
-        itData itd;
-        for (uint32_t i = data_.locId_ + 1; i < rt::numLocalities(); ++i) {
-          rt::executeAtWithRet(rt::Locality(i), getLocBeginIt, data_.oid_,
-                               &itd);
-          if (itd.locId_ != rt::numLocalities()) {
-            // It Data is valid
-            data_ = itd;
-            return *this;
-          }
-        }
-        data_ = itData(rt::numLocalities(), OIDT(0), lend, T());
+        data_ = getNextLocBeginIt(data_.locId_, data_.oid_);
         return *this;
       }
     }
-    itData itd;
-    rt::executeAtWithRet(rt::Locality(data_.locId_), getRemoteIt, data_, &itd);
-    data_ = itd;
+    data_ = getNextRemoteIt(data_);
     return *this;
   }
 
@@ -830,7 +1244,7 @@ class map_iterator : public std::iterator<std::forward_iterator_tag, T> {
 
  private:
   struct itData {
-    itData() : oid_(0), lmapIt_(nullptr, 0, 0, nullptr, nullptr) {}
+    itData() : oid_(0), lmapIt_(local_iterator_type::lmap_end(size_t(0))) {}
     itData(uint32_t locId, OIDT oid, local_iterator_type lmapIt, T element)
         : locId_(locId), oid_(oid), lmapIt_(lmapIt), element_(element) {}
     bool operator==(const itData &other) const {
@@ -845,41 +1259,93 @@ class map_iterator : public std::iterator<std::forward_iterator_tag, T> {
 
   itData data_;
 
-  static void getLocBeginIt(const OIDT &mapOID, itData *res) {
+  /// Number of entries fetched from a remote Locality at once.
+  constexpr static size_t kBatchSize =
+      constants::max(constants::kBufferNumBytes / sizeof(itData), 1lu);
+
+  // Entries of a remote Locality fetched by the calling thread, of which
+  // entries[next - 1] is the position of the traversal.  A batch shorter
+  // than kBatchSize ends with the last entry of its Locality.
+  struct remoteBatch {
+    itData entries[kBatchSize];
+    size_t size = 0;
+    size_t next = 0;
+  };
+
+  static remoteBatch &getThreadBatch() {
+    static thread_local remoteBatch batch;
+    return batch;
+  }
+
+  static void fillBatch(const OIDT &mapOID, local_iterator_type it,
+                        local_iterator_type localEnd, uint8_t *result,
+                        uint32_t *resultSize) {
+    itData *entries = reinterpret_cast<itData *>(result);
+    uint32_t locId = static_cast<uint32_t>(rt::thisLocality());
+    size_t numEntries = 0;
+    for (; it != localEnd && numEntries < kBatchSize; ++it, ++numEntries)
+      new (&entries[numEntries]) itData(locId, mapOID, it, *it);
+    *resultSize = numEntries * sizeof(itData);
+  }
+
+  static void getLocBeginBatch(const OIDT &mapOID, uint8_t *result,
+                               uint32_t *resultSize) {
     auto mapPtr = MapT::GetPtr(mapOID);
     auto lmapPtr = &(mapPtr->localMap_);
-    auto localEnd = local_iterator_type::lmap_end(lmapPtr);
-    auto localBegin = local_iterator_type::lmap_begin(lmapPtr);
-    if (localBegin != localEnd) {
-      *res = itData(static_cast<uint32_t>(rt::thisLocality()), mapOID,
-                    localBegin, *localBegin);
-    } else {
-      *res = itData(rt::numLocalities(), OIDT(0), localEnd, T());
-    }
+    fillBatch(mapOID, local_iterator_type::lmap_begin(lmapPtr),
+              local_iterator_type::lmap_end(lmapPtr), result, resultSize);
   }
 
-  static void getRemoteIt(const itData &itd, itData *res) {
+  static void getRemoteBatch(const itData &itd, uint8_t *result,
+                             uint32_t *resultSize) {
     auto mapPtr = MapT::GetPtr(itd.oid_);
-    auto lmapPtr = &(mapPtr->localMap_);
-    auto localEnd = local_iterator_type::lmap_end(lmapPtr);
+    auto localEnd = local_iterator_type::lmap_end(&(mapPtr->localMap_));
     local_iterator_type cit = itd.lmapIt_;
-    ++cit;
-    if (cit != localEnd) {
-      *res = itData(static_cast<uint32_t>(rt::thisLocality()), itd.oid_, cit,
-                    *cit);
-      return;
-    } else {
-      itData outitd;
-      for (uint32_t i = itd.locId_ + 1; i < rt::numLocalities(); ++i) {
-        rt::executeAtWithRet(rt::Locality(i), getLocBeginIt, itd.oid_, &outitd);
-        if (outitd.locId_ != rt::numLocalities()) {
-          // It Data is valid
-          *res = outitd;
-          return;
-        }
-      }
-      *res = itData(rt::numLocalities(), OIDT(0), localEnd, T());
+    if (cit != localEnd) ++cit;
+    fillBatch(itd.oid_, cit, localEnd, result, resultSize);
+  }
+
+  // Fetch a batch and make it the batch of the calling thread, which the
+  // tasks run by the thread while waiting may have replaced meanwhile.
+  template <typename FunT, typename InArgsT>
+  static remoteBatch &fetchBatch(uint32_t locId, FunT &&func,
+                                 const InArgsT &args) {
+    remoteBatch fetched;
+    uint32_t resultSize = 0;
+    rt::executeAtWithRetBuff(rt::Locality(locId), func, args,
+                             reinterpret_cast<uint8_t *>(fetched.entries),
+                             &resultSize);
+    fetched.size = resultSize / sizeof(itData);
+    remoteBatch &batch = getThreadBatch();
+    batch = fetched;
+    return batch;
+  }
+
+  // The first entry of the Localities following locId, fetched together with
+  // the entries following it.
+  static itData getNextLocBeginIt(uint32_t locId, const OIDT &mapOID) {
+    for (uint32_t i = locId + 1; i < rt::numLocalities(); ++i) {
+      remoteBatch &batch = fetchBatch(i, getLocBeginBatch, mapOID);
+      if (batch.size != 0) return batch.entries[batch.next++];
+    }
+    auto mapPtr = MapT::GetPtr(mapOID);
+    return itData(rt::numLocalities(), OIDT(0),
+                  local_iterator_type::lmap_end(&(mapPtr->localMap_)), T());
+  }
+
+  // The entry following itd on a remote Locality.  It is served by the batch
+  // of the calling thread when that holds the position of itd, otherwise it is
+  // fetched together with the entries following it.
+  static itData getNextRemoteIt(const itData &itd) {
+    remoteBatch &batch = getThreadBatch();
+    bool hit = batch.next != 0 && batch.entries[batch.next - 1] == itd &&
+               batch.entries[batch.next - 1].oid_ == itd.oid_;
+    if (hit && batch.next < batch.size) return batch.entries[batch.next++];
+    if (!hit || batch.size == kBatchSize) {
+      remoteBatch &fetched = fetchBatch(itd.locId_, getRemoteBatch, itd);
+      if (fetched.size != 0) return fetched.entries[fetched.next++];
     }
+    return getNextLocBeginIt(itd.locId_, itd.oid_);
   }
 };
 
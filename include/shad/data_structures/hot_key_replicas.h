@@ -0,0 +1,248 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_SHAD_DATA_STRUCTURES_HOT_KEY_REPLICAS_H_
+#define INCLUDE_SHAD_DATA_STRUCTURES_HOT_KEY_REPLICAS_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "shad/data_structures/compare_and_hash_utils.h"
+#include "shad/runtime/runtime.h"
+
+namespace shad {
+namespace impl {
+
+/// @brief Per-Locality state of the read replication of hot keys.
+///
+/// The owner side counts the remote reads of its keys in a direct-mapped
+/// table: a read of the key held by a slot increments its count, a read of
+/// another key decrements it, and a slot whose count drops to zero is taken
+/// over.  A key whose count reaches the threshold becomes hot and is marked
+/// as replicated; replicated slots are not taken over, so that the owner can
+/// find them again when the key is written.  The reader side keeps the
+/// direct-mapped cache of the replicas received from the owners.
+///
+/// Replicas and drops are tagged with the version of their owner, which
+/// every drop advances.  A reader discards the replicas older than the last
+/// drop received from their owner, so a replica overtaken by the drop of a
+/// later write is never stored.  Lookups of the cache take no lock: every
+/// slot is a sequence lock, and a read racing with a write is a miss.
+///
+/// @tparam KTYPE The type of the keys.
+/// @tparam VTYPE The type of the values.
+/// @tparam KEY_COMPARE The key comparison function.
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE>
+class HotKeyReplicas {
+ public:
+  /// @brief Constructor.
+  ///
+  /// @param capacity The number of slots of the replica cache and of the
+  /// access counters.
+  /// @param threshold The number of remote reads making a key hot.
+  HotKeyReplicas(size_t capacity, uint32_t threshold)
+      : capacity_(std::max(capacity, size_t(1))),
+        threshold_(std::max(threshold, uint32_t(1))),
+        replicas_(new Replica[capacity_]),
+        counters_(new Counter[capacity_]),
+        dropVersions_(new std::atomic<uint64_t>[rt::numLocalities()]) {
+    for (uint32_t l = 0; l < rt::numLocalities(); ++l) dropVersions_[l] = 0;
+  }
+
+  /// @brief Read the replica of a key.
+  ///
+  /// @param[in] key The key.
+  /// @param[out] value The replicated value, if any.
+  /// @return true if the key is replicated on this Locality.
+  bool Lookup(const KTYPE &key, VTYPE *value) {
+    const Replica &replica = replicas_[SlotOf(key)];
+    uint64_t sequence = replica.sequence.load(std::memory_order_acquire);
+    if (sequence % 2 != 0) return false;
+    bool valid = replica.valid;
+    alignas(KTYPE) uint8_t keyCopy[sizeof(KTYPE)];
+    alignas(VTYPE) uint8_t valueCopy[sizeof(VTYPE)];
+    std::memcpy(keyCopy, &replica.key, sizeof(KTYPE));
+    std::memcpy(valueCopy, &replica.value, sizeof(VTYPE));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (replica.sequence.load(std::memory_order_relaxed) != sequence)
+      return false;
+    if (!valid ||
+        KeyComp_(reinterpret_cast<const KTYPE *>(keyCopy), &key) != 0)
+      return false;
+    std::memcpy(value, valueCopy, sizeof(VTYPE));
+    return true;
+  }
+
+  /// @brief Store the replica of a key, evicting the one in its slot.
+  ///
+  /// @param owner The Locality owning the key.
+  /// @param version The version of the owner when it sent the replica.
+  /// @param key The key.
+  /// @param value The replicated value.
+  void Store(uint32_t owner, uint64_t version, const KTYPE &key,
+             const VTYPE &value) {
+    size_t slot = SlotOf(key);
+    std::lock_guard<rt::Lock> _(LockOf(slot));
+    if (version < dropVersions_[owner].load()) return;
+    Write(replicas_[slot], true, key, value);
+  }
+
+  /// @brief Drop the replica of a key, if any.
+  ///
+  /// @param owner The Locality owning the key.
+  /// @param version The version of the drop returned by Unreplicate().
+  /// @param key The key.
+  void Drop(uint32_t owner, uint64_t version, const KTYPE &key) {
+    uint64_t last = dropVersions_[owner].load();
+    while (last < version &&
+           !dropVersions_[owner].compare_exchange_weak(last, version)) {
+    }
+    size_t slot = SlotOf(key);
+    std::lock_guard<rt::Lock> _(LockOf(slot));
+    Replica &replica = replicas_[slot];
+    if (replica.valid && KeyComp_(&replica.key, &key) == 0)
+      Write(replica, false, replica.key, replica.value);
+  }
+
+  /// @brief Count a remote read of a key owned by this Locality.
+  ///
+  /// @return true if the key just became hot and must be replicated.
+  bool CountAccess(const KTYPE &key) {
+    size_t slot = SlotOf(key);
+    std::lock_guard<rt::Lock> _(LockOf(slot));
+    Counter &counter = counters_[slot];
+    if (counter.count != 0 && KeyComp_(&counter.key, &key) == 0) {
+      if (counter.replicated || ++counter.count < threshold_) return false;
+      counter.replicated = true;
+      return true;
+    }
+    if (counter.replicated) return false;
+    if (counter.count != 0) {
+      --counter.count;
+      return false;
+    }
+    counter.key = key;
+    counter.count = 1;
+    counter.replicated = threshold_ == 1;
+    return counter.replicated;
+  }
+
+  /// @brief The version tagging the replicas sent by this Locality.
+  uint64_t Version() const { return version_.load(); }
+
+  /// @brief Forget the replication of a key owned by this Locality.
+  ///
+  /// @return 0 if the key was not replicated, otherwise the version of the
+  /// drop of its replicas on all the Localities, newer than every replica
+  /// sent so far.
+  uint64_t Unreplicate(const KTYPE &key) {
+    size_t slot = SlotOf(key);
+    std::lock_guard<rt::Lock> _(LockOf(slot));
+    Counter &counter = counters_[slot];
+    if (!counter.replicated || KeyComp_(&counter.key, &key) != 0) return 0;
+    counter = Counter();
+    return version_.fetch_add(1) + 1;
+  }
+
+  /// @brief The replicated keys owned by this Locality.
+  std::vector<KTYPE> ReplicatedKeys() {
+    std::vector<KTYPE> keys;
+    for (size_t slot = 0; slot < capacity_; ++slot) {
+      std::lock_guard<rt::Lock> _(LockOf(slot));
+      if (counters_[slot].replicated) keys.push_back(counters_[slot].key);
+    }
+    return keys;
+  }
+
+  /// @brief Drop all the replicas and reset all the access counters.
+  void Clear() {
+    for (size_t slot = 0; slot < capacity_; ++slot) {
+      std::lock_guard<rt::Lock> _(LockOf(slot));
+      Replica &replica = replicas_[slot];
+      if (replica.valid) Write(replica, false, replica.key, replica.value);
+      counters_[slot] = Counter();
+    }
+  }
+
+  /// @brief The handle of the replicas and of the drops sent by this
+  /// Locality outside of a caller's handle.
+  rt::Handle &PushHandle() { return pushHandle_; }
+
+ private:
+  static constexpr size_t kNumLocks = 64;
+
+  // Written under the lock of the slot; odd sequences mark a write in
+  // progress.
+  struct Replica {
+    std::atomic<uint64_t> sequence{0};
+    bool valid = false;
+    KTYPE key;
+    VTYPE value;
+  };
+
+  struct Counter {
+    uint32_t count = 0;
+    bool replicated = false;
+    KTYPE key;
+  };
+
+  static void Write(Replica &replica, bool valid, const KTYPE &key,
+                    const VTYPE &value) {
+    uint64_t sequence = replica.sequence.load(std::memory_order_relaxed);
+    replica.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    replica.valid = valid;
+    replica.key = key;
+    replica.value = value;
+    replica.sequence.store(sequence + 2, std::memory_order_release);
+  }
+
+  size_t SlotOf(const KTYPE &key) const {
+    return BucketOf(shad::hash<KTYPE>{}(key), capacity_);
+  }
+
+  rt::Lock &LockOf(size_t slot) { return locks_[slot % kNumLocks]; }
+
+  size_t capacity_;
+  uint32_t threshold_;
+  std::unique_ptr<Replica[]> replicas_;
+  std::unique_ptr<Counter[]> counters_;
+  // The version of the last drop received from every owner.
+  std::unique_ptr<std::atomic<uint64_t>[]> dropVersions_;
+  std::atomic<uint64_t> version_{1};
+  rt::Lock locks_[kNumLocks];
+  rt::Handle pushHandle_;
+  KEY_COMPARE KeyComp_;
+};
+
+}  // namespace impl
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_DATA_STRUCTURES_HOT_KEY_REPLICAS_H_
@@ -0,0 +1,1184 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_SHAD_DATA_STRUCTURES_LOCAL_FLAT_HASHMAP_H_
+#define INCLUDE_SHAD_DATA_STRUCTURES_LOCAL_FLAT_HASHMAP_H_
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "shad/data_structures/compare_and_hash_utils.h"
+#include "shad/data_structures/local_hashmap.h"
+#include "shad/runtime/runtime.h"
+
+namespace shad {
+
+template <typename LMap, typename T>
+class lfmap_iterator;
+
+namespace impl {
+
+/// @brief Values of the control bytes of the open-addressing tables.
+///
+/// A full slot stores the low 7 bits of the hash of its key (0x00-0x7F), all
+/// the other states have the sign bit set.
+enum : int8_t {
+  kCtrlEmpty = -128,  // 0x80
+  kCtrlDeleted = -2,  // 0xFE
+  kCtrlBusy = -1,     // 0xFF: slot locked by an insertion, update or erase.
+};
+
+/// @brief A group of control bytes that is probed with a single comparison.
+///
+/// The width of the group is chosen at compile time: 32 lanes when AVX2 is
+/// available, 16 lanes with SSE2 and 8 lanes with the portable fallback.
+class CtrlGroup {
+ public:
+#if defined(__AVX2__)
+  static constexpr size_t kWidth = 32;
+
+  explicit CtrlGroup(const int8_t *ctrl)
+      : ctrl_(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(ctrl))) {}
+
+  /// @brief Bit mask of the lanes holding the control byte c.
+  uint32_t Match(int8_t c) const {
+    return static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(ctrl_, _mm256_set1_epi8(c))));
+  }
+
+ private:
+  __m256i ctrl_;
+#elif defined(__SSE2__)
+  static constexpr size_t kWidth = 16;
+
+  explicit CtrlGroup(const int8_t *ctrl)
+      : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl))) {}
+
+  /// @brief Bit mask of the lanes holding the control byte c.
+  uint32_t Match(int8_t c) const {
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(c))));
+  }
+
+ private:
+  __m128i ctrl_;
+#else
+  static constexpr size_t kWidth = 8;
+
+  explicit CtrlGroup(const int8_t *ctrl) { std::memcpy(ctrl_, ctrl, kWidth); }
+
+  /// @brief Bit mask of the lanes holding the control byte c.
+  uint32_t Match(int8_t c) const {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kWidth; ++i) mask |= uint32_t(ctrl_[i] == c) << i;
+    return mask;
+  }
+
+ private:
+  int8_t ctrl_[kWidth];
+#endif
+};
+
+}  // namespace impl
+
+/// @brief The LocalFlatHashmap data structure.
+///
+/// LocalFlatHashmap is an open-addressing alternative to LocalHashmap with
+/// the same interface.  Keys and values are stored in flat arrays next to a
+/// separate array of one-byte control words that are probed a group at a
+/// time with SIMD comparisons, so a lookup usually touches one cache line
+/// of metadata and one slot.
+///
+/// The map is split in independent segments.  Each segment grows on its own
+/// (doubling its capacity, or purging tombstones) when it reaches a 7/8 load
+/// factor, so a resize only stalls the operations on the segment being
+/// resized while the rest of the map stays available.
+///
+/// @warning Pointers to values and iterators are invalidated when the
+/// segment holding them grows.
+/// @warning The functions passed to Apply, ForEachEntry and ForEachKey run
+/// while holding the segment; they must not access the same map.
+///
+/// @tparam KTYPE type of the hashmap keys.
+/// @tparam VTYPE type of the hashmap values.
+/// @tparam KEY_COMPARE key comparison function; default is MemCmp<KTYPE>.
+/// @tparam INSERTER default is Overwriter
+/// (i.e. insertions overwrite previous values
+///  associated to the same key, if any).
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE = MemCmp<KTYPE>,
+          typename INSERTER = Overwriter<VTYPE>>
+class LocalFlatHashmap {
+  template <typename, typename, typename, typename,
+            template <typename, typename, typename, typename> class, typename>
+  friend class Hashmap;
+  friend class lfmap_iterator<
+      LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>,
+      const std::pair<KTYPE, VTYPE>>;
+  template <typename, typename, typename>
+  friend class map_iterator;
+
+ public:
+  using value_type = std::pair<KTYPE, VTYPE>;
+  template <typename T>
+  using local_iterator_type =
+      lfmap_iterator<LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>, T>;
+  using iterator = local_iterator_type<const std::pair<KTYPE, VTYPE>>;
+  using const_iterator = local_iterator_type<const std::pair<KTYPE, VTYPE>>;
+
+  /// @brief Constructor.
+  /// @param numInitBuckets initial number of segments, each sized to hold
+  /// constants::kDefaultNumEntriesPerBucket entries before growing.
+  explicit LocalFlatHashmap(const size_t numInitBuckets)
+      : numBuckets_(std::max(numInitBuckets, size_t(1))),
+        segments_(new Segment[numBuckets_]),
+        size_(0) {
+    Clear();
+  }
+
+  /// @brief Size of the hashmap (number of entries).
+  /// @return the size of the hashmap.
+  size_t Size() const { return size_.load(); }
+
+  /// @brief Insert a key-value pair in the hashmap.
+  /// @param[in] key the key.
+  /// @param[in] value the value to copy into the hashMap.
+  /// @return an iterator to the inserted value
+  std::pair<iterator, bool> Insert(const KTYPE &key, const VTYPE &value) {
+    return InsertImpl(key, value,
+                      [this](VTYPE *const lhs, const VTYPE &rhs, bool same) {
+                        return InsertPolicy_(lhs, rhs, same);
+                      });
+  }
+
+  template <typename ELTYPE>
+  std::pair<iterator, bool> Insert(const KTYPE &key, const ELTYPE &value) {
+    return InsertImpl(key, value,
+                      [](VTYPE *const lhs, const ELTYPE &rhs, bool same) {
+                        return INSERTER::Insert(lhs, rhs, same);
+                      });
+  }
+
+  /// @brief Asynchronously Insert a key-value pair in the hashmap.
+  /// @warning Asynchronous operations are guaranteed to have completed
+  /// only after calling the rt::waitForCompletion(rt::Handle &handle) method.
+  /// @param[in,out] handle Reference to the handle
+  /// to be used to wait for completion.
+  /// @param[in] key the key.
+  /// @param[in] value the value to copy into the hashMap.
+  void AsyncInsert(rt::Handle &handle, const KTYPE &key, const VTYPE &value);
+
+  template <typename ELTYPE>
+  void AsyncInsert(rt::Handle &handle, const KTYPE &key, const ELTYPE &value);
+
+  /// @brief Insert a buffer of key-value pairs.
+  ///
+  /// The pairs are grouped by segment and each segment is entered once for
+  /// its whole group, unless it has to grow.  The pairs with the same key
+  /// are applied in the order of the buffer.
+  /// @tparam EntryT type of the pairs, with key and value members.
+  /// @param[in] entries the pairs.
+  /// @param[in] numEntries the number of pairs.
+  template <typename EntryT>
+  void InsertEntries(const EntryT *entries, size_t numEntries);
+
+  /// @brief Remove a key-value pair from the hashmap.
+  /// @param[in] key the key.
+  void Erase(const KTYPE &key);
+
+  /// @brief Asynchronously remove a key-value pair from the hashmap.
+  /// @warning Asynchronous operations are guaranteed to have completed.
+  /// only after calling the rt::waitForCompletion(rt::Handle &handle) method.
+  /// @param[in,out] handle Reference to the handle.
+  /// to be used to wait for completion.
+  /// @param[in] key the key.
+  void AsyncErase(rt::Handle &handle, const KTYPE &key);
+
+  /// @brief Clear the content of the hashmap.
+  void Clear() {
+    size_ = 0;
+    for (size_t i = 0; i < numBuckets_; ++i)
+      segments_[i].table.reset(new Table(kInitGroups));
+  }
+
+  /// @brief Get the value associated to a key.
+  /// @param[in] key the key.
+  /// @param[out] res the address where to store the value,
+  /// if the the key-value is found.
+  /// @return true if the entry is found, false otherwise.
+  bool Lookup(const KTYPE &key, VTYPE *res) {
+    const uint64_t hash = HashOf(key);
+    Segment &segment = segments_[SegmentOf(hash)];
+    ReadGuard _(segment);
+    Table *table = segment.table.get();
+    size_t idx = FindSlot(table, hash, key);
+    if (idx == kNotFound) return false;
+    *res = table->slots[idx].value;
+    return true;
+  }
+
+  /// @brief Get the value associated to a key.
+  /// @param[in] key the key.
+  /// @return a pointer to the value if the the key-value is found
+  ///         and nullptr if it does not exists.
+  VTYPE *Lookup(const KTYPE &key);
+
+  /// @brief Asynchronously get the value associated to a key.
+  /// @warning Asynchronous operations are guaranteed to have completed
+  /// only after calling the rt::waitForCompletion(rt::Handle &handle) method.
+  /// @param[in,out] handle Reference to the handle
+  /// to be used to wait for completion.
+  /// @param[in] key the key.
+  /// @param[out] res the address where to storethe pointer to the value
+  ///                 if the the key-value was found,
+  ///                 or a nullptr otherwise.
+  void AsyncLookup(rt::Handle &handle, const KTYPE &key, VTYPE **res);
+
+  /// @brief Result for the
+  /// Lookup(const KTYPE&, LookupResult*) and
+  /// AsyncLookup(rt::Handle&, const KTYPE&, LookupResult*) methods.
+  struct LookupResult {
+    /// True if the key has been found in the Hashmap
+    bool found;
+    /// The value associated with the key.
+    VTYPE value;
+  };
+
+  /// @brief Lookup method.
+  /// @param[in] key The key.
+  /// @param[out] res The result of the lookup operation.
+  void Lookup(const KTYPE &key, LookupResult *res) {
+    res->found = Lookup(key, &res->value);
+  }
+
+  /// @brief Asynchronous lookup method.
+  ///
+  /// @warning Asynchronous operations are guaranteed to have completed.  only
+  /// after calling the rt::waitForCompletion(rt::Handle &handle) method.
+  ///
+  /// @param[in,out] handle Reference to the handle.  to be used to wait for
+  /// completion.
+  /// @param[in] key The key.
+  /// @param[out] res The result of the lookup operation.
+  void AsyncLookup(rt::Handle &handle, const KTYPE &key, LookupResult *res);
+
+  /// @brief Apply a user-defined function to a key-value pair.
+  ///
+  /// @tparam ApplyFunT User-defined function type.  The function prototype
+  /// should be:
+  /// @code
+  /// void(const KTYPE&, VTYPE&, Args&);
+  /// @endcode
+  /// @tparam ...Args Types of the function arguments.
+  ///
+  /// @param[in] key The key.
+  /// @param function The function to apply.
+  /// @param args The function arguments.
+  template <typename ApplyFunT, typename... Args>
+  void Apply(const KTYPE &key, ApplyFunT &&function, Args &... args) {
+    const uint64_t hash = HashOf(key);
+    Segment &segment = segments_[SegmentOf(hash)];
+    ReadGuard _(segment);
+    Table *table = segment.table.get();
+    size_t idx = FindSlot(table, hash, key);
+    if (idx != kNotFound) function(key, table->slots[idx].value, args...);
+  }
+
+  /// @brief Asynchronously apply a user-defined function to a key-value pair.
+  ///
+  /// @tparam ApplyFunT User-defined function type.  The function prototype
+  /// should be:
+  /// @code
+  /// void(rt::Handle &handle, const KTYPE&, VTYPE&, Args&);
+  /// @endcode
+  /// @tparam ...Args Types of the function arguments.
+  ///
+  /// @param[in,out] handle Reference to the handle.
+  /// @param[in] key The key.
+  /// @param function The function to apply.
+  /// @param args The function arguments.
+  template <typename ApplyFunT, typename... Args>
+  void AsyncApply(rt::Handle &handle, const KTYPE &key, ApplyFunT &&function,
+                  Args &... args);
+
+  /// @brief Apply a user-defined function to each key-value pair.
+  ///
+  /// @tparam ApplyFunT User-defined function type.  The function prototype
+  /// should be:
+  /// @code
+  /// void(const KTYPE&, VTYPE&, Args&);
+  /// @endcode
+  /// @tparam ...Args Types of the function arguments.
+  ///
+  /// @param function The function to apply.
+  /// @param args The function arguments.
+  template <typename ApplyFunT, typename... Args>
+  void ForEachEntry(ApplyFunT &&function, Args &... args);
+
+  /// @brief Asynchronously apply a user-defined function to each key-value
+  /// pair.
+  ///
+  /// @tparam ApplyFunT User-defined function type.  The function prototype
+  /// should be:
+  /// @code
+  /// void(shad::rt::Handle&, const KTYPE&, VTYPE&, Args&);
+  /// @endcode
+  /// @tparam ...Args Types of the function arguments.
+  ///
+  /// @warning Asynchronous operations are guaranteed to have completed.  only
+  /// after calling the rt::waitForCompletion(rt::Handle &handle) method.
+  ///
+  /// @param[in,out] handle Reference to the handle.  to be used to wait for
+  /// completion.
+  /// @param function The function to apply.
+  /// @param args The function arguments.
+  template <typename ApplyFunT, typename... Args>
+  void AsyncForEachEntry(rt::Handle &handle, ApplyFunT &&function,
+                         Args &... args);
+
+  /// @brief Apply a user-defined function to each key.
+  /// @tparam ApplyFunT User-defined function type.
+  /// The function prototype should be:
+  /// @code
+  /// void(const KTYPE&, Args&);
+  /// @endcode
+  /// @tparam ...Args Types of the function arguments.
+  /// @param function The function to apply.
+  /// @param args The function arguments.
+  template <typename ApplyFunT, typename... Args>
+  void ForEachKey(ApplyFunT &&function, Args &... args);
+
+  /// @brief Asynchronously apply a user-defined function to each key.
+  /// @tparam ApplyFunT User-defined function type.
+  /// The function prototype should be:
+  /// @code
+  /// void(shad::rt::Handle&, const KTYPE&, Args&);
+  /// @endcode
+  /// @tparam ...Args Types of the function arguments.
+  /// @warning Asynchronous operations are guaranteed to have completed.
+  /// only after calling the rt::waitForCompletion(rt::Handle &handle) method.
+  /// @param[in,out] handle Reference to the handle.
+  /// to be used to wait for completion.
+  /// @param function The function to apply.
+  /// @param args The function arguments.
+  template <typename ApplyFunT, typename... Args>
+  void AsyncForEachKey(rt::Handle &handle, ApplyFunT &&function,
+                       Args &... args);
+
+  /// @brief Print all the entries in the hashmap.
+  /// @warning std::ostream & operator<< must be defined for both
+  /// KTYPE and VTYPE
+  void PrintAllEntries();
+
+  iterator begin() { return iterator::lmap_begin(this); }
+
+  iterator end() { return iterator::lmap_end(numBuckets_); }
+
+  const_iterator cbegin() { return const_iterator::lmap_begin(this); }
+
+  const_iterator cend() { return const_iterator::lmap_end(numBuckets_); }
+
+ private:
+  static constexpr size_t kGroupWidth = impl::CtrlGroup::kWidth;
+  // Smallest power of two number of groups that holds
+  // kDefaultNumEntriesPerBucket entries below the maximum load factor.
+  static constexpr size_t kInitGroups = [] {
+    size_t groups = 1;
+    while (groups * kGroupWidth * 7 / 8 <
+           constants::kDefaultNumEntriesPerBucket)
+      groups <<= 1;
+    return groups;
+  }();
+  static constexpr size_t kNotFound = ~size_t(0);
+  // Gate bit set by the thread growing a segment.  Readers and writers of the
+  // segment entries count themselves in the remaining bits.
+  static constexpr uint32_t kGrowing = 0x1;
+  static constexpr uint32_t kShare = 0x2;
+
+  typedef KEY_COMPARE KeyCompare;
+
+  struct Slot {
+    KTYPE key;
+    VTYPE value;
+  };
+
+  struct Table {
+    explicit Table(size_t numGroups)
+        : groupMask(numGroups - 1),
+          capacity(numGroups * kGroupWidth),
+          maxUsed(capacity - capacity / 8),
+          used(0),
+          ctrl(new int8_t[capacity]),
+          slots(new Slot[capacity]) {
+      std::memset(ctrl.get(), impl::kCtrlEmpty, capacity);
+    }
+
+    size_t groupMask;
+    size_t capacity;
+    // Full, deleted and claimed slots; the table must grow past maxUsed.
+    size_t maxUsed;
+    std::atomic<size_t> used;
+    std::unique_ptr<int8_t[]> ctrl;
+    std::unique_ptr<Slot[]> slots;
+  };
+
+  struct Segment {
+    std::atomic<uint32_t> gate{0};
+    std::unique_ptr<Table> table;
+  };
+
+  // Shared access to a segment: excludes only a concurrent growth.
+  class ReadGuard {
+   public:
+    explicit ReadGuard(Segment &segment) : segment_(segment) {
+      while (segment_.gate.fetch_add(kShare, std::memory_order_acquire) &
+             kGrowing) {
+        segment_.gate.fetch_sub(kShare, std::memory_order_relaxed);
+        while (segment_.gate.load(std::memory_order_relaxed) & kGrowing)
+          rt::impl::yield();
+      }
+    }
+    ~ReadGuard() { segment_.gate.fetch_sub(kShare, std::memory_order_release); }
+
+   private:
+    Segment &segment_;
+  };
+
+  INSERTER InsertPolicy_;
+  KeyCompare KeyComp_;
+  size_t numBuckets_;
+  std::unique_ptr<Segment[]> segments_;
+  std::atomic<size_t> size_;
+
+  static int8_t LoadCtrl(const int8_t *ctrl) {
+    return __atomic_load_n(ctrl, __ATOMIC_ACQUIRE);
+  }
+
+  static void StoreCtrl(int8_t *ctrl, int8_t value) {
+    __atomic_store_n(ctrl, value, __ATOMIC_RELEASE);
+  }
+
+  static bool LockCtrl(int8_t *ctrl, int8_t *expected) {
+    return __atomic_compare_exchange_n(ctrl, expected, int8_t(impl::kCtrlBusy),
+                                       false, __ATOMIC_ACQUIRE,
+                                       __ATOMIC_ACQUIRE);
+  }
+
+  // shad::hash is the identity for integral keys: mix it (murmur3 finalizer)
+  // so that both the segment and the in-table position see random bits.
+  static uint64_t HashOf(const KTYPE &key) {
+    return impl::Mix64(shad::hash<KTYPE>{}(key));
+  }
+
+  static int8_t H2(uint64_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+
+  static size_t FirstGroup(const Table *table, uint64_t hash) {
+    return (hash >> 7) & table->groupMask;
+  }
+
+  size_t SegmentOf(uint64_t hash) const {
+    return ((hash >> 32) * numBuckets_) >> 32;
+  }
+
+  size_t FindSlot(Table *table, uint64_t hash, const KTYPE &key);
+
+  template <typename ELTYPE, typename PolicyT>
+  bool TryInsert(Table *table, size_t segmentId, uint64_t hash,
+                 const KTYPE &key, const ELTYPE &value, PolicyT &policy,
+                 std::pair<iterator, bool> *res);
+
+  template <typename ELTYPE, typename PolicyT>
+  std::pair<iterator, bool> InsertImpl(const KTYPE &key, const ELTYPE &value,
+                                       PolicyT &&policy) {
+    const uint64_t hash = HashOf(key);
+    const size_t segmentId = SegmentOf(hash);
+    Segment &segment = segments_[segmentId];
+    std::pair<iterator, bool> res;
+    for (;;) {
+      Table *table;
+      {
+        ReadGuard _(segment);
+        table = segment.table.get();
+        if (TryInsert(table, segmentId, hash, key, value, policy, &res))
+          return res;
+      }
+      Grow(segment, table);
+    }
+  }
+
+  static void Grow(Segment &segment, const Table *observed);
+
+  template <typename ApplyFunT, typename... Args, std::size_t... is>
+  static void CallForEachEntryFun(
+      const size_t i,
+      LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER> *mapPtr,
+      ApplyFunT function, std::tuple<Args...> &args,
+      std::index_sequence<is...>) {
+    Segment &segment = mapPtr->segments_[i];
+    ReadGuard _(segment);
+    Table *table = segment.table.get();
+    for (size_t j = 0; j < table->capacity; ++j) {
+      int8_t ctrl;
+      while ((ctrl = LoadCtrl(&table->ctrl[j])) == impl::kCtrlBusy)
+        rt::impl::yield();
+      if (ctrl >= 0)
+        function(table->slots[j].key, table->slots[j].value,
+                 std::get<is>(args)...);
+    }
+  }
+
+  template <typename Tuple, typename... Args>
+  static void ForEachEntryFunWrapper(const Tuple &args, size_t i) {
+    constexpr auto Size = std::tuple_size<
+        typename std::decay<decltype(std::get<2>(args))>::type>::value;
+    Tuple &tuple = const_cast<Tuple &>(args);
+    CallForEachEntryFun(i, std::get<0>(tuple), std::get<1>(tuple),
+                        std::get<2>(tuple), std::make_index_sequence<Size>{});
+  }
+
+  template <typename ApplyFunT, typename... Args, std::size_t... is>
+  static void AsyncCallForEachEntryFun(
+      rt::Handle &handle, const size_t i,
+      LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER> *mapPtr,
+      ApplyFunT function, std::tuple<Args...> &args,
+      std::index_sequence<is...>) {
+    Segment &segment = mapPtr->segments_[i];
+    ReadGuard _(segment);
+    Table *table = segment.table.get();
+    for (size_t j = 0; j < table->capacity; ++j) {
+      int8_t ctrl;
+      while ((ctrl = LoadCtrl(&table->ctrl[j])) == impl::kCtrlBusy)
+        rt::impl::yield();
+      if (ctrl >= 0)
+        function(handle, table->slots[j].key, table->slots[j].value,
+                 std::get<is>(args)...);
+    }
+  }
+
+  template <typename Tuple, typename... Args>
+  static void AsyncForEachEntryFunWrapper(rt::Handle &handle, const Tuple &args,
+                                          size_t i) {
+    constexpr auto Size = std::tuple_size<
+        typename std::decay<decltype(std::get<2>(args))>::type>::value;
+    Tuple &tuple = const_cast<Tuple &>(args);
+    AsyncCallForEachEntryFun(handle, i, std::get<0>(tuple), std::get<1>(tuple),
+                             std::get<2>(tuple),
+                             std::make_index_sequence<Size>{});
+  }
+
+  template <typename ApplyFunT, typename... Args, std::size_t... is>
+  static void CallForEachKeyFun(
+      const size_t i,
+      LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER> *mapPtr,
+      ApplyFunT function, std::tuple<Args...> &args,
+      std::index_sequence<is...>) {
+    Segment &segment = mapPtr->segments_[i];
+    ReadGuard _(segment);
+    Table *table = segment.table.get();
+    for (size_t j = 0; j < table->capacity; ++j) {
+      int8_t ctrl;
+      while ((ctrl = LoadCtrl(&table->ctrl[j])) == impl::kCtrlBusy)
+        rt::impl::yield();
+      if (ctrl >= 0) function(table->slots[j].key, std::get<is>(args)...);
+    }
+  }
+
+  template <typename Tuple, typename... Args>
+  static void ForEachKeyFunWrapper(const Tuple &args, size_t i) {
+    constexpr auto Size = std::tuple_size<
+        typename std::decay<decltype(std::get<2>(args))>::type>::value;
+    Tuple &tuple = const_cast<Tuple &>(args);
+    CallForEachKeyFun(i, std::get<0>(tuple), std::get<1>(tuple),
+                      std::get<2>(tuple), std::make_index_sequence<Size>{});
+  }
+
+  template <typename ApplyFunT, typename... Args, std::size_t... is>
+  static void AsyncCallForEachKeyFun(
+      rt::Handle &handle, const size_t i,
+      LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER> *mapPtr,
+      ApplyFunT function, std::tuple<Args...> &args,
+      std::index_sequence<is...>) {
+    Segment &segment = mapPtr->segments_[i];
+    ReadGuard _(segment);
+    Table *table = segment.table.get();
+    for (size_t j = 0; j < table->capacity; ++j) {
+      int8_t ctrl;
+      while ((ctrl = LoadCtrl(&table->ctrl[j])) == impl::kCtrlBusy)
+        rt::impl::yield();
+      if (ctrl >= 0)
+        function(handle, table->slots[j].key, std::get<is>(args)...);
+    }
+  }
+
+  template <typename Tuple, typename... Args>
+  static void AsyncForEachKeyFunWrapper(rt::Handle &handle, const Tuple &args,
+                                        size_t i) {
+    constexpr auto Size = std::tuple_size<
+        typename std::decay<decltype(std::get<2>(args))>::type>::value;
+    Tuple &tuple = const_cast<Tuple &>(args);
+    AsyncCallForEachKeyFun(handle, i, std::get<0>(tuple), std::get<1>(tuple),
+                           std::get<2>(tuple),
+                           std::make_index_sequence<Size>{});
+  }
+
+  template <typename ApplyFunT, typename... Args, std::size_t... is>
+  static void AsyncCallApplyFun(
+      rt::Handle &handle,
+      LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER> *mapPtr,
+      const KTYPE &key, ApplyFunT function, std::tuple<Args...> &args,
+      std::index_sequence<is...>) {
+    const uint64_t hash = HashOf(key);
+    Segment &segment = mapPtr->segments_[mapPtr->SegmentOf(hash)];
+    ReadGuard _(segment);
+    Table *table = segment.table.get();
+    size_t idx = mapPtr->FindSlot(table, hash, key);
+    if (idx != kNotFound)
+      function(handle, key, table->slots[idx].value, std::get<is>(args)...);
+  }
+
+  template <typename ApplyFunT, typename... Args, std::size_t... is>
+  static void CallApplyFun(
+      LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER> *mapPtr,
+      const KTYPE &key, ApplyFunT function, std::tuple<Args...> &args,
+      std::index_sequence<is...>) {
+    const uint64_t hash = HashOf(key);
+    Segment &segment = mapPtr->segments_[mapPtr->SegmentOf(hash)];
+    ReadGuard _(segment);
+    Table *table = segment.table.get();
+    size_t idx = mapPtr->FindSlot(table, hash, key);
+    if (idx != kNotFound)
+      function(key, table->slots[idx].value, std::get<is>(args)...);
+  }
+
+  template <typename Tuple, typename... Args>
+  static void AsyncApplyFunWrapper(rt::Handle &handle, const Tuple &args) {
+    constexpr auto Size = std::tuple_size<
+        typename std::decay<decltype(std::get<3>(args))>::type>::value;
+    Tuple &tuple = const_cast<Tuple &>(args);
+    AsyncCallApplyFun(handle, std::get<0>(tuple), std::get<1>(tuple),
+                      std::get<2>(tuple), std::get<3>(tuple),
+                      std::make_index_sequence<Size>{});
+  }
+};
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+size_t LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::FindSlot(
+    Table *table, uint64_t hash, const KTYPE &key) {
+  const int8_t h2 = H2(hash);
+  size_t group = FirstGroup(table, hash);
+  // Triangular probing visits every group of a power of two table.
+  for (size_t step = 1;; group = (group + step++) & table->groupMask) {
+    int8_t *ctrl = &table->ctrl[group * kGroupWidth];
+    impl::CtrlGroup g(ctrl);
+    uint32_t mask =
+        g.Match(h2) | g.Match(impl::kCtrlBusy) | g.Match(impl::kCtrlEmpty);
+    for (; mask != 0; mask &= mask - 1) {
+      size_t lane = __builtin_ctz(mask);
+      int8_t state;
+      // Yield on pending entries.
+      while ((state = LoadCtrl(&ctrl[lane])) == impl::kCtrlBusy)
+        rt::impl::yield();
+
+      // Stop at the first empty entry.
+      if (state == impl::kCtrlEmpty) return kNotFound;
+
+      size_t idx = group * kGroupWidth + lane;
+      if (state == h2 && KeyComp_(&table->slots[idx].key, &key) == 0)
+        return idx;
+    }
+  }
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+template <typename ELTYPE, typename PolicyT>
+bool LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::TryInsert(
+    Table *table, size_t segmentId, uint64_t hash, const KTYPE &key,
+    const ELTYPE &value, PolicyT &policy, std::pair<iterator, bool> *res) {
+  const int8_t h2 = H2(hash);
+  size_t group = FirstGroup(table, hash);
+  for (size_t step = 1;; group = (group + step++) & table->groupMask) {
+    int8_t *ctrl = &table->ctrl[group * kGroupWidth];
+    impl::CtrlGroup g(ctrl);
+    uint32_t mask =
+        g.Match(h2) | g.Match(impl::kCtrlBusy) | g.Match(impl::kCtrlEmpty);
+    // Lanes are visited in probing order and empty slots are claimed only
+    // when all the slots before them have been checked: concurrent inserts of
+    // the same key race for the same slot and the loser updates it.
+    for (; mask != 0; mask &= mask - 1) {
+      size_t lane = __builtin_ctz(mask);
+      size_t idx = group * kGroupWidth + lane;
+      Slot &slot = table->slots[idx];
+      int8_t state = LoadCtrl(&ctrl[lane]);
+      for (;;) {
+        if (state == impl::kCtrlBusy) {
+          rt::impl::yield();
+          state = LoadCtrl(&ctrl[lane]);
+        } else if (state == impl::kCtrlEmpty) {
+          if (table->used.fetch_add(1, std::memory_order_relaxed) >=
+              table->maxUsed) {
+            table->used.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+          }
+          if (LockCtrl(&ctrl[lane], &state)) {
+            // First time insertion.
+            slot.key = key;
+            bool inserted = policy(&slot.value, value, false);
+            size_ += 1;
+            StoreCtrl(&ctrl[lane], h2);
+            *res = std::make_pair(iterator(this, segmentId, idx), inserted);
+            return true;
+          }
+          table->used.fetch_sub(1, std::memory_order_relaxed);
+        } else if (state == h2 && KeyComp_(&slot.key, &key) == 0) {
+          // Update of an existing entry.
+          if (LockCtrl(&ctrl[lane], &state)) {
+            bool inserted = policy(&slot.value, value, true);
+            StoreCtrl(&ctrl[lane], h2);
+            *res = std::make_pair(iterator(this, segmentId, idx), inserted);
+            return true;
+          }
+        } else {
+          break;
+        }
+      }
+    }
+  }
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+template <typename EntryT>
+void LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::InsertEntries(
+    const EntryT *entries, size_t numEntries) {
+  std::vector<uint64_t> hashes(numEntries);
+  std::vector<size_t> order(numEntries);
+  for (size_t i = 0; i < numEntries; ++i) {
+    hashes[i] = HashOf(entries[i].key);
+    order[i] = i;
+  }
+  // The stable sort keeps the pairs of a key in the order of the buffer.
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return SegmentOf(hashes[a]) < SegmentOf(hashes[b]);
+  });
+
+  auto policy = [this](VTYPE *const lhs, const VTYPE &rhs, bool same) {
+    return InsertPolicy_(lhs, rhs, same);
+  };
+  std::pair<iterator, bool> res;
+  for (size_t first = 0; first < numEntries;) {
+    const size_t segmentId = SegmentOf(hashes[order[first]]);
+    Segment &segment = segments_[segmentId];
+    Table *table;
+    bool full = false;
+    {
+      ReadGuard _(segment);
+      table = segment.table.get();
+      for (; first < numEntries && SegmentOf(hashes[order[first]]) == segmentId;
+           ++first) {
+        const EntryT &entry = entries[order[first]];
+        if (!TryInsert(table, segmentId, hashes[order[first]], entry.key,
+                       entry.value, policy, &res)) {
+          full = true;
+          break;
+        }
+      }
+    }
+    if (full) Grow(segment, table);
+  }
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+void LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::Grow(
+    Segment &segment, const Table *observed) {
+  if (segment.gate.fetch_or(kGrowing, std::memory_order_acquire) & kGrowing) {
+    // Another thread is growing the segment.
+    while (segment.gate.load(std::memory_order_acquire) & kGrowing)
+      rt::impl::yield();
+    return;
+  }
+  while (segment.gate.load(std::memory_order_acquire) != kGrowing)
+    rt::impl::yield();
+
+  if (segment.table.get() == observed) {
+    Table *table = segment.table.get();
+    size_t live = 0;
+    for (size_t i = 0; i < table->capacity; ++i) live += table->ctrl[i] >= 0;
+
+    // Double the table unless most of the used slots are tombstones.
+    size_t numGroups = table->groupMask + 1;
+    if (live >= table->maxUsed / 2) numGroups <<= 1;
+
+    std::unique_ptr<Table> grown(new Table(numGroups));
+    for (size_t i = 0; i < table->capacity; ++i) {
+      if (table->ctrl[i] < 0) continue;
+      Slot &slot = table->slots[i];
+      const uint64_t hash = HashOf(slot.key);
+      size_t group = FirstGroup(grown.get(), hash);
+      for (size_t step = 1;; group = (group + step++) & grown->groupMask) {
+        int8_t *ctrl = &grown->ctrl[group * kGroupWidth];
+        uint32_t mask = impl::CtrlGroup(ctrl).Match(impl::kCtrlEmpty);
+        if (mask != 0) {
+          size_t lane = __builtin_ctz(mask);
+          ctrl[lane] = H2(hash);
+          grown->slots[group * kGroupWidth + lane] = std::move(slot);
+          break;
+        }
+      }
+    }
+    grown->used = live;
+    segment.table = std::move(grown);
+  }
+  segment.gate.fetch_and(~kGrowing, std::memory_order_release);
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+VTYPE *LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::Lookup(
+    const KTYPE &key) {
+  const uint64_t hash = HashOf(key);
+  Segment &segment = segments_[SegmentOf(hash)];
+  ReadGuard _(segment);
+  Table *table = segment.table.get();
+  size_t idx = FindSlot(table, hash, key);
+  return idx == kNotFound ? nullptr : &table->slots[idx].value;
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+void LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::Erase(
+    const KTYPE &key) {
+  const uint64_t hash = HashOf(key);
+  const int8_t h2 = H2(hash);
+  Segment &segment = segments_[SegmentOf(hash)];
+  ReadGuard _(segment);
+  Table *table = segment.table.get();
+  size_t group = FirstGroup(table, hash);
+  for (size_t step = 1;; group = (group + step++) & table->groupMask) {
+    int8_t *ctrl = &table->ctrl[group * kGroupWidth];
+    impl::CtrlGroup g(ctrl);
+    uint32_t mask =
+        g.Match(h2) | g.Match(impl::kCtrlBusy) | g.Match(impl::kCtrlEmpty);
+    for (; mask != 0; mask &= mask - 1) {
+      size_t lane = __builtin_ctz(mask);
+      Slot &slot = table->slots[group * kGroupWidth + lane];
+      int8_t state = LoadCtrl(&ctrl[lane]);
+      for (;;) {
+        if (state == impl::kCtrlBusy) {
+          rt::impl::yield();
+          state = LoadCtrl(&ctrl[lane]);
+        } else if (state == impl::kCtrlEmpty) {
+          // Key not found.
+          return;
+        } else if (state == h2 && KeyComp_(&slot.key, &key) == 0) {
+          if (LockCtrl(&ctrl[lane], &state)) {
+            // Deleted slots are reclaimed only when the segment grows.
+            slot = Slot();
+            size_--;
+            StoreCtrl(&ctrl[lane], impl::kCtrlDeleted);
+            return;
+          }
+        } else {
+          break;
+        }
+      }
+    }
+  }
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+void LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::PrintAllEntries() {
+  for (size_t segmentIdx = 0; segmentIdx < numBuckets_; segmentIdx++) {
+    Table *table = segments_[segmentIdx].table.get();
+    std::cout << "Bucket: " << segmentIdx << std::endl;
+    for (size_t i = 0; i < table->capacity; ++i) {
+      if (table->ctrl[i] < 0) continue;
+      std::cout << i << ": [" << table->slots[i].key << "] ["
+                << table->slots[i].value << "]\n";
+    }
+  }
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+void LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::AsyncErase(
+    rt::Handle &handle, const KTYPE &key) {
+  using LMapPtr = LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER> *;
+  auto args = std::tuple<LMapPtr, KTYPE>(this, key);
+  auto eraseLambda = [](rt::Handle &, const std::tuple<LMapPtr, KTYPE> &t) {
+    (std::get<0>(t))->Erase(std::get<1>(t));
+  };
+  rt::asyncExecuteAt(handle, rt::thisLocality(), eraseLambda, args);
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+void LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::AsyncInsert(
+    rt::Handle &handle, const KTYPE &key, const VTYPE &value) {
+  using LMapPtr = LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER> *;
+  auto args = std::tuple<LMapPtr, KTYPE, VTYPE>(this, key, value);
+  auto insertLambda = [](rt::Handle &,
+                         const std::tuple<LMapPtr, KTYPE, VTYPE> &t) {
+    (std::get<0>(t))->Insert(std::get<1>(t), std::get<2>(t));
+  };
+  rt::asyncExecuteAt(handle, rt::thisLocality(), insertLambda, args);
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+template <typename ELTYPE>
+void LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::AsyncInsert(
+    rt::Handle &handle, const KTYPE &key, const ELTYPE &value) {
+  using LMapPtr = LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER> *;
+  auto args = std::tuple<LMapPtr, KTYPE, ELTYPE>(this, key, value);
+  auto insertLambda = [](rt::Handle &,
+                         const std::tuple<LMapPtr, KTYPE, ELTYPE> &t) {
+    (std::get<0>(t))->Insert(std::get<1>(t), std::get<2>(t));
+  };
+  rt::asyncExecuteAt(handle, rt::thisLocality(), insertLambda, args);
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+void LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::AsyncLookup(
+    rt::Handle &handle, const KTYPE &key, VTYPE **result) {
+  using LMapPtr = LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER> *;
+  auto args = std::tuple<LMapPtr, KTYPE, VTYPE **>(this, key, result);
+  auto lookupLambda = [](rt::Handle &,
+                         const std::tuple<LMapPtr, KTYPE, VTYPE **> &t) {
+    *std::get<2>(t) = (std::get<0>(t))->Lookup(std::get<1>(t));
+  };
+  rt::asyncExecuteAt(handle, rt::thisLocality(), lookupLambda, args);
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+void LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::AsyncLookup(
+    rt::Handle &handle, const KTYPE &key, LookupResult *result) {
+  using LMapPtr = LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER> *;
+  auto args = std::tuple<LMapPtr, KTYPE, LookupResult *>(this, key, result);
+  auto lookupLambda = [](rt::Handle &,
+                         const std::tuple<LMapPtr, KTYPE, LookupResult *> &t) {
+    (std::get<0>(t))->Lookup(std::get<1>(t), std::get<2>(t));
+  };
+  rt::asyncExecuteAt(handle, rt::thisLocality(), lookupLambda, args);
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+template <typename ApplyFunT, typename... Args>
+void LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::ForEachEntry(
+    ApplyFunT &&function, Args &... args) {
+  using FunctionTy = void (*)(const KTYPE &, VTYPE &, Args &...);
+  FunctionTy fn = std::forward<decltype(function)>(function);
+  using LMapPtr = LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER> *;
+  using ArgsTuple = std::tuple<LMapPtr, FunctionTy, std::tuple<Args...>>;
+  ArgsTuple argsTuple(this, fn, std::tuple<Args...>(args...));
+  rt::forEachAt(rt::thisLocality(), ForEachEntryFunWrapper<ArgsTuple, Args...>,
+                argsTuple, numBuckets_);
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+template <typename ApplyFunT, typename... Args>
+void LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::AsyncForEachEntry(
+    rt::Handle &handle, ApplyFunT &&function, Args &... args) {
+  using FunctionTy = void (*)(rt::Handle &, const KTYPE &, VTYPE &, Args &...);
+  FunctionTy fn = std::forward<decltype(function)>(function);
+  using LMapPtr = LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER> *;
+  using ArgsTuple = std::tuple<LMapPtr, FunctionTy, std::tuple<Args...>>;
+  ArgsTuple argsTuple(this, fn, std::tuple<Args...>(args...));
+  rt::asyncForEachAt(handle, rt::thisLocality(),
+                     AsyncForEachEntryFunWrapper<ArgsTuple, Args...>, argsTuple,
+                     numBuckets_);
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+template <typename ApplyFunT, typename... Args>
+void LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::ForEachKey(
+    ApplyFunT &&function, Args &... args) {
+  using FunctionTy = void (*)(const KTYPE &, Args &...);
+  FunctionTy fn = std::forward<decltype(function)>(function);
+  using LMapPtr = LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER> *;
+  using ArgsTuple = std::tuple<LMapPtr, FunctionTy, std::tuple<Args...>>;
+  ArgsTuple argsTuple(this, fn, std::tuple<Args...>(args...));
+  rt::forEachAt(rt::thisLocality(), ForEachKeyFunWrapper<ArgsTuple, Args...>,
+                argsTuple, numBuckets_);
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+template <typename ApplyFunT, typename... Args>
+void LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::AsyncForEachKey(
+    rt::Handle &handle, ApplyFunT &&function, Args &... args) {
+  using FunctionTy = void (*)(rt::Handle &, const KTYPE &, Args &...);
+  FunctionTy fn = std::forward<decltype(function)>(function);
+  using LMapPtr = LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER> *;
+  using ArgsTuple = std::tuple<LMapPtr, FunctionTy, std::tuple<Args...>>;
+  ArgsTuple argsTuple(this, fn, std::tuple<Args...>(args...));
+  rt::asyncForEachAt(handle, rt::thisLocality(),
+                     AsyncForEachKeyFunWrapper<ArgsTuple, Args...>, argsTuple,
+                     numBuckets_);
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+template <typename ApplyFunT, typename... Args>
+void LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::AsyncApply(
+    rt::Handle &handle, const KTYPE &key, ApplyFunT &&function,
+    Args &... args) {
+  using FunctionTy = void (*)(rt::Handle &, const KTYPE &, VTYPE &, Args &...);
+  FunctionTy fn = std::forward<decltype(function)>(function);
+  using LMapPtr = LocalFlatHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER> *;
+  using ArgsTuple =
+      std::tuple<LMapPtr, const KTYPE, FunctionTy, std::tuple<Args...>>;
+
+  ArgsTuple argsTuple(this, key, fn, std::tuple<Args...>(args...));
+  rt::asyncExecuteAt(handle, rt::thisLocality(),
+                     AsyncApplyFunWrapper<ArgsTuple, Args...>, argsTuple);
+}
+
+template <typename LMap, typename T>
+class lfmap_iterator : public std::iterator<std::forward_iterator_tag, T> {
+ public:
+  using value_type = T;
+
+  lfmap_iterator() {}
+  lfmap_iterator(const LMap *mapPtr, size_t segment, size_t slot)
+      : mapPtr_(mapPtr), segment_(segment), slot_(slot) {}
+
+  static lfmap_iterator lmap_begin(const LMap *mapPtr) {
+    lfmap_iterator beg(mapPtr, 0, 0);
+    beg.seek_used();
+    return beg;
+  }
+
+  static lfmap_iterator lmap_end(const LMap *mapPtr) {
+    return lmap_end(mapPtr->numBuckets_);
+  }
+
+  static lfmap_iterator lmap_end(size_t numBuckets) {
+    return lfmap_iterator(nullptr, numBuckets, 0);
+  }
+
+  bool operator==(const lfmap_iterator &other) const {
+    return segment_ == other.segment_ && slot_ == other.slot_;
+  }
+  bool operator!=(const lfmap_iterator &other) const {
+    return !(*this == other);
+  }
+
+  T operator*() const {
+    auto &slot = mapPtr_->segments_[segment_].table->slots[slot_];
+    return T(slot.key, slot.value);
+  }
+
+  lfmap_iterator &operator++() {
+    ++slot_;
+    seek_used();
+    return *this;
+  }
+  lfmap_iterator operator++(int) {
+    lfmap_iterator tmp = *this;
+    operator++();
+    return tmp;
+  }
+
+  class partition_range {
+   public:
+    partition_range(const lfmap_iterator &begin, const lfmap_iterator &end)
+        : begin_(begin), end_(end) {}
+    lfmap_iterator begin() { return begin_; }
+    lfmap_iterator end() { return end_; }
+
+   private:
+    lfmap_iterator begin_;
+    lfmap_iterator end_;
+  };
+
+  // split a range into at most n_parts non-empty sub-ranges
+  static std::vector<partition_range> partitions(lfmap_iterator begin,
+                                                 lfmap_iterator end,
+                                                 size_t n_parts) {
+    std::vector<partition_range> res;
+    if (begin == end || n_parts == 0) return res;
+
+    auto map_ptr = begin.mapPtr_;
+    auto s_end = std::min(end.segment_ + 1, map_ptr->numBuckets_);
+    auto n_segments = s_end - begin.segment_;
+    auto part_step = (n_segments + n_parts - 1) / n_parts;
+    auto pbegin = begin;
+    for (auto si = begin.segment_ + part_step; si < s_end; si += part_step) {
+      lfmap_iterator pend(map_ptr, si, 0);
+      pend.seek_used();
+      if (!pend.precedes(end)) break;
+      if (pend != pbegin) {
+        res.push_back(partition_range{pbegin, pend});
+        pbegin = pend;
+      }
+    }
+    res.push_back(partition_range{pbegin, end});
+    return res;
+  }
+
+ private:
+  const LMap *mapPtr_;
+  size_t segment_;
+  size_t slot_;
+
+  bool precedes(const lfmap_iterator &other) const {
+    return segment_ < other.segment_ ||
+           (segment_ == other.segment_ && slot_ < other.slot_);
+  }
+
+  // move to the first used slot from the current position (included), or to
+  // the end iterator if there is none.
+  void seek_used() {
+    for (; segment_ < mapPtr_->numBuckets_; ++segment_, slot_ = 0) {
+      auto table = mapPtr_->segments_[segment_].table.get();
+      for (; slot_ < table->capacity; ++slot_)
+        if (table->ctrl[slot_] >= 0) return;
+    }
+    *this = lmap_end(mapPtr_->numBuckets_);
+  }
+};
+
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_DATA_STRUCTURES_LOCAL_FLAT_HASHMAP_H_
@@ -89,7 +89,8 @@ struct Updater {
 template <typename KTYPE, typename VTYPE, typename KEY_COMPARE = MemCmp<KTYPE>,
           typename INSERTER = Overwriter<VTYPE>>
 class LocalHashmap {
-  template <typename, typename, typename, typename>
+  template <typename, typename, typename, typename,
+            template <typename, typename, typename, typename> class, typename>
   friend class Hashmap;
   friend class lmap_iterator<LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>,
                              const std::pair<KTYPE, VTYPE>>;
@@ -100,6 +101,9 @@ class LocalHashmap {
 
  public:
   using value_type = std::pair<KTYPE, VTYPE>;
+  template <typename T>
+  using local_iterator_type =
+      lmap_iterator<LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>, T>;
   using iterator =
       lmap_iterator<LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>,
                     const std::pair<KTYPE, VTYPE>>;
@@ -137,6 +141,18 @@ class LocalHashmap {
 
   template <typename ELTYPE>
   void AsyncInsert(rt::Handle &handle, const KTYPE &key, const ELTYPE &value);
+
+  /// @brief Insert a buffer of key-value pairs.
+  ///
+  /// The pairs are grouped by bucket and the chain of each bucket is walked
+  /// once for its whole group.  The pairs with the same key are applied in
+  /// the order of the buffer.
+  /// @tparam EntryT type of the pairs, with key and value members.
+  /// @param[in] entries the pairs.
+  /// @param[in] numEntries the number of pairs.
+  template <typename EntryT>
+  void InsertEntries(const EntryT *entries, size_t numEntries);
+
   /// @brief Remove a key-value pair from the hashmap.
   /// @param[in] key the key.
   void Erase(const KTYPE &key);
@@ -385,6 +401,10 @@ class LocalHashmap {
 
     size_t BucketSize() const { return bucketSize_; }
 
+    // Serializes the Erase operations on the chain headed by this Bucket:
+    // an Erase moves entries backward and a concurrent one could miss them.
+    rt::Lock eraseLock;
+
    private:
     size_t bucketSize_;
     std::shared_ptr<Entry> entries;
@@ -397,6 +417,16 @@ class LocalHashmap {
   std::vector<Bucket> buckets_array_;
   std::atomic<size_t> size_;
 
+  void EraseImpl(const KTYPE &key);
+
+  template <typename EntryT>
+  void InsertInChain(size_t bucketIdx, const EntryT *entries,
+                     std::vector<size_t> *pending);
+
+  template <typename EntryT>
+  void UpdateEntry(Entry *entry, const EntryT *entries,
+                   std::vector<size_t> *pending);
+
   template <typename ApplyFunT, typename... Args, std::size_t... is>
   static void CallForEachEntryFun(
       const size_t i, LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER> *mapPtr,
@@ -540,7 +570,8 @@ class LocalHashmap {
       LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER> *mapPtr,
       const KTYPE &key, ApplyFunT function, std::tuple<Args...> &args,
       std::index_sequence<is...>) {
-    size_t bucketIdx = shad::hash<KTYPE>{}(key) % mapPtr->numBuckets_;
+    size_t bucketIdx =
+        impl::BucketOf(shad::hash<KTYPE>{}(key), mapPtr->numBuckets_);
     Bucket *bucket = &(mapPtr->buckets_array_[bucketIdx]);
 
     while (bucket != nullptr) {
@@ -572,7 +603,8 @@ class LocalHashmap {
       LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER> *mapPtr,
       const KTYPE &key, ApplyFunT function, std::tuple<Args...> &args,
       std::index_sequence<is...>) {
-    size_t bucketIdx = shad::hash<KTYPE>{}(key) % mapPtr->numBuckets_;
+    size_t bucketIdx =
+        impl::BucketOf(shad::hash<KTYPE>{}(key), mapPtr->numBuckets_);
     Bucket *bucket = &(mapPtr->buckets_array_[bucketIdx]);
 
     while (bucket != nullptr) {
@@ -614,7 +646,7 @@ template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
           typename INSERTER>
 VTYPE *LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::Lookup(
     const KTYPE &key) {
-  size_t bucketIdx = shad::hash<KTYPE>{}(key) % numBuckets_;
+  size_t bucketIdx = impl::BucketOf(shad::hash<KTYPE>{}(key), numBuckets_);
   Bucket *bucket = &(buckets_array_[bucketIdx]);
 
   VTYPE *result = nullptr;
@@ -670,7 +702,17 @@ template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
           typename INSERTER>
 void LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::Erase(
     const KTYPE &key) {
-  size_t bucketIdx = shad::hash<KTYPE>{}(key) % numBuckets_;
+  size_t bucketIdx = impl::BucketOf(shad::hash<KTYPE>{}(key), numBuckets_);
+  Bucket *bucket = &(buckets_array_[bucketIdx]);
+  std::lock_guard<rt::Lock> _(bucket->eraseLock);
+  EraseImpl(key);
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+void LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::EraseImpl(
+    const KTYPE &key) {
+  size_t bucketIdx = impl::BucketOf(shad::hash<KTYPE>{}(key), numBuckets_);
   Bucket *bucket = &(buckets_array_[bucketIdx]);
   Entry *prevEntry = nullptr;
   Entry *toDelete = nullptr;
@@ -704,7 +746,7 @@ void LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::Erase(
         if (!__sync_bool_compare_and_swap(&entry->state, USED,
                                           PENDING_INSERT)) {
           // entry has already been deleted by another operation
-          Erase(key);
+          EraseImpl(key);
           return;
         }
         // 3. The entry to remove has been found,
@@ -739,7 +781,7 @@ void LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::Erase(
                 lastEntry->state = EMPTY;
                 toDelete->state = USED;
                 size_++;
-                Erase(key);
+                EraseImpl(key);
                 return;
               }
               // now prevEntry is locked
@@ -756,7 +798,7 @@ void LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::Erase(
               if (lastEntry->state == PENDING_INSERT) {
                 toDelete->state = USED;
                 size_++;
-                Erase(key);
+                EraseImpl(key);
                 return;
               }
             }
@@ -778,7 +820,7 @@ void LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::Erase(
                                               PENDING_INSERT)) {
               toDelete->state = USED;
               size_++;
-              Erase(key);
+              EraseImpl(key);
               return;
             }
             if (lastEntry == prevEntry) {
@@ -848,7 +890,7 @@ std::pair<typename LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::iterator,
           bool>
 LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::Insert(const KTYPE &key,
                                                           const VTYPE &value) {
-  size_t bucketIdx = shad::hash<KTYPE>{}(key) % numBuckets_;
+  size_t bucketIdx = impl::BucketOf(shad::hash<KTYPE>{}(key), numBuckets_);
   Bucket *bucket = &(buckets_array_[bucketIdx]);
 
   // Forever or until we find an insertion point.
@@ -1021,7 +1063,7 @@ std::pair<typename LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::iterator,
           bool>
 LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::Insert(const KTYPE &key,
                                                           const ELTYPE &value) {
-  size_t bucketIdx = shad::hash<KTYPE>{}(key) % numBuckets_;
+  size_t bucketIdx = impl::BucketOf(shad::hash<KTYPE>{}(key), numBuckets_);
   Bucket *bucket = &(buckets_array_[bucketIdx]);
 
   // Forever or until we find an insertion point.
@@ -1085,6 +1127,109 @@ void LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::AsyncInsert(
   rt::asyncExecuteAt(handle, rt::thisLocality(), insertLambda, args);
 }
 
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+template <typename EntryT>
+void LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::InsertEntries(
+    const EntryT *entries, size_t numEntries) {
+  std::vector<size_t> buckets(numEntries);
+  std::vector<size_t> order(numEntries);
+  for (size_t i = 0; i < numEntries; ++i) {
+    buckets[i] =
+        impl::BucketOf(shad::hash<KTYPE>{}(entries[i].key), numBuckets_);
+    order[i] = i;
+  }
+  // The stable sort keeps the pairs of a key in the order of the buffer.
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return buckets[a] < buckets[b];
+  });
+
+  std::vector<size_t> pending;
+  for (size_t first = 0; first < numEntries;) {
+    size_t bucketIdx = buckets[order[first]];
+    for (; first < numEntries && buckets[order[first]] == bucketIdx; ++first)
+      pending.push_back(order[first]);
+    InsertInChain(bucketIdx, entries, &pending);
+  }
+}
+
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+template <typename EntryT>
+void LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::InsertInChain(
+    size_t bucketIdx, const EntryT *entries, std::vector<size_t> *pending) {
+  Bucket *bucket = &(buckets_array_[bucketIdx]);
+
+  // Forever or until all the pending pairs are inserted.
+  for (;;) {
+    for (size_t i = 0; i < bucket->BucketSize(); ++i) {
+      Entry *entry = &bucket->getEntry(i);
+
+      if (__sync_bool_compare_and_swap(&entry->state, EMPTY, PENDING_INSERT)) {
+        // First time insertion of the first pending key.
+        const EntryT &head = entries[pending->front()];
+        entry->key = head.key;
+        InsertPolicy_(&entry->value, head.value, false);
+        size_ += 1;
+        pending->erase(pending->begin());
+        UpdateEntry(entry, entries, pending);
+        entry->state = USED;
+      } else {
+        // Update of an existing entry
+        while (entry->state == PENDING_INSERT) rt::impl::yield();
+
+        bool found = false;
+        for (size_t p : *pending) {
+          if (KeyComp_(&entry->key, &entries[p].key) == 0) {
+            found = true;
+            break;
+          }
+        }
+        if (!found) continue;
+
+        while (!__sync_bool_compare_and_swap(&entry->state, USED,
+                                             PENDING_UPDATE))
+          rt::impl::yield();
+        UpdateEntry(entry, entries, pending);
+        entry->state = USED;
+      }
+      if (pending->empty()) return;
+    }
+
+    if (bucket->next == nullptr) {
+      // We need to allocate a new buffer
+      if (__sync_bool_compare_and_swap(&bucket->isNextAllocated, false, true)) {
+        // Allocate the bucket
+        std::shared_ptr<Bucket> newBucket(
+            new Bucket(constants::kDefaultNumEntriesPerBucket));
+        bucket->next.swap(newBucket);
+      } else {
+        // Wait for the allocation to happen
+        while (bucket->next == nullptr) rt::impl::yield();
+      }
+    }
+
+    bucket = bucket->next.get();
+  }
+}
+
+// Applies to the entry the pending pairs with its key and drops them from
+// the pending ones.  The caller holds the entry.
+template <typename KTYPE, typename VTYPE, typename KEY_COMPARE,
+          typename INSERTER>
+template <typename EntryT>
+void LocalHashmap<KTYPE, VTYPE, KEY_COMPARE, INSERTER>::UpdateEntry(
+    Entry *entry, const EntryT *entries, std::vector<size_t> *pending) {
+  size_t numKept = 0;
+  for (size_t p : *pending) {
+    if (KeyComp_(&entry->key, &entries[p].key) == 0)
+      InsertPolicy_(&entry->value, entries[p].value, true);
+    else
+      (*pending)[numKept++] = p;
+  }
+  pending->resize(numKept);
+}
+
 template <typename LMap, typename T>
 class lmap_iterator : public std::iterator<std::forward_iterator_tag, T> {
   template <typename, typename, typename>
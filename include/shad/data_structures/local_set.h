@@ -55,7 +55,7 @@ class lset_iterator;
 /// @tparam ELEM_COMPARE key comparison function; default is MemCmp<T>.
 template <typename T, typename ELEM_COMPARE = MemCmp<T>>
 class LocalSet {
-  template <typename, typename>
+  template <typename, typename, typename>
   friend class Set;
   template <typename, typename, typename>
   friend class LocalEdgeIndex;
@@ -96,6 +96,14 @@ class LocalSet {
   /// @param[in] element the element to insert.
   void AsyncInsert(rt::Handle& handle, const T& element);
 
+  /// @brief Insert a buffer of elements.
+  ///
+  /// The elements are grouped by bucket and the chain of each bucket is
+  /// walked once for its whole group.
+  /// @param[in] elements the elements to insert.
+  /// @param[in] numElements the number of elements.
+  void InsertElements(const T* elements, size_t numElements);
+
   /// @brief Remove an element from the set.
   /// @param[in] element the element to remove.
   void Erase(const T& element);
@@ -233,6 +241,10 @@ class LocalSet {
 
     size_t BucketSize() const { return bucketSize_; }
 
+    // Serializes the Erase operations on the chain headed by this Bucket:
+    // an Erase moves entries backward and a concurrent one could miss them.
+    rt::Lock eraseLock;
+
    private:
     size_t bucketSize_;
     std::shared_ptr<Entry> entries;
@@ -244,6 +256,15 @@ class LocalSet {
   std::vector<Bucket> buckets_array_;
   std::atomic<size_t> size_;
 
+  void EraseImpl(const T& element);
+
+  void InsertInChain(size_t bucketIdx, const T* elements,
+                     std::vector<size_t>* pending);
+
+  // Drops from the pending positions the elements equal to the entry.
+  void DropFound(const Entry* entry, const T* elements,
+                 std::vector<size_t>* pending);
+
   template <typename ApplyFunT, typename... Args, std::size_t... is>
   static void AsyncCallForEachElementFun(rt::Handle& handle, const size_t i,
                                          LocalSet<T>* setPtr,
@@ -361,7 +382,7 @@ class LocalSet {
 
 template <typename T, typename ELEM_COMPARE>
 bool LocalSet<T, ELEM_COMPARE>::Find(const T& element) {
-  size_t bucketIdx = shad::hash<T>{}(element) % numBuckets_;
+  size_t bucketIdx = impl::BucketOf(shad::hash<T>{}(element), numBuckets_);
   Bucket* bucket = &(buckets_array_[bucketIdx]);
 
   while (bucket != nullptr) {
@@ -403,7 +424,15 @@ void LocalSet<T, ELEM_COMPARE>::PrintAllElements() {
 
 template <typename T, typename ELEM_COMPARE>
 void LocalSet<T, ELEM_COMPARE>::Erase(const T& element) {
-  size_t bucketIdx = shad::hash<T>{}(element) % numBuckets_;
+  size_t bucketIdx = impl::BucketOf(shad::hash<T>{}(element), numBuckets_);
+  Bucket* bucket = &(buckets_array_[bucketIdx]);
+  std::lock_guard<rt::Lock> _(bucket->eraseLock);
+  EraseImpl(element);
+}
+
+template <typename T, typename ELEM_COMPARE>
+void LocalSet<T, ELEM_COMPARE>::EraseImpl(const T& element) {
+  size_t bucketIdx = impl::BucketOf(shad::hash<T>{}(element), numBuckets_);
   Bucket* bucket = &(buckets_array_[bucketIdx]);
   Entry* prevEntry = nullptr;
   Entry* toDelete = nullptr;
@@ -426,7 +455,7 @@ void LocalSet<T, ELEM_COMPARE>::Erase(const T& element) {
         // 2. Key found, try to acquire a lock on it
         if (!__sync_bool_compare_and_swap(&entry->state, USED,
                                           PENDING_INSERT)) {
-          Erase(element);
+          EraseImpl(element);
           return;
         }
         // 3. The entry to remove has been found,
@@ -459,7 +488,7 @@ void LocalSet<T, ELEM_COMPARE>::Erase(const T& element) {
                 lastEntry->state = EMPTY;
                 toDelete->state = USED;
                 ++size_;
-                Erase(element);
+                EraseImpl(element);
                 return;
               }
               // now prevEntry is locked
@@ -475,7 +504,7 @@ void LocalSet<T, ELEM_COMPARE>::Erase(const T& element) {
               if (lastEntry->state == PENDING_INSERT) {
                 toDelete->state = USED;
                 ++size_;
-                Erase(element);
+                EraseImpl(element);
                 return;
               }
             }
@@ -496,7 +525,7 @@ void LocalSet<T, ELEM_COMPARE>::Erase(const T& element) {
                                               PENDING_INSERT)) {
               toDelete->state = USED;
               ++size_;
-              Erase(element);
+              EraseImpl(element);
               return;
             }
             if (lastEntry == prevEntry) {
@@ -558,7 +587,7 @@ void LocalSet<T, ELEM_COMPARE>::AsyncErase(rt::Handle& handle,
 template <typename T, typename ELEM_COMPARE>
 std::pair<typename LocalSet<T, ELEM_COMPARE>::iterator, bool>
 LocalSet<T, ELEM_COMPARE>::Insert(const T& element) {
-  size_t bucketIdx = shad::hash<T>{}(element) % numBuckets_;
+  size_t bucketIdx = impl::BucketOf(shad::hash<T>{}(element), numBuckets_);
   Bucket* bucket = &(buckets_array_[bucketIdx]);
 
   // Forever or until we find an insertion point.
@@ -598,6 +627,78 @@ LocalSet<T, ELEM_COMPARE>::Insert(const T& element) {
   }
 }
 
+template <typename T, typename ELEM_COMPARE>
+void LocalSet<T, ELEM_COMPARE>::InsertElements(const T* elements,
+                                               size_t numElements) {
+  std::vector<size_t> buckets(numElements);
+  std::vector<size_t> order(numElements);
+  for (size_t i = 0; i < numElements; ++i) {
+    buckets[i] = impl::BucketOf(shad::hash<T>{}(elements[i]), numBuckets_);
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(),
+            [&](size_t a, size_t b) { return buckets[a] < buckets[b]; });
+
+  std::vector<size_t> pending;
+  for (size_t first = 0; first < numElements;) {
+    size_t bucketIdx = buckets[order[first]];
+    for (; first < numElements && buckets[order[first]] == bucketIdx; ++first)
+      pending.push_back(order[first]);
+    InsertInChain(bucketIdx, elements, &pending);
+  }
+}
+
+template <typename T, typename ELEM_COMPARE>
+void LocalSet<T, ELEM_COMPARE>::InsertInChain(size_t bucketIdx,
+                                              const T* elements,
+                                              std::vector<size_t>* pending) {
+  Bucket* bucket = &(buckets_array_[bucketIdx]);
+
+  // Forever or until all the pending elements are inserted.
+  for (;;) {
+    for (size_t i = 0; i < bucket->BucketSize(); ++i) {
+      Entry* entry = &bucket->getEntry(i);
+
+      if (__sync_bool_compare_and_swap(&entry->state, EMPTY, PENDING_INSERT)) {
+        entry->element = elements[pending->front()];
+        ++size_;
+        entry->state = USED;
+      } else {
+        while (entry->state == PENDING_INSERT) rt::impl::yield();
+      }
+      DropFound(entry, elements, pending);
+      if (pending->empty()) return;
+    }
+
+    if (bucket->next == nullptr) {
+      // We need to allocate a new buffer
+      if (__sync_bool_compare_and_swap(&bucket->isNextAllocated, false, true)) {
+        // Allocate the bucket
+        std::shared_ptr<Bucket> newBucket(
+            new Bucket(constants::kSetDefaultNumEntriesPerBucket));
+        bucket->next.swap(newBucket);
+      } else {
+        // Wait for the allocation to happen
+        while (bucket->next == nullptr) rt::impl::yield();
+      }
+    }
+
+    bucket = bucket->next.get();
+  }
+}
+
+template <typename T, typename ELEM_COMPARE>
+void LocalSet<T, ELEM_COMPARE>::DropFound(const Entry* entry,
+                                          const T* elements,
+                                          std::vector<size_t>* pending) {
+  size_t numKept = 0;
+  for (size_t p : *pending) {
+    if (ElemComp_(&entry->element, &elements[p]) != 0)
+      (*pending)[numKept++] = p;
+  }
+  pending->resize(numKept);
+}
+
 template <typename T, typename ELEM_COMPARE>
 void LocalSet<T, ELEM_COMPARE>::AsyncInsert(rt::Handle& handle,
                                             const T& element) {
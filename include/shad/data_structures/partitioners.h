@@ -0,0 +1,180 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_SHAD_DATA_STRUCTURES_PARTITIONERS_H_
+#define INCLUDE_SHAD_DATA_STRUCTURES_PARTITIONERS_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include "shad/data_structures/compare_and_hash_utils.h"
+#include "shad/runtime/runtime.h"
+
+namespace shad {
+
+/// @defgroup Partitioners Key partitioners.
+///
+/// A partitioner decides the Locality owning a key of Hashmap and Set.  It is
+/// a memcopy-able function object with prototype:
+/// @code
+/// uint32_t operator()(const Key &key, uint32_t numLocalities) const;
+/// @endcode
+/// returning a value in [0, numLocalities).  Each Locality keeps a copy of
+/// the partitioner passed to Create, so the key to Locality mapping is the
+/// same everywhere.  Containers created with equal partitioners over the
+/// same keys are co-partitioned: an entry of one is stored on the same
+/// Locality as the entry with the same key of the other.
+/// @{
+
+/// @brief Modulo hashing, shad::hash(key) % numLocalities.
+///
+/// The default partitioner.  EdgeIndex and the graph algorithms assign
+/// vertices to Localities with the same rule.
+///
+/// @tparam Key The type of the keys.
+template <typename Key>
+struct ModuloPartitioner {
+  uint32_t operator()(const Key &key, uint32_t numLocalities) const {
+    return shad::hash<Key>{}(key) % numLocalities;
+  }
+};
+
+/// @brief Jump consistent hashing.
+///
+/// Lamping and Veach's jump consistent hash: when the number of Localities
+/// grows from n to n + 1 only 1/(n + 1) of the keys change owner.
+///
+/// @tparam Key The type of the keys.
+template <typename Key>
+struct JumpConsistentPartitioner {
+  uint32_t operator()(const Key &key, uint32_t numLocalities) const {
+    uint64_t state = impl::Mix64(shad::hash<Key>{}(key));
+    int64_t bucket = -1, next = 0;
+    while (next < numLocalities) {
+      bucket = next;
+      state = state * 2862933555777941757ULL + 1;
+      next = static_cast<int64_t>((bucket + 1) *
+                                  (static_cast<double>(1LL << 31) /
+                                   static_cast<double>((state >> 33) + 1)));
+    }
+    return static_cast<uint32_t>(bucket);
+  }
+};
+
+/// @brief User-provided key to Locality function.
+///
+/// Typical Usage:
+/// @code
+/// // Keep the attributes of a vertex on the Locality owning the vertex.
+/// uint32_t ByVertex(const Attribute &key, uint32_t numLocalities) {
+///   return shad::hash<uint64_t>{}(key.vertex) % numLocalities;
+/// }
+///
+/// using MapT = shad::Hashmap<Attribute, double, shad::MemCmp<Attribute>,
+///                            shad::Overwriter<double>, shad::LocalHashmap,
+///                            shad::FunctionPartitioner<Attribute>>;
+/// auto map = MapT::Create(numEntries,
+///                         shad::FunctionPartitioner<Attribute>{ByVertex});
+/// @endcode
+///
+/// @tparam Key The type of the keys.
+template <typename Key>
+struct FunctionPartitioner {
+  using FunctionTy = uint32_t (*)(const Key &, uint32_t);
+
+  uint32_t operator()(const Key &key, uint32_t numLocalities) const {
+    return function(key, numLocalities);
+  }
+
+  FunctionTy function;
+};
+
+/// @brief Range partitioning on sorted splitters.
+///
+/// The i-th Locality owns the keys between the (i - 1)-th and the i-th
+/// splitter, so ordered keys that are close to each other share a Locality.
+/// The splitters are usually drawn from a sample of the keys with
+/// FromSample, which balances skewed key distributions.
+///
+/// @tparam Key The type of the keys.  It must be memcopy-able.
+/// @tparam Compare The strict weak ordering of the keys.
+/// @tparam MaxSplitters The capacity of the splitters storage.  It bounds
+/// the number of Localities keys are spread on to MaxSplitters + 1.
+template <typename Key, typename Compare = std::less<Key>,
+          size_t MaxSplitters = 127>
+class RangePartitioner {
+ public:
+  /// @brief Constructor.  All the keys are owned by the first Locality.
+  RangePartitioner() : numSplitters_(0), splitters_() {}
+
+  /// @brief Constructor.
+  ///
+  /// @param splitters The sorted splitters.
+  /// @param numSplitters The number of splitters.
+  /// @throw std::invalid_argument If numSplitters exceeds MaxSplitters.
+  RangePartitioner(const Key *splitters, size_t numSplitters)
+      : numSplitters_(numSplitters), splitters_() {
+    if (numSplitters > MaxSplitters)
+      throw std::invalid_argument("too many range splitters");
+    std::copy(splitters, splitters + numSplitters, splitters_.begin());
+  }
+
+  /// @brief Build a partitioner with evenly spaced splitters from a sample.
+  ///
+  /// @param sample The sample of the keys.
+  /// @param sampleSize The size of the sample.
+  /// @param numParts The number of ranges; default is rt::numLocalities().
+  /// @return A partitioner splitting the sample in numParts ranges of the
+  /// same size.
+  static RangePartitioner FromSample(const Key *sample, size_t sampleSize,
+                                     uint32_t numParts = rt::numLocalities()) {
+    std::vector<Key> sorted(sample, sample + sampleSize);
+    std::sort(sorted.begin(), sorted.end(), Compare());
+    std::vector<Key> splitters;
+    for (uint32_t i = 1; i < numParts && !sorted.empty(); ++i)
+      splitters.push_back(sorted[sorted.size() * i / numParts]);
+    return RangePartitioner(splitters.data(), splitters.size());
+  }
+
+  uint32_t operator()(const Key &key, uint32_t numLocalities) const {
+    auto end = splitters_.begin() + numSplitters_;
+    auto range = std::upper_bound(splitters_.begin(), end, key, Compare());
+    return static_cast<uint32_t>(range - splitters_.begin()) % numLocalities;
+  }
+
+ private:
+  size_t numSplitters_;
+  std::array<Key, MaxSplitters> splitters_;
+};
+
+/// @}
+
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_DATA_STRUCTURES_PARTITIONERS_H_
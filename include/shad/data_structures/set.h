@@ -27,15 +27,19 @@
 
 #include <algorithm>
 #include <functional>
+#include <memory>
 #include <tuple>
 #include <utility>
 #include <vector>
 
 #include "shad/data_structures/abstract_data_structure.h"
+#include "shad/data_structures/batch_utils.h"
 #include "shad/data_structures/buffer.h"
 #include "shad/data_structures/compare_and_hash_utils.h"
 #include "shad/data_structures/local_set.h"
+#include "shad/data_structures/partitioners.h"
 #include "shad/distributed_iterator_traits.h"
+#include "shad/runtime/collectives.h"
 #include "shad/runtime/runtime.h"
 
 namespace shad {
@@ -49,23 +53,26 @@ class set_iterator;
 /// @tparam T type of the entries stored in the set.
 /// @tparam ELEM_COMPARE element comparison function; default is MemCmp<T>.
 /// @warning obects of type T need to be trivially copiable.
-template <typename T, typename ELEM_COMPARE = MemCmp<T>>
-class Set : public AbstractDataStructure<Set<T, ELEM_COMPARE>> {
+/// @tparam PARTITIONER element to locality mapping; default is modulo hashing.
+/// @see Partitioners
+template <typename T, typename ELEM_COMPARE = MemCmp<T>,
+          typename PARTITIONER = ModuloPartitioner<T>>
+class Set : public AbstractDataStructure<Set<T, ELEM_COMPARE, PARTITIONER>> {
   template <typename>
   friend class AbstractDataStructure;
 
-  friend class set_iterator<Set<T, ELEM_COMPARE>, const T, T>;
+  friend class set_iterator<Set<T, ELEM_COMPARE, PARTITIONER>, const T, T>;
 
  public:
   using value_type = T;
-  using SetT = Set<T, ELEM_COMPARE>;
+  using SetT = Set<T, ELEM_COMPARE, PARTITIONER>;
   using LSetT = LocalSet<T, ELEM_COMPARE>;
   using ObjectID = typename AbstractDataStructure<SetT>::ObjectID;
   using ShadSetPtr = typename AbstractDataStructure<SetT>::SharedPtr;
   using BuffersVector = typename impl::BuffersVector<T, SetT>;
 
-  using iterator = set_iterator<Set<T, ELEM_COMPARE>, const T, T>;
-  using const_iterator = set_iterator<Set<T, ELEM_COMPARE>, const T, T>;
+  using iterator = set_iterator<SetT, const T, T>;
+  using const_iterator = set_iterator<SetT, const T, T>;
   using local_iterator = lset_iterator<LocalSet<T, ELEM_COMPARE>, const T>;
   using const_local_iterator =
       lset_iterator<LocalSet<T, ELEM_COMPARE>, const T>;
@@ -73,22 +80,42 @@ class Set : public AbstractDataStructure<Set<T, ELEM_COMPARE>> {
   ///
   /// Creates a new set instance.
   /// @param numEntries Expected number of elements.
+  /// @param partitioner The element to locality mapping; it is copied on
+  /// every locality.
   /// @return A shared pointer to the newly created set instance.
 #ifdef DOXYGEN_IS_RUNNING
-  static ShadSetPtr Create(const size_t numEntries);
+  static ShadSetPtr Create(const size_t numEntries,
+                           const PARTITIONER& partitioner = PARTITIONER());
 #endif
 
+  /// @brief The locality owning an element.
+  /// @param[in] element the element.
+  /// @return the locality where element is (or would be) stored.
+  rt::Locality GetOwner(const T& element) const {
+    return rt::Locality(partitioner_(element, rt::numLocalities()));
+  }
+
   /// @brief Getter of the Global Identifier.
   ///
   /// @return The global identifier associated with the set instance.
   ObjectID GetGlobalID() const { return oid_; }
 
   /// @brief Overall size of the set (number of elements).
-  /// @warning Calling the size method may result in one-to-all
-  /// communication among localities to retrieve consinstent information.
+  ///
+  /// Every locality keeps the count of the elements it stores; the counts are
+  /// summed with a single tree reduction over all the localities.
   /// @return the size of the set.
   size_t Size() const;
 
+  /// @brief Approximate size of the set (number of elements).
+  ///
+  /// Extrapolated from the elements stored on the calling locality, so it
+  /// requires no communication.
+  /// @return the approximate size of the set.
+  size_t ApproximateSize() const {
+    return localSet_.size_ * rt::numLocalities();
+  }
+
   /// @brief Insert an element in the set.
   /// @param[in] element the element.
   /// @return a pair consisting of an iterator to the inserted element (or to
@@ -165,6 +192,36 @@ class Set : public AbstractDataStructure<Set<T, ELEM_COMPARE>> {
   /// @param[out] found the address where to store the result of the operation.
   void AsyncFind(rt::Handle& handle, const T& element, bool* found);
 
+  /// @brief Insert a batch of elements.
+  ///
+  /// The elements are grouped by owner Locality and shipped with one message
+  /// per Locality, where they are inserted in parallel.
+  ///
+  /// @param[in] elements The elements.
+  /// @param[in] numElements The number of elements.
+  void InsertBatch(const T* elements, size_t numElements);
+
+  /// @brief Asynchronously insert a batch of elements.
+  /// @warning Asynchronous operations are guaranteed to have completed
+  /// only after calling the rt::waitForCompletion(rt::Handle &handle) method.
+  /// The elements are copied: the array can be reused on return.
+  /// @param[in,out] handle Reference to the handle
+  /// to be used to wait for completion.
+  /// @param[in] elements The elements.
+  /// @param[in] numElements The number of elements.
+  void AsyncInsertBatch(rt::Handle& handle, const T* elements,
+                        size_t numElements);
+
+  /// @brief Check if the set contains a batch of elements.
+  ///
+  /// The elements are grouped by owner Locality and shipped with one message
+  /// per Locality, where they are looked up in parallel.
+  ///
+  /// @param[in] elements The elements to find.
+  /// @param[in] numElements The number of elements.
+  /// @param[out] found found[i] is true if elements[i] is in the set.
+  void FindBatch(const T* elements, size_t numElements, bool* found);
+
   /// @brief Apply a user-defined function to each element in the set.
   /// @tparam ApplyFunT User-defined function type.
   /// The function prototype should be:
@@ -209,6 +266,11 @@ class Set : public AbstractDataStructure<Set<T, ELEM_COMPARE>> {
   // FIXME it should be protected
   void BufferEntryInsert(const T& element) { localSet_.Insert(element); }
 
+  // FIXME it should be protected
+  void BufferEntriesInsert(const T* elements, size_t numElements) {
+    localSet_.InsertElements(elements, numElements);
+  }
+
   iterator begin() { return iterator::set_begin(this); }
   iterator end() { return iterator::set_end(this); }
   const_iterator cbegin() const { return const_iterator::set_begin(this); }
@@ -247,43 +309,43 @@ class Set : public AbstractDataStructure<Set<T, ELEM_COMPARE>> {
   ObjectID oid_;
   LocalSet<T, ELEM_COMPARE> localSet_;
   BuffersVector buffers_;
+  PARTITIONER partitioner_;
 
   struct ExeAtArgs {
     ObjectID oid;
     T element;
   };
 
+  struct BatchHeader {
+    ObjectID oid;
+    size_t numElements;
+  };
+
  protected:
-  Set(ObjectID oid, const size_t numEntries)
+  Set(ObjectID oid, const size_t numEntries,
+      const PARTITIONER& partitioner = PARTITIONER())
       : oid_(oid),
         localSet_(
             std::max(numEntries / (constants::kSetDefaultNumEntriesPerBucket *
                                    rt::numLocalities()),
                      1lu)),
-        buffers_(oid) {}
+        buffers_(oid),
+        partitioner_(partitioner) {}
 };
 
-template <typename T, typename ELEM_COMPARE>
-inline size_t Set<T, ELEM_COMPARE>::Size() const {
-  size_t size = localSet_.size_;
-  size_t remoteSize(0);
-  auto sizeLambda = [](const ObjectID& oid, size_t* res) {
-    auto setPtr = SetT::GetPtr(oid);
-    *res = setPtr->localSet_.size_;
+template <typename T, typename ELEM_COMPARE, typename PARTITIONER>
+inline size_t Set<T, ELEM_COMPARE, PARTITIONER>::Size() const {
+  auto sizeLambda = [](const ObjectID& oid) -> size_t {
+    return SetT::GetPtr(oid)->localSet_.size_;
   };
-  for (auto tgtLoc : rt::allLocalities()) {
-    if (tgtLoc != rt::thisLocality()) {
-      rt::executeAtWithRet(tgtLoc, sizeLambda, oid_, &remoteSize);
-      size += remoteSize;
-    }
-  }
-  return size;
+  return rt::treeReduce(rt::localities_range(), sizeLambda,
+                        std::plus<size_t>(), size_t(0), oid_);
 }
 
-template <typename T, typename ELEM_COMPARE>
-inline std::pair<typename Set<T, ELEM_COMPARE>::iterator, bool>
-Set<T, ELEM_COMPARE>::Insert(const T& element) {
-  size_t targetId = shad::hash<T>{}(element) % rt::numLocalities();
+template <typename T, typename ELEM_COMPARE, typename PARTITIONER>
+inline std::pair<typename Set<T, ELEM_COMPARE, PARTITIONER>::iterator, bool>
+Set<T, ELEM_COMPARE, PARTITIONER>::Insert(const T& element) {
+  size_t targetId = partitioner_(element, rt::numLocalities());
   rt::Locality targetLocality(targetId);
 
   using itr_traits = distributed_iterator_traits<iterator>;
@@ -307,10 +369,10 @@ Set<T, ELEM_COMPARE>::Insert(const T& element) {
   return res;
 }
 
-template <typename T, typename ELEM_COMPARE>
-inline void Set<T, ELEM_COMPARE>::AsyncInsert(rt::Handle& handle,
-                                              const T& element) {
-  size_t targetId = shad::hash<T>{}(element) % rt::numLocalities();
+template <typename T, typename ELEM_COMPARE, typename PARTITIONER>
+inline void Set<T, ELEM_COMPARE, PARTITIONER>::AsyncInsert(rt::Handle& handle,
+                                                           const T& element) {
+  size_t targetId = partitioner_(element, rt::numLocalities());
   rt::Locality targetLocality(targetId);
   if (targetLocality == rt::thisLocality()) {
     localSet_.AsyncInsert(handle, element);
@@ -324,24 +386,106 @@ inline void Set<T, ELEM_COMPARE>::AsyncInsert(rt::Handle& handle,
   }
 }
 
-template <typename T, typename ELEM_COMPARE>
-inline void Set<T, ELEM_COMPARE>::BufferedInsert(const T& element) {
-  size_t targetId = shad::hash<T>{}(element) % rt::numLocalities();
+template <typename T, typename ELEM_COMPARE, typename PARTITIONER>
+inline void Set<T, ELEM_COMPARE, PARTITIONER>::InsertBatch(const T* elements,
+                                                           size_t numElements) {
+  rt::Handle handle;
+  AsyncInsertBatch(handle, elements, numElements);
+  rt::waitForCompletion(handle);
+}
+
+template <typename T, typename ELEM_COMPARE, typename PARTITIONER>
+inline void Set<T, ELEM_COMPARE, PARTITIONER>::AsyncInsertBatch(
+    rt::Handle& handle, const T* elements, size_t numElements) {
+  using Layout = impl::BatchLayout<BatchHeader, T>;
+  auto insertBatchLambda = [](rt::Handle&, const uint8_t* payload,
+                              const uint32_t) {
+    const BatchHeader& header = Layout::Header(payload);
+    auto setPtr = SetT::GetPtr(header.oid);
+    const T* elements = Layout::template Array<0>(payload, header.numElements);
+    rt::impl::parallelFor(header.numElements, [&](size_t i) {
+      setPtr->localSet_.Insert(elements[i]);
+    });
+  };
+
+  auto partition =
+      impl::PartitionByLocality(elements, numElements, partitioner_);
+  for (uint32_t l = 0; l < rt::numLocalities(); ++l) {
+    size_t count = partition.Count(l);
+    if (count == 0) continue;
+
+    auto payload = Layout::Allocate(count, BatchHeader{oid_, count});
+    T* batch = Layout::template Array<0>(payload.get(), count);
+    for (size_t i = 0; i < count; ++i)
+      new (&batch[i]) T(elements[partition.Position(l, i)]);
+    rt::asyncExecuteAt(handle, rt::Locality(l), insertBatchLambda, payload,
+                       Layout::Bytes(count));
+  }
+}
+
+template <typename T, typename ELEM_COMPARE, typename PARTITIONER>
+inline void Set<T, ELEM_COMPARE, PARTITIONER>::FindBatch(const T* elements,
+                                                         size_t numElements,
+                                                         bool* found) {
+  using Layout = impl::BatchLayout<BatchHeader, T>;
+  auto findBatchLambda = [](rt::Handle&, const uint8_t* payload,
+                            const uint32_t, uint8_t* resultBuffer,
+                            uint32_t* resultSize) {
+    const BatchHeader& header = Layout::Header(payload);
+    auto setPtr = SetT::GetPtr(header.oid);
+    const T* elements = Layout::template Array<0>(payload, header.numElements);
+    bool* found = reinterpret_cast<bool*>(resultBuffer);
+    rt::impl::parallelFor(header.numElements, [&](size_t i) {
+      found[i] = setPtr->localSet_.Find(elements[i]);
+    });
+    *resultSize = header.numElements * sizeof(bool);
+  };
+
+  auto partition =
+      impl::PartitionByLocality(elements, numElements, partitioner_);
+  std::vector<std::unique_ptr<bool[]>> resultBuffers(rt::numLocalities());
+  std::vector<uint32_t> resultSizes(rt::numLocalities(), 0);
+  rt::Handle handle;
+  for (uint32_t l = 0; l < rt::numLocalities(); ++l) {
+    size_t count = partition.Count(l);
+    if (count == 0) continue;
+
+    auto payload = Layout::Allocate(count, BatchHeader{oid_, count});
+    T* batch = Layout::template Array<0>(payload.get(), count);
+    for (size_t i = 0; i < count; ++i)
+      new (&batch[i]) T(elements[partition.Position(l, i)]);
+    resultBuffers[l].reset(new bool[count]);
+    rt::asyncExecuteAtWithRetBuff(
+        handle, rt::Locality(l), findBatchLambda, payload, Layout::Bytes(count),
+        reinterpret_cast<uint8_t*>(resultBuffers[l].get()), &resultSizes[l]);
+  }
+  rt::waitForCompletion(handle);
+
+  for (uint32_t l = 0; l < rt::numLocalities(); ++l) {
+    for (size_t i = 0; i < partition.Count(l); ++i)
+      found[partition.Position(l, i)] = resultBuffers[l][i];
+  }
+}
+
+template <typename T, typename ELEM_COMPARE, typename PARTITIONER>
+inline void Set<T, ELEM_COMPARE, PARTITIONER>::BufferedInsert(
+    const T& element) {
+  size_t targetId = partitioner_(element, rt::numLocalities());
   rt::Locality targetLocality(targetId);
   buffers_.Insert(element, targetLocality);
 }
 
-template <typename T, typename ELEM_COMPARE>
-inline void Set<T, ELEM_COMPARE>::BufferedAsyncInsert(rt::Handle& handle,
-                                                      const T& element) {
-  size_t targetId = shad::hash<T>{}(element) % rt::numLocalities();
+template <typename T, typename ELEM_COMPARE, typename PARTITIONER>
+inline void Set<T, ELEM_COMPARE, PARTITIONER>::BufferedAsyncInsert(
+    rt::Handle& handle, const T& element) {
+  size_t targetId = partitioner_(element, rt::numLocalities());
   rt::Locality targetLocality(targetId);
   buffers_.AsyncInsert(handle, element, targetLocality);
 }
 
-template <typename T, typename ELEM_COMPARE>
-inline void Set<T, ELEM_COMPARE>::Erase(const T& element) {
-  size_t targetId = shad::hash<T>{}(element) % rt::numLocalities();
+template <typename T, typename ELEM_COMPARE, typename PARTITIONER>
+inline void Set<T, ELEM_COMPARE, PARTITIONER>::Erase(const T& element) {
+  size_t targetId = partitioner_(element, rt::numLocalities());
   rt::Locality targetLocality(targetId);
   if (targetLocality == rt::thisLocality()) {
     localSet_.Erase(element);
@@ -355,10 +499,10 @@ inline void Set<T, ELEM_COMPARE>::Erase(const T& element) {
   }
 }
 
-template <typename T, typename ELEM_COMPARE>
-inline void Set<T, ELEM_COMPARE>::AsyncErase(rt::Handle& handle,
-                                             const T& element) {
-  size_t targetId = shad::hash<T>{}(element) % rt::numLocalities();
+template <typename T, typename ELEM_COMPARE, typename PARTITIONER>
+inline void Set<T, ELEM_COMPARE, PARTITIONER>::AsyncErase(rt::Handle& handle,
+                                                          const T& element) {
+  size_t targetId = partitioner_(element, rt::numLocalities());
   rt::Locality targetLocality(targetId);
   if (targetLocality == rt::thisLocality()) {
     localSet_.AsyncErase(handle, element);
@@ -372,9 +516,9 @@ inline void Set<T, ELEM_COMPARE>::AsyncErase(rt::Handle& handle,
   }
 }
 
-template <typename T, typename ELEM_COMPARE>
-inline bool Set<T, ELEM_COMPARE>::Find(const T& element) {
-  size_t targetId = shad::hash<T>{}(element) % rt::numLocalities();
+template <typename T, typename ELEM_COMPARE, typename PARTITIONER>
+inline bool Set<T, ELEM_COMPARE, PARTITIONER>::Find(const T& element) {
+  size_t targetId = partitioner_(element, rt::numLocalities());
   rt::Locality targetLocality(targetId);
   if (targetLocality == rt::thisLocality()) {
     return localSet_.Find(element);
@@ -391,10 +535,11 @@ inline bool Set<T, ELEM_COMPARE>::Find(const T& element) {
   return false;
 }
 
-template <typename T, typename ELEM_COMPARE>
-inline void Set<T, ELEM_COMPARE>::AsyncFind(rt::Handle& handle,
-                                            const T& element, bool* found) {
-  size_t targetId = shad::hash<T>{}(element) % rt::numLocalities();
+template <typename T, typename ELEM_COMPARE, typename PARTITIONER>
+inline void Set<T, ELEM_COMPARE, PARTITIONER>::AsyncFind(rt::Handle& handle,
+                                                         const T& element,
+                                                         bool* found) {
+  size_t targetId = partitioner_(element, rt::numLocalities());
   rt::Locality targetLocality(targetId);
 
   if (targetLocality == rt::thisLocality()) {
@@ -409,9 +554,10 @@ inline void Set<T, ELEM_COMPARE>::AsyncFind(rt::Handle& handle,
   }
 }
 
-template <typename T, typename ELEM_COMPARE>
+template <typename T, typename ELEM_COMPARE, typename PARTITIONER>
 template <typename ApplyFunT, typename... Args>
-void Set<T, ELEM_COMPARE>::ForEachElement(ApplyFunT&& function, Args&... args) {
+void Set<T, ELEM_COMPARE, PARTITIONER>::ForEachElement(ApplyFunT&& function,
+                                                       Args&... args) {
   using FunctionTy = void (*)(const T&, Args&...);
   FunctionTy fn = std::forward<decltype(function)>(function);
   using feArgs = std::tuple<ObjectID, FunctionTy, std::tuple<Args...>>;
@@ -428,11 +574,10 @@ void Set<T, ELEM_COMPARE>::ForEachElement(ApplyFunT&& function, Args&... args) {
   rt::executeOnAll(feLambda, arguments);
 }
 
-template <typename T, typename ELEM_COMPARE>
+template <typename T, typename ELEM_COMPARE, typename PARTITIONER>
 template <typename ApplyFunT, typename... Args>
-void Set<T, ELEM_COMPARE>::AsyncForEachElement(rt::Handle& handle,
-                                               ApplyFunT&& function,
-                                               Args&... args) {
+void Set<T, ELEM_COMPARE, PARTITIONER>::AsyncForEachElement(
+    rt::Handle& handle, ApplyFunT&& function, Args&... args) {
   using FunctionTy = void (*)(rt::Handle&, const T&, Args&...);
   FunctionTy fn = std::forward<decltype(function)>(function);
   using feArgs = std::tuple<ObjectID, FunctionTy, std::tuple<Args...>>;
@@ -527,24 +672,11 @@ class set_iterator : public std::iterator<std::forward_iterator_tag, T> {
         data_.element_ = *(data_.lsetIt_);
         return *this;
       } else {
-        // find the local begin on next localities
-        itData itd;
-        for (uint32_t i = data_.locId_ + 1; i < rt::numLocalities(); ++i) {
-          rt::executeAtWithRet(rt::Locality(i), getLocBeginIt, data_.oid_,
-                               &itd);
-          if (itd.locId_ != rt::numLocalities()) {
-            // It Data is valid
-            data_ = itd;
-            return *this;
-          }
-        }
-        data_ = itData(rt::numLocalities(), OIDT(0), lend, T());
+        data_ = getNextLocBeginIt(data_.locId_, data_.oid_);
         return *this;
       }
     }
-    itData itd;
-    rt::executeAtWithRet(rt::Locality(data_.locId_), getRemoteIt, data_, &itd);
-    data_ = itd;
+    data_ = getNextRemoteIt(data_);
     return *this;
   }
   set_iterator operator++(int) {
@@ -609,41 +741,88 @@ class set_iterator : public std::iterator<std::forward_iterator_tag, T> {
 
   itData data_;
 
-  static void getLocBeginIt(const OIDT& setOID, itData* res) {
+  /// Number of entries fetched from a remote Locality at once.
+  constexpr static size_t kBatchSize =
+      constants::max(constants::kBufferNumBytes / sizeof(itData), 1lu);
+
+  // Consecutive elements of a remote Locality, as last fetched by the calling
+  // thread; its traversal stands at entries[next - 1].  Fewer than kBatchSize
+  // entries means the batch reaches the end of its Locality.
+  struct remoteBatch {
+    itData entries[kBatchSize];
+    size_t size = 0;
+    size_t next = 0;
+  };
+
+  static remoteBatch& getThreadBatch() {
+    static thread_local remoteBatch batch;
+    return batch;
+  }
+
+  static void fillBatch(const OIDT& setOID, local_iterator_type it,
+                        local_iterator_type localEnd, uint8_t* result,
+                        uint32_t* resultSize) {
+    itData* entries = reinterpret_cast<itData*>(result);
+    uint32_t locId = static_cast<uint32_t>(rt::thisLocality());
+    size_t numEntries = 0;
+    for (; it != localEnd && numEntries < kBatchSize; ++it, ++numEntries)
+      new (&entries[numEntries]) itData(locId, setOID, it, *it);
+    *resultSize = numEntries * sizeof(itData);
+  }
+
+  static void getLocBeginBatch(const OIDT& setOID, uint8_t* result,
+                               uint32_t* resultSize) {
     auto setPtr = SetT::GetPtr(setOID);
     auto lsetPtr = &(setPtr->localSet_);
-    auto localEnd = local_iterator_type::lset_end(lsetPtr);
-    auto localBegin = local_iterator_type::lset_begin(lsetPtr);
-    if (localBegin != localEnd) {
-      *res = itData(static_cast<uint32_t>(rt::thisLocality()), setOID,
-                    localBegin, *localBegin);
-    } else {
-      *res = itData(rt::numLocalities(), OIDT(0), localEnd, T());
-    }
+    fillBatch(setOID, local_iterator_type::lset_begin(lsetPtr),
+              local_iterator_type::lset_end(lsetPtr), result, resultSize);
   }
 
-  static void getRemoteIt(const itData& itd, itData* res) {
+  static void getRemoteBatch(const itData& itd, uint8_t* result,
+                             uint32_t* resultSize) {
     auto setPtr = SetT::GetPtr(itd.oid_);
-    auto lsetPtr = &(setPtr->localSet_);
-    auto localEnd = local_iterator_type::lset_end(lsetPtr);
+    auto localEnd = local_iterator_type::lset_end(&(setPtr->localSet_));
     local_iterator_type cit = itd.lsetIt_;
-    ++cit;
-    if (cit != localEnd) {
-      *res = itData(static_cast<uint32_t>(rt::thisLocality()), itd.oid_, cit,
-                    *cit);
-      return;
-    } else {
-      itData outitd;
-      for (uint32_t i = itd.locId_ + 1; i < rt::numLocalities(); ++i) {
-        rt::executeAtWithRet(rt::Locality(i), getLocBeginIt, itd.oid_, &outitd);
-        if (outitd.locId_ != rt::numLocalities()) {
-          // It Data is valid
-          *res = outitd;
-          return;
-        }
-      }
-      *res = itData(rt::numLocalities(), OIDT(0), localEnd, T());
+    if (cit != localEnd) ++cit;
+    fillBatch(itd.oid_, cit, localEnd, result, resultSize);
+  }
+
+  // Fetch a batch into a local copy: the tasks the thread runs while waiting
+  // may traverse other sets and replace the batch of the thread.
+  template <typename FunT, typename InArgsT>
+  static remoteBatch& fetchBatch(uint32_t locId, FunT&& func,
+                                 const InArgsT& args) {
+    remoteBatch fetched;
+    uint32_t resultSize = 0;
+    rt::executeAtWithRetBuff(rt::Locality(locId), func, args,
+                             reinterpret_cast<uint8_t*>(fetched.entries),
+                             &resultSize);
+    fetched.size = resultSize / sizeof(itData);
+    remoteBatch& batch = getThreadBatch();
+    batch = fetched;
+    return batch;
+  }
+
+  static itData getNextLocBeginIt(uint32_t locId, const OIDT& setOID) {
+    for (uint32_t i = locId + 1; i < rt::numLocalities(); ++i) {
+      remoteBatch& batch = fetchBatch(i, getLocBeginBatch, setOID);
+      if (batch.size != 0) return batch.entries[batch.next++];
+    }
+    auto setPtr = SetT::GetPtr(setOID);
+    return itData(rt::numLocalities(), OIDT(0),
+                  local_iterator_type::lset_end(&(setPtr->localSet_)), T());
+  }
+
+  static itData getNextRemoteIt(const itData& itd) {
+    remoteBatch& batch = getThreadBatch();
+    bool hit = batch.next != 0 && batch.entries[batch.next - 1] == itd &&
+               batch.entries[batch.next - 1].oid_ == itd.oid_;
+    if (hit && batch.next < batch.size) return batch.entries[batch.next++];
+    if (!hit || batch.size == kBatchSize) {
+      remoteBatch& fetched = fetchBatch(itd.locId_, getRemoteBatch, itd);
+      if (fetched.size != 0) return fetched.entries[fetched.next++];
     }
+    return getNextLocBeginIt(itd.locId_, itd.oid_);
   }
 };
 
@@ -37,6 +37,7 @@
 #include <vector>
 
 #include "shad/data_structures/abstract_data_structure.h"
+#include "shad/data_structures/batch_utils.h"
 #include "shad/data_structures/buffer.h"
 #include "shad/runtime/runtime.h"
 
@@ -197,6 +198,66 @@ class Vector : public AbstractDataStructure<Vector<T, Allocator>> {
   /// @brief Adds an element at the end of the shad::Vector.
   void PushBack(const T &value);
 
+  /// @brief Adds a sequence of elements at the end of the shad::Vector.
+  ///
+  /// The positions of the whole sequence are reserved with a single request
+  /// to the Locality owning the size of the container, and the elements are
+  /// written with one bulk transfer per block.  Concurrent calls append
+  /// their sequences contiguously, in an unspecified order.
+  ///
+  /// Typical usage:
+  /// @code
+  /// auto vectorPtr = shad::Vector<size_t>::Create(0);
+  /// std::vector<size_t> results = computeResults();
+  /// auto first = vectorPtr->PushBackRange(results.begin(), results.end());
+  /// // results[i] is at position first + i.
+  /// @endcode
+  ///
+  /// @param[in] begin An input iterator to the start of the sequence.
+  /// @param[in] end An input iterator to the end of the sequence.
+  /// @return The position of the first appended element.
+  template <typename InputIterator>
+  size_type PushBackRange(InputIterator begin, InputIterator end);
+
+  /// @brief Adds a sequence of elements at the end of the shad::Vector
+  /// asynchronously.
+  ///
+  /// The positions are reserved synchronously; the elements are written
+  /// asynchronously.
+  ///
+  /// @warning The elements are guaranteed to be written only after calling
+  /// the shad::rt::waitForCompletion(rt::Handle &handle) method.
+  ///
+  /// @param[in,out] handle Reference to the handle to be used to wait for
+  /// completion.
+  /// @param[in] begin An input iterator to the start of the sequence.
+  /// @param[in] end An input iterator to the end of the sequence.
+  /// @return The position of the first appended element.
+  template <typename InputIterator>
+  size_type AsyncPushBackRange(rt::Handle &handle, InputIterator begin,
+                               InputIterator end);
+
+  /// @brief Adds an element at the end of the shad::Vector, using a local
+  /// staging buffer.
+  ///
+  /// The elements pushed on a Locality are appended in chunks through
+  /// PushBackRange(), so that producers do not synchronize with the
+  /// Locality owning the size for every element.
+  ///
+  /// Typical usage:
+  /// @code
+  /// auto vectorPtr = shad::Vector<size_t>::Create(0);
+  /// for (auto &result : results)
+  ///   vectorPtr->BufferedPushBack(result);
+  /// vectorPtr->WaitForBufferedInsert();
+  /// @endcode
+  ///
+  /// @warning Insertions are finalized only after calling the
+  /// WaitForBufferedInsert() method on the Locality where they were issued.
+  ///
+  /// @param[in] value The value to be appended.
+  void BufferedPushBack(const value_type &value);
+
   /// @brief Write a value at the specified position.
   ///
   /// This method overwrite the element at the specified position.
@@ -345,7 +406,10 @@ class Vector : public AbstractDataStructure<Vector<T, Allocator>> {
                              const value_type &value);
 
   /// @brief Finalize method for buffered insertions.
-  void WaitForBufferedInsert() { buffers_.FlushAll(); }
+  void WaitForBufferedInsert() {
+    buffers_.FlushAll();
+    _flushPushBackBuffer();
+  }
 
   /// @}
 
@@ -513,7 +577,9 @@ class Vector : public AbstractDataStructure<Vector<T, Allocator>> {
         size_(n),
         capacity_(0),
         allocator_(),
-        buffers_(oid) {
+        buffers_(oid),
+        pushBackBuffer_(),
+        pushBackLock_() {
     size_t blocksToAllocate = std::max(_sizeToLocalBlocks(n, kBlockSize), 1UL);
     capacity_ =
         std::max(kBlockSize * _blockOffsetFromPosition(n).first, kBlockSize);
@@ -609,6 +675,87 @@ class Vector : public AbstractDataStructure<Vector<T, Allocator>> {
     capacity_ += kBlockSize * blocksToAllocate;
   }
 
+  /// @brief Reserve n positions at the end of the container.
+  /// @return The first reserved position.
+  size_type _reserveBack(size_type n) {
+    size_type first(0);
+    rt::executeAtWithRet(
+        mainLocality_,
+        [](const std::pair<ObjectID, size_type> &args, size_type *first) {
+          auto This = Vector<T, Allocator>::GetPtr(args.first);
+          std::lock_guard<rt::Lock> _(This->sizeCapacityLock_);
+
+          *first = This->size_;
+          This->size_ += args.second;
+          if (This->size_ > This->capacity_) This->_reserve(This->size_);
+        },
+        std::make_pair(oid_, n), &first);
+    return first;
+  }
+
+  /// @brief Write n contiguous values starting at position, with one
+  /// transfer per block.
+  void _asyncWriteRange(rt::Handle &handle, size_type position,
+                        const value_type *values, size_type n) {
+    struct WriteHeader {
+      ObjectID oid;
+      size_type position;
+      size_type count;
+    };
+    using Layout = impl::BatchLayout<WriteHeader, value_type>;
+    constexpr size_type kMaxWrite =
+        constants::max(constants::kBufferNumBytes / sizeof(value_type), 1lu);
+
+    auto writeLambda = [](rt::Handle &, const uint8_t *payload,
+                          const uint32_t) {
+      const WriteHeader &header = Layout::Header(payload);
+      auto This = Vector<T, Allocator>::GetPtr(header.oid);
+      auto blockOffsetPair = This->_blockOffsetFromPosition(header.position);
+      size_type localBlock =
+          This->_globlalBlockToLocalBlock(blockOffsetPair.first);
+      const value_type *values =
+          Layout::template Array<0>(payload, header.count);
+      std::copy(values, values + header.count,
+                &This->dataBlocks_[localBlock][blockOffsetPair.second]);
+    };
+
+    while (n > 0) {
+      rt::Locality target(0);
+      size_t blockNumber(0);
+      size_t offset(0);
+      std::tie(target, blockNumber, offset) =
+          _targetFromPosition(position, kBlockSize);
+      size_type count = std::min(n, kBlockSize - offset);
+
+      if (target == rt::thisLocality()) {
+        size_type localBlock = _globlalBlockToLocalBlock(blockNumber);
+        std::copy(values, values + count, &dataBlocks_[localBlock][offset]);
+      } else {
+        count = std::min(count, kMaxWrite);
+        auto payload =
+            Layout::Allocate(count, WriteHeader{oid_, position, count});
+        std::copy(values, values + count,
+                  Layout::template Array<0>(payload.get(), count));
+        rt::asyncExecuteAt(handle, target, writeLambda, payload,
+                           Layout::Bytes(count));
+      }
+
+      values += count;
+      position += count;
+      n -= count;
+    }
+  }
+
+  void _flushPushBackBuffer() {
+    std::vector<value_type> values;
+    {
+      std::lock_guard<rt::Lock> _(pushBackLock_);
+      values.swap(pushBackBuffer_);
+    }
+    if (values.empty()) return;
+    PushBackRange(values.begin(), values.end());
+  }
+
   void _clear() {
     for (auto block : dataBlocks_) {
       for (T *toDestroy = block; toDestroy < block + kBlockSize; ++toDestroy) {
@@ -730,6 +877,8 @@ class Vector : public AbstractDataStructure<Vector<T, Allocator>> {
   size_type capacity_;
   allocator_type allocator_;
   BuffersVector buffers_;
+  std::vector<value_type> pushBackBuffer_;
+  rt::Lock pushBackLock_;
 };
 
 template <typename T, typename Allocator>
@@ -1028,6 +1177,44 @@ void Vector<T, Allocator>::PushBack(
   }
 }
 
+template <typename T, typename Allocator>
+template <typename InputIterator>
+typename Vector<T, Allocator>::size_type Vector<T, Allocator>::PushBackRange(
+    InputIterator begin, InputIterator end) {
+  rt::Handle handle;
+  size_type first = AsyncPushBackRange(handle, begin, end);
+  rt::waitForCompletion(handle);
+  return first;
+}
+
+template <typename T, typename Allocator>
+template <typename InputIterator>
+typename Vector<T, Allocator>::size_type
+Vector<T, Allocator>::AsyncPushBackRange(rt::Handle &handle,
+                                         InputIterator begin,
+                                         InputIterator end) {
+  std::vector<value_type> values(begin, end);
+  if (values.empty()) return Size();
+
+  size_type first = _reserveBack(values.size());
+  _asyncWriteRange(handle, first, values.data(), values.size());
+  return first;
+}
+
+template <typename T, typename Allocator>
+void Vector<T, Allocator>::BufferedPushBack(const value_type &value) {
+  static const size_type kPushBackChunk = kBlockSize;
+
+  std::vector<value_type> values;
+  {
+    std::lock_guard<rt::Lock> _(pushBackLock_);
+    pushBackBuffer_.push_back(value);
+    if (pushBackBuffer_.size() < kPushBackChunk) return;
+    values.swap(pushBackBuffer_);
+  }
+  PushBackRange(values.begin(), values.end());
+}
+
 template <typename T, typename Allocator>
 typename Vector<T, Allocator>::iterator Vector<T, Allocator>::InsertAt(
     Vector<T, Allocator>::size_type position,
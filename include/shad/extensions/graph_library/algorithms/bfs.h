@@ -0,0 +1,450 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_ALGORITHMS_BFS_H_
+#define INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_ALGORITHMS_BFS_H_
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "shad/data_structures/abstract_data_structure.h"
+#include "shad/data_structures/array.h"
+#include "shad/data_structures/batch_utils.h"
+#include "shad/data_structures/buffer.h"
+#include "shad/extensions/graph_library/algorithms/owned_vertices.h"
+#include "shad/runtime/runtime.h"
+
+namespace shad {
+
+/// @brief Per-vertex output of a graph traversal.
+///
+/// Both arrays are indexed by vertex.  Unreached vertices have distance
+/// std::numeric_limits<DistT>::max() and parent
+/// std::numeric_limits<VertexT>::max(); the source is its own parent.
+///
+/// @tparam VertexT The type of the vertices.
+/// @tparam DistT The type of the distances.
+template <typename VertexT, typename DistT>
+struct TraversalResult {
+  typename Array<DistT>::ShadArrayPtr distances;
+  typename Array<VertexT>::ShadArrayPtr parents;
+};
+
+namespace impl {
+
+/// @brief Distributed state of a level-synchronous breadth-first search.
+///
+/// Every Locality keeps a visited bitmap, the levels and parents of its
+/// owned vertices, and the part of the frontier it owns.  Top-down steps
+/// expand the frontier and send visits of remote vertices through
+/// aggregation buffers; bottom-up steps let every unvisited vertex look for
+/// a parent in a replicated frontier bitmap, and need symmetric graphs.
+///
+/// @tparam GraphT The type of the graph, an EdgeIndex.
+template <typename GraphT>
+class BFSState : public AbstractDataStructure<BFSState<GraphT>> {
+  template <typename>
+  friend class shad::AbstractDataStructure;
+
+ public:
+  using VertexT = typename GraphT::SrcType;
+  using ObjectID = typename AbstractDataStructure<BFSState>::ObjectID;
+  using SharedPtr = typename AbstractDataStructure<BFSState>::SharedPtr;
+  static constexpr size_t kUnreached = std::numeric_limits<size_t>::max();
+
+  struct VisitEntry {
+    VertexT vertex;
+    VertexT parent;
+  };
+
+  struct LevelStats {
+    size_t frontierSize;
+    size_t frontierEdges;
+    size_t visitedEdges;
+  };
+
+  ObjectID GetGlobalID() const { return oid_; }
+  typename GraphT::ObjectID GetGraphID() const { return gid_; }
+  size_t NumVertices() const { return numVertices_; }
+
+  /// @brief Visit an owned vertex.
+  /// @return true if the vertex had not been visited.
+  bool Visit(const VertexT &v, const VertexT &parent) {
+    size_t id = vertices_.LocalId(v);
+    if (id == vertices_.Size()) return false;
+    uint64_t mask = uint64_t(1) << (id % 64);
+    if (visited_[id / 64].fetch_or(mask, std::memory_order_relaxed) & mask)
+      return false;
+    levels_[id] = level_ + 1;
+    parents_[id] = parent;
+    return true;
+  }
+
+  /// @brief Level of an owned vertex.
+  size_t Level(const VertexT &v) const {
+    size_t id = vertices_.LocalId(v);
+    return id == vertices_.Size() ? kUnreached : levels_[id];
+  }
+
+  void BufferEntriesInsert(const VisitEntry *entries, size_t numEntries) {
+    std::vector<VertexT> visited;
+    for (size_t i = 0; i < numEntries; ++i)
+      if (Visit(entries[i].vertex, entries[i].parent))
+        visited.push_back(entries[i].vertex);
+    AppendToNext(visited);
+  }
+
+  /// @brief Make an owned vertex the only vertex of the frontier.
+  void Start(const VertexT &src) {
+    size_t id = vertices_.LocalId(src);
+    if (id == vertices_.Size()) return;
+    visited_[id / 64].fetch_or(uint64_t(1) << (id % 64));
+    levels_[id] = 0;
+    parents_[id] = src;
+    current_.assign(1, src);
+  }
+
+  /// @brief Expand the owned part of the frontier.
+  ///
+  /// Visits of remote vertices are completed by FlushVisits().
+  void TopDownStep() {
+    auto localIndex = GraphT::GetPtr(gid_)->GetLocalIndexPtr();
+    size_t numChunks = NumTraversalChunks(current_.size());
+    rt::impl::parallelFor(numChunks, [&](size_t c) {
+      size_t begin = current_.size() * c / numChunks;
+      size_t end = current_.size() * (c + 1) / numChunks;
+      std::vector<VertexT> visited;
+      BFSState *state = this;
+      std::vector<VertexT> *visitedPtr = &visited;
+      for (size_t i = begin; i < end; ++i) {
+        if (localIndex->GetDegree(current_[i]) == 0) continue;
+        localIndex->ForEachNeighbor(current_[i], TopDownVisit, state,
+                                    visitedPtr);
+      }
+      AppendToNext(visited);
+    });
+  }
+
+  void FlushVisits() { buffers_.FlushAll(); }
+
+  /// @brief Clear the replicated frontier bitmap.
+  void ClearFrontierBits() {
+    size_t size = numWords(numVertices_);
+    std::fill(frontierBits_.get(), frontierBits_.get() + size, 0);
+  }
+
+  /// @brief Set the bits of the owned frontier on all Localities.
+  void ShareFrontier() {
+    using Layout = BatchLayout<ObjectID, VertexT>;
+    auto setLambda = [](rt::Handle &, const uint8_t *payload,
+                        const uint32_t size) {
+      size_t count = (size - sizeof(ObjectID)) / sizeof(VertexT);
+      auto ptr = BFSState<GraphT>::GetPtr(Layout::Header(payload));
+      const VertexT *vertices = Layout::template Array<0>(payload, count);
+      for (size_t i = 0; i < count; ++i) {
+        size_t v = vertices[i];
+        ptr->frontierBits_[v / 64].fetch_or(uint64_t(1) << (v % 64),
+                                            std::memory_order_relaxed);
+      }
+    };
+    constexpr size_t kMaxBatchSize = constants::kBufferNumBytes /
+                                     sizeof(VertexT);
+    rt::Handle handle;
+    for (size_t begin = 0; begin < current_.size(); begin += kMaxBatchSize) {
+      size_t count = std::min(kMaxBatchSize, current_.size() - begin);
+      auto payload = Layout::Allocate(count, oid_);
+      std::copy(current_.begin() + begin, current_.begin() + begin + count,
+                Layout::template Array<0>(payload.get(), count));
+      for (auto loc : rt::allLocalities())
+        rt::asyncExecuteAt(handle, loc, setLambda, payload,
+                           Layout::Bytes(count));
+    }
+    rt::waitForCompletion(handle);
+  }
+
+  /// @brief Look for parents of the unvisited owned vertices in the
+  /// replicated frontier bitmap.
+  void BottomUpStep() {
+    auto localIndex = GraphT::GetPtr(gid_)->GetLocalIndexPtr();
+    size_t numChunks = NumTraversalChunks(vertices_.Size());
+    rt::impl::parallelFor(numChunks, [&](size_t c) {
+      size_t begin = vertices_.Size() * c / numChunks;
+      size_t end = vertices_.Size() * (c + 1) / numChunks;
+      std::vector<VertexT> visited;
+      for (size_t id = begin; id < end; ++id) {
+        if (visited_[id / 64].load(std::memory_order_relaxed) &
+            (uint64_t(1) << (id % 64)))
+          continue;
+        const VertexT &v = vertices_.Vertex(id);
+        if (localIndex->GetDegree(v) == 0) continue;
+        std::tuple<BFSState *, VertexT, bool> search(this, v, false);
+        auto searchPtr = &search;
+        localIndex->ForEachNeighbor(v, BottomUpSearch, searchPtr);
+        if (std::get<2>(search) && Visit(v, std::get<1>(search)))
+          visited.push_back(v);
+      }
+      AppendToNext(visited);
+    });
+  }
+
+  /// @brief Move to the next level.
+  /// @return The statistics of the owned part of the new frontier.
+  LevelStats Advance() {
+    auto localIndex = GraphT::GetPtr(gid_)->GetLocalIndexPtr();
+    current_.swap(next_);
+    next_.clear();
+    ++level_;
+    size_t frontierEdges = 0;
+    for (auto &v : current_) frontierEdges += localIndex->GetDegree(v);
+    visitedEdges_ += frontierEdges;
+    return LevelStats{current_.size(), frontierEdges, visitedEdges_};
+  }
+
+  /// @brief Write levels and parents of the owned vertices to the result
+  /// arrays.  The buffers of the Array are per Locality: flush them here.
+  void WriteResults(const typename Array<size_t>::ObjectID &levelsOid,
+                    const typename Array<VertexT>::ObjectID &parentsOid) {
+    auto levelsPtr = Array<size_t>::GetPtr(levelsOid);
+    auto parentsPtr = Array<VertexT>::GetPtr(parentsOid);
+    rt::impl::parallelFor(vertices_.Size(), [&](size_t id) {
+      if (levels_[id] == kUnreached) return;
+      levelsPtr->BufferedInsertAt(vertices_.Vertex(id), levels_[id]);
+      parentsPtr->BufferedInsertAt(vertices_.Vertex(id), parents_[id]);
+    });
+    levelsPtr->WaitForBufferedInsert();
+    parentsPtr->WaitForBufferedInsert();
+  }
+
+ protected:
+  BFSState(ObjectID oid, const typename GraphT::ObjectID &gid,
+           size_t numVertices, bool bottomUp)
+      : oid_(oid),
+        gid_(gid),
+        numVertices_(numVertices),
+        vertices_(numVertices),
+        visited_(new std::atomic<uint64_t>[numWords(vertices_.Size())]),
+        levels_(vertices_.Size(), kUnreached),
+        parents_(vertices_.Size()),
+        buffers_(oid) {
+    std::fill(visited_.get(), visited_.get() + numWords(vertices_.Size()), 0);
+    if (bottomUp)
+      frontierBits_.reset(new std::atomic<uint64_t>[numWords(numVertices)]);
+  }
+
+ private:
+  using BuffersVector = impl::BuffersVector<VisitEntry, BFSState<GraphT>>;
+
+  static size_t numWords(size_t numBits) { return (numBits + 63) / 64; }
+
+  static void TopDownVisit(const VertexT &src, const VertexT &dest,
+                           BFSState *&state,
+                           std::vector<VertexT> *&visited) {
+    uint32_t owner = OwnedVertices<VertexT>::Owner(dest);
+    if (owner == static_cast<uint32_t>(rt::thisLocality())) {
+      if (state->Visit(dest, src)) visited->push_back(dest);
+    } else {
+      state->buffers_.Insert(VisitEntry{dest, src}, rt::Locality(owner));
+    }
+  }
+
+  static void BottomUpSearch(const VertexT &src, const VertexT &dest,
+                             std::tuple<BFSState *, VertexT, bool> *&search) {
+    if (std::get<2>(*search)) return;
+    size_t d = dest;
+    if (d >= std::get<0>(*search)->numVertices_) return;
+    auto &word = std::get<0>(*search)->frontierBits_[d / 64];
+    if (word.load(std::memory_order_relaxed) & (uint64_t(1) << (d % 64))) {
+      std::get<1>(*search) = dest;
+      std::get<2>(*search) = true;
+    }
+  }
+
+  void AppendToNext(const std::vector<VertexT> &visited) {
+    if (visited.empty()) return;
+    std::lock_guard<rt::Lock> lock(nextLock_);
+    next_.insert(next_.end(), visited.begin(), visited.end());
+  }
+
+  ObjectID oid_;
+  typename GraphT::ObjectID gid_;
+  size_t numVertices_;
+  OwnedVertices<VertexT> vertices_;
+  std::unique_ptr<std::atomic<uint64_t>[]> visited_;
+  std::unique_ptr<std::atomic<uint64_t>[]> frontierBits_;
+  std::vector<size_t> levels_;
+  std::vector<VertexT> parents_;
+  std::vector<VertexT> current_;
+  std::vector<VertexT> next_;
+  rt::Lock nextLock_;
+  size_t level_ = 0;
+  size_t visitedEdges_ = 0;
+  BuffersVector buffers_;
+};
+
+/// @brief Run a breadth-first search on a BFSState.
+///
+/// Top-down and bottom-up steps are selected with the heuristic of Beamer
+/// et al., "Direction-Optimizing Breadth-First Search" (SC'12).
+///
+/// @param state The state of the search.
+/// @param src The source vertex.
+/// @param symmetric true if bottom-up steps can be used.
+/// @param target If not null, the search stops at the level of the target.
+template <typename GraphT>
+void RunBFS(const typename BFSState<GraphT>::SharedPtr &state,
+            const typename GraphT::SrcType &src, bool symmetric,
+            const typename GraphT::SrcType *target) {
+  using StateT = BFSState<GraphT>;
+  using VertexT = typename GraphT::SrcType;
+  using ObjectID = typename StateT::ObjectID;
+  using LevelStats = typename StateT::LevelStats;
+  constexpr size_t kAlpha = 14;
+  constexpr size_t kBeta = 24;
+
+  auto graph = GraphT::GetPtr(state->GetGraphID());
+  ObjectID oid = state->GetGlobalID();
+  rt::executeAt(rt::Locality(OwnedVertices<VertexT>::Owner(src)),
+                [](const std::tuple<ObjectID, VertexT> &args) {
+                  StateT::GetPtr(std::get<0>(args))->Start(std::get<1>(args));
+                },
+                std::make_tuple(oid, src));
+
+  size_t numEdges = graph->NumEdges();
+  size_t srcDegree = graph->GetDegree(src);
+  LevelStats stats{1, srcDegree, srcDegree};
+  bool bottomUp = false;
+  while (stats.frontierSize != 0) {
+    if (target != nullptr) {
+      size_t level = StateT::kUnreached;
+      rt::executeAtWithRet(
+          rt::Locality(OwnedVertices<VertexT>::Owner(*target)),
+          [](const std::tuple<ObjectID, VertexT> &args, size_t *level) {
+            auto ptr = StateT::GetPtr(std::get<0>(args));
+            *level = ptr->Level(std::get<1>(args));
+          },
+          std::make_tuple(oid, *target), &level);
+      if (level != StateT::kUnreached) return;
+    }
+
+    if (symmetric) {
+      if (!bottomUp &&
+          stats.frontierEdges > (numEdges - stats.visitedEdges) / kAlpha)
+        bottomUp = true;
+      else if (bottomUp && stats.frontierSize < state->NumVertices() / kBeta)
+        bottomUp = false;
+    }
+
+    if (bottomUp) {
+      rt::executeOnAll(
+          [](const ObjectID &oid) { StateT::GetPtr(oid)->ClearFrontierBits(); },
+          oid);
+      rt::executeOnAll(
+          [](const ObjectID &oid) { StateT::GetPtr(oid)->ShareFrontier(); },
+          oid);
+      rt::executeOnAll(
+          [](const ObjectID &oid) { StateT::GetPtr(oid)->BottomUpStep(); },
+          oid);
+    } else {
+      rt::executeOnAll(
+          [](const ObjectID &oid) { StateT::GetPtr(oid)->TopDownStep(); },
+          oid);
+      rt::executeOnAll(
+          [](const ObjectID &oid) { StateT::GetPtr(oid)->FlushVisits(); },
+          oid);
+    }
+
+    std::vector<LevelStats> localStats(rt::numLocalities());
+    rt::Handle handle;
+    for (auto loc : rt::allLocalities())
+      rt::asyncExecuteAtWithRet(
+          handle, loc,
+          [](rt::Handle &, const ObjectID &oid, LevelStats *res) {
+            *res = StateT::GetPtr(oid)->Advance();
+          },
+          oid, &localStats[static_cast<uint32_t>(loc)]);
+    rt::waitForCompletion(handle);
+    stats = LevelStats{0, 0, 0};
+    for (auto &s : localStats) {
+      stats.frontierSize += s.frontierSize;
+      stats.frontierEdges += s.frontierEdges;
+      stats.visitedEdges += s.visitedEdges;
+    }
+  }
+}
+
+}  // namespace impl
+
+/// @brief Breadth-first search.
+///
+/// The search is level-synchronous and direction-optimizing: when the
+/// frontier is large, unvisited vertices look for a parent in the frontier
+/// (bottom-up) instead of the frontier visiting its neighbors (top-down).
+/// Bottom-up steps are only correct on symmetric graphs, where every edge
+/// is stored in both directions.
+///
+/// @tparam GraphT The type of the graph, an EdgeIndex whose vertices are
+/// integral identifiers in [0, numVertices).
+/// @param gid The ObjectID of the graph.
+/// @param src The source vertex.
+/// @param numVertices The number of vertices of the graph.
+/// @param symmetric true if the graph is symmetric.
+/// @return The level (distance from src) and BFS tree parent of every
+/// vertex.  The arrays are owned by the caller.
+/// @throws std::invalid_argument if the graph has split vertices.
+template <typename GraphT>
+TraversalResult<typename GraphT::SrcType, size_t> BFS(
+    typename GraphT::ObjectID gid, const typename GraphT::SrcType &src,
+    size_t numVertices, bool symmetric = false) {
+  using VertexT = typename GraphT::SrcType;
+  using StateT = impl::BFSState<GraphT>;
+  if (GraphT::GetPtr(gid)->HasSplitVertices())
+    throw std::invalid_argument("split vertices are not supported");
+  auto state = StateT::Create(gid, numVertices, symmetric);
+  impl::RunBFS<GraphT>(state, src, symmetric, nullptr);
+
+  TraversalResult<VertexT, size_t> result;
+  result.distances = Array<size_t>::Create(numVertices, StateT::kUnreached);
+  result.parents = Array<VertexT>::Create(
+      numVertices, std::numeric_limits<VertexT>::max());
+  rt::executeOnAll(
+      [](const std::tuple<typename StateT::ObjectID,
+                          typename Array<size_t>::ObjectID,
+                          typename Array<VertexT>::ObjectID> &args) {
+        StateT::GetPtr(std::get<0>(args))
+            ->WriteResults(std::get<1>(args), std::get<2>(args));
+      },
+      std::make_tuple(state->GetGlobalID(), result.distances->GetGlobalID(),
+                      result.parents->GetGlobalID()));
+  StateT::Destroy(state->GetGlobalID());
+  return result;
+}
+
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_ALGORITHMS_BFS_H_
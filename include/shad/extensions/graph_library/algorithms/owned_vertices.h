@@ -0,0 +1,103 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+
+#ifndef INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_ALGORITHMS_OWNED_VERTICES_H_
+#define INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_ALGORITHMS_OWNED_VERTICES_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "shad/data_structures/batch_utils.h"
+#include "shad/data_structures/compare_and_hash_utils.h"
+#include "shad/runtime/runtime.h"
+
+namespace shad {
+namespace impl {
+
+/// @brief Dense numbering of the vertices owned by this Locality.
+///
+/// Vertices are owned by the Locality shad::hash<VertexT>{}(v) %
+/// rt::numLocalities(), as in the EdgeIndex, and numbered in increasing
+/// order.
+///
+/// @tparam VertexT The type of the vertices, an integral type.
+template <typename VertexT>
+class OwnedVertices {
+ public:
+  /// @brief Number the vertices of [0, numVertices) owned by this Locality.
+  explicit OwnedVertices(size_t numVertices) {
+    constexpr size_t kChunkSize = 1 << 16;
+    size_t numChunks = (numVertices + kChunkSize - 1) / kChunkSize;
+    std::vector<size_t> offsets(numChunks + 1, 0);
+    uint32_t thisLocality = static_cast<uint32_t>(rt::thisLocality());
+    rt::impl::parallelFor(numChunks, [&](size_t c) {
+      size_t end = std::min(numVertices, (c + 1) * kChunkSize);
+      for (size_t v = c * kChunkSize; v < end; ++v)
+        if (Owner(VertexT(v)) == thisLocality) ++offsets[c + 1];
+    });
+    for (size_t c = 0; c < numChunks; ++c) offsets[c + 1] += offsets[c];
+    vertices_.resize(offsets[numChunks]);
+    rt::impl::parallelFor(numChunks, [&](size_t c) {
+      size_t end = std::min(numVertices, (c + 1) * kChunkSize);
+      size_t pos = offsets[c];
+      for (size_t v = c * kChunkSize; v < end; ++v)
+        if (Owner(VertexT(v)) == thisLocality) vertices_[pos++] = v;
+    });
+  }
+
+  /// @brief The Locality owning a vertex.
+  static uint32_t Owner(const VertexT &v) {
+    return shad::hash<VertexT>{}(v) % rt::numLocalities();
+  }
+
+  size_t Size() const { return vertices_.size(); }
+
+  /// @brief The local number of an owned vertex.
+  /// @return Size() if v is not an owned vertex of [0, numVertices).
+  size_t LocalId(const VertexT &v) const {
+    auto it = std::lower_bound(vertices_.begin(), vertices_.end(), v);
+    if (it == vertices_.end() || *it != v) return vertices_.size();
+    return it - vertices_.begin();
+  }
+
+  /// @brief The owned vertex with a given local number.
+  const VertexT &Vertex(size_t id) const { return vertices_[id]; }
+
+ private:
+  std::vector<VertexT> vertices_;
+};
+
+/// @brief Number of parallel chunks used to process numItems items.
+inline size_t NumTraversalChunks(size_t numItems) {
+  constexpr size_t kChunksPerThread = 4;
+  return std::min(numItems,
+                  kChunksPerThread * size_t(rt::impl::getConcurrency()));
+}
+
+}  // namespace impl
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_ALGORITHMS_OWNED_VERTICES_H_
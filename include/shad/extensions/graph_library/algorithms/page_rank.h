@@ -0,0 +1,417 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+
+#ifndef INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_ALGORITHMS_PAGE_RANK_H_
+#define INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_ALGORITHMS_PAGE_RANK_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "shad/data_structures/abstract_data_structure.h"
+#include "shad/data_structures/array.h"
+#include "shad/data_structures/batch_utils.h"
+#include "shad/data_structures/buffer.h"
+#include "shad/extensions/graph_library/algorithms/owned_vertices.h"
+#include "shad/runtime/runtime.h"
+
+namespace shad {
+namespace impl {
+
+/// @brief Distributed state of a PageRank computation.
+///
+/// Every Locality owns the scores of its vertices.  At setup, the
+/// destinations of the local edges owned by every other Locality are
+/// collected in a ghost list, registered once with the owner.  Every
+/// iteration then pulls the contributions of the local sources into one
+/// slot per ghost, and ships the combined slots to the owners, so the number
+/// of messages does not depend on the number of edges.
+///
+/// @tparam GraphT The type of the graph, an EdgeIndex.
+template <typename GraphT>
+class PageRankState : public AbstractDataStructure<PageRankState<GraphT>> {
+  template <typename>
+  friend class shad::AbstractDataStructure;
+
+ public:
+  using VertexT = typename GraphT::SrcType;
+  using ObjectID = typename AbstractDataStructure<PageRankState>::ObjectID;
+  using SharedPtr = typename AbstractDataStructure<PageRankState>::SharedPtr;
+
+  ObjectID GetGlobalID() const { return oid_; }
+
+  /// @brief Collect the local edges and build the pull lists.
+  void Build() {
+    auto localIndex = GraphT::GetPtr(gid_)->GetLocalIndexPtr();
+    std::vector<std::pair<VertexT, VertexT>> edges(
+        localIndex->UpdateNumEdges());
+    std::atomic<size_t> numEdges(0);
+    auto edgesPtr = edges.data();
+    auto numEdgesPtr = &numEdges;
+    localIndex->ForEachEdge(
+        [](const VertexT &src, const VertexT &dest,
+           std::pair<VertexT, VertexT> *&edges,
+           std::atomic<size_t> *&numEdges) {
+          edges[numEdges->fetch_add(1, std::memory_order_relaxed)] = {dest,
+                                                                     src};
+        },
+        edgesPtr, numEdgesPtr);
+    edges.resize(numEdges.load());
+
+    rt::impl::parallelFor(vertices_.Size(), [&](size_t id) {
+      outDegree_[id] = localIndex->GetDegree(vertices_.Vertex(id));
+    });
+
+    // Group the edges by owner of the destination, then by destination.
+    uint32_t numLocalities = rt::numLocalities();
+    using EdgeT = std::pair<VertexT, VertexT>;
+    std::sort(edges.begin(), edges.end(),
+              [](const EdgeT &a, const EdgeT &b) {
+                uint32_t ownerA = OwnedVertices<VertexT>::Owner(a.first);
+                uint32_t ownerB = OwnedVertices<VertexT>::Owner(b.first);
+                return std::tie(ownerA, a.first) < std::tie(ownerB, b.first);
+              });
+    auto edge = edges.begin();
+    for (uint32_t t = 0; t < numLocalities; ++t) {
+      PullLists &lists = pullLists_[t];
+      lists.offsets.assign(1, 0);
+      for (; edge != edges.end() &&
+             OwnedVertices<VertexT>::Owner(edge->first) == t;
+           ++edge) {
+        if (lists.slots.empty() || lists.slots.back() != edge->first) {
+          if (!lists.slots.empty()) lists.offsets.push_back(lists.srcs.size());
+          lists.slots.push_back(edge->first);
+        }
+        size_t srcId = vertices_.LocalId(edge->second);
+        if (srcId != vertices_.Size()) lists.srcs.push_back(srcId);
+      }
+      lists.offsets.push_back(lists.srcs.size());
+      if (lists.slots.empty()) lists.offsets.assign(1, 0);
+      outgoing_[t].assign(lists.slots.size(), 0);
+    }
+  }
+
+  /// @brief Register the ghost lists with their owners.
+  ///
+  /// The owners translate ghosts to local identifiers once.
+  void RegisterGhosts() {
+    uint32_t thisLocality = static_cast<uint32_t>(rt::thisLocality());
+    rt::Handle handle;
+    for (uint32_t t = 0; t < rt::numLocalities(); ++t) {
+      if (t == thisLocality) continue;
+      rt::executeAt(rt::Locality(t),
+                    [](const std::tuple<ObjectID, uint32_t, size_t> &args) {
+                      PageRankState<GraphT>::GetPtr(std::get<0>(args))
+                          ->ResizeGhosts(std::get<1>(args), std::get<2>(args));
+                    },
+                    std::make_tuple(oid_, thisLocality,
+                                    pullLists_[t].slots.size()));
+      SendChunks(handle, t, pullLists_[t].slots, RegisterChunk);
+    }
+    rt::waitForCompletion(handle);
+  }
+
+  /// @brief Size the receive slots of the ghosts of Locality source.
+  void ResizeGhosts(uint32_t source, size_t numGhosts) {
+    ghostIds_[source].resize(numGhosts);
+    incoming_[source].resize(numGhosts);
+  }
+
+  /// @brief Make an owned vertex a seed of personalized PageRank.
+  void AddSeed(const VertexT &v) {
+    size_t id = vertices_.LocalId(v);
+    if (id != vertices_.Size()) teleport_[id] = 1.0 / numSeeds_;
+  }
+
+  /// @brief Initialize the scores with the teleport distribution.
+  void Initialize() { scores_ = teleport_; }
+
+  /// @brief Compute and ship the contributions of the owned vertices.
+  /// @return The mass of the owned dangling vertices.
+  double Scatter() {
+    double dangling = 0;
+    for (size_t id = 0; id < vertices_.Size(); ++id) {
+      if (outDegree_[id] == 0)
+        dangling += scores_[id];
+      else
+        contributions_[id] = scores_[id] / outDegree_[id];
+    }
+
+    uint32_t thisLocality = static_cast<uint32_t>(rt::thisLocality());
+    for (uint32_t t = 0; t < rt::numLocalities(); ++t) {
+      const PullLists &lists = pullLists_[t];
+      std::vector<double> &sums = outgoing_[t];
+      rt::impl::parallelFor(lists.slots.size(), [&](size_t slot) {
+        double sum = 0;
+        for (size_t i = lists.offsets[slot]; i < lists.offsets[slot + 1]; ++i)
+          sum += contributions_[lists.srcs[i]];
+        sums[slot] = sum;
+      });
+    }
+
+    rt::Handle handle;
+    for (uint32_t t = 0; t < rt::numLocalities(); ++t)
+      if (t != thisLocality)
+        SendChunks(handle, t, outgoing_[t], ContributionsChunk);
+    rt::waitForCompletion(handle);
+    return dangling;
+  }
+
+  /// @brief Update the scores of the owned vertices.
+  /// @return The L1 norm of the update.
+  double Update(double dangling) {
+    uint32_t thisLocality = static_cast<uint32_t>(rt::thisLocality());
+    std::fill(sums_.begin(), sums_.end(), 0);
+    const PullLists &lists = pullLists_[thisLocality];
+    const std::vector<double> &local = outgoing_[thisLocality];
+    rt::impl::parallelFor(lists.slots.size(), [&](size_t slot) {
+      size_t id = vertices_.LocalId(lists.slots[slot]);
+      if (id != vertices_.Size()) sums_[id] += local[slot];
+    });
+    // Ghosts of the same source are distinct vertices.
+    for (uint32_t s = 0; s < rt::numLocalities(); ++s) {
+      if (s == thisLocality) continue;
+      rt::impl::parallelFor(ghostIds_[s].size(), [&](size_t slot) {
+        if (ghostIds_[s][slot] != vertices_.Size())
+          sums_[ghostIds_[s][slot]] += incoming_[s][slot];
+      });
+    }
+
+    double diff = 0;
+    for (size_t id = 0; id < vertices_.Size(); ++id) {
+      double score = (1 - damping_) * teleport_[id] +
+                     damping_ * (sums_[id] + dangling * teleport_[id]);
+      diff += std::fabs(score - scores_[id]);
+      scores_[id] = score;
+    }
+    return diff;
+  }
+
+  /// @brief Write the scores of the owned vertices to the result array.
+  /// The buffers of the Array are per Locality: flush them here.
+  void WriteResults(const typename Array<double>::ObjectID &scoresOid) {
+    auto scoresPtr = Array<double>::GetPtr(scoresOid);
+    rt::impl::parallelFor(vertices_.Size(), [&](size_t id) {
+      scoresPtr->BufferedInsertAt(vertices_.Vertex(id), scores_[id]);
+    });
+    scoresPtr->WaitForBufferedInsert();
+  }
+
+ protected:
+  PageRankState(ObjectID oid, const typename GraphT::ObjectID &gid,
+                size_t numVertices, double damping, size_t numSeeds)
+      : oid_(oid),
+        gid_(gid),
+        damping_(damping),
+        numSeeds_(numSeeds),
+        vertices_(numVertices),
+        outDegree_(vertices_.Size()),
+        teleport_(vertices_.Size(), numSeeds == 0 ? 1.0 / numVertices : 0),
+        contributions_(vertices_.Size()),
+        sums_(vertices_.Size()),
+        pullLists_(rt::numLocalities()),
+        outgoing_(rt::numLocalities()),
+        ghostIds_(rt::numLocalities()),
+        incoming_(rt::numLocalities()) {}
+
+ private:
+  /// @brief Local sources of the edges to every slot of a destination
+  /// Locality, in CSR form.
+  struct PullLists {
+    std::vector<VertexT> slots;
+    std::vector<size_t> offsets;
+    std::vector<size_t> srcs;
+  };
+
+  struct ChunkHeader {
+    ObjectID oid;
+    uint32_t source;
+    size_t offset;
+    size_t count;
+  };
+
+  template <typename T>
+  using ChunkLayout = BatchLayout<ChunkHeader, T>;
+
+  template <typename T>
+  void SendChunks(rt::Handle &handle, uint32_t target,
+                  const std::vector<T> &values,
+                  void (*function)(rt::Handle &, const uint8_t *,
+                                   const uint32_t)) {
+    using Layout = ChunkLayout<T>;
+    constexpr size_t kChunkSize =
+        constants::max(constants::kBufferNumBytes / sizeof(T), 1lu);
+    uint32_t thisLocality = static_cast<uint32_t>(rt::thisLocality());
+    for (size_t offset = 0; offset < values.size(); offset += kChunkSize) {
+      size_t count = std::min(kChunkSize, values.size() - offset);
+      auto payload = Layout::Allocate(
+          count, ChunkHeader{oid_, thisLocality, offset, count});
+      std::copy(values.begin() + offset, values.begin() + offset + count,
+                Layout::template Array<0>(payload.get(), count));
+      rt::asyncExecuteAt(handle, rt::Locality(target), function, payload,
+                         Layout::Bytes(count));
+    }
+  }
+
+  static void RegisterChunk(rt::Handle &, const uint8_t *payload,
+                            const uint32_t) {
+    using Layout = ChunkLayout<VertexT>;
+    const ChunkHeader &header = Layout::Header(payload);
+    const VertexT *ghosts = Layout::template Array<0>(payload, header.count);
+    auto ptr = PageRankState<GraphT>::GetPtr(header.oid);
+    std::vector<size_t> &ids = ptr->ghostIds_[header.source];
+    for (size_t i = 0; i < header.count; ++i)
+      ids[header.offset + i] = ptr->vertices_.LocalId(ghosts[i]);
+  }
+
+  static void ContributionsChunk(rt::Handle &, const uint8_t *payload,
+                                 const uint32_t) {
+    using Layout = ChunkLayout<double>;
+    const ChunkHeader &header = Layout::Header(payload);
+    const double *values = Layout::template Array<0>(payload, header.count);
+    auto ptr = PageRankState<GraphT>::GetPtr(header.oid);
+    std::copy(values, values + header.count,
+              ptr->incoming_[header.source].begin() + header.offset);
+  }
+
+  ObjectID oid_;
+  typename GraphT::ObjectID gid_;
+  double damping_;
+  size_t numSeeds_;
+  OwnedVertices<VertexT> vertices_;
+  std::vector<size_t> outDegree_;
+  std::vector<double> teleport_;
+  std::vector<double> scores_;
+  std::vector<double> contributions_;
+  std::vector<double> sums_;
+  std::vector<PullLists> pullLists_;
+  std::vector<std::vector<double>> outgoing_;
+  std::vector<std::vector<size_t>> ghostIds_;
+  std::vector<std::vector<double>> incoming_;
+};
+
+}  // namespace impl
+
+/// @brief Distributed PageRank.
+///
+/// The computation is synchronous: every iteration, each Locality pulls the
+/// contributions of its sources into one value per destination vertex and
+/// ships the combined values to the owners of the destinations, so each
+/// iteration costs O(numLocalities) aggregated messages rather than one
+/// message per edge.  The mass of dangling vertices is redistributed with
+/// the teleport distribution.
+///
+/// @tparam GraphT The type of the graph, an EdgeIndex whose vertices are
+/// integral identifiers in [0, numVertices).
+/// @param gid The ObjectID of the graph.
+/// @param numVertices The number of vertices of the graph.
+/// @param damping The damping factor.
+/// @param maxIterations The maximum number of iterations.
+/// @param epsilon The computation stops when the L1 norm of the update of
+/// the scores is below epsilon.
+/// @param seeds The seeds of personalized PageRank; teleports are uniform
+/// over all the vertices when empty.
+/// @return The score of every vertex.  The array is owned by the caller.
+/// @throws std::invalid_argument if the graph has split vertices.
+template <typename GraphT>
+typename Array<double>::ShadArrayPtr PageRank(
+    typename GraphT::ObjectID gid, size_t numVertices, double damping = 0.85,
+    size_t maxIterations = 20, double epsilon = 1e-6,
+    const std::vector<typename GraphT::SrcType> &seeds = {}) {
+  using VertexT = typename GraphT::SrcType;
+  using StateT = impl::PageRankState<GraphT>;
+  using ObjectID = typename StateT::ObjectID;
+  if (GraphT::GetPtr(gid)->HasSplitVertices())
+    throw std::invalid_argument("split vertices are not supported");
+
+  std::vector<VertexT> uniqueSeeds(seeds);
+  std::sort(uniqueSeeds.begin(), uniqueSeeds.end());
+  uniqueSeeds.erase(std::unique(uniqueSeeds.begin(), uniqueSeeds.end()),
+                    uniqueSeeds.end());
+  auto state = StateT::Create(gid, numVertices, damping, uniqueSeeds.size());
+  ObjectID oid = state->GetGlobalID();
+  rt::executeOnAll([](const ObjectID &oid) { StateT::GetPtr(oid)->Build(); },
+                   oid);
+  rt::executeOnAll(
+      [](const ObjectID &oid) { StateT::GetPtr(oid)->RegisterGhosts(); }, oid);
+  for (auto &seed : uniqueSeeds)
+    rt::executeAt(rt::Locality(impl::OwnedVertices<VertexT>::Owner(seed)),
+                  [](const std::tuple<ObjectID, VertexT> &args) {
+                    StateT::GetPtr(std::get<0>(args))
+                        ->AddSeed(std::get<1>(args));
+                  },
+                  std::make_tuple(oid, seed));
+  rt::executeOnAll(
+      [](const ObjectID &oid) { StateT::GetPtr(oid)->Initialize(); }, oid);
+
+  auto reduce = [&oid](void (*function)(rt::Handle &,
+                                        const std::tuple<ObjectID, double> &,
+                                        double *),
+                       double arg) {
+    std::vector<double> results(rt::numLocalities());
+    rt::Handle handle;
+    for (auto loc : rt::allLocalities())
+      rt::asyncExecuteAtWithRet(handle, loc, function,
+                                std::make_tuple(oid, arg),
+                                &results[static_cast<uint32_t>(loc)]);
+    rt::waitForCompletion(handle);
+    double sum = 0;
+    for (auto result : results) sum += result;
+    return sum;
+  };
+
+  for (size_t iteration = 0; iteration < maxIterations; ++iteration) {
+    double dangling = reduce(
+        [](rt::Handle &, const std::tuple<ObjectID, double> &args,
+           double *res) {
+          *res = StateT::GetPtr(std::get<0>(args))->Scatter();
+        },
+        0);
+    double diff = reduce(
+        [](rt::Handle &, const std::tuple<ObjectID, double> &args,
+           double *res) {
+          *res = StateT::GetPtr(std::get<0>(args))->Update(std::get<1>(args));
+        },
+        dangling);
+    if (diff < epsilon) break;
+  }
+
+  auto scores = Array<double>::Create(numVertices, 0.0);
+  rt::executeOnAll(
+      [](const std::tuple<ObjectID, typename Array<double>::ObjectID> &args) {
+        StateT::GetPtr(std::get<0>(args))->WriteResults(std::get<1>(args));
+      },
+      std::make_tuple(oid, scores->GetGlobalID()));
+  StateT::Destroy(oid);
+  return scores;
+}
+
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_ALGORITHMS_PAGE_RANK_H_
@@ -22,115 +22,405 @@
 //
 //===----------------------------------------------------------------------===//
 
+
 #ifndef INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_ALGORITHMS_SSSP_H_
 #define INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_ALGORITHMS_SSSP_H_
 
-#include <atomic>
-#include <fstream>
-#include <iostream>
-#include <sstream>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
 #include <utility>
+#include <vector>
 
+#include "shad/data_structures/abstract_data_structure.h"
 #include "shad/data_structures/array.h"
-#include "shad/data_structures/set.h"
-#include "shad/extensions/graph_library/edge_index.h"
+#include "shad/data_structures/batch_utils.h"
+#include "shad/data_structures/buffer.h"
+#include "shad/extensions/graph_library/algorithms/bfs.h"
 #include "shad/runtime/runtime.h"
-#include "shad/util/measure.h"
 
-/// @brief Length of the shortest path between two vertices.
+namespace shad {
+
+/// @brief Destination of a weighted edge.
 ///
-/// @tparam GraphT Graph Type.
-/// @tparam VertexT VertexType.
-/// @param gid ObjectID of the graph.
-/// @param src The source vertex.
-/// @param dest The destination vertex.
-/// @return The length of the shortest path between two vertices if any;
-///         returns numeric limits'infinity if no path is found.
+/// Weighted graphs are EdgeIndex<VertexT, WeightedEdge<VertexT, WeightT>>.
 ///
-template <typename GraphT, typename VertexT>
-size_t sssp_length(typename GraphT::ObjectID gid, VertexT src, VertexT dest);
+/// @tparam VertexT The type of the vertices.
+/// @tparam WeightT The type of the weights, an arithmetic type.
+/// @warning Neighbors are compared byte-wise, so the struct must not have
+/// padding (e.g., uint64_t vertices with float weights).
+template <typename VertexT, typename WeightT>
+struct WeightedEdge {
+  using VertexType = VertexT;
+  using WeightType = WeightT;
 
-template <typename GraphT, typename VertexT>
-void __sssp_neigh_iter(shad::rt::Handle &handle, const VertexT &src,
-                       const VertexT &dest,
-                       typename shad::Set<VertexT>::ObjectID &qnextID,
-                       // visited will be embedded in the graph
-                       shad::Array<bool>::ObjectID &visitedID,
-                       shad::Array<bool>::ObjectID &foundID, VertexT &target) {
-  auto visitedPtr = shad::Array<bool>::GetPtr(visitedID);
-  if (visitedPtr->At(dest) == true) return;
-  if (dest == target) {
-    bool sol_found = true;
-    auto foundPtr = shad::Array<bool>::GetPtr(foundID);
-    foundPtr->InsertAt(0, sol_found);
-    return;
+  VertexT vertex;
+  WeightT weight;
+};
+
+namespace impl {
+
+/// @brief Distributed state of a delta-stepping single-source shortest
+/// paths computation.
+///
+/// Every Locality keeps the tentative distances and parents of its owned
+/// vertices and their buckets of width delta.  Relaxations of remote
+/// vertices go through aggregation buffers.
+///
+/// @tparam GraphT The type of the graph, an EdgeIndex of WeightedEdge.
+template <typename GraphT>
+class DeltaSteppingState
+    : public AbstractDataStructure<DeltaSteppingState<GraphT>> {
+  template <typename>
+  friend class shad::AbstractDataStructure;
+
+ public:
+  using VertexT = typename GraphT::SrcType;
+  using WeightT = typename GraphT::DestType::WeightType;
+  using ObjectID = typename AbstractDataStructure<DeltaSteppingState>::ObjectID;
+  using SharedPtr =
+      typename AbstractDataStructure<DeltaSteppingState>::SharedPtr;
+  static constexpr size_t kNoBucket = std::numeric_limits<size_t>::max();
+  static constexpr WeightT kInfinity = std::numeric_limits<WeightT>::max();
+
+  struct RelaxEntry {
+    VertexT vertex;
+    VertexT parent;
+    WeightT distance;
+  };
+
+  ObjectID GetGlobalID() const { return oid_; }
+
+  void BufferEntriesInsert(const RelaxEntry *entries, size_t numEntries) {
+    std::vector<std::pair<size_t, VertexT>> updates;
+    for (size_t i = 0; i < numEntries; ++i)
+      Relax(entries[i].vertex, entries[i].parent, entries[i].distance,
+            &updates);
+    AddToBuckets(updates);
   }
-  auto qnextPtr = shad::Set<VertexT>::GetPtr(qnextID);
-  qnextPtr->Insert(dest);
-  bool dest_visited = true;
-  visitedPtr->InsertAt(dest, dest_visited);
-}
 
-template <typename GraphT, typename VertexT>
-void __sssp_iteration(shad::rt::Handle &handle, const size_t &curr_vertex,
-                      typename GraphT::ObjectID &gid,
-                      typename shad::Set<VertexT>::ObjectID &qnextID,
-                      shad::Array<bool>::ObjectID &visitedID,
-                      shad::Array<bool>::ObjectID &foundID, size_t &target) {
-  auto graphPtr = GraphT::GetPtr(gid);
-  graphPtr->AsyncForEachNeighbor(handle, curr_vertex,
-                                 __sssp_neigh_iter<GraphT, VertexT>, qnextID,
-                                 visitedID, foundID, target);
-}
+  /// @brief Make an owned vertex the source.
+  void Start(const VertexT &src) {
+    std::vector<std::pair<size_t, VertexT>> updates;
+    Relax(src, src, WeightT(0), &updates);
+    AddToBuckets(updates);
+  }
 
-template <typename GraphT, typename VertexT>
-size_t __sssp_length(  // GraphT::SharedPtr gPtr,
-    typename GraphT::ObjectID gid, size_t num_vertices,
-    typename shad::Set<VertexT>::SharedPtr to_visit_0,
-    typename shad::Set<VertexT>::SharedPtr to_visit_1,
-    shad::Array<bool>::SharedPtr visitedPtr,
-    shad::Array<bool>::SharedPtr foundPtr, VertexT src, VertexT dest) {
-  if (src == dest) return 0;
-  size_t level = 0;
-  shad::Set<size_t>::ShadSetPtr qPtr, nextqPtr;
-  qPtr = to_visit_0;
-  nextqPtr = to_visit_1;
-
-  qPtr->Insert(src);
-  bool v = true;
-  visitedPtr->InsertAt(src, v);
-  auto visitedID = visitedPtr->GetGlobalID();
-  auto foundID = foundPtr->GetGlobalID();
-  shad::rt::Handle handle;
-  while (qPtr->Size()) {
-    auto nextID = nextqPtr->GetGlobalID();
-    qPtr->AsyncForEachElement(handle, __sssp_iteration<GraphT, VertexT>, gid,
-                              nextID, visitedID, foundID, dest);
-    shad::rt::waitForCompletion(handle);
-    // check solution
-    ++level;
-    if (foundPtr->At(0)) return level;
-    // prepare for next round
-    qPtr->Reset(num_vertices / 2);
-    qPtr.swap(nextqPtr);
+  /// @brief Index of the first non-empty owned bucket.
+  size_t MinBucket() {
+    std::lock_guard<rt::Lock> lock(bucketsLock_);
+    return buckets_.empty() ? kNoBucket : buckets_.begin()->first;
+  }
+
+  /// @brief Whether an owned bucket is non-empty.
+  bool HasBucket(size_t bucket) {
+    std::lock_guard<rt::Lock> lock(bucketsLock_);
+    return buckets_.count(bucket) != 0;
+  }
+
+  /// @brief Empty a bucket, relaxing the light edges of its vertices.
+  ///
+  /// Relaxations of remote vertices are completed by FlushRelaxations().
+  void LightStep(size_t bucket) {
+    std::vector<VertexT> vertices;
+    {
+      std::lock_guard<rt::Lock> lock(bucketsLock_);
+      auto it = buckets_.find(bucket);
+      if (it == buckets_.end()) return;
+      vertices.swap(it->second);
+      buckets_.erase(it);
+    }
+
+    // Skip duplicates and stale entries, whose distance has moved to a
+    // lower bucket.
+    std::sort(vertices.begin(), vertices.end());
+    vertices.erase(std::unique(vertices.begin(), vertices.end()),
+                   vertices.end());
+    auto last = std::remove_if(
+        vertices.begin(), vertices.end(), [&](const VertexT &v) {
+          return BucketOf(Distance(vertices_.LocalId(v))) != bucket;
+        });
+    vertices.erase(last, vertices.end());
+    for (auto &v : vertices) {
+      size_t id = vertices_.LocalId(v);
+      if (settledBucket_[id] == bucket) continue;
+      settledBucket_[id] = bucket;
+      settled_.push_back(v);
+    }
+    RelaxEdges(vertices, true);
+  }
+
+  /// @brief Relax the heavy edges of the vertices removed from the current
+  /// bucket.
+  void HeavyStep() {
+    RelaxEdges(settled_, false);
+    settled_.clear();
+  }
+
+  void FlushRelaxations() { buffers_.FlushAll(); }
+
+  /// @brief Write distances and parents of the owned vertices to the result
+  /// arrays.  The buffers of the Array are per Locality: flush them here.
+  void WriteResults(const typename Array<WeightT>::ObjectID &distancesOid,
+                    const typename Array<VertexT>::ObjectID &parentsOid) {
+    auto distancesPtr = Array<WeightT>::GetPtr(distancesOid);
+    auto parentsPtr = Array<VertexT>::GetPtr(parentsOid);
+    rt::impl::parallelFor(vertices_.Size(), [&](size_t id) {
+      if (distances_[id] == kInfinity) return;
+      distancesPtr->BufferedInsertAt(vertices_.Vertex(id), distances_[id]);
+      parentsPtr->BufferedInsertAt(vertices_.Vertex(id), parents_[id]);
+    });
+    distancesPtr->WaitForBufferedInsert();
+    parentsPtr->WaitForBufferedInsert();
+  }
+
+ protected:
+  DeltaSteppingState(ObjectID oid, const typename GraphT::ObjectID &gid,
+                     size_t numVertices, WeightT delta)
+      : oid_(oid),
+        gid_(gid),
+        delta_(delta),
+        vertices_(numVertices),
+        distances_(vertices_.Size(), kInfinity),
+        parents_(vertices_.Size()),
+        settledBucket_(vertices_.Size(), kNoBucket),
+        locks_(new rt::Lock[kNumLocks]),
+        buffers_(oid) {}
+
+ private:
+  using EdgeT = typename GraphT::DestType;
+  using BuffersVector =
+      impl::BuffersVector<RelaxEntry, DeltaSteppingState<GraphT>>;
+  using Updates = std::vector<std::pair<size_t, VertexT>>;
+  static constexpr size_t kNumLocks = 1024;
+
+  struct RelaxContext {
+    DeltaSteppingState *state;
+    WeightT distance;
+    bool light;
+    Updates *updates;
+  };
+
+  size_t BucketOf(WeightT distance) const {
+    if (distance == kInfinity) return kNoBucket;
+    return static_cast<size_t>(distance / delta_);
+  }
+
+  WeightT Distance(size_t id) {
+    std::lock_guard<rt::Lock> lock(locks_[id % kNumLocks]);
+    return distances_[id];
   }
-  return std::numeric_limits<size_t>::infinity();
+
+  /// @brief Lower the tentative distance of an owned vertex.
+  void Relax(const VertexT &v, const VertexT &parent, WeightT distance,
+             Updates *updates) {
+    size_t id = vertices_.LocalId(v);
+    if (id == vertices_.Size()) return;
+    std::lock_guard<rt::Lock> lock(locks_[id % kNumLocks]);
+    if (distance >= distances_[id]) return;
+    distances_[id] = distance;
+    parents_[id] = parent;
+    updates->emplace_back(BucketOf(distance), v);
+  }
+
+  void AddToBuckets(const Updates &updates) {
+    if (updates.empty()) return;
+    std::lock_guard<rt::Lock> lock(bucketsLock_);
+    for (auto &update : updates)
+      buckets_[update.first].push_back(update.second);
+  }
+
+  static void RelaxEdge(const VertexT &src, const EdgeT &edge,
+                        RelaxContext *&context) {
+    if ((edge.weight <= context->state->delta_) != context->light) return;
+    WeightT distance = context->distance + edge.weight;
+    uint32_t owner = OwnedVertices<VertexT>::Owner(edge.vertex);
+    if (owner == static_cast<uint32_t>(rt::thisLocality())) {
+      context->state->Relax(edge.vertex, src, distance, context->updates);
+    } else {
+      context->state->buffers_.Insert(
+          RelaxEntry{edge.vertex, src, distance}, rt::Locality(owner));
+    }
+  }
+
+  void RelaxEdges(const std::vector<VertexT> &vertices, bool light) {
+    auto localIndex = GraphT::GetPtr(gid_)->GetLocalIndexPtr();
+    size_t numChunks = NumTraversalChunks(vertices.size());
+    rt::impl::parallelFor(numChunks, [&](size_t c) {
+      size_t begin = vertices.size() * c / numChunks;
+      size_t end = vertices.size() * (c + 1) / numChunks;
+      Updates updates;
+      for (size_t i = begin; i < end; ++i) {
+        const VertexT &v = vertices[i];
+        if (localIndex->GetDegree(v) == 0) continue;
+        WeightT distance = Distance(vertices_.LocalId(v));
+        RelaxContext context{this, distance, light, &updates};
+        RelaxContext *contextPtr = &context;
+        localIndex->ForEachNeighbor(v, RelaxEdge, contextPtr);
+      }
+      AddToBuckets(updates);
+    });
+  }
+
+  ObjectID oid_;
+  typename GraphT::ObjectID gid_;
+  WeightT delta_;
+  OwnedVertices<VertexT> vertices_;
+  std::vector<WeightT> distances_;
+  std::vector<VertexT> parents_;
+  std::vector<size_t> settledBucket_;
+  std::vector<VertexT> settled_;
+  std::unique_ptr<rt::Lock[]> locks_;
+  std::map<size_t, std::vector<VertexT>> buckets_;
+  rt::Lock bucketsLock_;
+  BuffersVector buffers_;
+};
+
+}  // namespace impl
+
+/// @brief Single-source shortest paths with delta-stepping.
+///
+/// Implements the bucket-synchronous delta-stepping of Meyer and Sanders,
+/// "Delta-stepping: a parallelizable shortest path algorithm" (J.
+/// Algorithms, 2003): vertices are kept in buckets of width delta; the
+/// light edges (weight <= delta) of the first non-empty bucket are relaxed
+/// until the bucket stays empty, then its heavy edges are relaxed once.
+///
+/// @tparam GraphT The type of the graph, an EdgeIndex<VertexT,
+/// WeightedEdge<VertexT, WeightT>> whose vertices are integral identifiers in
+/// [0, numVertices).  Weights must not be negative.
+/// @param gid The ObjectID of the graph.
+/// @param src The source vertex.
+/// @param numVertices The number of vertices of the graph.
+/// @param delta The width of the buckets.
+/// @return The distance from src and shortest path tree parent of every
+/// vertex.  The arrays are owned by the caller.
+/// @throws std::invalid_argument if the graph has split vertices.
+template <typename GraphT>
+TraversalResult<typename GraphT::SrcType,
+                typename GraphT::DestType::WeightType>
+DeltaStepping(typename GraphT::ObjectID gid,
+              const typename GraphT::SrcType &src, size_t numVertices,
+              typename GraphT::DestType::WeightType delta) {
+  using VertexT = typename GraphT::SrcType;
+  using WeightT = typename GraphT::DestType::WeightType;
+  using StateT = impl::DeltaSteppingState<GraphT>;
+  using ObjectID = typename StateT::ObjectID;
+  if (GraphT::GetPtr(gid)->HasSplitVertices())
+    throw std::invalid_argument("split vertices are not supported");
+
+  auto state = StateT::Create(gid, numVertices, delta);
+  ObjectID oid = state->GetGlobalID();
+  rt::executeAt(rt::Locality(impl::OwnedVertices<VertexT>::Owner(src)),
+                [](const std::tuple<ObjectID, VertexT> &args) {
+                  StateT::GetPtr(std::get<0>(args))->Start(std::get<1>(args));
+                },
+                std::make_tuple(oid, src));
+
+  auto globalMinBucket = [&oid]() {
+    std::vector<size_t> buckets(rt::numLocalities());
+    rt::Handle handle;
+    for (auto loc : rt::allLocalities())
+      rt::asyncExecuteAtWithRet(
+          handle, loc,
+          [](rt::Handle &, const ObjectID &oid, size_t *res) {
+            *res = StateT::GetPtr(oid)->MinBucket();
+          },
+          oid, &buckets[static_cast<uint32_t>(loc)]);
+    rt::waitForCompletion(handle);
+    return *std::min_element(buckets.begin(), buckets.end());
+  };
+  auto anyBucket = [&oid](size_t bucket) {
+    for (auto loc : rt::allLocalities()) {
+      bool res = false;
+      rt::executeAtWithRet(
+          loc,
+          [](const std::tuple<ObjectID, size_t> &args, bool *res) {
+            *res = StateT::GetPtr(std::get<0>(args))
+                       ->HasBucket(std::get<1>(args));
+          },
+          std::make_tuple(oid, bucket), &res);
+      if (res) return true;
+    }
+    return false;
+  };
+
+  for (size_t bucket = globalMinBucket(); bucket != StateT::kNoBucket;
+       bucket = globalMinBucket()) {
+    do {
+      rt::executeOnAll(
+          [](const std::tuple<ObjectID, size_t> &args) {
+            StateT::GetPtr(std::get<0>(args))->LightStep(std::get<1>(args));
+          },
+          std::make_tuple(oid, bucket));
+      rt::executeOnAll(
+          [](const ObjectID &oid) {
+            StateT::GetPtr(oid)->FlushRelaxations();
+          },
+          oid);
+    } while (anyBucket(bucket));
+    rt::executeOnAll(
+        [](const ObjectID &oid) { StateT::GetPtr(oid)->HeavyStep(); }, oid);
+    rt::executeOnAll(
+        [](const ObjectID &oid) { StateT::GetPtr(oid)->FlushRelaxations(); },
+        oid);
+  }
+
+  TraversalResult<VertexT, WeightT> result;
+  result.distances = Array<WeightT>::Create(numVertices, StateT::kInfinity);
+  result.parents = Array<VertexT>::Create(
+      numVertices, std::numeric_limits<VertexT>::max());
+  rt::executeOnAll(
+      [](const std::tuple<ObjectID, typename Array<WeightT>::ObjectID,
+                          typename Array<VertexT>::ObjectID> &args) {
+        StateT::GetPtr(std::get<0>(args))
+            ->WriteResults(std::get<1>(args), std::get<2>(args));
+      },
+      std::make_tuple(oid, result.distances->GetGlobalID(),
+                      result.parents->GetGlobalID()));
+  StateT::Destroy(oid);
+  return result;
 }
 
+}  // namespace shad
+
+/// @brief Length of the shortest path between two vertices.
+///
+/// The path is found with a breadth-first search that stops at the level of
+/// dest.
+///
+/// @tparam GraphT Graph Type.
+/// @tparam VertexT VertexType.
+/// @param gid ObjectID of the graph.
+/// @param src The source vertex.
+/// @param dest The destination vertex.
+/// @return The length of the shortest path between two vertices if any;
+///         returns std::numeric_limits<size_t>::max() if no path is found.
+/// @throws std::invalid_argument if the graph has split vertices.
+///
 template <typename GraphT, typename VertexT>
 size_t sssp_length(typename GraphT::ObjectID gid, VertexT src, VertexT dest) {
+  using StateT = shad::impl::BFSState<GraphT>;
+  if (src == dest) return 0;
   auto gPtr = GraphT::GetPtr(gid);
-  size_t num_vertices = gPtr->Size();
-  auto q0Ptr = shad::Set<VertexT>::Create(num_vertices / 2);
-  auto q1Ptr = shad::Set<VertexT>::Create(num_vertices / 2);
-  auto visited = shad::Array<bool>::Create(num_vertices, false);
-  auto found = shad::Array<bool>::Create(1, false);
-  return __sssp_length<GraphT, VertexT>(gid, num_vertices, q0Ptr, q1Ptr,
-                                        visited, found, src, dest);
-  shad::Set<VertexT>::Destroy(q0Ptr->GetGlobalID());
-  shad::Set<VertexT>::Destroy(q1Ptr->GetGlobalID());
-  shad::Array<bool>::Destroy(visited->GetGlobalID());
-  shad::Array<bool>::Destroy(found->GetGlobalID());
+  if (gPtr->HasSplitVertices())
+    throw std::invalid_argument("split vertices are not supported");
+  auto state = StateT::Create(gid, gPtr->Size(), false);
+  shad::impl::RunBFS<GraphT>(state, src, false, &dest);
+
+  size_t length = StateT::kUnreached;
+  shad::rt::executeAtWithRet(
+      shad::rt::Locality(shad::impl::OwnedVertices<VertexT>::Owner(dest)),
+      [](const std::tuple<typename StateT::ObjectID, VertexT> &args,
+         size_t *length) {
+        *length = StateT::GetPtr(std::get<0>(args))->Level(std::get<1>(args));
+      },
+      std::make_tuple(state->GetGlobalID(), dest), &length);
+  StateT::Destroy(state->GetGlobalID());
+  return length;
 }
 
 #endif  // INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_ALGORITHMS_SSSP_H_
@@ -0,0 +1,425 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+
+#ifndef INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_ALGORITHMS_TRIANGLE_COUNT_H_
+#define INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_ALGORITHMS_TRIANGLE_COUNT_H_
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "shad/data_structures/abstract_data_structure.h"
+#include "shad/data_structures/batch_utils.h"
+#include "shad/data_structures/buffer.h"
+#include "shad/extensions/graph_library/algorithms/owned_vertices.h"
+#include "shad/runtime/runtime.h"
+
+namespace shad {
+
+/// @brief Result of a triangle count.
+struct TriangleStats {
+  /// The number of distinct triangles.
+  size_t triangles;
+  /// The number of paths of length two (connected triples).
+  size_t wedges;
+
+  /// @brief The global clustering coefficient (transitivity).
+  double ClusteringCoefficient() const {
+    return wedges == 0 ? 0 : 3.0 * triangles / wedges;
+  }
+};
+
+namespace impl {
+
+/// @brief Number of elements of the sorted range [first, last) that are
+/// also in the sorted range [otherFirst, otherLast).
+///
+/// Ranges of similar size are merged; when one range is much shorter, its
+/// elements are searched in the other one with exponential search.
+template <typename VertexT>
+size_t IntersectionSize(const VertexT *first, const VertexT *last,
+                        const VertexT *otherFirst, const VertexT *otherLast) {
+  constexpr size_t kGallopingRatio = 32;
+  size_t size = last - first;
+  size_t otherSize = otherLast - otherFirst;
+  if (size > otherSize) {
+    std::swap(first, otherFirst);
+    std::swap(last, otherLast);
+    std::swap(size, otherSize);
+  }
+  size_t count = 0;
+  if (size * kGallopingRatio < otherSize) {
+    for (; first != last && otherFirst != otherLast; ++first) {
+      size_t step = 1;
+      const VertexT *bound = otherFirst;
+      while (bound < otherLast && *bound < *first) {
+        otherFirst = bound + 1;
+        bound += step;
+        step *= 2;
+      }
+      otherFirst = std::lower_bound(otherFirst, std::min(bound, otherLast),
+                                    *first);
+      if (otherFirst != otherLast && *otherFirst == *first) {
+        ++count;
+        ++otherFirst;
+      }
+    }
+    return count;
+  }
+  // Branch-free merge: both cursors advance on equality.
+  while (first != last && otherFirst != otherLast) {
+    VertexT a = *first, b = *otherFirst;
+    count += a == b;
+    first += a <= b;
+    otherFirst += b <= a;
+  }
+  return count;
+}
+
+/// @brief Distributed state of a triangle count.
+///
+/// The edges are symmetrized and oriented from lower to higher rank, the
+/// rank of a vertex being its degree with ties broken by identifier, so
+/// that every triangle is found exactly once and adjacency lists of high
+/// degree vertices stay short.  The oriented lists needed by other
+/// Localities are pushed once, in batches, before the local intersections.
+///
+/// @tparam GraphT The type of the graph, an EdgeIndex.
+template <typename GraphT>
+class TriangleCountState
+    : public AbstractDataStructure<TriangleCountState<GraphT>> {
+  template <typename>
+  friend class shad::AbstractDataStructure;
+
+ public:
+  using VertexT = typename GraphT::SrcType;
+  using ObjectID = typename AbstractDataStructure<TriangleCountState>::ObjectID;
+  using SharedPtr =
+      typename AbstractDataStructure<TriangleCountState>::SharedPtr;
+
+  /// @brief Interpretation of the entries received through the buffers.
+  enum class Phase { kSymmetrize, kOrient, kShare };
+
+  struct Entry {
+    VertexT target;
+    VertexT vertex;
+    size_t degree;
+  };
+
+  ObjectID GetGlobalID() const { return oid_; }
+
+  void SetPhase(Phase phase) { phase_ = phase; }
+
+  void BufferEntriesInsert(const Entry *entries, size_t numEntries) {
+    switch (phase_) {
+      case Phase::kSymmetrize:
+        for (size_t i = 0; i < numEntries; ++i)
+          AddNeighbor(entries[i].target, entries[i].vertex);
+        break;
+      case Phase::kOrient:
+        for (size_t i = 0; i < numEntries; ++i)
+          AddOriented(entries[i].target, entries[i].vertex,
+                      entries[i].degree);
+        break;
+      case Phase::kShare: {
+        std::lock_guard<rt::Lock> lock(ghostsLock_);
+        for (size_t i = 0; i < numEntries; ++i)
+          ghosts_[entries[i].target].push_back(entries[i].vertex);
+        break;
+      }
+    }
+  }
+
+  /// @brief Send both directions of the local edges to the owners.
+  void Symmetrize() {
+    auto localIndex = GraphT::GetPtr(gid_)->GetLocalIndexPtr();
+    TriangleCountState *state = this;
+    localIndex->ForEachEdge(
+        [](const VertexT &src, const VertexT &dest,
+           TriangleCountState *&state) {
+          if (src == dest || size_t(src) >= state->numVertices_ ||
+              size_t(dest) >= state->numVertices_)
+            return;
+          state->AddNeighbor(src, dest);
+          state->Send(Entry{dest, src, 0});
+        },
+        state);
+    buffers_.FlushAll();
+  }
+
+  /// @brief Remove duplicate edges.
+  void SortNeighbors() {
+    rt::impl::parallelFor(vertices_.Size(), [&](size_t id) {
+      auto &neighbors = neighbors_[id];
+      std::sort(neighbors.begin(), neighbors.end());
+      neighbors.erase(std::unique(neighbors.begin(), neighbors.end()),
+                      neighbors.end());
+      degrees_[id] = neighbors.size();
+    });
+  }
+
+  /// @brief Send the degree of every owned vertex to its neighbors.
+  void Orient() {
+    size_t numChunks = NumTraversalChunks(vertices_.Size());
+    rt::impl::parallelFor(numChunks, [&](size_t c) {
+      size_t begin = vertices_.Size() * c / numChunks;
+      size_t end = vertices_.Size() * (c + 1) / numChunks;
+      for (size_t id = begin; id < end; ++id) {
+        const VertexT &u = vertices_.Vertex(id);
+        size_t degree = degrees_[id];
+        for (auto &v : neighbors_[id]) Send(Entry{v, u, degree});
+      }
+    });
+    buffers_.FlushAll();
+  }
+
+  /// @brief Sort the oriented lists and free the symmetric ones.
+  void SortOriented() {
+    rt::impl::parallelFor(vertices_.Size(), [&](size_t id) {
+      std::sort(oriented_[id].begin(), oriented_[id].end());
+      std::vector<VertexT>().swap(neighbors_[id]);
+    });
+    for (auto &requests : requests_) {
+      std::sort(requests.begin(), requests.end());
+      requests.erase(std::unique(requests.begin(), requests.end()),
+                     requests.end());
+    }
+  }
+
+  /// @brief Push the oriented lists needed by other Localities.
+  void Share() {
+    uint32_t thisLocality = static_cast<uint32_t>(rt::thisLocality());
+    for (uint32_t t = 0; t < rt::numLocalities(); ++t) {
+      if (t == thisLocality) continue;
+      const std::vector<size_t> &requests = requests_[t];
+      size_t numChunks = NumTraversalChunks(requests.size());
+      rt::impl::parallelFor(numChunks, [&](size_t c) {
+        size_t begin = requests.size() * c / numChunks;
+        size_t end = requests.size() * (c + 1) / numChunks;
+        for (size_t i = begin; i < end; ++i) {
+          const VertexT &v = vertices_.Vertex(requests[i]);
+          for (auto &w : oriented_[requests[i]])
+            buffers_.Insert(Entry{v, w, 0}, rt::Locality(t));
+        }
+      });
+    }
+    buffers_.FlushAll();
+  }
+
+  /// @brief Sort the received oriented lists.
+  void SortGhosts() {
+    std::vector<std::vector<VertexT> *> lists;
+    lists.reserve(ghosts_.size());
+    for (auto &ghost : ghosts_) lists.push_back(&ghost.second);
+    rt::impl::parallelFor(lists.size(), [&](size_t i) {
+      std::sort(lists[i]->begin(), lists[i]->end());
+    });
+  }
+
+  /// @brief Count the triangles whose lowest ranked vertex is owned.
+  TriangleStats Count() {
+    size_t numChunks = NumTraversalChunks(vertices_.Size());
+    std::vector<TriangleStats> partial(numChunks, TriangleStats{0, 0});
+    rt::impl::parallelFor(numChunks, [&](size_t c) {
+      size_t begin = vertices_.Size() * c / numChunks;
+      size_t end = vertices_.Size() * (c + 1) / numChunks;
+      TriangleStats stats{0, 0};
+      for (size_t id = begin; id < end; ++id) {
+        size_t degree = degrees_[id];
+        if (degree > 1) stats.wedges += degree * (degree - 1) / 2;
+        const std::vector<VertexT> &out = oriented_[id];
+        for (auto &v : out) {
+          const std::vector<VertexT> *other = OrientedList(v);
+          if (other == nullptr) continue;
+          stats.triangles +=
+              IntersectionSize(out.data(), out.data() + out.size(),
+                               other->data(), other->data() + other->size());
+        }
+      }
+      partial[c] = stats;
+    });
+    TriangleStats stats{0, 0};
+    for (auto &p : partial) {
+      stats.triangles += p.triangles;
+      stats.wedges += p.wedges;
+    }
+    return stats;
+  }
+
+ protected:
+  TriangleCountState(ObjectID oid, const typename GraphT::ObjectID &gid,
+                     size_t numVertices)
+      : oid_(oid),
+        gid_(gid),
+        numVertices_(numVertices),
+        vertices_(numVertices),
+        neighbors_(vertices_.Size()),
+        oriented_(vertices_.Size()),
+        degrees_(vertices_.Size()),
+        requests_(rt::numLocalities()),
+        locks_(new rt::Lock[kNumLocks]),
+        buffers_(oid) {}
+
+ private:
+  using BuffersVector = impl::BuffersVector<Entry, TriangleCountState<GraphT>>;
+  static constexpr size_t kNumLocks = 1024;
+
+  static bool Precedes(size_t degree, const VertexT &v, size_t otherDegree,
+                       const VertexT &other) {
+    return std::tie(degree, v) < std::tie(otherDegree, other);
+  }
+
+  void Send(const Entry &entry) {
+    uint32_t owner = OwnedVertices<VertexT>::Owner(entry.target);
+    if (owner == static_cast<uint32_t>(rt::thisLocality()))
+      BufferEntriesInsert(&entry, 1);
+    else
+      buffers_.Insert(entry, rt::Locality(owner));
+  }
+
+  void AddNeighbor(const VertexT &u, const VertexT &v) {
+    size_t id = vertices_.LocalId(u);
+    if (id == vertices_.Size()) return;
+    std::lock_guard<rt::Lock> lock(locks_[id % kNumLocks]);
+    neighbors_[id].push_back(v);
+  }
+
+  /// @brief Record the degree of the neighbor u of the owned vertex v.
+  void AddOriented(const VertexT &v, const VertexT &u, size_t degree) {
+    size_t id = vertices_.LocalId(v);
+    if (id == vertices_.Size()) return;
+    if (Precedes(degrees_[id], v, degree, u)) {
+      std::lock_guard<rt::Lock> lock(locks_[id % kNumLocks]);
+      oriented_[id].push_back(u);
+      return;
+    }
+    // The owner of u intersects with the oriented list of v.
+    uint32_t owner = OwnedVertices<VertexT>::Owner(u);
+    if (owner == static_cast<uint32_t>(rt::thisLocality())) return;
+    std::lock_guard<rt::Lock> lock(requestsLock_);
+    requests_[owner].push_back(id);
+  }
+
+  const std::vector<VertexT> *OrientedList(const VertexT &v) const {
+    size_t id = vertices_.LocalId(v);
+    if (id != vertices_.Size()) return &oriented_[id];
+    auto ghost = ghosts_.find(v);
+    return ghost == ghosts_.end() ? nullptr : &ghost->second;
+  }
+
+  ObjectID oid_;
+  typename GraphT::ObjectID gid_;
+  size_t numVertices_;
+  Phase phase_ = Phase::kSymmetrize;
+  OwnedVertices<VertexT> vertices_;
+  std::vector<std::vector<VertexT>> neighbors_;
+  std::vector<std::vector<VertexT>> oriented_;
+  std::vector<size_t> degrees_;
+  std::vector<std::vector<size_t>> requests_;
+  rt::Lock requestsLock_;
+  std::unordered_map<VertexT, std::vector<VertexT>> ghosts_;
+  rt::Lock ghostsLock_;
+  std::unique_ptr<rt::Lock[]> locks_;
+  BuffersVector buffers_;
+};
+
+}  // namespace impl
+
+/// @brief Count the triangles of an undirected graph.
+///
+/// Every edge may be stored in one or both directions; self loops,
+/// duplicate edges and vertices outside [0, numVertices) are ignored.  Each
+/// triangle is found once by intersecting the sorted lists of its vertices,
+/// oriented by degree, and the totals of all the Localities are combined in
+/// a single reduction.
+///
+/// @tparam GraphT The type of the graph, an EdgeIndex whose vertices are
+/// integral identifiers in [0, numVertices).
+/// @param gid The ObjectID of the graph.
+/// @param numVertices The number of vertices of the graph.
+/// @return The number of triangles and of wedges of the graph.
+/// @throws std::invalid_argument if the graph has split vertices.
+template <typename GraphT>
+TriangleStats TriangleCount(typename GraphT::ObjectID gid,
+                            size_t numVertices) {
+  using StateT = impl::TriangleCountState<GraphT>;
+  using ObjectID = typename StateT::ObjectID;
+  using Phase = typename StateT::Phase;
+  if (GraphT::GetPtr(gid)->HasSplitVertices())
+    throw std::invalid_argument("split vertices are not supported");
+
+  auto state = StateT::Create(gid, numVertices);
+  ObjectID oid = state->GetGlobalID();
+  auto setPhase = [&oid](Phase phase) {
+    rt::executeOnAll(
+        [](const std::tuple<ObjectID, Phase> &args) {
+          StateT::GetPtr(std::get<0>(args))->SetPhase(std::get<1>(args));
+        },
+        std::make_tuple(oid, phase));
+  };
+  setPhase(Phase::kSymmetrize);
+  rt::executeOnAll(
+      [](const ObjectID &oid) { StateT::GetPtr(oid)->Symmetrize(); }, oid);
+  rt::executeOnAll(
+      [](const ObjectID &oid) { StateT::GetPtr(oid)->SortNeighbors(); }, oid);
+  setPhase(Phase::kOrient);
+  rt::executeOnAll([](const ObjectID &oid) { StateT::GetPtr(oid)->Orient(); },
+                   oid);
+  rt::executeOnAll(
+      [](const ObjectID &oid) { StateT::GetPtr(oid)->SortOriented(); }, oid);
+  setPhase(Phase::kShare);
+  rt::executeOnAll([](const ObjectID &oid) { StateT::GetPtr(oid)->Share(); },
+                   oid);
+  rt::executeOnAll(
+      [](const ObjectID &oid) { StateT::GetPtr(oid)->SortGhosts(); }, oid);
+
+  std::vector<TriangleStats> results(rt::numLocalities());
+  rt::Handle handle;
+  for (auto loc : rt::allLocalities())
+    rt::asyncExecuteAtWithRet(
+        handle, loc,
+        [](rt::Handle &, const ObjectID &oid, TriangleStats *result) {
+          *result = StateT::GetPtr(oid)->Count();
+        },
+        oid, &results[static_cast<uint32_t>(loc)]);
+  rt::waitForCompletion(handle);
+  StateT::Destroy(oid);
+
+  TriangleStats stats{0, 0};
+  for (auto &result : results) {
+    stats.triangles += result.triangles;
+    stats.wedges += result.wedges;
+  }
+  return stats;
+}
+
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_ALGORITHMS_TRIANGLE_COUNT_H_
@@ -0,0 +1,511 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_CSR_GRAPH_H_
+#define INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_CSR_GRAPH_H_
+
+#include <functional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "shad/data_structures/abstract_data_structure.h"
+#include "shad/data_structures/batch_utils.h"
+#include "shad/data_structures/compare_and_hash_utils.h"
+#include "shad/extensions/graph_library/local_csr_graph.h"
+#include "shad/runtime/collectives.h"
+#include "shad/runtime/runtime.h"
+
+namespace shad {
+
+/// @brief The CSRGraph data structure.
+///
+/// SHAD's CSRGraph is an immutable, distributed, compressed sparse row
+/// representation of the neighbors lists of a graph.  Vertices are
+/// distributed among Localities as in the EdgeIndex, and every Locality
+/// stores its vertices and their sorted neighbors lists in contiguous arrays,
+/// so that traversals access memory sequentially.
+///
+/// A CSRGraph is built either by freezing an EdgeIndex with Freeze(), or by
+/// streaming edges with InsertEdges() and calling Finalize().
+///
+/// @tparam SrcT type of source vertices (used as identifiers).
+/// @tparam DestT type of destination vertices (used as identifiers).
+/// @warning SrcT and DestT must be trivially copiable and ordered by
+/// operator<.
+template <typename SrcT, typename DestT = SrcT>
+class CSRGraph : public AbstractDataStructure<CSRGraph<SrcT, DestT>> {
+  template <typename>
+  friend class AbstractDataStructure;
+
+ public:
+  using ObjectID = typename AbstractDataStructure<CSRGraph>::ObjectID;
+  using SharedPtr = typename AbstractDataStructure<CSRGraph>::SharedPtr;
+  using SrcType = SrcT;
+  using DestType = DestT;
+  using LGraphT = LocalCSRGraph<SrcT, DestT>;
+
+  /// @brief Create method.
+  ///
+  /// Creates a new, empty, csr_graph instance.
+  ///
+  /// @return A shared pointer to the newly created csr_graph instance.
+#ifdef DOXYGEN_IS_RUNNING
+  static SharedPtr Create();
+#endif
+
+  /// @brief Build a CSRGraph with the edges of an EdgeIndex.
+  ///
+  /// The EdgeIndex is left untouched and must not be modified while the
+  /// CSRGraph is built.
+  ///
+  /// @tparam EdgeIndexPtrT The type of the shared pointer to the EdgeIndex.
+  /// @param edgeIndex The EdgeIndex to freeze.
+  /// @return A shared pointer to the newly created csr_graph instance.
+  /// @throws std::invalid_argument if the EdgeIndex has split vertices.
+  template <typename EdgeIndexPtrT>
+  static SharedPtr Freeze(const EdgeIndexPtrT &edgeIndex);
+
+  /// @brief Getter of the Global Identifier.
+  ///
+  /// @return The global identifier associated with the csr_graph instance.
+  ObjectID GetGlobalID() const { return oid_; }
+
+  /// @brief Overall number of source vertices.
+  size_t Size() const;
+
+  /// @brief Overall number of edges.
+  size_t NumEdges() const;
+
+  /// @brief Number of neighbors of a given vertex.
+  /// @param[in] src the source vertex.
+  /// @return the number of neighbors of vertex src.
+  size_t GetDegree(const SrcT &src);
+
+  /// @brief Stream a batch of edges into the graph.
+  ///
+  /// The edges are shipped to the Localities owning their source vertex,
+  /// where they are staged until Finalize() is called.  If the stream is
+  /// sorted, finalization does not need to sort the edges.
+  ///
+  /// @param[in] srcs The source vertices.
+  /// @param[in] dests The destination vertices, (srcs[i], dests[i]) is an
+  /// edge.
+  /// @param[in] numEdges The number of edges.
+  void InsertEdges(const SrcT *srcs, const DestT *dests, size_t numEdges);
+
+  /// @brief Add the streamed edges to the graph.
+  void Finalize() {
+    auto finalizeLambda = [](const ObjectID &oid) {
+      CSRGraph<SrcT, DestT>::GetPtr(oid)->localGraph_.Finalize();
+    };
+    rt::executeOnAll(finalizeLambda, oid_);
+  }
+
+  /// @brief Apply a user-defined function to each neighbor of a given vertex.
+  ///
+  /// @tparam ApplyFunT User-defined function type.  The function prototype
+  /// should be:
+  /// @code
+  /// void(const SrcT&, const DestT&, Args&);
+  /// @endcode
+  /// @tparam ...Args Types of the function arguments.
+  ///
+  /// @param src The source vertex
+  /// @param function The function to apply.
+  /// @param args The function arguments.
+  template <typename ApplyFunT, typename... Args>
+  void ForEachNeighbor(const SrcT &src, ApplyFunT &&function, Args &... args);
+
+  /// @brief Asynchronously apply a user-defined function
+  /// to each neighbor of a given vertex.
+  ///
+  /// @tparam ApplyFunT User-defined function type.  The function prototype
+  /// should be:
+  /// @code
+  /// void(Handle&, const SrcT&, const DestT&, Args&);
+  /// @endcode
+  /// @tparam ...Args Types of the function arguments.
+  ///
+  /// @param[in,out] handle Reference to the handle
+  /// to be used to wait for completion.
+  /// @param src The source vertex.
+  /// @param function The function to apply.
+  /// @param args The function arguments.
+  template <typename ApplyFunT, typename... Args>
+  void AsyncForEachNeighbor(rt::Handle &handle, const SrcT &src,
+                            ApplyFunT &&function, Args &... args);
+
+  /// @brief Apply a user-defined function to each vertex.
+  ///
+  /// @tparam ApplyFunT User-defined function type.  The function prototype
+  /// should be:
+  /// @code
+  /// void(const SrcT&, Args&);
+  /// @endcode
+  /// @tparam ...Args Types of the function arguments.
+  ///
+  /// @param function The function to apply.
+  /// @param args The function arguments.
+  template <typename ApplyFunT, typename... Args>
+  void ForEachVertex(ApplyFunT &&function, Args &... args);
+
+  /// @brief Asynchronously apply a user-defined function to each vertex.
+  ///
+  /// @tparam ApplyFunT User-defined function type.  The function prototype
+  /// should be:
+  /// @code
+  /// void(Handle&, const SrcT&, Args&);
+  /// @endcode
+  /// @tparam ...Args Types of the function arguments.
+  ///
+  /// @param[in,out] handle Reference to the handle
+  /// to be used to wait for completion.
+  /// @param function The function to apply.
+  /// @param args The function arguments.
+  template <typename ApplyFunT, typename... Args>
+  void AsyncForEachVertex(rt::Handle &handle, ApplyFunT &&function,
+                          Args &... args);
+
+  /// @brief Apply a user-defined function to each edge.
+  ///
+  /// @tparam ApplyFunT User-defined function type.  The function prototype
+  /// should be:
+  /// @code
+  /// void(const SrcT&, const DestT&, Args&);
+  /// @endcode
+  /// @tparam ...Args Types of the function arguments.
+  ///
+  /// @param function The function to apply.
+  /// @param args The function arguments.
+  template <typename ApplyFunT, typename... Args>
+  void ForEachEdge(ApplyFunT &&function, Args &... args);
+
+  /// @brief Asynchronously apply a user-defined function to each edge.
+  ///
+  /// @tparam ApplyFunT User-defined function type.  The function prototype
+  /// should be:
+  /// @code
+  /// void(Handle&, const SrcT&, const DestT&, Args&);
+  /// @endcode
+  /// @tparam ...Args Types of the function arguments.
+  ///
+  /// @param[in,out] handle Reference to the handle
+  /// to be used to wait for completion.
+  /// @param function The function to apply.
+  /// @param args The function arguments.
+  template <typename ApplyFunT, typename... Args>
+  void AsyncForEachEdge(rt::Handle &handle, ApplyFunT &&function,
+                        Args &... args);
+
+  /// @brief The part of the graph stored on this Locality.
+  LGraphT *GetLocalGraphPtr() { return &localGraph_; }
+
+ private:
+  ObjectID oid_;
+  LGraphT localGraph_;
+
+  struct BatchHeader {
+    ObjectID oid;
+    size_t numEdges;
+  };
+
+  template <typename ApplyFunT, typename... Args, std::size_t... is>
+  static void ForEachNeighborWrapper(const ObjectID &oid, const SrcT &src,
+                                     const ApplyFunT function,
+                                     std::tuple<Args...> &args,
+                                     std::index_sequence<is...>) {
+    auto ptr = CSRGraph<SrcT, DestT>::GetPtr(oid);
+    ptr->localGraph_.ForEachNeighbor(src, function, std::get<is>(args)...);
+  }
+
+  template <typename ApplyFunT, typename... Args, std::size_t... is>
+  static void AsyncForEachNeighborWrapper(rt::Handle &handle,
+                                          const ObjectID &oid, const SrcT &src,
+                                          const ApplyFunT function,
+                                          std::tuple<Args...> &args,
+                                          std::index_sequence<is...>) {
+    auto ptr = CSRGraph<SrcT, DestT>::GetPtr(oid);
+    ptr->localGraph_.AsyncForEachNeighbor(handle, src, function,
+                                          std::get<is>(args)...);
+  }
+
+  template <typename ApplyFunT, typename... Args, std::size_t... is>
+  static void ForEachVertexWrapper(const ObjectID &oid,
+                                   const ApplyFunT function,
+                                   std::tuple<Args...> &args,
+                                   std::index_sequence<is...>) {
+    auto ptr = CSRGraph<SrcT, DestT>::GetPtr(oid);
+    ptr->localGraph_.ForEachVertex(function, std::get<is>(args)...);
+  }
+
+  template <typename ApplyFunT, typename... Args, std::size_t... is>
+  static void AsyncForEachVertexWrapper(rt::Handle &handle, const ObjectID &oid,
+                                        const ApplyFunT function,
+                                        std::tuple<Args...> &args,
+                                        std::index_sequence<is...>) {
+    auto ptr = CSRGraph<SrcT, DestT>::GetPtr(oid);
+    ptr->localGraph_.AsyncForEachVertex(handle, function,
+                                        std::get<is>(args)...);
+  }
+
+  template <typename ApplyFunT, typename... Args, std::size_t... is>
+  static void ForEachEdgeWrapper(const ObjectID &oid, const ApplyFunT function,
+                                 std::tuple<Args...> &args,
+                                 std::index_sequence<is...>) {
+    auto ptr = CSRGraph<SrcT, DestT>::GetPtr(oid);
+    ptr->localGraph_.ForEachEdge(function, std::get<is>(args)...);
+  }
+
+  template <typename ApplyFunT, typename... Args, std::size_t... is>
+  static void AsyncForEachEdgeWrapper(rt::Handle &handle, const ObjectID &oid,
+                                      const ApplyFunT function,
+                                      std::tuple<Args...> &args,
+                                      std::index_sequence<is...>) {
+    auto ptr = CSRGraph<SrcT, DestT>::GetPtr(oid);
+    ptr->localGraph_.AsyncForEachEdge(handle, function, std::get<is>(args)...);
+  }
+
+ protected:
+  explicit CSRGraph(ObjectID oid) : oid_(oid) {}
+};
+
+template <typename SrcT, typename DestT>
+template <typename EdgeIndexPtrT>
+typename CSRGraph<SrcT, DestT>::SharedPtr CSRGraph<SrcT, DestT>::Freeze(
+    const EdgeIndexPtrT &edgeIndex) {
+  using EdgeIndexT = typename EdgeIndexPtrT::element_type;
+  if (edgeIndex->HasSplitVertices())
+    throw std::invalid_argument("split vertices are not supported");
+  auto graph = CSRGraph<SrcT, DestT>::Create();
+  auto freezeLambda =
+      [](const std::tuple<ObjectID, typename EdgeIndexT::ObjectID> &args) {
+        auto graphPtr = CSRGraph<SrcT, DestT>::GetPtr(std::get<0>(args));
+        auto indexPtr = EdgeIndexT::GetPtr(std::get<1>(args));
+        graphPtr->localGraph_.Freeze(indexPtr->GetLocalIndexPtr());
+      };
+  rt::executeOnAll(freezeLambda, std::make_tuple(graph->GetGlobalID(),
+                                                 edgeIndex->GetGlobalID()));
+  return graph;
+}
+
+template <typename SrcT, typename DestT>
+inline size_t CSRGraph<SrcT, DestT>::Size() const {
+  auto sizeLambda = [](const ObjectID &oid) -> size_t {
+    return CSRGraph<SrcT, DestT>::GetPtr(oid)->localGraph_.Size();
+  };
+  return rt::treeReduce(rt::localities_range(), sizeLambda,
+                        std::plus<size_t>(), size_t(0), oid_);
+}
+
+template <typename SrcT, typename DestT>
+inline size_t CSRGraph<SrcT, DestT>::NumEdges() const {
+  auto numEdgesLambda = [](const ObjectID &oid) -> size_t {
+    return CSRGraph<SrcT, DestT>::GetPtr(oid)->localGraph_.NumEdges();
+  };
+  return rt::treeReduce(rt::localities_range(), numEdgesLambda,
+                        std::plus<size_t>(), size_t(0), oid_);
+}
+
+template <typename SrcT, typename DestT>
+inline size_t CSRGraph<SrcT, DestT>::GetDegree(const SrcT &src) {
+  size_t targetId = shad::hash<SrcT>{}(src) % rt::numLocalities();
+  rt::Locality targetLocality(targetId);
+  if (targetLocality == rt::thisLocality()) return localGraph_.GetDegree(src);
+
+  size_t degree = 0;
+  auto degreeLambda = [](const std::tuple<ObjectID, SrcT> &args,
+                         size_t *res) {
+    auto ptr = CSRGraph<SrcT, DestT>::GetPtr(std::get<0>(args));
+    *res = ptr->localGraph_.GetDegree(std::get<1>(args));
+  };
+  rt::executeAtWithRet(targetLocality, degreeLambda,
+                       std::make_tuple(oid_, src), &degree);
+  return degree;
+}
+
+template <typename SrcT, typename DestT>
+inline void CSRGraph<SrcT, DestT>::InsertEdges(const SrcT *srcs,
+                                               const DestT *dests,
+                                               size_t numEdges) {
+  using Layout = impl::BatchLayout<BatchHeader, SrcT, DestT>;
+  auto stageLambda = [](const uint8_t *payload, const uint32_t) {
+    const BatchHeader &header = Layout::Header(payload);
+    auto graphPtr = CSRGraph<SrcT, DestT>::GetPtr(header.oid);
+    graphPtr->localGraph_.StageEdges(
+        Layout::template Array<0>(payload, header.numEdges),
+        Layout::template Array<1>(payload, header.numEdges), header.numEdges);
+  };
+
+  // Batches are shipped in order, so that a sorted stream stays sorted.
+  auto partition = impl::PartitionByLocality(srcs, numEdges);
+  for (uint32_t l = 0; l < rt::numLocalities(); ++l) {
+    size_t count = partition.Count(l);
+    if (count == 0) continue;
+
+    auto payload = Layout::Allocate(count, BatchHeader{oid_, count});
+    SrcT *batchSrcs = Layout::template Array<0>(payload.get(), count);
+    DestT *batchDests = Layout::template Array<1>(payload.get(), count);
+    for (size_t i = 0; i < count; ++i) {
+      size_t pos = partition.Position(l, i);
+      batchSrcs[i] = srcs[pos];
+      batchDests[i] = dests[pos];
+    }
+    rt::executeAt(rt::Locality(l), stageLambda, payload, Layout::Bytes(count));
+  }
+}
+
+template <typename SrcT, typename DestT>
+template <typename ApplyFunT, typename... Args>
+void CSRGraph<SrcT, DestT>::ForEachNeighbor(const SrcT &src,
+                                            ApplyFunT &&function,
+                                            Args &... args) {
+  size_t targetId = shad::hash<SrcT>{}(src) % rt::numLocalities();
+  rt::Locality targetLocality(targetId);
+  if (targetLocality == rt::thisLocality()) {
+    localGraph_.ForEachNeighbor(src, function, args...);
+    return;
+  }
+  using FunctionTy = void (*)(const SrcT &src, const DestT &dest, Args &...);
+  FunctionTy fn = std::forward<decltype(function)>(function);
+  using feArgs = std::tuple<ObjectID, SrcT, FunctionTy, std::tuple<Args...>>;
+  feArgs arguments(oid_, src, fn, std::tuple<Args...>(args...));
+  auto feLambda = [](const feArgs &args) {
+    feArgs &fargs = const_cast<feArgs &>(args);
+    constexpr auto size = std::tuple_size<
+        typename std::decay<decltype(std::get<3>(fargs))>::type>::value;
+    ForEachNeighborWrapper(std::get<0>(fargs), std::get<1>(fargs),
+                           std::get<2>(fargs), std::get<3>(fargs),
+                           std::make_index_sequence<size>());
+  };
+  rt::executeAt(targetLocality, feLambda, arguments);
+}
+
+template <typename SrcT, typename DestT>
+template <typename ApplyFunT, typename... Args>
+void CSRGraph<SrcT, DestT>::AsyncForEachNeighbor(rt::Handle &handle,
+                                                 const SrcT &src,
+                                                 ApplyFunT &&function,
+                                                 Args &... args) {
+  size_t targetId = shad::hash<SrcT>{}(src) % rt::numLocalities();
+  rt::Locality targetLocality(targetId);
+  if (targetLocality == rt::thisLocality()) {
+    localGraph_.AsyncForEachNeighbor(handle, src, function, args...);
+    return;
+  }
+  using FunctionTy = void (*)(rt::Handle & handle, const SrcT &src,
+                              const DestT &dest, Args &...);
+  FunctionTy fn = std::forward<decltype(function)>(function);
+  using feArgs = std::tuple<ObjectID, SrcT, FunctionTy, std::tuple<Args...>>;
+  feArgs arguments(oid_, src, fn, std::tuple<Args...>(args...));
+  auto feLambda = [](rt::Handle &handle, const feArgs &args) {
+    feArgs &fargs = const_cast<feArgs &>(args);
+    constexpr auto size = std::tuple_size<
+        typename std::decay<decltype(std::get<3>(fargs))>::type>::value;
+    AsyncForEachNeighborWrapper(handle, std::get<0>(fargs), std::get<1>(fargs),
+                                std::get<2>(fargs), std::get<3>(fargs),
+                                std::make_index_sequence<size>());
+  };
+  rt::asyncExecuteAt(handle, targetLocality, feLambda, arguments);
+}
+
+template <typename SrcT, typename DestT>
+template <typename ApplyFunT, typename... Args>
+void CSRGraph<SrcT, DestT>::ForEachVertex(ApplyFunT &&function,
+                                          Args &... args) {
+  using FunctionTy = void (*)(const SrcT &src, Args &...);
+  FunctionTy fn = std::forward<decltype(function)>(function);
+  using feArgs = std::tuple<ObjectID, FunctionTy, std::tuple<Args...>>;
+  feArgs arguments(oid_, fn, std::tuple<Args...>(args...));
+  auto feLambda = [](const feArgs &args) {
+    constexpr auto size = std::tuple_size<
+        typename std::decay<decltype(std::get<2>(args))>::type>::value;
+    feArgs &fargs = const_cast<feArgs &>(args);
+    ForEachVertexWrapper(std::get<0>(fargs), std::get<1>(fargs),
+                         std::get<2>(fargs), std::make_index_sequence<size>());
+  };
+  rt::executeOnAll(feLambda, arguments);
+}
+
+template <typename SrcT, typename DestT>
+template <typename ApplyFunT, typename... Args>
+void CSRGraph<SrcT, DestT>::AsyncForEachVertex(rt::Handle &handle,
+                                               ApplyFunT &&function,
+                                               Args &... args) {
+  using FunctionTy = void (*)(rt::Handle & h, const SrcT &src, Args &...);
+  FunctionTy fn = std::forward<decltype(function)>(function);
+  using feArgs = std::tuple<ObjectID, FunctionTy, std::tuple<Args...>>;
+  feArgs arguments(oid_, fn, std::tuple<Args...>(args...));
+  auto feLambda = [](rt::Handle &handle, const feArgs &args) {
+    constexpr auto size = std::tuple_size<
+        typename std::decay<decltype(std::get<2>(args))>::type>::value;
+    feArgs &fargs = const_cast<feArgs &>(args);
+    AsyncForEachVertexWrapper(handle, std::get<0>(fargs), std::get<1>(fargs),
+                              std::get<2>(fargs),
+                              std::make_index_sequence<size>());
+  };
+  rt::asyncExecuteOnAll(handle, feLambda, arguments);
+}
+
+template <typename SrcT, typename DestT>
+template <typename ApplyFunT, typename... Args>
+void CSRGraph<SrcT, DestT>::ForEachEdge(ApplyFunT &&function, Args &... args) {
+  using FunctionTy = void (*)(const SrcT &src, const DestT &dest, Args &...);
+  FunctionTy fn = std::forward<decltype(function)>(function);
+  using feArgs = std::tuple<ObjectID, FunctionTy, std::tuple<Args...>>;
+  feArgs arguments(oid_, fn, std::tuple<Args...>(args...));
+  auto feLambda = [](const feArgs &args) {
+    feArgs &fargs = const_cast<feArgs &>(args);
+    constexpr auto size = std::tuple_size<
+        typename std::decay<decltype(std::get<2>(fargs))>::type>::value;
+    ForEachEdgeWrapper(std::get<0>(fargs), std::get<1>(fargs),
+                       std::get<2>(fargs), std::make_index_sequence<size>());
+  };
+  rt::executeOnAll(feLambda, arguments);
+}
+
+template <typename SrcT, typename DestT>
+template <typename ApplyFunT, typename... Args>
+void CSRGraph<SrcT, DestT>::AsyncForEachEdge(rt::Handle &handle,
+                                             ApplyFunT &&function,
+                                             Args &... args) {
+  using FunctionTy = void (*)(rt::Handle & handle, const SrcT &src,
+                              const DestT &dest, Args &...);
+  FunctionTy fn = std::forward<decltype(function)>(function);
+  using feArgs = std::tuple<ObjectID, FunctionTy, std::tuple<Args...>>;
+  feArgs arguments(oid_, fn, std::tuple<Args...>(args...));
+  auto feLambda = [](rt::Handle &handle, const feArgs &args) {
+    feArgs &fargs = const_cast<feArgs &>(args);
+    constexpr auto size = std::tuple_size<
+        typename std::decay<decltype(std::get<2>(fargs))>::type>::value;
+    AsyncForEachEdgeWrapper(handle, std::get<0>(fargs), std::get<1>(fargs),
+                            std::get<2>(fargs),
+                            std::make_index_sequence<size>());
+  };
+  rt::asyncExecuteOnAll(handle, feLambda, arguments);
+}
+
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_CSR_GRAPH_H_
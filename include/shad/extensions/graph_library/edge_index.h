@@ -26,7 +26,11 @@
 #define INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_EDGE_INDEX_H_
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <functional>
+#include <mutex>
+#include <stdexcept>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -36,6 +40,7 @@
 #include "shad/data_structures/compare_and_hash_utils.h"
 #include "shad/data_structures/local_set.h"
 #include "shad/extensions/graph_library/local_edge_index.h"
+#include "shad/runtime/collectives.h"
 #include "shad/runtime/runtime.h"
 
 namespace shad {
@@ -47,6 +52,11 @@ namespace shad {
 /// @tparam SrcT type of source vertices (used as identifiers).
 /// @tparam DestT type of destination vertices (used as identifiers).
 /// @warning obects of type SrcT and DestT need to be trivially copiable.
+///
+/// The neighbors list of a source is stored on the locality picked by hashing
+/// the source, unless the source has been split with
+/// SplitHighDegreeVertices(): the neighbors of a split vertex are spread over
+/// all the localities according to the hash of the destination.
 /// @tparam StorageT EdgeIndex local storage. Default is a map of sets.
 template <typename SrcT, typename DestT,
           typename StorageT = DefaultEdgeIndexStorage<SrcT, DestT>>
@@ -94,10 +104,89 @@ class EdgeIndex
   /// @return the number of unique source vertices in the index.
   size_t Size() const;
 
+  /// @brief Approximate number of unique sources, extrapolated from the
+  /// calling locality without any communication.
+  /// @return the approximate number of unique source vertices in the index.
+  size_t ApproximateSize() const {
+    return localIndex_.Size() * rt::numLocalities();
+  }
+
   /// @brief Overall number of edges in the index.
+  ///
+  /// The neighbor lists are recounted on all the localities concurrently and
+  /// the counts are summed with a single tree reduction.
   /// @return the number of edges in the index.
   size_t NumEdges();
 
+  /// @brief Split the neighbors lists of the high-degree vertices.
+  ///
+  /// Every source whose degree exceeds degreeThreshold becomes a split vertex:
+  /// its neighbors are moved to the locality picked by hashing each
+  /// destination, and the edges inserted afterwards follow the same placement.
+  /// ForEachNeighbor, AsyncForEachNeighbor and GetDegree fan out to all the
+  /// fragments of a split vertex, ForEachEdge visits each fragment where it
+  /// is stored, and ForEachVertex and Size still count the vertex once, on the
+  /// locality owning it.
+  ///
+  /// @warning This is a freeze point: it must not run concurrently with any
+  /// other operation on the index.
+  ///
+  /// @param degreeThreshold The degree above which a source is split.
+  /// @return the number of vertices split by this call.
+  size_t SplitHighDegreeVertices(size_t degreeThreshold);
+
+  /// @brief Check if a vertex has been split across the localities.
+  /// @param[in] src the source vertex.
+  /// @return true if the neighbors of src are spread over the localities.
+  bool IsSplitVertex(const SrcT &src) {
+    return splitVertices_.Size() != 0 && splitVertices_.Find(src);
+  }
+
+  /// @return true if SplitHighDegreeVertices() split at least one vertex.
+  bool HasSplitVertices() { return splitVertices_.Size() != 0; }
+
+  /// @brief Enable the delta-log insertion mode.
+  ///
+  /// Insertions and deletions of single edges, buffered ones included, are
+  /// appended to logs on the locality storing the edge instead of updating
+  /// the neighbors lists in place.  The logs of a locality are striped by
+  /// source, so that the updates of a source are kept in the order they
+  /// were logged.  A locality merges its logs into
+  /// the neighbors lists, grouped by source, when its pending deltas reach
+  /// compactionThreshold or when Compact() is called.  Reads apply the pending
+  /// deltas of the localities they visit first, so they observe every update
+  /// logged before they started.
+  ///
+  /// @param compactionThreshold Number of pending deltas per locality that
+  /// triggers a merge.
+  void EnableDeltaLog(
+      size_t compactionThreshold = kDefaultCompactionThreshold) {
+    auto enableLambda = [](const std::tuple<ObjectID, size_t> &args) {
+      auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(std::get<0>(args));
+      ptr->compactionThreshold_ = std::max<size_t>(std::get<1>(args), 1);
+    };
+    rt::executeOnAll(enableLambda, std::make_tuple(oid_, compactionThreshold));
+  }
+
+  /// @brief Merge the pending deltas and go back to in-place updates.
+  void DisableDeltaLog() {
+    auto disableLambda = [](const ObjectID &oid) {
+      auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(oid);
+      ptr->compactionThreshold_ = 0;
+      ptr->ApplyDeltas();
+    };
+    rt::executeOnAll(disableLambda, oid_);
+  }
+
+  /// @brief Merge the pending deltas into the neighbors lists on all the
+  /// localities.
+  void Compact() {
+    auto compactLambda = [](const ObjectID &oid) {
+      EdgeIndex<SrcT, DestT, StorageT>::GetPtr(oid)->ApplyDeltas();
+    };
+    rt::executeOnAll(compactLambda, oid_);
+  }
+
   /// @brief Insert an edge in the index.
   /// @param[in] src the source vertex.
   /// @param[in] value the destination vertex.
@@ -221,9 +310,12 @@ class EdgeIndex
 
   // FIXME it should be protected
   void BufferEntryInsert(const EntryT &entry) {
-    localIndex_.Insert(entry.src, entry.dest);
+    LocalInsert(entry.src, entry.dest);
   }
 
+  // FIXME it should be protected
+  void BufferEntriesInsert(const EntryT *entries, size_t numEntries);
+
   /// @brief Apply a user-defined function to each neighbor of a given vertex.
   ///
   /// @tparam ApplyFunT User-defined function type.  The function prototype
@@ -327,8 +419,18 @@ class EdgeIndex
   void AsyncForEachEdge(rt::Handle &handle, ApplyFunT &&function,
                         Args &... args);
 
-  // FIXME for testing purposes only
+  /// @brief Access the neighbors lists owned by this locality.
+  ///
+  /// The local indexes of all the localities partition the edges only while
+  /// no vertex is split: the fragments of a split vertex stored on the other
+  /// localities are not in the local index of its owner.
+  ///
+  /// @throws std::invalid_argument if the index has split vertices, see
+  /// HasSplitVertices().
   LocalEdgeIndex<SrcT, DestT, StorageT> *GetLocalIndexPtr() {
+    if (HasSplitVertices())
+      throw std::invalid_argument("split vertices are not supported");
+    SyncDeltas();
     return &localIndex_;
   }
 
@@ -357,9 +459,38 @@ class EdgeIndex
                              Args &... args);
 
  private:
+  using FragmentsT = LocalEdgeIndex<
+      SrcT, DestT,
+      DefaultEdgeIndexStorage<SrcT, DestT,
+                              typename StorageT::NeighborListStorageT>>;
+  static constexpr size_t kExpectedSplitVertices = 1024;
+  static constexpr size_t kDefaultCompactionThreshold = 1 << 16;
+  static constexpr size_t kNumDeltaLogs = 64;
+
+  struct Delta {
+    SrcT src;
+    DestT dest;
+    bool erase;
+  };
+
+  struct DeltaLog {
+    rt::Lock lock;
+    std::vector<Delta> deltas;
+  };
+
   ObjectID oid_;
   LocalEdgeIndex<SrcT, DestT, StorageT> localIndex_;
+  /// Fragments of the split vertices owned by the other localities.
+  FragmentsT fragments_;
+  /// The split vertices, replicated on all the localities.
+  LocalSet<SrcT> splitVertices_;
   BuffersVector buffers_;
+  /// Pending deltas per locality; zero when the delta log is disabled.
+  std::atomic<size_t> compactionThreshold_{0};
+  /// Deltas logged and not applied yet, counted before they are logged.
+  std::atomic<size_t> numPendingDeltas_{0};
+  std::array<DeltaLog, kNumDeltaLogs> deltaLogs_;
+  rt::Lock compactionLock_;
 
   struct InsertArgs {
     ObjectID oid;
@@ -387,12 +518,123 @@ class EdgeIndex
     LocalEdgeListChunk chunk;
   };
 
+  struct HubScan {
+    LocalEdgeIndex<SrcT, DestT, StorageT> *index;
+    LocalSet<SrcT> *splitVertices;
+    size_t threshold;
+    std::vector<SrcT> hubs;
+    rt::Lock lock;
+  };
+
+  bool IsOwner(const SrcT &src) const {
+    size_t targetId = shad::hash<SrcT>{}(src) % rt::numLocalities();
+    return rt::Locality(targetId) == rt::thisLocality();
+  }
+
+  rt::Locality TargetLocality(const SrcT &src, const DestT &dest) {
+    if (IsSplitVertex(src))
+      return rt::Locality(shad::hash<DestT>{}(dest) % rt::numLocalities());
+    return rt::Locality(shad::hash<SrcT>{}(src) % rt::numLocalities());
+  }
+
+  bool LogDelta(const SrcT &src, const DestT &dest, bool erase) {
+    size_t threshold = compactionThreshold_.load();
+    if (threshold == 0) return false;
+    size_t numPending = numPendingDeltas_.fetch_add(1) + 1;
+    DeltaLog &log = deltaLogs_[shad::hash<SrcT>{}(src) % kNumDeltaLogs];
+    {
+      std::lock_guard<rt::Lock> _(log.lock);
+      log.deltas.push_back(Delta{src, dest, erase});
+    }
+    if (numPending >= threshold) ApplyDeltas();
+    return true;
+  }
+
+  void SyncDeltas() {
+    if (numPendingDeltas_.load() != 0) ApplyDeltas();
+  }
+
+  void ApplyDeltas();
+
+  void LocalInsert(const SrcT &src, const DestT &dest) {
+    if (LogDelta(src, dest, false)) return;
+    if (splitVertices_.Size() == 0 || IsOwner(src))
+      localIndex_.Insert(src, dest);
+    else
+      fragments_.Insert(src, dest);
+  }
+
+  void LocalAsyncInsert(rt::Handle &handle, const SrcT &src,
+                        const DestT &dest) {
+    if (LogDelta(src, dest, false)) return;
+    if (splitVertices_.Size() == 0 || IsOwner(src))
+      localIndex_.AsyncInsert(handle, src, dest);
+    else
+      fragments_.AsyncInsert(handle, src, dest);
+  }
+
+  void LocalInsertEdgeList(const SrcT &src, const DestT *destinations,
+                           size_t numDest) {
+    if (IsOwner(src))
+      localIndex_.InsertEdgeList(src, destinations, numDest, false);
+    else
+      fragments_.InsertEdgeList(src, destinations, numDest, false);
+  }
+
+  void LocalErase(const SrcT &src, const DestT &dest) {
+    if (LogDelta(src, dest, true)) return;
+    localIndex_.Erase(src, dest);
+    if (fragments_.Size() != 0) fragments_.Erase(src, dest);
+  }
+
+  void LocalAsyncErase(rt::Handle &handle, const SrcT &src,
+                       const DestT &dest) {
+    if (LogDelta(src, dest, true)) return;
+    localIndex_.AsyncErase(handle, src, dest);
+    if (fragments_.Size() != 0) fragments_.AsyncErase(handle, src, dest);
+  }
+
+  size_t LocalDegree(const SrcT &src) {
+    SyncDeltas();
+    return localIndex_.GetDegree(src) + fragments_.GetDegree(src);
+  }
+
+  void ResetLocalNeighbors(const SrcT &src) {
+    auto owned = localIndex_.GetNeighbors(src);
+    if (owned != nullptr) owned->Reset(0);
+    auto fragment = fragments_.GetNeighbors(src);
+    if (fragment != nullptr) fragment->Reset(0);
+  }
+
+  static void InsertFragmentChunk(const EdgeListChunk &args) {
+    auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(args.oid);
+    ptr->SyncDeltas();
+    if (args.chunk.overwrite) ptr->ResetLocalNeighbors(args.src);
+    size_t numDest =
+        std::min(args.chunk.numDest, args.chunk.destinations.size());
+    ptr->LocalInsertEdgeList(args.src, args.chunk.destinations.data(),
+                             numDest);
+  }
+
+  void InsertFragment(const rt::Locality &locality, const SrcT &src,
+                      DestT *destinations, size_t numDest);
+  void AsyncInsertFragment(rt::Handle &handle, const rt::Locality &locality,
+                           const SrcT &src, DestT *destinations,
+                           size_t numDest, bool overwrite);
+  void InsertSplitEdgeList(const SrcT &src, DestT *destinations,
+                           size_t numDest, bool overwrite);
+  void AsyncInsertSplitEdgeList(rt::Handle &handle, const SrcT &src,
+                                DestT *destinations, size_t numDest,
+                                bool overwrite);
+  size_t SplitLocalVertices(size_t degreeThreshold);
+
   template <typename ApplyFunT, typename... Args, std::size_t... is>
   static void ForEachNeighborWrapper(const ObjectID &oid, const SrcT &src,
                                      const ApplyFunT function,
                                      std::tuple<Args...> &args,
                                      std::index_sequence<is...>) {
     auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(oid);
+    ptr->SyncDeltas();
     ptr->localIndex_.ForEachNeighbor(src, function, std::get<is>(args)...);
   }
 
@@ -403,16 +645,47 @@ class EdgeIndex
                                           std::tuple<Args...> &args,
                                           std::index_sequence<is...>) {
     auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(oid);
+    ptr->SyncDeltas();
     ptr->localIndex_.AsyncForEachNeighbor(handle, src, function,
                                           std::get<is>(args)...);
   }
 
+  template <typename ApplyFunT, typename... Args, std::size_t... is>
+  static void ForEachFragmentWrapper(const ObjectID &oid, const SrcT &src,
+                                     const ApplyFunT function,
+                                     std::tuple<Args...> &args,
+                                     std::index_sequence<is...>) {
+    auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(oid);
+    ptr->SyncDeltas();
+    if (ptr->localIndex_.GetNeighbors(src) != nullptr)
+      ptr->localIndex_.ForEachNeighbor(src, function, std::get<is>(args)...);
+    if (ptr->fragments_.GetNeighbors(src) != nullptr)
+      ptr->fragments_.ForEachNeighbor(src, function, std::get<is>(args)...);
+  }
+
+  template <typename ApplyFunT, typename... Args, std::size_t... is>
+  static void AsyncForEachFragmentWrapper(rt::Handle &handle,
+                                          const ObjectID &oid, const SrcT &src,
+                                          const ApplyFunT function,
+                                          std::tuple<Args...> &args,
+                                          std::index_sequence<is...>) {
+    auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(oid);
+    ptr->SyncDeltas();
+    if (ptr->localIndex_.GetNeighbors(src) != nullptr)
+      ptr->localIndex_.AsyncForEachNeighbor(handle, src, function,
+                                            std::get<is>(args)...);
+    if (ptr->fragments_.GetNeighbors(src) != nullptr)
+      ptr->fragments_.AsyncForEachNeighbor(handle, src, function,
+                                           std::get<is>(args)...);
+  }
+
   template <typename ApplyFunT, typename... Args, std::size_t... is>
   static void ForEachVertexWrapper(const ObjectID &oid,
                                    const ApplyFunT function,
                                    std::tuple<Args...> &args,
                                    std::index_sequence<is...>) {
     auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(oid);
+    ptr->SyncDeltas();
     ptr->localIndex_.ForEachVertex(function, std::get<is>(args)...);
   }
 
@@ -422,6 +695,7 @@ class EdgeIndex
                                         std::tuple<Args...> &args,
                                         std::index_sequence<is...>) {
     auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(oid);
+    ptr->SyncDeltas();
     ptr->localIndex_.AsyncForEachVertex(handle, function,
                                         std::get<is>(args)...);
   }
@@ -431,7 +705,10 @@ class EdgeIndex
                                  std::tuple<Args...> &args,
                                  std::index_sequence<is...>) {
     auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(oid);
+    ptr->SyncDeltas();
     ptr->localIndex_.ForEachEdge(function, std::get<is>(args)...);
+    if (ptr->fragments_.Size() != 0)
+      ptr->fragments_.ForEachEdge(function, std::get<is>(args)...);
   }
 
   template <typename ApplyFunT, typename... Args, std::size_t... is>
@@ -440,62 +717,291 @@ class EdgeIndex
                                       std::tuple<Args...> &args,
                                       std::index_sequence<is...>) {
     auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(oid);
+    ptr->SyncDeltas();
     ptr->localIndex_.AsyncForEachEdge(handle, function, std::get<is>(args)...);
+    if (ptr->fragments_.Size() != 0)
+      ptr->fragments_.AsyncForEachEdge(handle, function,
+                                       std::get<is>(args)...);
   }
 
  protected:
   EdgeIndex(ObjectID oid, const size_t numVertices)
-      : oid_(oid), localIndex_(numVertices), buffers_(oid) {}
+      : oid_(oid),
+        localIndex_(numVertices),
+        fragments_(kExpectedSplitVertices),
+        buffers_(oid) {}
   EdgeIndex(ObjectID oid, const size_t numVertices,
             const typename StorageT::SrcAttributesT &initAttr)
-      : oid_(oid), localIndex_(numVertices, initAttr), buffers_(oid) {}
+      : oid_(oid),
+        localIndex_(numVertices, initAttr),
+        fragments_(kExpectedSplitVertices),
+        buffers_(oid) {}
 };
 
 template <typename SrcT, typename DestT, typename StorageT>
 inline size_t EdgeIndex<SrcT, DestT, StorageT>::Size() const {
-  size_t size = localIndex_.Size();
-  size_t remoteSize;
-  auto sizeLambda = [](const ObjectID &oid, size_t *res) {
+  auto sizeLambda = [](const ObjectID &oid) -> size_t {
     auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(oid);
-    *res = ptr->localIndex_.Size();
+    ptr->SyncDeltas();
+    return ptr->localIndex_.Size();
   };
-  for (auto tgtLoc : rt::allLocalities()) {
-    if (tgtLoc != rt::thisLocality()) {
-      rt::executeAtWithRet(tgtLoc, sizeLambda, oid_, &remoteSize);
-      size += remoteSize;
-    }
-  }
-  return size;
+  return rt::treeReduce(rt::localities_range(), sizeLambda,
+                        std::plus<size_t>(), size_t(0), oid_);
 }
 
 template <typename SrcT, typename DestT, typename StorageT>
 inline size_t EdgeIndex<SrcT, DestT, StorageT>::NumEdges() {
-  size_t size = localIndex_.UpdateNumEdges();
-  size_t remoteSize;
-  auto sizeLambda = [](const ObjectID &oid, size_t *res) {
+  auto numEdgesLambda = [](const ObjectID &oid) -> size_t {
     auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(oid);
-    *res = ptr->localIndex_.UpdateNumEdges();
+    ptr->SyncDeltas();
+    return ptr->localIndex_.UpdateNumEdges() +
+           ptr->fragments_.UpdateNumEdges();
   };
-  for (auto tgtLoc : rt::allLocalities()) {
-    if (tgtLoc != rt::thisLocality()) {
-      rt::executeAtWithRet(tgtLoc, sizeLambda, oid_, &remoteSize);
-      size += remoteSize;
+  return rt::treeReduce(rt::localities_range(), numEdgesLambda,
+                        std::plus<size_t>(), size_t(0), oid_);
+}
+
+template <typename SrcT, typename DestT, typename StorageT>
+inline size_t EdgeIndex<SrcT, DestT, StorageT>::SplitHighDegreeVertices(
+    size_t degreeThreshold) {
+  auto splitLambda = [](const std::tuple<ObjectID, size_t> &args) -> size_t {
+    auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(std::get<0>(args));
+    return ptr->SplitLocalVertices(std::get<1>(args));
+  };
+  return rt::treeReduce(rt::localities_range(), splitLambda,
+                        std::plus<size_t>(), size_t(0),
+                        std::make_tuple(oid_, degreeThreshold));
+}
+
+template <typename SrcT, typename DestT, typename StorageT>
+inline size_t EdgeIndex<SrcT, DestT, StorageT>::SplitLocalVertices(
+    size_t degreeThreshold) {
+  SyncDeltas();
+  HubScan scan;
+  scan.index = &localIndex_;
+  scan.splitVertices = &splitVertices_;
+  scan.threshold = degreeThreshold;
+  HubScan *scanPtr = &scan;
+  auto scanLambda = [](const SrcT &src, HubScan *&scan) {
+    if (scan->index->GetDegree(src) <= scan->threshold) return;
+    if (scan->splitVertices->Find(src)) return;
+    std::lock_guard<rt::Lock> _(scan->lock);
+    scan->hubs.push_back(src);
+  };
+  localIndex_.ForEachVertex(scanLambda, scanPtr);
+
+  auto markLambda = [](const std::tuple<ObjectID, SrcT> &args) {
+    auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(std::get<0>(args));
+    ptr->splitVertices_.Insert(std::get<1>(args));
+  };
+  for (auto &src : scan.hubs) {
+    rt::executeOnAll(markLambda, std::make_tuple(oid_, src));
+
+    std::vector<std::vector<DestT>> shares(rt::numLocalities());
+    for (auto dest : *localIndex_.GetNeighbors(src))
+      shares[shad::hash<DestT>{}(dest) % rt::numLocalities()].push_back(dest);
+
+    auto &ownShare = shares[static_cast<uint32_t>(rt::thisLocality())];
+    localIndex_.InsertEdgeList(src, ownShare.data(), ownShare.size(), true);
+    for (auto &locality : rt::allLocalities()) {
+      auto &share = shares[static_cast<uint32_t>(locality)];
+      if (locality == rt::thisLocality() || share.empty()) continue;
+      InsertFragment(locality, src, share.data(), share.size());
     }
   }
-  return size;
+  return scan.hubs.size();
+}
+
+template <typename SrcT, typename DestT, typename StorageT>
+inline void EdgeIndex<SrcT, DestT, StorageT>::InsertFragment(
+    const rt::Locality &locality, const SrcT &src, DestT *destinations,
+    size_t numDest) {
+  if (locality == rt::thisLocality()) {
+    SyncDeltas();
+    LocalInsertEdgeList(src, destinations, numDest);
+    return;
+  }
+  auto insertLambda = [](const EdgeListChunk &args) {
+    InsertFragmentChunk(args);
+  };
+  size_t locSize = StorageT::kEdgeListChunkSize_;
+  for (size_t i = 0; i < numDest; i += locSize) {
+    size_t chunkSize = std::min(locSize, numDest - i);
+    LocalEdgeListChunk lchunk(chunkSize, false, destinations + i);
+    EdgeListChunk args(oid_, src, lchunk);
+    rt::executeAt(locality, insertLambda, args);
+  }
+}
+
+template <typename SrcT, typename DestT, typename StorageT>
+inline void EdgeIndex<SrcT, DestT, StorageT>::AsyncInsertFragment(
+    rt::Handle &handle, const rt::Locality &locality, const SrcT &src,
+    DestT *destinations, size_t numDest, bool overwrite) {
+  auto syncInsertLambda = [](const EdgeListChunk &args) {
+    InsertFragmentChunk(args);
+  };
+  auto insertLambda = [](rt::Handle &, const EdgeListChunk &args) {
+    InsertFragmentChunk(args);
+  };
+  // The first chunk resets the neighbors on the locality, hence it must
+  // complete before the other chunks are sent.
+  size_t locSize = StorageT::kEdgeListChunkSize_;
+  size_t chunkSize = std::min(locSize, numDest);
+  LocalEdgeListChunk lchunk(chunkSize, overwrite, destinations);
+  EdgeListChunk args(oid_, src, lchunk);
+  if (overwrite && chunkSize < numDest)
+    rt::executeAt(locality, syncInsertLambda, args);
+  else
+    rt::asyncExecuteAt(handle, locality, insertLambda, args);
+  for (size_t i = chunkSize; i < numDest; i += locSize) {
+    chunkSize = std::min(locSize, numDest - i);
+    lchunk = LocalEdgeListChunk(chunkSize, false, destinations + i);
+    args = EdgeListChunk(oid_, src, lchunk);
+    rt::asyncExecuteAt(handle, locality, insertLambda, args);
+  }
+}
+
+template <typename SrcT, typename DestT, typename StorageT>
+inline void EdgeIndex<SrcT, DestT, StorageT>::InsertSplitEdgeList(
+    const SrcT &src, DestT *destinations, size_t numDest, bool overwrite) {
+  if (overwrite) {
+    auto resetLambda = [](const std::tuple<ObjectID, SrcT> &args) {
+      auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(std::get<0>(args));
+      ptr->SyncDeltas();
+      ptr->ResetLocalNeighbors(std::get<1>(args));
+    };
+    rt::executeOnAll(resetLambda, std::make_tuple(oid_, src));
+  }
+  std::vector<std::vector<DestT>> shares(rt::numLocalities());
+  for (size_t i = 0; i < numDest; ++i) {
+    size_t targetId = shad::hash<DestT>{}(destinations[i]) %
+                      rt::numLocalities();
+    shares[targetId].push_back(destinations[i]);
+  }
+  for (auto &locality : rt::allLocalities()) {
+    auto &share = shares[static_cast<uint32_t>(locality)];
+    if (!share.empty())
+      InsertFragment(locality, src, share.data(), share.size());
+  }
+}
+
+template <typename SrcT, typename DestT, typename StorageT>
+inline void EdgeIndex<SrcT, DestT, StorageT>::AsyncInsertSplitEdgeList(
+    rt::Handle &handle, const SrcT &src, DestT *destinations, size_t numDest,
+    bool overwrite) {
+  std::vector<std::vector<DestT>> shares(rt::numLocalities());
+  for (size_t i = 0; i < numDest; ++i) {
+    size_t targetId = shad::hash<DestT>{}(destinations[i]) %
+                      rt::numLocalities();
+    shares[targetId].push_back(destinations[i]);
+  }
+  for (auto &locality : rt::allLocalities()) {
+    auto &share = shares[static_cast<uint32_t>(locality)];
+    if (overwrite || !share.empty())
+      AsyncInsertFragment(handle, locality, src, share.data(), share.size(),
+                          overwrite);
+  }
+}
+
+template <typename SrcT, typename DestT, typename StorageT>
+inline void EdgeIndex<SrcT, DestT, StorageT>::BufferEntriesInsert(
+    const EntryT *entries, size_t numEntries) {
+  // The delta log keeps the insertions one by one.
+  if (compactionThreshold_.load() != 0) {
+    for (size_t i = 0; i < numEntries; ++i)
+      LocalInsert(entries[i].src, entries[i].dest);
+    return;
+  }
+
+  // Group the edges by source, so that every neighbors list is looked up and
+  // locked once per run of edges instead of once per edge.
+  std::vector<EntryT> edges(entries, entries + numEntries);
+  std::stable_sort(edges.begin(), edges.end(),
+                   [](const EntryT &a, const EntryT &b) {
+                     return shad::hash<SrcT>{}(a.src) <
+                            shad::hash<SrcT>{}(b.src);
+                   });
+  std::vector<DestT> run;
+  for (size_t first = 0; first < edges.size();) {
+    const SrcT &src = edges[first].src;
+    size_t last = first;
+    for (; last < edges.size() && !(edges[last].src != src); ++last)
+      run.push_back(edges[last].dest);
+    LocalInsertEdgeList(src, run.data(), run.size());
+    run.clear();
+    first = last;
+  }
+}
+
+template <typename SrcT, typename DestT, typename StorageT>
+inline void EdgeIndex<SrcT, DestT, StorageT>::ApplyDeltas() {
+  std::lock_guard<rt::Lock> _(compactionLock_);
+  std::vector<Delta> deltas;
+  for (auto &log : deltaLogs_) {
+    std::lock_guard<rt::Lock> _(log.lock);
+    deltas.insert(deltas.end(), log.deltas.begin(), log.deltas.end());
+    log.deltas.clear();
+  }
+  if (deltas.empty()) return;
+
+  // Group the deltas by source, keeping the order of the updates of each
+  // source, so that every neighbors list is looked up once per run of
+  // insertions instead of once per edge.  All the updates of a source sit
+  // in the same log, hence a stable sort keeps them in order.
+  std::stable_sort(deltas.begin(), deltas.end(),
+                   [](const Delta &a, const Delta &b) {
+                     return shad::hash<SrcT>{}(a.src) <
+                            shad::hash<SrcT>{}(b.src);
+                   });
+  std::vector<DestT> run;
+  for (size_t first = 0; first < deltas.size();) {
+    const SrcT &src = deltas[first].src;
+    size_t last = first;
+    for (; last < deltas.size() && !(deltas[last].src != src); ++last) {
+      if (!deltas[last].erase) {
+        run.push_back(deltas[last].dest);
+        continue;
+      }
+      if (!run.empty()) {
+        LocalInsertEdgeList(src, run.data(), run.size());
+        run.clear();
+      }
+      localIndex_.Erase(src, deltas[last].dest);
+      fragments_.Erase(src, deltas[last].dest);
+    }
+    if (!run.empty()) {
+      LocalInsertEdgeList(src, run.data(), run.size());
+      run.clear();
+    }
+    first = last;
+  }
+  // Readers skip the merge once the counter drops to zero, hence only after
+  // the deltas are visible in the neighbors lists.
+  numPendingDeltas_.fetch_sub(deltas.size());
 }
 
 template <typename SrcT, typename DestT, typename StorageT>
 inline size_t EdgeIndex<SrcT, DestT, StorageT>::GetDegree(const SrcT &src) {
+  if (IsSplitVertex(src)) {
+    auto degreeLambda = [](const std::tuple<ObjectID, SrcT> &args) -> size_t {
+      auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(std::get<0>(args));
+      return ptr->LocalDegree(std::get<1>(args));
+    };
+    return rt::treeReduce(rt::localities_range(), degreeLambda,
+                          std::plus<size_t>(), size_t(0),
+                          std::make_tuple(oid_, src));
+  }
   size_t targetId = shad::hash<SrcT>{}(src) % rt::numLocalities();
   rt::Locality targetLocality(targetId);
   size_t degree = 0;
   if (targetLocality == rt::thisLocality()) {
+    SyncDeltas();
     return localIndex_.GetDegree(src);
   } else {
     auto degreeLambda = [](const std::tuple<ObjectID, SrcT> &args,
                            size_t *res) {
       auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(std::get<0>(args));
+      ptr->SyncDeltas();
       *res = ptr->localIndex_.GetDegree(std::get<1>(args));
     };
     rt::executeAtWithRet(targetLocality, degreeLambda,
@@ -507,15 +1013,14 @@ inline size_t EdgeIndex<SrcT, DestT, StorageT>::GetDegree(const SrcT &src) {
 template <typename SrcT, typename DestT, typename StorageT>
 inline void EdgeIndex<SrcT, DestT, StorageT>::Insert(const SrcT &src,
                                                      const DestT &dest) {
-  size_t targetId = shad::hash<SrcT>{}(src) % rt::numLocalities();
-  rt::Locality targetLocality(targetId);
+  rt::Locality targetLocality = TargetLocality(src, dest);
 
   if (targetLocality == rt::thisLocality()) {
-    localIndex_.Insert(src, dest);
+    LocalInsert(src, dest);
   } else {
     auto insertLambda = [](const InsertArgs &args) {
       auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(args.oid);
-      ptr->localIndex_.Insert(args.src, args.dest);
+      ptr->LocalInsert(args.src, args.dest);
     };
     InsertArgs args{oid_, src, dest};
     rt::executeAt(targetLocality, insertLambda, args);
@@ -525,14 +1030,20 @@ inline void EdgeIndex<SrcT, DestT, StorageT>::Insert(const SrcT &src,
 template <typename SrcT, typename DestT, typename StorageT>
 inline void EdgeIndex<SrcT, DestT, StorageT>::InsertEdgeList(
     const SrcT &src, DestT *destinations, size_t numDest, bool overwrite) {
+  if (IsSplitVertex(src)) {
+    InsertSplitEdgeList(src, destinations, numDest, overwrite);
+    return;
+  }
   size_t targetId = shad::hash<SrcT>{}(src) % rt::numLocalities();
   rt::Locality targetLocality(targetId);
   if (targetLocality == rt::thisLocality()) {
+    SyncDeltas();
     localIndex_.InsertEdgeList(src, destinations, numDest, overwrite);
   } else {
     int toInsert = numDest;
     auto insertLambda = [](const EdgeListChunk &args) {
       auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(args.oid);
+      ptr->SyncDeltas();
       ptr->localIndex_.Insert(args.src, args.chunk);
     };
     size_t locSize = StorageT::kEdgeListChunkSize_;
@@ -556,18 +1067,25 @@ template <typename SrcT, typename DestT, typename StorageT>
 inline void EdgeIndex<SrcT, DestT, StorageT>::AsyncInsertEdgeList(
     rt::Handle &handle, const SrcT &src, DestT *destinations, size_t numDest,
     bool overwrite) {
+  if (IsSplitVertex(src)) {
+    AsyncInsertSplitEdgeList(handle, src, destinations, numDest, overwrite);
+    return;
+  }
   size_t targetId = shad::hash<SrcT>{}(src) % rt::numLocalities();
   rt::Locality targetLocality(targetId);
 
   if (targetLocality == rt::thisLocality()) {
+    SyncDeltas();
     localIndex_.InsertEdgeList(src, destinations, numDest, overwrite);
   } else {
     auto syncInsertLambda = [](const EdgeListChunk &args) {
       auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(args.oid);
+      ptr->SyncDeltas();
       ptr->localIndex_.Insert(args.src, args.chunk);
     };
     auto insertLambda = [](rt::Handle &handle, const EdgeListChunk &args) {
       auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(args.oid);
+      ptr->SyncDeltas();
       ptr->localIndex_.AsyncInsert(handle, args.src, args.chunk);
     };
 
@@ -598,15 +1116,14 @@ template <typename SrcT, typename DestT, typename StorageT>
 inline void EdgeIndex<SrcT, DestT, StorageT>::AsyncInsert(rt::Handle &handle,
                                                           const SrcT &src,
                                                           const DestT &dest) {
-  size_t targetId = shad::hash<SrcT>{}(src) % rt::numLocalities();
-  rt::Locality targetLocality(targetId);
+  rt::Locality targetLocality = TargetLocality(src, dest);
 
   if (targetLocality == rt::thisLocality()) {
-    localIndex_.AsyncInsert(handle, src, dest);
+    LocalAsyncInsert(handle, src, dest);
   } else {
     auto insertLambda = [](rt::Handle &handle, const InsertArgs &args) {
       auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(args.oid);
-      ptr->localIndex_.AsyncInsert(handle, args.src, args.dest);
+      ptr->LocalAsyncInsert(handle, args.src, args.dest);
     };
     InsertArgs args = {oid_, src, dest};
     rt::asyncExecuteAt(handle, targetLocality, insertLambda, args);
@@ -616,15 +1133,14 @@ inline void EdgeIndex<SrcT, DestT, StorageT>::AsyncInsert(rt::Handle &handle,
 template <typename SrcT, typename DestT, typename StorageT>
 inline void EdgeIndex<SrcT, DestT, StorageT>::Erase(const SrcT &src,
                                                     const DestT &dest) {
-  size_t targetId = shad::hash<SrcT>{}(src) % rt::numLocalities();
-  rt::Locality targetLocality(targetId);
+  rt::Locality targetLocality = TargetLocality(src, dest);
 
   if (targetLocality == rt::thisLocality()) {
-    localIndex_.Erase(src, dest);
+    LocalErase(src, dest);
   } else {
     auto eraseLambda = [](const InsertArgs &args) {
       auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(args.oid);
-      ptr->localIndex_.Erase(args.src, args.dest);
+      ptr->LocalErase(args.src, args.dest);
     };
     InsertArgs args = {oid_, src, dest};
     rt::executeAt(targetLocality, eraseLambda, args);
@@ -635,15 +1151,14 @@ template <typename SrcT, typename DestT, typename StorageT>
 inline void EdgeIndex<SrcT, DestT, StorageT>::AsyncErase(rt::Handle &handle,
                                                          const SrcT &src,
                                                          const DestT &dest) {
-  size_t targetId = shad::hash<SrcT>{}(src) % rt::numLocalities();
-  rt::Locality targetLocality(targetId);
+  rt::Locality targetLocality = TargetLocality(src, dest);
 
   if (targetLocality == rt::thisLocality()) {
-    localIndex_.AsyncErase(handle, src, dest);
+    LocalAsyncErase(handle, src, dest);
   } else {
     auto eraseLambda = [](rt::Handle &handle, const InsertArgs &args) {
       auto ptr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(args.oid);
-      ptr->localIndex_.AsyncErase(handle, args.src, args.dest);
+      ptr->LocalAsyncErase(handle, args.src, args.dest);
     };
     InsertArgs args = {oid_, src, dest};
     rt::asyncExecuteAt(handle, targetLocality, eraseLambda, args);
@@ -653,10 +1168,9 @@ inline void EdgeIndex<SrcT, DestT, StorageT>::AsyncErase(rt::Handle &handle,
 template <typename SrcT, typename DestT, typename StorageT>
 inline void EdgeIndex<SrcT, DestT, StorageT>::BufferedInsert(
     const SrcT &src, const DestT &dest) {
-  size_t targetId = shad::hash<SrcT>{}(src) % rt::numLocalities();
-  rt::Locality targetLocality(targetId);
+  rt::Locality targetLocality = TargetLocality(src, dest);
   if (targetLocality == rt::thisLocality()) {
-    localIndex_.Insert(src, dest);
+    LocalInsert(src, dest);
   } else {
     buffers_.Insert(EntryT(src, dest), targetLocality);
   }
@@ -665,10 +1179,9 @@ inline void EdgeIndex<SrcT, DestT, StorageT>::BufferedInsert(
 template <typename SrcT, typename DestT, typename StorageT>
 inline void EdgeIndex<SrcT, DestT, StorageT>::BufferedAsyncInsert(
     rt::Handle &handle, const SrcT &src, const DestT &dest) {
-  size_t targetId = shad::hash<SrcT>{}(src) % rt::numLocalities();
-  rt::Locality targetLocality(targetId);
+  rt::Locality targetLocality = TargetLocality(src, dest);
   if (targetLocality == rt::thisLocality()) {
-    localIndex_.AsyncInsert(handle, src, dest);
+    LocalAsyncInsert(handle, src, dest);
   } else {
     buffers_.AsyncInsert(handle, EntryT(src, dest), targetLocality);
   }
@@ -717,9 +1230,11 @@ template <typename ApplyFunT, typename... Args>
 void EdgeIndex<SrcT, DestT, StorageT>::ForEachNeighbor(const SrcT &src,
                                                        ApplyFunT &&function,
                                                        Args &... args) {
+  bool split = IsSplitVertex(src);
   size_t targetId = shad::hash<SrcT>{}(src) % rt::numLocalities();
   rt::Locality targetLocality(targetId);
-  if (targetLocality == rt::thisLocality()) {
+  if (!split && targetLocality == rt::thisLocality()) {
+    SyncDeltas();
     localIndex_.ForEachNeighbor(src, function, args...);
     return;
   }
@@ -727,6 +1242,18 @@ void EdgeIndex<SrcT, DestT, StorageT>::ForEachNeighbor(const SrcT &src,
   FunctionTy fn = std::forward<decltype(function)>(function);
   using feArgs = std::tuple<ObjectID, SrcT, FunctionTy, std::tuple<Args...>>;
   feArgs arguments(oid_, src, fn, std::tuple<Args...>(args...));
+  if (split) {
+    auto splitLambda = [](const feArgs &args) {
+      feArgs &fargs = const_cast<feArgs &>(args);
+      constexpr auto size = std::tuple_size<
+          typename std::decay<decltype(std::get<3>(fargs))>::type>::value;
+      ForEachFragmentWrapper(std::get<0>(fargs), std::get<1>(fargs),
+                             std::get<2>(fargs), std::get<3>(fargs),
+                             std::make_index_sequence<size>());
+    };
+    rt::executeOnAll(splitLambda, arguments);
+    return;
+  }
   auto feLambda = [](const feArgs &args) {
     feArgs &fargs = const_cast<feArgs &>(args);
     constexpr auto size = std::tuple_size<
@@ -742,9 +1269,11 @@ template <typename SrcT, typename DestT, typename StorageT>
 template <typename ApplyFunT, typename... Args>
 void EdgeIndex<SrcT, DestT, StorageT>::AsyncForEachNeighbor(
     rt::Handle &handle, const SrcT &src, ApplyFunT &&function, Args &... args) {
+  bool split = IsSplitVertex(src);
   size_t targetId = shad::hash<SrcT>{}(src) % rt::numLocalities();
   rt::Locality targetLocality(targetId);
-  if (targetLocality == rt::thisLocality()) {
+  if (!split && targetLocality == rt::thisLocality()) {
+    SyncDeltas();
     localIndex_.AsyncForEachNeighbor(handle, src, function, args...);
     return;
   }
@@ -753,6 +1282,19 @@ void EdgeIndex<SrcT, DestT, StorageT>::AsyncForEachNeighbor(
   FunctionTy fn = std::forward<decltype(function)>(function);
   using feArgs = std::tuple<ObjectID, SrcT, FunctionTy, std::tuple<Args...>>;
   feArgs arguments(oid_, src, fn, std::tuple<Args...>(args...));
+  if (split) {
+    auto splitLambda = [](rt::Handle &handle, const feArgs &args) {
+      feArgs &fargs = const_cast<feArgs &>(args);
+      constexpr auto size = std::tuple_size<
+          typename std::decay<decltype(std::get<3>(fargs))>::type>::value;
+      AsyncForEachFragmentWrapper(handle, std::get<0>(fargs),
+                                  std::get<1>(fargs), std::get<2>(fargs),
+                                  std::get<3>(fargs),
+                                  std::make_index_sequence<size>());
+    };
+    rt::asyncExecuteOnAll(handle, splitLambda, arguments);
+    return;
+  }
   auto feLambda = [](rt::Handle &handle, const feArgs &args) {
     feArgs &fargs = const_cast<feArgs &>(args);
     constexpr auto size = std::tuple_size<
@@ -810,10 +1352,12 @@ bool EdgeIndex<SrcT, DestT, StorageT>::GetVertexAttributes(
   rt::Locality targetLocality(targetId);
 
   if (targetLocality == rt::thisLocality()) {
+    SyncDeltas();
     return localIndex_.GetVertexAttributes(src, attr);
   } else {
     auto lookupLambda = [](const LookupArgs &args, LookupResult *res) {
       auto eiPtr = EdgeIndex<SrcT, DestT, StorageT>::GetPtr(args.oid);
+      eiPtr->SyncDeltas();
       res->found = eiPtr->localIndex_.GetVertexAttributes(args.src, &res->attr);
     };
     LookupArgs args = {oid_, src};
@@ -835,6 +1379,7 @@ void EdgeIndex<SrcT, DestT, StorageT>::VertexAttributesApply(
   rt::Locality targetLocality(targetId);
 
   if (targetLocality == rt::thisLocality()) {
+    SyncDeltas();
     return localIndex_.VertexAttributesApply(src, function, args...);
   } else {
     printf("mmmh.. not local\n");
@@ -848,8 +1393,9 @@ void EdgeIndex<SrcT, DestT, StorageT>::VertexAttributesApply(
       ApplyArgs &tuple = const_cast<ApplyArgs &>(args);
       constexpr auto Size = std::tuple_size<
           typename std::decay<decltype(std::get<3>(tuple))>::type>::value;
-      StorageT *stPtr =
-          (IdxT::GetPtr(std::get<0>(tuple))->localIndex_.GetEdgesPtr());
+      auto eiPtr = IdxT::GetPtr(std::get<0>(tuple));
+      eiPtr->SyncDeltas();
+      StorageT *stPtr = eiPtr->localIndex_.GetEdgesPtr();
       StorageT::CallVertexAttributesApplyFun(
           stPtr, std::get<1>(tuple), std::get<2>(tuple), std::get<3>(tuple),
           std::make_index_sequence<Size>{});
@@ -0,0 +1,530 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_EDGE_LIST_LOADER_H_
+#define INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_EDGE_LIST_LOADER_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "shad/data_structures/batch_utils.h"
+#include "shad/runtime/runtime.h"
+
+namespace shad {
+
+/// @brief Formats of the files read by LoadEdgeList().
+enum class EdgeListFormat {
+  /// METIS graph: a "numVertices numEdges" header line followed by one line
+  /// per vertex listing its 1-based neighbors.  Lines starting with '%' are
+  /// comments.  Weighted METIS graphs are not supported.
+  kMETIS,
+  /// Text edge list: one "src dest" pair per line.  Lines starting with
+  /// '#' or '%' are comments.
+  kEdgeList,
+  /// Binary edge list, as written by WriteBinaryEdgeList().
+  kBinary
+};
+
+namespace impl {
+
+/// @brief Header of the binary edge list files.
+///
+/// The header is followed by numEdges records, each made of the bytes of
+/// the source vertex followed by the bytes of the destination vertex.
+struct BinaryEdgeListHeader {
+  uint64_t magic;
+  uint64_t numEdges;
+  uint32_t srcSize;
+  uint32_t destSize;
+};
+
+constexpr uint64_t kBinaryEdgeListMagic = 0x5453494c45444853;  // "SHDELIST"
+
+/// @brief Read-only memory mapping of a whole file.
+class MappedFile {
+ public:
+  explicit MappedFile(const char *path) {
+    fd_ = open(path, O_RDONLY);
+    if (fd_ == -1)
+      throw std::system_error(errno, std::generic_category(), path);
+    struct stat st;
+    if (fstat(fd_, &st) == -1) {
+      close(fd_);
+      throw std::system_error(errno, std::generic_category(), path);
+    }
+    size_ = st.st_size;
+    if (size_ == 0) return;
+    void *addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (addr == MAP_FAILED) {
+      close(fd_);
+      throw std::system_error(errno, std::generic_category(), path);
+    }
+    madvise(addr, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char *>(addr);
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  ~MappedFile() {
+    if (data_ != nullptr) munmap(const_cast<char *>(data_), size_);
+    close(fd_);
+  }
+
+  const char *Data() const { return data_; }
+  size_t Size() const { return size_; }
+
+ private:
+  int fd_;
+  const char *data_ = nullptr;
+  size_t size_;
+};
+
+/// @brief Position of the first line starting at or after pos.
+inline size_t LineStart(const char *data, size_t size, size_t pos) {
+  if (pos == 0 || pos >= size) return std::min(pos, size);
+  if (data[pos - 1] == '\n') return pos;
+  const void *nl = memchr(data + pos, '\n', size - pos);
+  return nl == nullptr ? size : static_cast<const char *>(nl) - data + 1;
+}
+
+/// @brief Apply function(lineBegin, lineEnd) to every line of [begin, end).
+template <typename FunT>
+void ForEachLine(const char *begin, const char *end, FunT &&function) {
+  while (begin < end) {
+    const void *nl = memchr(begin, '\n', end - begin);
+    const char *lineEnd = nl == nullptr ? end : static_cast<const char *>(nl);
+    function(begin, lineEnd);
+    begin = lineEnd + 1;
+  }
+}
+
+/// @brief Parse the next unsigned integer of a line.
+///
+/// @return false if there are no more integers in the line.
+inline bool ParseUnsigned(const char *&pos, const char *end, uint64_t *value) {
+  while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r')) ++pos;
+  if (pos == end || *pos < '0' || *pos > '9') return false;
+  uint64_t result = 0;
+  for (; pos < end && *pos >= '0' && *pos <= '9'; ++pos)
+    result = result * 10 + (*pos - '0');
+  *value = result;
+  return true;
+}
+
+/// @brief Task of a Locality, followed in the message by the file path.
+template <typename ObjectID>
+struct EdgeListTask {
+  ObjectID oid;
+  EdgeListFormat format;
+  uint64_t begin;
+  uint64_t end;
+  uint64_t first;
+};
+
+/// @brief Split [begin, end) in line-aligned chunks, one per worker.
+inline std::vector<size_t> LineChunks(const char *data, size_t begin,
+                                      size_t end) {
+  constexpr size_t kChunksPerThread = 4;
+  constexpr size_t kMinChunkSize = 1 << 16;
+  size_t numChunks =
+      std::min(kChunksPerThread * size_t(rt::impl::getConcurrency()),
+               (end - begin) / kMinChunkSize + 1);
+  std::vector<size_t> bounds(numChunks + 1);
+  for (size_t i = 0; i <= numChunks; ++i)
+    bounds[i] = std::max(
+        begin, LineStart(data, end, begin + (end - begin) * i / numChunks));
+  return bounds;
+}
+
+/// @brief Number of METIS vertex lines in the line-aligned range [begin, end).
+inline uint64_t CountMETISLines(const char *begin, const char *end) {
+  uint64_t count = 0;
+  ForEachLine(begin, end, [&](const char *line, const char *) {
+    if (*line != '%') ++count;
+  });
+  return count;
+}
+
+/// @brief Parse the METIS header and return the offset of the first vertex.
+inline size_t ParseMETISHeader(const MappedFile &file, uint64_t *numVertices,
+                               uint64_t *numEdges) {
+  const char *data = file.Data();
+  size_t size = file.Size();
+  size_t pos = 0;
+  while (pos < size) {
+    size_t next = LineStart(data, size, pos + 1);
+    if (data[pos] != '%') {
+      const char *cur = data + pos;
+      const char *lineEnd = data + next;
+      uint64_t format = 0;
+      if (!ParseUnsigned(cur, lineEnd, numVertices) ||
+          !ParseUnsigned(cur, lineEnd, numEdges))
+        throw std::invalid_argument("malformed METIS header");
+      if (ParseUnsigned(cur, lineEnd, &format) && format != 0)
+        throw std::invalid_argument("weighted METIS graphs are not supported");
+      return next;
+    }
+    pos = next;
+  }
+  throw std::invalid_argument("missing METIS header");
+}
+
+/// @brief Read and validate the header of a binary edge list.
+template <typename SrcT, typename DestT>
+BinaryEdgeListHeader ReadBinaryHeader(const MappedFile &file) {
+  BinaryEdgeListHeader header;
+  if (file.Size() < sizeof(header))
+    throw std::invalid_argument("truncated binary edge list");
+  memcpy(&header, file.Data(), sizeof(header));
+  if (header.magic != kBinaryEdgeListMagic)
+    throw std::invalid_argument("not a binary edge list");
+  if (header.srcSize != sizeof(SrcT) || header.destSize != sizeof(DestT))
+    throw std::invalid_argument("binary edge list vertex size mismatch");
+  if (file.Size() != sizeof(header) + header.numEdges * (sizeof(SrcT) +
+                                                         sizeof(DestT)))
+    throw std::invalid_argument("truncated binary edge list");
+  return header;
+}
+
+/// @brief Parse the part of an edge list file assigned to this Locality.
+template <typename EdgeIndexT>
+void LoadEdgeListRange(
+    const char *path, const EdgeListTask<typename EdgeIndexT::ObjectID> &task) {
+  using SrcT = typename EdgeIndexT::SrcType;
+  using DestT = typename EdgeIndexT::DestType;
+  auto edgeIndex = EdgeIndexT::GetPtr(task.oid);
+  MappedFile file(path);
+  const char *data = file.Data();
+
+  if (task.format == EdgeListFormat::kBinary) {
+    constexpr size_t kRecordSize = sizeof(SrcT) + sizeof(DestT);
+    const char *records = data + sizeof(BinaryEdgeListHeader);
+    rt::impl::parallelFor(task.end - task.begin, [&](size_t i) {
+      const char *record = records + (task.begin + i) * kRecordSize;
+      SrcT src;
+      DestT dest;
+      memcpy(&src, record, sizeof(SrcT));
+      memcpy(&dest, record + sizeof(SrcT), sizeof(DestT));
+      edgeIndex->BufferedInsert(src, dest);
+    });
+    return;
+  }
+
+  std::vector<size_t> bounds = LineChunks(data, task.begin, task.end);
+  size_t numChunks = bounds.size() - 1;
+
+  if (task.format == EdgeListFormat::kEdgeList) {
+    rt::impl::parallelFor(numChunks, [&](size_t c) {
+      ForEachLine(data + bounds[c], data + bounds[c + 1],
+                  [&](const char *pos, const char *end) {
+                    uint64_t src, dest;
+                    if (pos < end && (*pos == '#' || *pos == '%')) return;
+                    if (!ParseUnsigned(pos, end, &src) ||
+                        !ParseUnsigned(pos, end, &dest))
+                      return;
+                    edgeIndex->BufferedInsert(SrcT(src), DestT(dest));
+                  });
+    });
+    return;
+  }
+
+  // METIS vertices are identified by their line number: every chunk counts
+  // its lines first, so that all the chunks can be parsed in parallel.
+  std::vector<uint64_t> firstVertex(numChunks + 1, task.first);
+  rt::impl::parallelFor(numChunks, [&](size_t c) {
+    firstVertex[c + 1] =
+        CountMETISLines(data + bounds[c], data + bounds[c + 1]);
+  });
+  for (size_t c = 0; c < numChunks; ++c) firstVertex[c + 1] += firstVertex[c];
+
+  rt::impl::parallelFor(numChunks, [&](size_t c) {
+    SrcT src = firstVertex[c];
+    std::vector<DestT> neighbors;
+    ForEachLine(data + bounds[c], data + bounds[c + 1],
+                [&](const char *pos, const char *end) {
+                  if (*pos == '%') return;
+                  neighbors.clear();
+                  uint64_t dest;
+                  while (ParseUnsigned(pos, end, &dest))
+                    neighbors.push_back(DestT(dest - 1));
+                  if (!neighbors.empty())
+                    edgeIndex->InsertEdgeList(src, neighbors.data(),
+                                              neighbors.size(), false);
+                  ++src;
+                });
+  });
+}
+
+}  // namespace impl
+
+/// @brief Load an edge list file in an EdgeIndex.
+///
+/// The file is memory mapped on every Locality, so it must be reachable with
+/// the same path from all of them.  Every Locality parses its own byte range
+/// of the file in parallel and inserts the edges with the EdgeIndex
+/// buffered insertions (InsertEdgeList() for METIS neighbors lists).
+///
+/// @tparam EdgeIndexPtrT The type of the shared pointer to the EdgeIndex.
+/// @param path The path of the file.
+/// @param format The format of the file.
+/// @param edgeIndex The EdgeIndex where the edges are inserted.
+/// @throws std::system_error if the file cannot be read.
+/// @throws std::invalid_argument if the file is malformed.
+template <typename EdgeIndexPtrT>
+void LoadEdgeList(const std::string &path, EdgeListFormat format,
+                  const EdgeIndexPtrT &edgeIndex) {
+  using EdgeIndexT = typename EdgeIndexPtrT::element_type;
+  using SrcT = typename EdgeIndexT::SrcType;
+  using DestT = typename EdgeIndexT::DestType;
+  using TaskT = impl::EdgeListTask<typename EdgeIndexT::ObjectID>;
+  using Layout = impl::BatchLayout<TaskT, char>;
+
+  // The ranges of the Localities: records for binary files, bytes otherwise.
+  impl::MappedFile file(path.c_str());
+  uint64_t begin = 0;
+  uint64_t end = file.Size();
+  if (format == EdgeListFormat::kBinary) {
+    end = impl::ReadBinaryHeader<SrcT, DestT>(file).numEdges;
+  } else if (format == EdgeListFormat::kMETIS) {
+    uint64_t numVertices, numEdges;
+    begin = impl::ParseMETISHeader(file, &numVertices, &numEdges);
+  }
+
+  uint32_t numLocalities = rt::numLocalities();
+  std::vector<TaskT> tasks;
+  tasks.reserve(numLocalities);
+  for (uint32_t l = 0; l < numLocalities; ++l) {
+    uint64_t rangeBegin = begin + (end - begin) * l / numLocalities;
+    uint64_t rangeEnd = begin + (end - begin) * (l + 1) / numLocalities;
+    if (format != EdgeListFormat::kBinary) {
+      rangeBegin = std::max(
+          begin, impl::LineStart(file.Data(), file.Size(), rangeBegin));
+      rangeEnd = impl::LineStart(file.Data(), file.Size(), rangeEnd);
+    }
+    tasks.push_back(
+        TaskT{edgeIndex->GetGlobalID(), format, rangeBegin, rangeEnd, 0});
+  }
+
+  auto makePayload = [&path](const TaskT &task) {
+    auto payload = Layout::Allocate(path.size() + 1, task);
+    memcpy(Layout::template Array<0>(payload.get(), path.size() + 1),
+           path.c_str(), path.size() + 1);
+    return payload;
+  };
+  if (format == EdgeListFormat::kMETIS) {
+    // First vertex of every Locality: count the lines of its range.
+    std::vector<uint64_t> numLines(numLocalities);
+    rt::Handle handle;
+    for (uint32_t l = 0; l < numLocalities; ++l) {
+      auto countLambda = [](rt::Handle &, const uint8_t *payload,
+                            const uint32_t size, uint64_t *numLines) {
+        const TaskT &task = Layout::Header(payload);
+        impl::MappedFile file(Layout::template Array<0>(
+            payload, size - sizeof(TaskT)));
+        std::vector<size_t> bounds =
+            impl::LineChunks(file.Data(), task.begin, task.end);
+        std::vector<uint64_t> counts(bounds.size() - 1);
+        rt::impl::parallelFor(counts.size(), [&](size_t c) {
+          counts[c] = impl::CountMETISLines(file.Data() + bounds[c],
+                                            file.Data() + bounds[c + 1]);
+        });
+        *numLines = 0;
+        for (auto count : counts) *numLines += count;
+      };
+      rt::asyncExecuteAtWithRet(handle, rt::Locality(l), countLambda,
+                                makePayload(tasks[l]),
+                                Layout::Bytes(path.size() + 1), &numLines[l]);
+    }
+    rt::waitForCompletion(handle);
+    for (uint32_t l = 1; l < numLocalities; ++l)
+      tasks[l].first = tasks[l - 1].first + numLines[l - 1];
+  }
+
+  rt::Handle handle;
+  for (uint32_t l = 0; l < numLocalities; ++l) {
+    auto loadLambda = [](rt::Handle &, const uint8_t *payload,
+                         const uint32_t size) {
+      impl::LoadEdgeListRange<EdgeIndexT>(
+          Layout::template Array<0>(payload, size - sizeof(TaskT)),
+          Layout::Header(payload));
+    };
+    rt::asyncExecuteAt(handle, rt::Locality(l), loadLambda,
+                       makePayload(tasks[l]), Layout::Bytes(path.size() + 1));
+  }
+  rt::waitForCompletion(handle);
+  edgeIndex->WaitForBufferedInsert();
+}
+
+/// @brief Create an EdgeIndex with the content of an edge list file.
+///
+/// @tparam EdgeIndexT The type of the EdgeIndex.
+/// @param path The path of the file.
+/// @param format The format of the file.
+/// @param numVertices The expected number of source vertices, used to size
+/// the EdgeIndex.  It is read from the header of METIS files when 0, and it
+/// is required for the other formats.
+/// @return A shared pointer to the newly created EdgeIndex.
+/// @throws std::system_error if the file cannot be read.
+/// @throws std::invalid_argument if the file is malformed.
+template <typename EdgeIndexT>
+typename EdgeIndexT::SharedPtr LoadEdgeIndex(const std::string &path,
+                                             EdgeListFormat format,
+                                             size_t numVertices = 0) {
+  if (numVertices == 0) {
+    if (format != EdgeListFormat::kMETIS)
+      throw std::invalid_argument("the number of vertices is required");
+    impl::MappedFile file(path.c_str());
+    uint64_t numEdges;
+    impl::ParseMETISHeader(file, &numVertices, &numEdges);
+  }
+  auto edgeIndex = EdgeIndexT::Create(numVertices);
+  LoadEdgeList(path, format, edgeIndex);
+  return edgeIndex;
+}
+
+/// @brief Write the edges of an EdgeIndex to a binary edge list file.
+///
+/// Binary files load much faster than text files with LoadEdgeList().  Every
+/// Locality writes its own edges, so the path must be reachable with the
+/// same path from all of them.
+///
+/// @tparam EdgeIndexPtrT The type of the shared pointer to the EdgeIndex.
+/// @param path The path of the file.
+/// @param edgeIndex The EdgeIndex to write.
+/// @throws std::system_error if the file cannot be written.
+/// @throws std::invalid_argument if the EdgeIndex has split vertices.
+template <typename EdgeIndexPtrT>
+void WriteBinaryEdgeList(const std::string &path,
+                         const EdgeIndexPtrT &edgeIndex) {
+  using EdgeIndexT = typename EdgeIndexPtrT::element_type;
+  using SrcT = typename EdgeIndexT::SrcType;
+  using DestT = typename EdgeIndexT::DestType;
+  using ObjectID = typename EdgeIndexT::ObjectID;
+  using TaskT = impl::EdgeListTask<ObjectID>;
+  using Layout = impl::BatchLayout<TaskT, char>;
+  constexpr size_t kRecordSize = sizeof(SrcT) + sizeof(DestT);
+  if (edgeIndex->HasSplitVertices())
+    throw std::invalid_argument("split vertices are not supported");
+
+  uint32_t numLocalities = rt::numLocalities();
+  std::vector<uint64_t> numEdges(numLocalities);
+  rt::Handle handle;
+  for (uint32_t l = 0; l < numLocalities; ++l) {
+    auto countLambda = [](rt::Handle &, const ObjectID &oid, uint64_t *res) {
+      *res = EdgeIndexT::GetPtr(oid)->GetLocalIndexPtr()->UpdateNumEdges();
+    };
+    rt::asyncExecuteAtWithRet(handle, rt::Locality(l), countLambda,
+                              edgeIndex->GetGlobalID(), &numEdges[l]);
+  }
+  rt::waitForCompletion(handle);
+
+  impl::BinaryEdgeListHeader header{impl::kBinaryEdgeListMagic, 0,
+                                    sizeof(SrcT), sizeof(DestT)};
+  for (auto count : numEdges) header.numEdges += count;
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1)
+    throw std::system_error(errno, std::generic_category(), path);
+  if (pwrite(fd, &header, sizeof(header), 0) != sizeof(header) ||
+      ftruncate(fd, sizeof(header) + header.numEdges * kRecordSize) == -1) {
+    int error = errno;
+    close(fd);
+    throw std::system_error(error, std::generic_category(), path);
+  }
+  close(fd);
+
+  uint64_t first = 0;
+  std::vector<int> errors(numLocalities);
+  for (uint32_t l = 0; l < numLocalities; ++l) {
+    TaskT task{edgeIndex->GetGlobalID(), EdgeListFormat::kBinary, 0,
+               numEdges[l], first};
+    first += numEdges[l];
+    auto payload = Layout::Allocate(path.size() + 1, task);
+    memcpy(Layout::template Array<0>(payload.get(), path.size() + 1),
+           path.c_str(), path.size() + 1);
+
+    auto writeLambda = [](rt::Handle &, const uint8_t *payload,
+                          const uint32_t size, int *error) {
+      const TaskT &task = Layout::Header(payload);
+      auto localIndex = EdgeIndexT::GetPtr(task.oid)->GetLocalIndexPtr();
+      std::vector<char> records(task.end * kRecordSize);
+      std::atomic<size_t> numRecords(0);
+      char *recordsPtr = records.data();
+      std::atomic<size_t> *numRecordsPtr = &numRecords;
+      auto collectLambda = [](const SrcT &src, const DestT &dest,
+                              char *&records,
+                              std::atomic<size_t> *&numRecords) {
+        char *record =
+            records + numRecords->fetch_add(1, std::memory_order_relaxed) *
+                          kRecordSize;
+        memcpy(record, &src, sizeof(SrcT));
+        memcpy(record + sizeof(SrcT), &dest, sizeof(DestT));
+      };
+      localIndex->ForEachEdge(collectLambda, recordsPtr, numRecordsPtr);
+
+      const char *path =
+          Layout::template Array<0>(payload, size - sizeof(TaskT));
+      *error = 0;
+      int fd = open(path, O_WRONLY);
+      if (fd == -1) {
+        *error = errno;
+        return;
+      }
+      off_t offset = sizeof(impl::BinaryEdgeListHeader) +
+                     task.first * kRecordSize;
+      for (size_t written = 0; written < records.size();) {
+        ssize_t res = pwrite(fd, records.data() + written,
+                             records.size() - written, offset + written);
+        if (res == -1) {
+          *error = errno;
+          break;
+        }
+        written += res;
+      }
+      close(fd);
+    };
+    rt::asyncExecuteAtWithRet(handle, rt::Locality(l), writeLambda, payload,
+                              Layout::Bytes(path.size() + 1), &errors[l]);
+  }
+  rt::waitForCompletion(handle);
+  for (auto error : errors)
+    if (error != 0)
+      throw std::system_error(error, std::generic_category(), path);
+}
+
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_EDGE_LIST_LOADER_H_
@@ -0,0 +1,360 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_LOCAL_CSR_GRAPH_H_
+#define INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_LOCAL_CSR_GRAPH_H_
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "shad/runtime/runtime.h"
+
+namespace shad {
+
+/// @brief The LocalCSRGraph data structure.
+///
+/// SHAD's LocalCSRGraph is a "local", immutable, compressed sparse row
+/// representation of the neighbors lists of a graph: the source vertices are
+/// stored sorted in a contiguous array, and the sorted neighbors of the i-th
+/// vertex are stored in neighbors_[offsets_[i]] ... neighbors_[offsets_[i+1]).
+/// LocalCSRGraphs can be used ONLY on the Locality on which they are created.
+///
+/// Edges can be staged concurrently with StageEdges(); Finalize() merges the
+/// staged edges into the CSR arrays.  Traversals must not overlap with
+/// Finalize().
+///
+/// @tparam SrcT type of source vertices (used as identifiers).
+/// @tparam DestT type of destination vertices (used as identifiers).
+/// @warning SrcT and DestT must be trivially copiable and ordered by
+/// operator<.
+template <typename SrcT, typename DestT>
+class LocalCSRGraph {
+ public:
+  /// Index returned by VertexIndex() for vertices that are not stored.
+  static constexpr size_t kNotFound = ~size_t(0);
+
+  LocalCSRGraph() : offsets_(1, 0) {}
+
+  /// @brief Number of source vertices.
+  size_t Size() const { return vertices_.size(); }
+
+  /// @brief Number of edges.
+  size_t NumEdges() const { return neighbors_.size(); }
+
+  /// @brief Position of a source vertex in the vertices array.
+  /// @return the position of src or kNotFound.
+  size_t VertexIndex(const SrcT& src) const {
+    auto it = std::lower_bound(vertices_.begin(), vertices_.end(), src);
+    if (it == vertices_.end() || src < *it) return kNotFound;
+    return it - vertices_.begin();
+  }
+
+  /// @brief Number of neighbors of a given vertex.
+  size_t GetDegree(const SrcT& src) const {
+    size_t idx = VertexIndex(src);
+    return idx == kNotFound ? 0 : offsets_[idx + 1] - offsets_[idx];
+  }
+
+  /// @brief The sorted source vertices.
+  const SrcT* Vertices() const { return vertices_.data(); }
+
+  /// @brief The offsets of the neighbors lists, Size() + 1 entries.
+  const size_t* Offsets() const { return offsets_.data(); }
+
+  /// @brief The concatenated sorted neighbors lists.
+  const DestT* Neighbors() const { return neighbors_.data(); }
+
+  /// @brief Stage a batch of edges, to be added by Finalize().
+  void StageEdges(const SrcT* srcs, const DestT* dests, size_t numEdges) {
+    std::lock_guard<std::mutex> _(stagingLock_);
+    for (size_t i = 0; i < numEdges; ++i)
+      staging_.emplace_back(srcs[i], dests[i]);
+  }
+
+  /// @brief Add the staged edges to the CSR arrays.
+  ///
+  /// The sort is skipped when the edges have been staged in order, as when
+  /// they come from a sorted edge stream.
+  void Finalize() {
+    std::vector<std::pair<SrcT, DestT>> edges;
+    edges.swap(staging_);
+    if (edges.empty()) return;
+
+    if (!neighbors_.empty()) {
+      edges.reserve(edges.size() + neighbors_.size());
+      for (size_t i = 0; i < vertices_.size(); ++i)
+        for (size_t j = offsets_[i]; j < offsets_[i + 1]; ++j)
+          edges.emplace_back(vertices_[i], neighbors_[j]);
+    }
+    if (!std::is_sorted(edges.begin(), edges.end()))
+      std::sort(edges.begin(), edges.end());
+    Build(edges);
+  }
+
+  /// @brief Replace the content of the graph with the edges of a local
+  /// edge index.
+  ///
+  /// @tparam LocalIndexT The type of the local edge index.
+  /// @param index The local edge index.
+  template <typename LocalIndexT>
+  void Freeze(LocalIndexT* index) {
+    std::vector<std::pair<SrcT, DestT>> edges(index->UpdateNumEdges());
+    std::atomic<size_t> numEdges(0);
+    std::pair<SrcT, DestT>* edgesPtr = edges.data();
+    std::atomic<size_t>* numEdgesPtr = &numEdges;
+    auto collectLambda = [](const SrcT& src, const DestT& dest,
+                            std::pair<SrcT, DestT>*& edges,
+                            std::atomic<size_t>*& numEdges) {
+      edges[numEdges->fetch_add(1, std::memory_order_relaxed)] = {src, dest};
+    };
+    index->ForEachEdge(collectLambda, edgesPtr, numEdgesPtr);
+    edges.resize(numEdges.load());
+    std::sort(edges.begin(), edges.end());
+    Build(edges);
+  }
+
+  template <typename ApplyFunT, typename... Args>
+  void ForEachNeighbor(const SrcT& src, ApplyFunT&& function, Args&... args) {
+    size_t idx = VertexIndex(src);
+    if (idx == kNotFound) return;
+    for (size_t j = offsets_[idx]; j < offsets_[idx + 1]; ++j)
+      function(src, neighbors_[j], args...);
+  }
+
+  template <typename ApplyFunT, typename... Args>
+  void AsyncForEachNeighbor(rt::Handle& handle, const SrcT& src,
+                            ApplyFunT&& function, Args&... args) {
+    size_t idx = VertexIndex(src);
+    if (idx == kNotFound) return;
+    for (size_t j = offsets_[idx]; j < offsets_[idx + 1]; ++j)
+      function(handle, src, neighbors_[j], args...);
+  }
+
+  template <typename ApplyFunT, typename... Args>
+  void ForEachVertex(ApplyFunT&& function, Args&... args);
+
+  template <typename ApplyFunT, typename... Args>
+  void AsyncForEachVertex(rt::Handle& handle, ApplyFunT&& function,
+                          Args&... args);
+
+  template <typename ApplyFunT, typename... Args>
+  void ForEachEdge(ApplyFunT&& function, Args&... args);
+
+  template <typename ApplyFunT, typename... Args>
+  void AsyncForEachEdge(rt::Handle& handle, ApplyFunT&& function,
+                        Args&... args);
+
+ private:
+  static constexpr size_t kChunksPerThread = 4;
+
+  std::vector<SrcT> vertices_;
+  std::vector<size_t> offsets_;
+  std::vector<DestT> neighbors_;
+  std::vector<std::pair<SrcT, DestT>> staging_;
+  std::mutex stagingLock_;
+
+  // Build the CSR arrays from edges sorted by (src, dest).
+  void Build(const std::vector<std::pair<SrcT, DestT>>& edges) {
+    vertices_.clear();
+    offsets_.assign(1, 0);
+    neighbors_.resize(edges.size());
+    for (size_t i = 0; i < edges.size(); ++i) {
+      if (i == 0 || edges[i - 1].first < edges[i].first) {
+        if (i != 0) offsets_.push_back(i);
+        vertices_.push_back(edges[i].first);
+      }
+      neighbors_[i] = edges[i].second;
+    }
+    if (!edges.empty()) offsets_.push_back(edges.size());
+    vertices_.shrink_to_fit();
+    offsets_.shrink_to_fit();
+  }
+
+  size_t NumChunks() const {
+    return std::max<size_t>(
+        std::min<size_t>(vertices_.size(),
+                         kChunksPerThread * rt::impl::getConcurrency()),
+        1);
+  }
+
+  size_t ChunkSize(size_t numChunks) const {
+    return (vertices_.size() + numChunks - 1) / numChunks;
+  }
+
+  template <typename ApplyFunT, typename... Args, std::size_t... is>
+  static void CallForEachVertexFun(LocalCSRGraph<SrcT, DestT>* graphPtr,
+                                   size_t begin, size_t end,
+                                   ApplyFunT function,
+                                   std::tuple<Args...>& args,
+                                   std::index_sequence<is...>) {
+    for (size_t i = begin; i < end; ++i)
+      function(graphPtr->vertices_[i], std::get<is>(args)...);
+  }
+
+  template <typename ApplyFunT, typename... Args, std::size_t... is>
+  static void AsyncCallForEachVertexFun(rt::Handle& handle,
+                                        LocalCSRGraph<SrcT, DestT>* graphPtr,
+                                        size_t begin, size_t end,
+                                        ApplyFunT function,
+                                        std::tuple<Args...>& args,
+                                        std::index_sequence<is...>) {
+    for (size_t i = begin; i < end; ++i)
+      function(handle, graphPtr->vertices_[i], std::get<is>(args)...);
+  }
+
+  template <typename ApplyFunT, typename... Args, std::size_t... is>
+  static void CallForEachEdgeFun(LocalCSRGraph<SrcT, DestT>* graphPtr,
+                                 size_t begin, size_t end, ApplyFunT function,
+                                 std::tuple<Args...>& args,
+                                 std::index_sequence<is...>) {
+    for (size_t i = begin; i < end; ++i) {
+      const SrcT& src = graphPtr->vertices_[i];
+      for (size_t j = graphPtr->offsets_[i]; j < graphPtr->offsets_[i + 1]; ++j)
+        function(src, graphPtr->neighbors_[j], std::get<is>(args)...);
+    }
+  }
+
+  template <typename ApplyFunT, typename... Args, std::size_t... is>
+  static void AsyncCallForEachEdgeFun(rt::Handle& handle,
+                                      LocalCSRGraph<SrcT, DestT>* graphPtr,
+                                      size_t begin, size_t end,
+                                      ApplyFunT function,
+                                      std::tuple<Args...>& args,
+                                      std::index_sequence<is...>) {
+    for (size_t i = begin; i < end; ++i) {
+      const SrcT& src = graphPtr->vertices_[i];
+      for (size_t j = graphPtr->offsets_[i]; j < graphPtr->offsets_[i + 1]; ++j)
+        function(handle, src, graphPtr->neighbors_[j], std::get<is>(args)...);
+    }
+  }
+};
+
+template <typename SrcT, typename DestT>
+template <typename ApplyFunT, typename... Args>
+void LocalCSRGraph<SrcT, DestT>::ForEachVertex(ApplyFunT&& function,
+                                               Args&... args) {
+  using FunctionTy = void (*)(const SrcT&, Args&...);
+  FunctionTy fn = std::forward<decltype(function)>(function);
+  using LGraphPtr = LocalCSRGraph<SrcT, DestT>*;
+  using ArgsTuple =
+      std::tuple<LGraphPtr, FunctionTy, size_t, std::tuple<Args...>>;
+  size_t numChunks = NumChunks();
+  ArgsTuple argsTuple(this, fn, ChunkSize(numChunks),
+                      std::tuple<Args...>(args...));
+  auto feLambda = [](const ArgsTuple& args, size_t chunk) {
+    ArgsTuple& tuple = const_cast<ArgsTuple&>(args);
+    LGraphPtr graphPtr = std::get<0>(tuple);
+    size_t begin = chunk * std::get<2>(tuple);
+    size_t end = std::min(begin + std::get<2>(tuple), graphPtr->Size());
+    CallForEachVertexFun(graphPtr, begin, end, std::get<1>(tuple),
+                         std::get<3>(tuple),
+                         std::make_index_sequence<sizeof...(Args)>{});
+  };
+  rt::forEachAt(rt::thisLocality(), feLambda, argsTuple, numChunks);
+}
+
+template <typename SrcT, typename DestT>
+template <typename ApplyFunT, typename... Args>
+void LocalCSRGraph<SrcT, DestT>::AsyncForEachVertex(rt::Handle& handle,
+                                                    ApplyFunT&& function,
+                                                    Args&... args) {
+  using FunctionTy = void (*)(rt::Handle&, const SrcT&, Args&...);
+  FunctionTy fn = std::forward<decltype(function)>(function);
+  using LGraphPtr = LocalCSRGraph<SrcT, DestT>*;
+  using ArgsTuple =
+      std::tuple<LGraphPtr, FunctionTy, size_t, std::tuple<Args...>>;
+  size_t numChunks = NumChunks();
+  ArgsTuple argsTuple(this, fn, ChunkSize(numChunks),
+                      std::tuple<Args...>(args...));
+  auto feLambda = [](rt::Handle& handle, const ArgsTuple& args, size_t chunk) {
+    ArgsTuple& tuple = const_cast<ArgsTuple&>(args);
+    LGraphPtr graphPtr = std::get<0>(tuple);
+    size_t begin = chunk * std::get<2>(tuple);
+    size_t end = std::min(begin + std::get<2>(tuple), graphPtr->Size());
+    AsyncCallForEachVertexFun(handle, graphPtr, begin, end, std::get<1>(tuple),
+                              std::get<3>(tuple),
+                              std::make_index_sequence<sizeof...(Args)>{});
+  };
+  rt::asyncForEachAt(handle, rt::thisLocality(), feLambda, argsTuple,
+                     numChunks);
+}
+
+template <typename SrcT, typename DestT>
+template <typename ApplyFunT, typename... Args>
+void LocalCSRGraph<SrcT, DestT>::ForEachEdge(ApplyFunT&& function,
+                                             Args&... args) {
+  using FunctionTy = void (*)(const SrcT&, const DestT&, Args&...);
+  FunctionTy fn = std::forward<decltype(function)>(function);
+  using LGraphPtr = LocalCSRGraph<SrcT, DestT>*;
+  using ArgsTuple =
+      std::tuple<LGraphPtr, FunctionTy, size_t, std::tuple<Args...>>;
+  size_t numChunks = NumChunks();
+  ArgsTuple argsTuple(this, fn, ChunkSize(numChunks),
+                      std::tuple<Args...>(args...));
+  auto feLambda = [](const ArgsTuple& args, size_t chunk) {
+    ArgsTuple& tuple = const_cast<ArgsTuple&>(args);
+    LGraphPtr graphPtr = std::get<0>(tuple);
+    size_t begin = chunk * std::get<2>(tuple);
+    size_t end = std::min(begin + std::get<2>(tuple), graphPtr->Size());
+    CallForEachEdgeFun(graphPtr, begin, end, std::get<1>(tuple),
+                       std::get<3>(tuple),
+                       std::make_index_sequence<sizeof...(Args)>{});
+  };
+  rt::forEachAt(rt::thisLocality(), feLambda, argsTuple, numChunks);
+}
+
+template <typename SrcT, typename DestT>
+template <typename ApplyFunT, typename... Args>
+void LocalCSRGraph<SrcT, DestT>::AsyncForEachEdge(rt::Handle& handle,
+                                                  ApplyFunT&& function,
+                                                  Args&... args) {
+  using FunctionTy =
+      void (*)(rt::Handle&, const SrcT&, const DestT&, Args&...);
+  FunctionTy fn = std::forward<decltype(function)>(function);
+  using LGraphPtr = LocalCSRGraph<SrcT, DestT>*;
+  using ArgsTuple =
+      std::tuple<LGraphPtr, FunctionTy, size_t, std::tuple<Args...>>;
+  size_t numChunks = NumChunks();
+  ArgsTuple argsTuple(this, fn, ChunkSize(numChunks),
+                      std::tuple<Args...>(args...));
+  auto feLambda = [](rt::Handle& handle, const ArgsTuple& args, size_t chunk) {
+    ArgsTuple& tuple = const_cast<ArgsTuple&>(args);
+    LGraphPtr graphPtr = std::get<0>(tuple);
+    size_t begin = chunk * std::get<2>(tuple);
+    size_t end = std::min(begin + std::get<2>(tuple), graphPtr->Size());
+    AsyncCallForEachEdgeFun(handle, graphPtr, begin, end, std::get<1>(tuple),
+                            std::get<3>(tuple),
+                            std::make_index_sequence<sizeof...(Args)>{});
+  };
+  rt::asyncForEachAt(handle, rt::thisLocality(), feLambda, argsTuple,
+                     numChunks);
+}
+
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_EXTENSIONS_GRAPH_LIBRARY_LOCAL_CSR_GRAPH_H_
@@ -184,9 +184,8 @@ class LocalEdgeIndex {
       __sync_fetch_and_add(edgeCntPtr, nsize);
     };
     edges_.edgeList_.ForEachKey(countLambda, eiptr, cntPtr);
-    // FIXME : This is should be atomic.
-    numEdges_ = numEdges;
-    return numEdges_;
+    numEdges_.store(numEdges);
+    return numEdges;
   }
 
   void Insert(const SrcT& src, const DestT& dest) {
@@ -345,7 +344,7 @@ class LocalEdgeIndex {
   StorageT* GetEdgesPtr() { return &edges_; }
 
  private:
-  size_t numEdges_;
+  std::atomic<size_t> numEdges_;
   StorageT edges_;
 };
 
@@ -0,0 +1,379 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_SHAD_RUNTIME_COLLECTIVES_H_
+#define INCLUDE_SHAD_RUNTIME_COLLECTIVES_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "shad/runtime/locality.h"
+#include "shad/runtime/runtime.h"
+
+namespace shad {
+
+namespace rt {
+
+namespace impl {
+
+/// @brief Split point of a locality range in the collective trees.
+///
+/// The locality at the head of [first, last) delegates [mid, last) to the
+/// locality mid and keeps working on [first, mid).  Repeating the split until
+/// a single locality is left yields a binomial tree of depth log2(last -
+/// first) rooted at first.
+inline uint32_t TreeSplit(uint32_t first, uint32_t last) {
+  return first + (last - first + 1) / 2;
+}
+
+/// @brief Per-locality scratch space of the in-flight tree scans.
+///
+/// The up-sweep of a scan leaves on every inner node of the tree the
+/// partial results of its left sub-trees; the down-sweep picks them up to
+/// compute the prefix of the right sub-trees.  Entries are keyed by the scan
+/// identifier and by the child locality they refer to.
+class CollectiveScratch {
+ public:
+  /// @brief Generate an identifier unique across all the localities.
+  static uint64_t NewId() {
+    static std::atomic<uint32_t> counter(0);
+    uint64_t locality = static_cast<uint32_t>(thisLocality());
+    return ((locality + 1) << 32) | counter++;
+  }
+
+  /// @brief Store a value.
+  template <typename T>
+  static void Put(uint64_t id, uint32_t key, const T &value) {
+    std::lock_guard<Lock> _(GetLock());
+    GetTable()[std::make_pair(id, key)] = std::make_shared<T>(value);
+  }
+
+  /// @brief Retrieve and erase a value stored with Put.
+  template <typename T>
+  static T Take(uint64_t id, uint32_t key) {
+    std::lock_guard<Lock> _(GetLock());
+    auto &table = GetTable();
+    auto itr = table.find(std::make_pair(id, key));
+    T value = *std::static_pointer_cast<T>(itr->second);
+    table.erase(itr);
+    return value;
+  }
+
+ private:
+  using TableT = std::map<std::pair<uint64_t, uint32_t>, std::shared_ptr<void>>;
+
+  static TableT &GetTable() {
+    static TableT table;
+    return table;
+  }
+
+  static Lock &GetLock() {
+    static Lock lock;
+    return lock;
+  }
+};
+
+template <typename FunT, typename InArgsT>
+struct TreeBroadcastArgs {
+  uint32_t first;
+  uint32_t last;
+  FunT func;
+  InArgsT args;
+};
+
+template <typename FunT, typename InArgsT>
+void TreeBroadcastStep(const TreeBroadcastArgs<FunT, InArgsT> &step) {
+  using StepT = TreeBroadcastArgs<FunT, InArgsT>;
+  Handle handle;
+  for (uint32_t last = step.last; last - step.first > 1;) {
+    uint32_t mid = TreeSplit(step.first, last);
+    asyncExecuteAt(handle, Locality(mid),
+                   [](Handle &, const StepT &child) {
+                     TreeBroadcastStep(child);
+                   },
+                   StepT{mid, last, step.func, step.args});
+    last = mid;
+  }
+  step.func(step.args);
+  waitForCompletion(handle);
+}
+
+template <typename MapT, typename OpT, typename InArgsT>
+struct TreeReduceArgs {
+  uint64_t id;
+  uint32_t first;
+  uint32_t last;
+  MapT map;
+  OpT op;
+  InArgsT args;
+};
+
+// Up-sweep shared by treeReduce and treeExclusiveScan.  When id is not zero
+// every inner node records the partial result of [first, mid) for each of
+// its children mid.
+template <typename ResT, typename MapT, typename OpT, typename InArgsT>
+ResT TreeReduceStep(const TreeReduceArgs<MapT, OpT, InArgsT> &step) {
+  using StepT = TreeReduceArgs<MapT, OpT, InArgsT>;
+  std::vector<uint32_t> children;
+  for (uint32_t last = step.last; last - step.first > 1;) {
+    last = TreeSplit(step.first, last);
+    children.push_back(last);
+  }
+
+  std::vector<ResT> partials(children.size());
+  Handle handle;
+  for (size_t i = 0; i < children.size(); ++i) {
+    uint32_t last = i == 0 ? step.last : children[i - 1];
+    asyncExecuteAtWithRet(
+        handle, Locality(children[i]),
+        [](Handle &, const StepT &child, ResT *result) {
+          *result = TreeReduceStep<ResT>(child);
+        },
+        StepT{step.id, children[i], last, step.map, step.op, step.args},
+        &partials[i]);
+  }
+  ResT result = step.map(step.args);
+  waitForCompletion(handle);
+
+  for (size_t i = children.size(); i > 0; --i) {
+    if (step.id != 0) CollectiveScratch::Put(step.id, children[i - 1], result);
+    result = step.op(result, partials[i - 1]);
+  }
+  return result;
+}
+
+template <typename ConsumeT, typename OpT, typename ResT, typename InArgsT>
+struct TreeScanArgs {
+  uint64_t id;
+  uint32_t first;
+  uint32_t last;
+  ConsumeT consume;
+  OpT op;
+  ResT prefix;
+  InArgsT args;
+};
+
+// Down-sweep of treeExclusiveScan.
+template <typename ConsumeT, typename OpT, typename ResT, typename InArgsT>
+void TreeScanStep(const TreeScanArgs<ConsumeT, OpT, ResT, InArgsT> &step) {
+  using StepT = TreeScanArgs<ConsumeT, OpT, ResT, InArgsT>;
+  Handle handle;
+  for (uint32_t last = step.last; last - step.first > 1;) {
+    uint32_t mid = TreeSplit(step.first, last);
+    ResT left = CollectiveScratch::Take<ResT>(step.id, mid);
+    asyncExecuteAt(handle, Locality(mid),
+                   [](Handle &, const StepT &child) { TreeScanStep(child); },
+                   StepT{step.id, mid, last, step.consume, step.op,
+                         step.op(step.prefix, left), step.args});
+    last = mid;
+  }
+  step.consume(step.args, step.prefix);
+  waitForCompletion(handle);
+}
+
+template <typename ConsumeT>
+struct ConsumeResult {
+  template <typename InArgsT, typename ResT>
+  void operator()(const std::tuple<InArgsT, ResT> &args) const {
+    consume(std::get<0>(args), std::get<1>(args));
+  }
+
+  ConsumeT consume;
+};
+
+}  // namespace impl
+
+/// @brief Execute a function on every locality of a range.
+///
+/// Unlike executeOnAll, the calling locality sends a single message: the
+/// tasks are spawned along a binomial tree rooted at the first locality of
+/// the range, so the fan-out of every locality is at most log2(range.size()).
+///
+/// @tparam FunT The type of the function object to be executed.  It is
+/// shipped together with the arguments, so it must be memcopy-able (a
+/// lambda without captures or a stateless functor).  The prototype must be:
+/// @code
+/// void(const InArgsT &);
+/// @endcode
+/// @tparam InArgsT The type of the argument accepted by the function.  It
+/// must be memcopy-able.
+///
+/// @param range The localities where func is executed.
+/// @param func The function to execute.
+/// @param args The arguments to be passed to the function.
+template <typename FunT, typename InArgsT>
+void treeBroadcast(const localities_range &range, FunT &&func,
+                   const InArgsT &args) {
+  using StepT = impl::TreeBroadcastArgs<std::decay_t<FunT>, InArgsT>;
+  if (range.size() == 0) return;
+  uint32_t first = static_cast<uint32_t>(range.begin());
+  uint32_t last = static_cast<uint32_t>(range.end());
+  executeAt(range.begin(),
+            [](const StepT &step) { impl::TreeBroadcastStep(step); },
+            StepT{first, last, func, args});
+}
+
+/// @brief Reduce the values mapped on every locality of a range.
+///
+/// The partial results travel up a binomial tree rooted at the first locality
+/// of the range and are combined in locality order, so op must be
+/// associative but need not be commutative.
+///
+/// @tparam ResT The type of the result.  It must be DefaultConstructible and
+/// memcopy-able.
+/// @tparam MapT The type of the function object computing the local value.
+/// It must be memcopy-able and its prototype must be:
+/// @code
+/// ResT(const InArgsT &);
+/// @endcode
+/// @tparam OpT The type of the binary function object combining two results.
+/// It must be memcopy-able.
+/// @tparam InArgsT The type of the argument accepted by map.
+///
+/// @param range The localities where map is executed.
+/// @param map The function computing the local values.
+/// @param op The combining operation.
+/// @param init The initial value of the reduction.
+/// @param args The arguments to be passed to map.
+///
+/// @return op(init, map(args)@range.begin(), ..., map(args)@range.end() - 1).
+template <typename ResT, typename MapT, typename OpT, typename InArgsT>
+ResT treeReduce(const localities_range &range, MapT &&map, OpT &&op,
+                const ResT &init, const InArgsT &args) {
+  using StepT =
+      impl::TreeReduceArgs<std::decay_t<MapT>, std::decay_t<OpT>, InArgsT>;
+  if (range.size() == 0) return init;
+  uint32_t first = static_cast<uint32_t>(range.begin());
+  uint32_t last = static_cast<uint32_t>(range.end());
+  ResT result;
+  executeAtWithRet(range.begin(),
+                   [](const StepT &step, ResT *result) {
+                     *result = impl::TreeReduceStep<ResT>(step);
+                   },
+                   StepT{0, first, last, map, op, args}, &result);
+  return op(init, result);
+}
+
+/// @brief Reduce the values mapped on every locality of a range and hand the
+/// result back to every locality of the range.
+///
+/// It is a treeReduce followed by a treeBroadcast: both legs take log2 of the
+/// range size steps.
+///
+/// @tparam ConsumeT The type of the function object receiving the result.
+/// It must be memcopy-able and its prototype must be:
+/// @code
+/// void(const InArgsT &, const ResT &);
+/// @endcode
+///
+/// @param range The localities where map and consume are executed.
+/// @param map The function computing the local values.
+/// @param op The combining operation.
+/// @param consume The function receiving the reduced value.
+/// @param init The initial value of the reduction.
+/// @param args The arguments to be passed to map and consume.
+///
+/// @return The reduced value.
+///
+/// @see treeReduce
+template <typename ResT, typename MapT, typename OpT, typename ConsumeT,
+          typename InArgsT>
+ResT treeAllReduce(const localities_range &range, MapT &&map, OpT &&op,
+                   ConsumeT &&consume, const ResT &init, const InArgsT &args) {
+  ResT result = treeReduce(range, map, op, init, args);
+  treeBroadcast(range, impl::ConsumeResult<std::decay_t<ConsumeT>>{consume},
+                std::make_tuple(args, result));
+  return result;
+}
+
+/// @brief Exclusive scan of the values mapped on every locality of a range.
+///
+/// Every locality of the range computes its local value with map, the values
+/// are combined with an up-sweep and a down-sweep over a binomial tree rooted
+/// at the first locality of the range, and every locality receives through
+/// consume the combination of init with the values of the localities that
+/// precede it.  Each sweep takes log2 of the range size steps; map is always
+/// executed on every locality before consume is executed on any of them.
+///
+/// @tparam ResT The type of the result.  It must be DefaultConstructible and
+/// memcopy-able.
+/// @tparam MapT The type of the function object computing the local value.
+/// It must be memcopy-able and its prototype must be:
+/// @code
+/// ResT(const InArgsT &);
+/// @endcode
+/// @tparam OpT The type of the associative binary function object combining
+/// two results.  It must be memcopy-able.
+/// @tparam ConsumeT The type of the function object receiving the prefix.
+/// It must be memcopy-able and its prototype must be:
+/// @code
+/// void(const InArgsT &, const ResT &);
+/// @endcode
+/// @tparam InArgsT The type of the argument accepted by map and consume.
+///
+/// @param range The localities where map and consume are executed.
+/// @param map The function computing the local values.
+/// @param op The combining operation.
+/// @param consume The function receiving the prefixes.
+/// @param init The prefix of the first locality.
+/// @param args The arguments to be passed to map and consume.
+///
+/// @return The combination of init with all the mapped values.
+template <typename ResT, typename MapT, typename OpT, typename ConsumeT,
+          typename InArgsT>
+ResT treeExclusiveScan(const localities_range &range, MapT &&map, OpT &&op,
+                       ConsumeT &&consume, const ResT &init,
+                       const InArgsT &args) {
+  using UpStepT =
+      impl::TreeReduceArgs<std::decay_t<MapT>, std::decay_t<OpT>, InArgsT>;
+  using DownStepT = impl::TreeScanArgs<std::decay_t<ConsumeT>,
+                                       std::decay_t<OpT>, ResT, InArgsT>;
+  if (range.size() == 0) return init;
+  uint64_t id = impl::CollectiveScratch::NewId();
+  uint32_t first = static_cast<uint32_t>(range.begin());
+  uint32_t last = static_cast<uint32_t>(range.end());
+  ResT total;
+  executeAtWithRet(range.begin(),
+                   [](const UpStepT &step, ResT *result) {
+                     *result = impl::TreeReduceStep<ResT>(step);
+                   },
+                   UpStepT{id, first, last, map, op, args}, &total);
+  executeAt(range.begin(),
+            [](const DownStepT &step) { impl::TreeScanStep(step); },
+            DownStepT{id, first, last, consume, op, init, args});
+  return op(init, total);
+}
+
+}  // namespace rt
+
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_RUNTIME_COLLECTIVES_H_
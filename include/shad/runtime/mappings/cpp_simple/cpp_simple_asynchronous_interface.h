@@ -25,6 +25,7 @@
 #ifndef INCLUDE_SHAD_RUNTIME_MAPPINGS_CPP_SIMPLE_CPP_SIMPLE_ASYNCHRONOUS_INTERFACE_H_
 #define INCLUDE_SHAD_RUNTIME_MAPPINGS_CPP_SIMPLE_CPP_SIMPLE_ASYNCHRONOUS_INTERFACE_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -34,6 +35,7 @@
 #include "shad/runtime/handle.h"
 #include "shad/runtime/locality.h"
 #include "shad/runtime/mapping_traits.h"
+#include "shad/runtime/mappings/cpp_simple/cpp_simple_thread_pool.h"
 #include "shad/runtime/mappings/cpp_simple/cpp_simple_traits_mapping.h"
 #include "shad/runtime/mappings/cpp_simple/cpp_simple_utility.h"
 
@@ -48,11 +50,9 @@ struct AsynchronousInterface<cpp_tag> {
   static void asyncExecuteAt(Handle &handle, const Locality &loc,
                              FunT &&function, const InArgsT &args) {
     checkLocality(loc);
-    handle.id_ =
-        handle.IsNull() ? HandleTrait<cpp_tag>::CreateNewHandle() : handle.id_;
     using FunctionTy = void (*)(Handle &, const InArgsT &);
     FunctionTy fn = std::forward<decltype(function)>(function);
-    fn(handle, args);
+    spawn(handle, [=, &handle] { fn(handle, args); });
   }
 
   template <typename FunT>
@@ -61,11 +61,21 @@ struct AsynchronousInterface<cpp_tag> {
                              const std::shared_ptr<uint8_t> &argsBuffer,
                              const uint32_t bufferSize) {
     checkLocality(loc);
-    handle.id_ =
-        handle.IsNull() ? HandleTrait<cpp_tag>::CreateNewHandle() : handle.id_;
     using FunctionTy = void (*)(Handle &, const uint8_t *, const uint32_t);
     FunctionTy fn = std::forward<decltype(function)>(function);
-    fn(handle, argsBuffer.get(), bufferSize);
+    spawn(handle, [=, &handle] { fn(handle, argsBuffer.get(), bufferSize); });
+  }
+
+  template <typename FunT, typename InArgsT>
+  static void asyncExecuteAfter(Handle &predecessor, Handle &handle,
+                                FunT &&function, const InArgsT &args) {
+    using FunctionTy = void (*)(Handle &, const InArgsT &);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    if (predecessor.IsNull())
+      return spawn(handle, [=, &handle] { fn(handle, args); });
+    if (handle.IsNull()) handle.id_ = HandleTrait<cpp_tag>::CreateNewHandle();
+    ThreadPool::Instance().SpawnAfter(*predecessor.id_, *handle.id_,
+                                      [=, &handle] { fn(handle, args); });
   }
 
   template <typename FunT, typename InArgsT>
@@ -74,12 +84,11 @@ struct AsynchronousInterface<cpp_tag> {
                                         uint8_t *resultBuffer,
                                         uint32_t *resultSize) {
     checkLocality(loc);
-    handle.id_ =
-        handle.IsNull() ? HandleTrait<cpp_tag>::CreateNewHandle() : handle.id_;
     using FunctionTy =
         void (*)(Handle &, const InArgsT &, uint8_t *, uint32_t *);
     FunctionTy fn = std::forward<decltype(function)>(function);
-    fn(handle, args, resultBuffer, resultSize);
+    spawn(handle,
+          [=, &handle] { fn(handle, args, resultBuffer, resultSize); });
   }
 
   template <typename FunT>
@@ -88,12 +97,12 @@ struct AsynchronousInterface<cpp_tag> {
       const std::shared_ptr<uint8_t> &argsBuffer, const uint32_t bufferSize,
       uint8_t *resultBuffer, uint32_t *resultSize) {
     checkLocality(loc);
-    handle.id_ =
-        handle.IsNull() ? HandleTrait<cpp_tag>::CreateNewHandle() : handle.id_;
     using FunctionTy = void (*)(Handle &, const uint8_t *, const uint32_t,
                                 uint8_t *, uint32_t *);
     FunctionTy fn = std::forward<decltype(function)>(function);
-    fn(handle, argsBuffer.get(), bufferSize, resultBuffer, resultSize);
+    spawn(handle, [=, &handle] {
+      fn(handle, argsBuffer.get(), bufferSize, resultBuffer, resultSize);
+    });
   }
 
   template <typename FunT, typename InArgsT, typename ResT>
@@ -101,11 +110,9 @@ struct AsynchronousInterface<cpp_tag> {
                                     FunT &&function, const InArgsT &args,
                                     ResT *result) {
     checkLocality(loc);
-    handle.id_ =
-        handle.IsNull() ? HandleTrait<cpp_tag>::CreateNewHandle() : handle.id_;
     using FunctionTy = void (*)(Handle &, const InArgsT &, ResT *);
     FunctionTy fn = std::forward<decltype(function)>(function);
-    fn(handle, args, result);
+    spawn(handle, [=, &handle] { fn(handle, args, result); });
   }
 
   template <typename FunT, typename ResT>
@@ -114,33 +121,29 @@ struct AsynchronousInterface<cpp_tag> {
                                     const std::shared_ptr<uint8_t> &argsBuffer,
                                     const uint32_t bufferSize, ResT *result) {
     checkLocality(loc);
-    handle.id_ =
-        handle.IsNull() ? HandleTrait<cpp_tag>::CreateNewHandle() : handle.id_;
     using FunctionTy =
         void (*)(Handle &, const uint8_t *, const uint32_t, ResT *);
     FunctionTy fn = std::forward<decltype(function)>(function);
-    fn(handle, argsBuffer.get(), bufferSize, result);
+    spawn(handle, [=, &handle] {
+      fn(handle, argsBuffer.get(), bufferSize, result);
+    });
   }
 
   template <typename FunT, typename InArgsT>
   static void asyncExecuteOnAll(Handle &handle, FunT &&function,
                                 const InArgsT &args) {
-    handle.id_ =
-        handle.IsNull() ? HandleTrait<cpp_tag>::CreateNewHandle() : handle.id_;
     using FunctionTy = void (*)(Handle &, const InArgsT &);
     FunctionTy fn = std::forward<decltype(function)>(function);
-    fn(handle, args);
+    spawn(handle, [=, &handle] { fn(handle, args); });
   }
 
   template <typename FunT>
   static void asyncExecuteOnAll(Handle &handle, FunT &&function,
                                 const std::shared_ptr<uint8_t> &argsBuffer,
                                 const uint32_t bufferSize) {
-    handle.id_ =
-        handle.IsNull() ? HandleTrait<cpp_tag>::CreateNewHandle() : handle.id_;
     using FunctionTy = void (*)(Handle &, const uint8_t *, const uint32_t);
     FunctionTy fn = std::forward<decltype(function)>(function);
-    fn(handle, argsBuffer.get(), bufferSize);
+    spawn(handle, [=, &handle] { fn(handle, argsBuffer.get(), bufferSize); });
   }
 
   template <typename FunT, typename InArgsT>
@@ -148,11 +151,11 @@ struct AsynchronousInterface<cpp_tag> {
                              FunT &&function, const InArgsT &args,
                              const size_t numIters) {
     checkLocality(loc);
-    handle.id_ =
-        handle.IsNull() ? HandleTrait<cpp_tag>::CreateNewHandle() : handle.id_;
     using FunctionTy = void (*)(Handle &, const InArgsT &, size_t);
     FunctionTy fn = std::forward<decltype(function)>(function);
-    for (auto i = 0; i < numIters; ++i) fn(handle, args, i);
+    spawnForEach(handle, numIters, [=, &handle](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) fn(handle, args, i);
+    });
   }
 
   template <typename FunT>
@@ -161,23 +164,23 @@ struct AsynchronousInterface<cpp_tag> {
                              const std::shared_ptr<uint8_t> &argsBuffer,
                              const uint32_t bufferSize, const size_t numIters) {
     checkLocality(loc);
-    handle.id_ =
-        handle.IsNull() ? HandleTrait<cpp_tag>::CreateNewHandle() : handle.id_;
     using FunctionTy =
         void (*)(Handle &, const uint8_t *, const uint32_t, size_t);
     FunctionTy fn = std::forward<decltype(function)>(function);
-    for (auto i = 0; i < numIters; ++i)
-      fn(handle, argsBuffer.get(), bufferSize, i);
+    spawnForEach(handle, numIters, [=, &handle](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i)
+        fn(handle, argsBuffer.get(), bufferSize, i);
+    });
   }
 
   template <typename FunT, typename InArgsT>
   static void asyncForEachOnAll(Handle &handle, FunT &&function,
                                 const InArgsT &args, const size_t numIters) {
-    handle.id_ =
-        handle.IsNull() ? HandleTrait<cpp_tag>::CreateNewHandle() : handle.id_;
     using FunctionTy = void (*)(Handle &, const InArgsT &, size_t);
     FunctionTy fn = std::forward<decltype(function)>(function);
-    for (auto i = 0; i < numIters; ++i) fn(handle, args, i);
+    spawnForEach(handle, numIters, [=, &handle](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) fn(handle, args, i);
+    });
   }
 
   template <typename FunT>
@@ -185,13 +188,40 @@ struct AsynchronousInterface<cpp_tag> {
                                 const std::shared_ptr<uint8_t> &argsBuffer,
                                 const uint32_t bufferSize,
                                 const size_t numIters) {
-    handle.id_ =
-        handle.IsNull() ? HandleTrait<cpp_tag>::CreateNewHandle() : handle.id_;
     using FunctionTy =
         void (*)(Handle &, const uint8_t *, const uint32_t, size_t);
     FunctionTy fn = std::forward<decltype(function)>(function);
-    for (auto i = 0; i < numIters; ++i)
-      fn(handle, argsBuffer.get(), bufferSize, i);
+    spawnForEach(handle, numIters, [=, &handle](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i)
+        fn(handle, argsBuffer.get(), bufferSize, i);
+    });
+  }
+
+ private:
+  static constexpr size_t kChunksPerThread = 4;
+
+  // Tasks reference the Handle: like in the TBB mapping, it must not be
+  // destroyed before waiting for their completion.
+  template <typename TaskT>
+  static void spawn(Handle &handle, TaskT &&task) {
+    if (handle.IsNull()) handle.id_ = HandleTrait<cpp_tag>::CreateNewHandle();
+    ThreadPool::Instance().Spawn(*handle.id_, std::forward<TaskT>(task));
+  }
+
+  // Split numIters iterations in chunks run as independent tasks.
+  template <typename ChunkT>
+  static void spawnForEach(Handle &handle, const size_t numIters,
+                           const ChunkT &chunk) {
+    if (handle.IsNull()) handle.id_ = HandleTrait<cpp_tag>::CreateNewHandle();
+    if (numIters == 0) return;
+    auto &pool = ThreadPool::Instance();
+    size_t numChunks =
+        std::min(numIters, kChunksPerThread * pool.Concurrency());
+    size_t chunkSize = (numIters + numChunks - 1) / numChunks;
+    for (size_t begin = 0; begin < numIters; begin += chunkSize) {
+      size_t end = std::min(begin + chunkSize, numIters);
+      pool.Spawn(*handle.id_, [=] { chunk(begin, end); });
+    }
   }
 };
 
@@ -29,6 +29,7 @@
 #include <utility>
 
 #include "shad/runtime/locality.h"
+#include "shad/runtime/mappings/cpp_simple/cpp_simple_thread_pool.h"
 #include "shad/runtime/mappings/cpp_simple/cpp_simple_traits_mapping.h"
 #include "shad/runtime/mappings/cpp_simple/cpp_simple_utility.h"
 #include "shad/runtime/synchronous_interface.h"
@@ -123,7 +124,8 @@ struct SynchronousInterface<cpp_tag> {
     using FunctionTy = void (*)(const InArgsT &, size_t);
     FunctionTy fn = std::forward<decltype(function)>(function);
     checkLocality(loc);
-    for (auto i = 0; i < numIters; ++i) fn(args, i);
+    ThreadPool::Instance().ParallelFor(numIters,
+                                       [&](size_t i) { fn(args, i); });
   }
 
   template <typename FunT>
@@ -133,7 +135,8 @@ struct SynchronousInterface<cpp_tag> {
     using FunctionTy = void (*)(const uint8_t *, const uint32_t, size_t);
     FunctionTy fn = std::forward<decltype(function)>(function);
     checkLocality(loc);
-    for (auto i = 0; i < numIters; ++i) fn(argsBuffer.get(), bufferSize, i);
+    ThreadPool::Instance().ParallelFor(
+        numIters, [&](size_t i) { fn(argsBuffer.get(), bufferSize, i); });
   }
 
   template <typename FunT, typename InArgsT>
@@ -141,7 +144,8 @@ struct SynchronousInterface<cpp_tag> {
                            const size_t numIters) {
     using FunctionTy = void (*)(const InArgsT &, size_t);
     FunctionTy fn = std::forward<decltype(function)>(function);
-    for (auto i = 0; i < numIters; ++i) fn(args, i);
+    ThreadPool::Instance().ParallelFor(numIters,
+                                       [&](size_t i) { fn(args, i); });
   }
 
   template <typename FunT>
@@ -150,7 +154,8 @@ struct SynchronousInterface<cpp_tag> {
                            const uint32_t bufferSize, const size_t numIters) {
     using FunctionTy = void (*)(const uint8_t *, const uint32_t, size_t);
     FunctionTy fn = std::forward<decltype(function)>(function);
-    for (auto i = 0; i < numIters; ++i) fn(argsBuffer.get(), bufferSize, i);
+    ThreadPool::Instance().ParallelFor(
+        numIters, [&](size_t i) { fn(argsBuffer.get(), bufferSize, i); });
   }
 };
 
@@ -0,0 +1,487 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_SHAD_RUNTIME_MAPPINGS_CPP_SIMPLE_CPP_SIMPLE_THREAD_POOL_H_
+#define INCLUDE_SHAD_RUNTIME_MAPPINGS_CPP_SIMPLE_CPP_SIMPLE_THREAD_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace shad {
+namespace rt {
+namespace impl {
+
+/// @brief Move-only closure of a task run by the ThreadPool.
+///
+/// Closures up to kInlineSize bytes are stored in place, so that spawning a
+/// task does not allocate; larger closures are moved to the heap.  The
+/// trivially copyable ones, e.g. lambdas capturing pointers and PODs, are
+/// relocated with a memcpy and need no destruction.
+class PoolTask {
+ public:
+  PoolTask() = default;
+
+  template <typename FunT,
+            typename = std::enable_if_t<
+                !std::is_same<std::decay_t<FunT>, PoolTask>::value>>
+  PoolTask(FunT &&function) {  // NOLINT
+    using ClosureT = std::decay_t<FunT>;
+    if constexpr (sizeof(ClosureT) <= kInlineSize &&
+                  alignof(ClosureT) <= alignof(std::max_align_t) &&
+                  std::is_nothrow_move_constructible<ClosureT>::value) {
+      new (storage_) ClosureT(std::forward<FunT>(function));
+      ops_ = &InlineOps<ClosureT>::kOps;
+    } else {
+      new (storage_) ClosureT *(new ClosureT(std::forward<FunT>(function)));
+      ops_ = &HeapOps<ClosureT>::kOps;
+    }
+  }
+
+  PoolTask(PoolTask &&other) noexcept { MoveFrom(&other); }
+
+  PoolTask &operator=(PoolTask &&other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(&other);
+    }
+    return *this;
+  }
+
+  PoolTask(const PoolTask &) = delete;
+  PoolTask &operator=(const PoolTask &) = delete;
+
+  ~PoolTask() { Reset(); }
+
+  void operator()() { ops_->invoke(storage_); }
+
+ private:
+  static constexpr size_t kInlineSize = 64;
+
+  struct Ops {
+    void (*invoke)(void *);
+    // Null when a memcpy of the storage relocates the closure.
+    void (*relocate)(void *from, void *to);
+    // Null when the closure needs no destruction.
+    void (*destroy)(void *);
+  };
+
+  template <typename ClosureT>
+  struct InlineOps {
+    static void Invoke(void *closure) {
+      (*static_cast<ClosureT *>(closure))();
+    }
+    static void Relocate(void *from, void *to) {
+      auto closure = static_cast<ClosureT *>(from);
+      new (to) ClosureT(std::move(*closure));
+      closure->~ClosureT();
+    }
+    static void Destroy(void *closure) {
+      static_cast<ClosureT *>(closure)->~ClosureT();
+    }
+    static constexpr bool kTrivial =
+        std::is_trivially_copyable<ClosureT>::value;
+    static constexpr Ops kOps{&Invoke, kTrivial ? nullptr : &Relocate,
+                              kTrivial ? nullptr : &Destroy};
+  };
+
+  // Only the pointer to the closure is stored in place.
+  template <typename ClosureT>
+  struct HeapOps {
+    static ClosureT *Get(void *storage) {
+      return *static_cast<ClosureT **>(storage);
+    }
+    static void Invoke(void *storage) { (*Get(storage))(); }
+    static void Destroy(void *storage) { delete Get(storage); }
+    static constexpr Ops kOps{&Invoke, nullptr, &Destroy};
+  };
+
+  void MoveFrom(PoolTask *other) {
+    if (other->ops_ == nullptr) return;
+    if (other->ops_->relocate != nullptr)
+      other->ops_->relocate(other->storage_, storage_);
+    else
+      std::memcpy(storage_, other->storage_, kInlineSize);
+    ops_ = other->ops_;
+    other->ops_ = nullptr;
+  }
+
+  void Reset() {
+    if (ops_ != nullptr && ops_->destroy != nullptr) ops_->destroy(storage_);
+    ops_ = nullptr;
+  }
+
+  alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+  const Ops *ops_ = nullptr;
+};
+
+/// @brief Completion counter of the tasks spawned on a Handle.
+///
+/// The first exception thrown by one of the tasks is stored and rethrown
+/// by the thread waiting for their completion.  Continuations are spawned
+/// when no task of the Handle is pending anymore.
+struct CppHandle {
+  struct Continuation {
+    // The Handle accounting the continuation.
+    CppHandle *handle;
+    PoolTask task;
+  };
+
+  std::atomic<size_t> pending{0};
+  std::mutex errorLock;
+  std::exception_ptr error;
+  // Guards the continuations, and the last decrement of pending.
+  std::mutex continuationLock;
+  std::vector<Continuation> continuations;
+};
+
+/// @brief Work-stealing thread pool backing the cpp_simple mapping.
+///
+/// Every worker owns a deque of tasks: it pushes and pops its own tasks from
+/// the back and steals from the front of the other deques when it runs out
+/// of work.  Threads that are not part of the pool submit tasks round-robin
+/// and, like the workers, execute pending tasks while they wait for the
+/// completion of a Handle, so that nested parallelism cannot deadlock.
+///
+/// A thread holding a runtime lock only executes the tasks of the Handle it
+/// is waiting for: any other task might try to acquire the same lock.
+class ThreadPool {
+ public:
+  using Task = PoolTask;
+
+  /// @brief The pool of the process, started at its first use.
+  static ThreadPool &Instance() {
+    static ThreadPool pool;
+    return pool;
+  }
+
+  /// @brief Number of hardware threads used by the pool.
+  size_t Concurrency() const { return concurrency_; }
+
+  /// @brief Set the number of hardware threads of the pool.
+  ///
+  /// Mappings running several localities on the same host share the
+  /// hardware threads among them.  It has effect only before the first call
+  /// to Instance(); zero selects all the hardware threads.
+  ///
+  /// @param concurrency The number of hardware threads.
+  static void Configure(size_t concurrency) { configured_ = concurrency; }
+
+  /// @brief Account a runtime lock acquired by the calling thread.
+  static void LockAcquired() { ++locksHeld_; }
+
+  /// @brief Account a runtime lock released by the calling thread.
+  static void LockReleased() { --locksHeld_; }
+
+  /// @brief Run a task asynchronously, accounting it in handle.
+  ///
+  /// @param handle The completion counter of the task.
+  /// @param task The task to run.
+  template <typename TaskT>
+  void Spawn(CppHandle &handle, TaskT &&task) {
+    handle.pending.fetch_add(1, std::memory_order_relaxed);
+    Submit(&handle, Task(std::forward<TaskT>(task)));
+  }
+
+  /// @brief Run a task asynchronously once all the tasks spawned on
+  /// predecessor have completed, accounting it in handle from now on.
+  ///
+  /// The task is stored on predecessor and spawned by the thread completing
+  /// its last pending task, so no thread blocks in the meanwhile.  If a task
+  /// of predecessor failed, the task is not run and handle gets the error.
+  ///
+  /// @param predecessor The completion counter of the tasks to wait for.
+  /// @param handle The completion counter of the task.
+  /// @param task The task to run.
+  template <typename TaskT>
+  void SpawnAfter(CppHandle &predecessor, CppHandle &handle, TaskT &&task) {
+    handle.pending.fetch_add(1, std::memory_order_relaxed);
+    std::exception_ptr error;
+    {
+      std::lock_guard<std::mutex> _(predecessor.continuationLock);
+      if (predecessor.pending.load(std::memory_order_acquire) != 0) {
+        predecessor.continuations.push_back(
+            CppHandle::Continuation{&handle, Task(std::forward<TaskT>(task))});
+        return;
+      }
+      std::lock_guard<std::mutex> errorGuard(predecessor.errorLock);
+      error = predecessor.error;
+    }
+    if (!error) {
+      Submit(&handle, Task(std::forward<TaskT>(task)));
+      return;
+    }
+    SetError(handle, error);
+    Complete(handle);
+  }
+
+  /// @brief Account the completion of a task of handle, spawning the
+  /// continuations of handle when it was the last pending one.
+  ///
+  /// @param handle The completion counter of the task.
+  void Complete(CppHandle &handle) {
+    size_t pending = handle.pending.load(std::memory_order_relaxed);
+    while (pending > 1) {
+      if (handle.pending.compare_exchange_weak(pending, pending - 1,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed))
+        return;
+    }
+    // The last task: the waiters of handle synchronize on the lock before
+    // releasing it, see Drain().
+    std::vector<CppHandle::Continuation> continuations;
+    std::exception_ptr error;
+    {
+      std::lock_guard<std::mutex> _(handle.continuationLock);
+      if (handle.pending.fetch_sub(1, std::memory_order_acq_rel) != 1 ||
+          handle.continuations.empty())
+        return;
+      std::swap(continuations, handle.continuations);
+      // The error stays on handle, for its own waiters.
+      std::lock_guard<std::mutex> errorGuard(handle.errorLock);
+      error = handle.error;
+    }
+    for (auto &continuation : continuations) {
+      if (!error) {
+        Submit(continuation.handle, std::move(continuation.task));
+        continue;
+      }
+      SetError(*continuation.handle, error);
+      Complete(*continuation.handle);
+    }
+  }
+
+  /// @brief Wait for all the tasks spawned on handle, executing pending
+  /// tasks in the meanwhile.
+  ///
+  /// @param handle The completion counter to wait for.
+  void WaitFor(CppHandle &handle) {
+    Drain(handle);
+    if (handle.error) {
+      std::exception_ptr error;
+      std::swap(error, handle.error);
+      std::rethrow_exception(error);
+    }
+  }
+
+  /// @brief Execute function(i) for i in [0, numIters) on the pool and wait
+  /// for completion.  The calling thread executes the first chunk of
+  /// iterations.
+  ///
+  /// @tparam FunT The type of the function.
+  /// @param numIters The number of iterations.
+  /// @param function The function executed at every iteration.
+  template <typename FunT>
+  void ParallelFor(size_t numIters, const FunT &function) {
+    size_t numChunks = std::min(numIters, kChunksPerThread * concurrency_);
+    if (numChunks <= 1) {
+      for (size_t i = 0; i < numIters; ++i) function(i);
+      return;
+    }
+
+    size_t chunkSize = (numIters + numChunks - 1) / numChunks;
+    CppHandle handle;
+    for (size_t begin = chunkSize; begin < numIters; begin += chunkSize) {
+      size_t end = std::min(begin + chunkSize, numIters);
+      Spawn(handle, [&function, begin, end] {
+        for (size_t i = begin; i < end; ++i) function(i);
+      });
+    }
+    try {
+      for (size_t i = 0; i < chunkSize; ++i) function(i);
+    } catch (...) {
+      // The spawned chunks reference the stack of this call.
+      Drain(handle);
+      throw;
+    }
+    WaitFor(handle);
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+ private:
+  static constexpr size_t kChunksPerThread = 4;
+  static constexpr size_t kNotAWorker = ~size_t(0);
+
+  struct Entry {
+    // The Handle accounting the task.
+    CppHandle *handle{nullptr};
+    Task task;
+  };
+
+  struct Worker {
+    std::mutex lock;
+    std::deque<Entry> tasks;
+  };
+
+  // Index of the worker running on this thread, kNotAWorker otherwise.
+  static inline thread_local size_t thisWorker_ = kNotAWorker;
+  // Number of runtime locks held by this thread.
+  static inline thread_local size_t locksHeld_ = 0;
+  static inline size_t configured_ = 0;
+
+  size_t concurrency_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+  std::atomic<size_t> nextWorker_{0};
+  std::atomic<size_t> queued_{0};
+  std::atomic<size_t> sleepers_{0};
+  std::mutex sleepLock_;
+  std::condition_variable sleepCV_;
+  bool stop_{false};
+
+  ThreadPool()
+      : concurrency_(configured_ != 0
+                         ? configured_
+                         : std::max(std::thread::hardware_concurrency(), 1u)) {
+    // The threads waiting on a Handle execute tasks as well: one worker less
+    // than the hardware threads, but at least one to progress asynchronous
+    // tasks while the caller is not waiting.
+    size_t numWorkers = std::max(concurrency_ - 1, size_t(1));
+    for (size_t i = 0; i < numWorkers; ++i)
+      workers_.emplace_back(new Worker());
+    for (size_t i = 0; i < numWorkers; ++i)
+      threads_.emplace_back([this, i] { WorkerLoop(i); });
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> _(sleepLock_);
+      stop_ = true;
+    }
+    sleepCV_.notify_all();
+    for (auto &thread : threads_) thread.join();
+  }
+
+  void Submit(CppHandle *handle, Task &&task) {
+    size_t id = thisWorker_ != kNotAWorker
+                    ? thisWorker_
+                    : nextWorker_.fetch_add(1, std::memory_order_relaxed) %
+                          workers_.size();
+    {
+      std::lock_guard<std::mutex> _(workers_[id]->lock);
+      workers_[id]->tasks.push_back(Entry{handle, std::move(task)});
+    }
+    queued_.fetch_add(1);
+    if (sleepers_.load() != 0) {
+      { std::lock_guard<std::mutex> _(sleepLock_); }
+      sleepCV_.notify_one();
+    }
+  }
+
+  // Record error on handle, unless a task of handle already failed.
+  static void SetError(CppHandle &handle, const std::exception_ptr &error) {
+    std::lock_guard<std::mutex> _(handle.errorLock);
+    if (!handle.error) handle.error = error;
+  }
+
+  // Pop a task from the deque of this thread or steal one from the others.
+  // When only is not null, consider only the tasks accounted in it.
+  bool Pop(Entry *entry, const CppHandle *only) {
+    size_t numWorkers = workers_.size();
+    size_t self = thisWorker_;
+    if (self != kNotAWorker) {
+      Worker &worker = *workers_[self];
+      std::lock_guard<std::mutex> _(worker.lock);
+      for (auto it = worker.tasks.rbegin(); it != worker.tasks.rend(); ++it) {
+        if (only != nullptr && it->handle != only) continue;
+        *entry = std::move(*it);
+        worker.tasks.erase(std::next(it).base());
+        queued_.fetch_sub(1);
+        return true;
+      }
+    }
+    size_t start = self != kNotAWorker ? self + 1 : 0;
+    for (size_t i = 0; i < numWorkers; ++i) {
+      size_t victim = (start + i) % numWorkers;
+      if (victim == self) continue;
+      Worker &worker = *workers_[victim];
+      std::lock_guard<std::mutex> _(worker.lock);
+      for (auto it = worker.tasks.begin(); it != worker.tasks.end(); ++it) {
+        if (only != nullptr && it->handle != only) continue;
+        *entry = std::move(*it);
+        worker.tasks.erase(it);
+        queued_.fetch_sub(1);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Run a pending task.  While waiting for handle, a thread holding a
+  // runtime lock only runs the tasks accounted in it.
+  bool RunOne(const CppHandle *handle = nullptr) {
+    Entry entry;
+    if (!Pop(&entry, locksHeld_ != 0 ? handle : nullptr)) return false;
+    try {
+      entry.task();
+    } catch (...) {
+      SetError(*entry.handle, std::current_exception());
+    }
+    Complete(*entry.handle);
+    return true;
+  }
+
+  // Run tasks until no task of handle is pending.  The thread completing the
+  // last task may still hold the lock of handle: the handle can be released
+  // only after it is done with it.
+  void Drain(CppHandle &handle) {
+    while (handle.pending.load(std::memory_order_acquire) != 0) {
+      if (!RunOne(&handle)) std::this_thread::yield();
+    }
+    std::lock_guard<std::mutex> _(handle.continuationLock);
+  }
+
+  void WorkerLoop(size_t id) {
+    thisWorker_ = id;
+    for (;;) {
+      if (RunOne()) continue;
+
+      std::unique_lock<std::mutex> guard(sleepLock_);
+      sleepers_.fetch_add(1);
+      sleepCV_.wait(guard, [this] { return stop_ || queued_.load() != 0; });
+      sleepers_.fetch_sub(1);
+      if (stop_ && queued_.load() == 0) return;
+    }
+  }
+};
+
+}  // namespace impl
+}  // namespace rt
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_RUNTIME_MAPPINGS_CPP_SIMPLE_CPP_SIMPLE_THREAD_POOL_H_
@@ -30,8 +30,10 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 
 #include "shad/runtime/mapping_traits.h"
+#include "shad/runtime/mappings/cpp_simple/cpp_simple_thread_pool.h"
 
 namespace shad {
 
@@ -40,8 +42,6 @@ namespace impl {
 
 struct cpp_tag {};
 
-struct CppHandle {};
-
 template <>
 struct HandleTrait<cpp_tag> {
   using HandleTy = std::shared_ptr<CppHandle>;
@@ -64,15 +64,24 @@ struct HandleTrait<cpp_tag> {
 
   static HandleTy CreateNewHandle() { return std::make_shared<CppHandle>(); }
 
-  static void WaitFor(ParameterTy H) {}
+  static void WaitFor(ParameterTy H) {
+    if (H == nullptr) return;
+    ThreadPool::Instance().WaitFor(*H);
+  }
 };
 
 template <>
 struct LockTrait<cpp_tag> {
   using LockTy = std::mutex;
 
-  static void lock(LockTy &L) { L.lock(); }
-  static void unlock(LockTy &L) { L.unlock(); }
+  static void lock(LockTy &L) {
+    L.lock();
+    ThreadPool::LockAcquired();
+  }
+  static void unlock(LockTy &L) {
+    ThreadPool::LockReleased();
+    L.unlock();
+  }
 };
 
 template <>
@@ -81,8 +90,8 @@ struct RuntimeInternalsTrait<cpp_tag> {
 
   static void Finalize() {}
 
-  static size_t Concurrency() { return 1; }
-  static void Yield() {}
+  static size_t Concurrency() { return ThreadPool::Instance().Concurrency(); }
+  static void Yield() { std::this_thread::yield(); }
 
   static uint32_t ThisLocality() { return 0; }
   static uint32_t NullLocality() { return -1; }
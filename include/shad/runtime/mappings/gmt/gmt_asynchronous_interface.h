@@ -38,6 +38,7 @@
 #include "shad/runtime/locality.h"
 #include "shad/runtime/mapping_traits.h"
 #include "shad/runtime/mappings/gmt/gmt_traits_mapping.h"
+#include "shad/runtime/mappings/gmt/gmt_transfer.h"
 #include "shad/runtime/mappings/gmt/gmt_utility.h"
 
 namespace shad {
@@ -61,10 +62,9 @@ struct AsynchronousInterface<gmt_tag> {
 
     handle = (handle.IsNull()) ? Handle(HandleTrait<gmt_tag>::CreateNewHandle())
                                : handle;
-    gmt_execute_on_node_with_handle(
-        getNodeId(loc), execAsyncFunWrapper<FunT, InArgsT>,
-        reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs), nullptr,
-        nullptr, GMT_PREEMPTABLE, getGmtHandle(handle));
+    executeOnNode(getNodeId(loc), execAsyncFunWrapper<FunT, InArgsT>,
+                  reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs),
+                  nullptr, nullptr, getGmtHandle(handle));
   }
 
   template <typename FunT>
@@ -90,9 +90,32 @@ struct AsynchronousInterface<gmt_tag> {
     handle = (handle.IsNull()) ? Handle(HandleTrait<gmt_tag>::CreateNewHandle())
                                : handle;
 
-    gmt_execute_on_node_with_handle(
-        getNodeId(loc), execAsyncFunWrapper, buffer.get(), newBufferSize,
-        nullptr, nullptr, GMT_PREEMPTABLE, getGmtHandle(handle));
+    executeOnNode(getNodeId(loc), execAsyncFunWrapper, buffer.get(),
+                  newBufferSize, nullptr, nullptr, getGmtHandle(handle));
+  }
+
+  // The continuation is suspended while it waits for predecessor.
+  template <typename FunT, typename InArgsT>
+  static void asyncExecuteAfter(Handle &predecessor, Handle &handle,
+                                FunT &&function, const InArgsT &args) {
+    using FunctionTy = void (*)(Handle &, const InArgsT &);
+    // The continuation waits on a copy of the predecessor, which the caller
+    // keeps using and may wait for or reuse.
+    struct ContinuationArgs {
+      HandleTrait<gmt_tag>::HandleTy predecessor;
+      FunctionTy fn;
+      InArgsT args;
+    };
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    Locality here(RuntimeInternalsTrait<gmt_tag>::ThisLocality());
+    if (predecessor.IsNull()) return asyncExecuteAt(handle, here, fn, args);
+    asyncExecuteAt(
+        handle, here,
+        [](Handle &successor, const ContinuationArgs &continuation) {
+          HandleTrait<gmt_tag>::WaitForDependency(continuation.predecessor);
+          continuation.fn(successor, continuation.args);
+        },
+        ContinuationArgs{predecessor.id_, fn, args});
   }
 
   template <typename FunT, typename InArgsT>
@@ -113,10 +136,10 @@ struct AsynchronousInterface<gmt_tag> {
     handle = (handle.IsNull()) ? Handle(HandleTrait<gmt_tag>::CreateNewHandle())
                                : handle;
 
-    gmt_execute_on_node_with_handle(
+    executeOnNodeWithResult(
         getNodeId(loc), asyncExecFunWithRetBuffWrapper<FunctionTy, InArgsT>,
         reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs),
-        resultBuffer, resultSize, GMT_PREEMPTABLE, getGmtHandle(handle));
+        resultBuffer, resultSize, getGmtHandle(handle));
   }
 
   template <typename FunT>
@@ -143,10 +166,9 @@ struct AsynchronousInterface<gmt_tag> {
     handle = (handle.IsNull()) ? Handle(HandleTrait<gmt_tag>::CreateNewHandle())
                                : handle;
 
-    gmt_execute_on_node_with_handle(
-        getNodeId(loc), asyncExecFunWithRetBuffWrapper, buffer.get(),
-        newBufferSize, resultBuffer, resultSize, GMT_PREEMPTABLE,
-        getGmtHandle(handle));
+    executeOnNodeWithResult(getNodeId(loc), asyncExecFunWithRetBuffWrapper,
+                            buffer.get(), newBufferSize, resultBuffer,
+                            resultSize, getGmtHandle(handle));
   }
 
   template <typename FunT, typename ResT>
@@ -173,10 +195,9 @@ struct AsynchronousInterface<gmt_tag> {
     handle = (handle.IsNull()) ? Handle(HandleTrait<gmt_tag>::CreateNewHandle())
                                : handle;
 
-    gmt_execute_on_node_with_handle(
-        getNodeId(loc), asyncExecFunWithRetWrapper<ResT>, buffer.get(),
-        newBufferSize, result, &garbageSize, GMT_PREEMPTABLE,
-        getGmtHandle(handle));
+    executeOnNodeWithRet(getNodeId(loc), asyncExecFunWithRetWrapper<ResT>,
+                         buffer.get(), newBufferSize, result, sizeof(ResT),
+                         getGmtHandle(handle));
   }
 
   template <typename FunT, typename InArgsT, typename ResT>
@@ -192,15 +213,13 @@ struct AsynchronousInterface<gmt_tag> {
 
     ExecFunWrapperArgs<FunctionTy, InArgsT> funArgs{fn, args};
 
-    uint32_t resultSize = 0;
-
     handle = (handle.IsNull()) ? Handle(HandleTrait<gmt_tag>::CreateNewHandle())
                                : handle;
 
-    gmt_execute_on_node_with_handle(
+    executeOnNodeWithRet(
         getNodeId(loc), asyncExecFunWithRetWrapper<FunctionTy, InArgsT, ResT>,
         reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs), result,
-        &garbageSize, GMT_PREEMPTABLE, getGmtHandle(handle));
+        sizeof(ResT), getGmtHandle(handle));
   }
 
   template <typename FunT, typename InArgsT>
@@ -217,10 +236,9 @@ struct AsynchronousInterface<gmt_tag> {
     handle = (handle.IsNull()) ? Handle(HandleTrait<gmt_tag>::CreateNewHandle())
                                : handle;
 
-    gmt_execute_on_all_with_handle(execAsyncFunWrapper<FunctionTy, InArgsT>,
-                                   reinterpret_cast<const uint8_t *>(&funArgs),
-                                   sizeof(funArgs), GMT_PREEMPTABLE,
-                                   getGmtHandle(handle));
+    executeOnAllNodes(execAsyncFunWrapper<FunctionTy, InArgsT>,
+                      reinterpret_cast<const uint8_t *>(&funArgs),
+                      sizeof(funArgs), getGmtHandle(handle));
   }
 
   template <typename FunT>
@@ -244,9 +262,8 @@ struct AsynchronousInterface<gmt_tag> {
     handle = (handle.IsNull()) ? Handle(HandleTrait<gmt_tag>::CreateNewHandle())
                                : handle;
 
-    gmt_execute_on_all_with_handle(execAsyncFunWrapper, buffer.get(),
-                                   newBufferSize, GMT_PREEMPTABLE,
-                                   getGmtHandle(handle));
+    executeOnAllNodes(execAsyncFunWrapper, buffer.get(), newBufferSize,
+                      getGmtHandle(handle));
   }
 
   template <typename FunT, typename InArgsT>
@@ -272,11 +289,10 @@ struct AsynchronousInterface<gmt_tag> {
 
     ExecFunWrapperArgs<FunctionTy, InArgsT> funArgs{fn, args};
 
-    gmt_for_loop_on_node_with_handle(
-        getNodeId(loc), numIters, workload,
-        asyncForEachWrapper<FunctionTy, InArgsT>,
-        reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs),
-        getGmtHandle(handle));
+    forLoopOnNode(getNodeId(loc), numIters, workload,
+                  asyncForEachWrapper<FunctionTy, InArgsT>,
+                  reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs),
+                  getGmtHandle(handle));
   }
 
   template <typename FunT>
@@ -314,9 +330,8 @@ struct AsynchronousInterface<gmt_tag> {
         numIters / (gmt_num_workers() * kOverSubscriptionFactor);
     workload = std::max(workload, uint32_t(1));
 
-    gmt_for_loop_on_node_with_handle(getNodeId(loc), numIters, workload,
-                                     asyncForEachWrapper, buffer.get(),
-                                     newBufferSize, getGmtHandle(handle));
+    forLoopOnNode(getNodeId(loc), numIters, workload, asyncForEachWrapper,
+                  buffer.get(), newBufferSize, getGmtHandle(handle));
   }
 
   template <typename FunT, typename InArgsT>
@@ -340,10 +355,9 @@ struct AsynchronousInterface<gmt_tag> {
     handle = (handle.IsNull()) ? Handle(HandleTrait<gmt_tag>::CreateNewHandle())
                                : handle;
 
-    gmt_for_loop_with_handle(
-        numIters, workload, asyncForEachWrapper<FunctionTy, InArgsT>,
-        reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs),
-        GMT_SPAWN_SPREAD, getGmtHandle(handle));
+    forLoopOnAll(numIters, workload, asyncForEachWrapper<FunctionTy, InArgsT>,
+                 reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs),
+                 getGmtHandle(handle));
   }
 
   template <typename FunT>
@@ -380,9 +394,8 @@ struct AsynchronousInterface<gmt_tag> {
     handle = (handle.IsNull()) ? Handle(HandleTrait<gmt_tag>::CreateNewHandle())
                                : handle;
 
-    gmt_for_loop_with_handle(numIters, workload, asyncForEachWrapper,
-                             buffer.get(), newBufferSize, GMT_SPAWN_SPREAD,
-                             getGmtHandle(handle));
+    forLoopOnAll(numIters, workload, asyncForEachWrapper, buffer.get(),
+                 newBufferSize, getGmtHandle(handle));
   }
 };
 
@@ -35,6 +35,7 @@
 
 #include "shad/runtime/locality.h"
 #include "shad/runtime/mappings/gmt/gmt_traits_mapping.h"
+#include "shad/runtime/mappings/gmt/gmt_transfer.h"
 #include "shad/runtime/mappings/gmt/gmt_utility.h"
 #include "shad/runtime/synchronous_interface.h"
 
@@ -57,9 +58,9 @@ struct SynchronousInterface<gmt_tag> {
 
     ExecFunWrapperArgs<FunctionTy, InArgsT> funArgs{fn, args};
 
-    gmt_execute_on_node(getNodeId(loc), execFunWrapper<FunctionTy, InArgsT>,
-                        reinterpret_cast<const uint8_t *>(&funArgs),
-                        sizeof(funArgs), nullptr, nullptr, GMT_PREEMPTABLE);
+    executeOnNode(getNodeId(loc), execFunWrapper<FunctionTy, InArgsT>,
+                  reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs),
+                  nullptr, nullptr, GMT_HANDLE_NULL);
   }
 
   template <typename FunT>
@@ -81,8 +82,8 @@ struct SynchronousInterface<gmt_tag> {
     if (argsBuffer != nullptr && bufferSize)
       memcpy(buffer.get() + sizeof(fn), argsBuffer.get(), bufferSize);
 
-    gmt_execute_on_node(impl::getNodeId(loc), execFunWrapper, buffer.get(),
-                        newBufferSize, nullptr, nullptr, GMT_PREEMPTABLE);
+    executeOnNode(getNodeId(loc), execFunWrapper, buffer.get(), newBufferSize,
+                  nullptr, nullptr, GMT_HANDLE_NULL);
   }
 
   template <typename FunT, typename InArgsT>
@@ -98,10 +99,10 @@ struct SynchronousInterface<gmt_tag> {
 
     ExecFunWrapperArgs<FunctionTy, InArgsT> funArgs{fn, args};
 
-    gmt_execute_on_node(
+    executeOnNodeWithResult(
         getNodeId(loc), execFunWithRetBuffWrapper<FunctionTy, InArgsT>,
         reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs),
-        resultBuffer, resultSize, GMT_PREEMPTABLE);
+        resultBuffer, resultSize, GMT_HANDLE_NULL);
   }
 
   template <typename FunT>
@@ -126,9 +127,9 @@ struct SynchronousInterface<gmt_tag> {
     if (argsBuffer != nullptr && bufferSize)
       memcpy(buffer.get() + sizeof(fn), argsBuffer.get(), bufferSize);
 
-    gmt_execute_on_node(getNodeId(loc), execFunWithRetBuffWrapper, buffer.get(),
-                        newBufferSize, resultBuffer, resultSize,
-                        GMT_PREEMPTABLE);
+    executeOnNodeWithResult(getNodeId(loc), execFunWithRetBuffWrapper,
+                            buffer.get(), newBufferSize, resultBuffer,
+                            resultSize, GMT_HANDLE_NULL);
   }
 
   template <typename FunT, typename InArgsT, typename ResT>
@@ -143,11 +144,11 @@ struct SynchronousInterface<gmt_tag> {
 
     ExecFunWrapperArgs<FunctionTy, InArgsT> funArgs{fn, args};
 
-    uint32_t resultSize = 0;
-    gmt_execute_on_node(getNodeId(loc),
-                        execFunWithRetWrapper<FunctionTy, InArgsT, ResT>,
-                        reinterpret_cast<const uint8_t *>(&funArgs),
-                        sizeof(funArgs), result, &resultSize, GMT_PREEMPTABLE);
+    executeOnNodeWithRet(getNodeId(loc),
+                         execFunWithRetWrapper<FunctionTy, InArgsT, ResT>,
+                         reinterpret_cast<const uint8_t *>(&funArgs),
+                         sizeof(funArgs), result, sizeof(ResT),
+                         GMT_HANDLE_NULL);
   }
 
   template <typename FunT, typename ResT>
@@ -169,10 +170,9 @@ struct SynchronousInterface<gmt_tag> {
     if (argsBuffer != nullptr && bufferSize)
       memcpy(buffer.get() + sizeof(fn), argsBuffer.get(), bufferSize);
 
-    uint32_t retSize;
-    gmt_execute_on_node(getNodeId(loc), execFunWithRetWrapper<ResT>,
-                        buffer.get(), newBufferSize, result, &retSize,
-                        GMT_PREEMPTABLE);
+    executeOnNodeWithRet(getNodeId(loc), execFunWithRetWrapper<ResT>,
+                         buffer.get(), newBufferSize, result, sizeof(ResT),
+                         GMT_HANDLE_NULL);
   }
 
   template <typename FunT, typename InArgsT>
@@ -185,9 +185,9 @@ struct SynchronousInterface<gmt_tag> {
 
     ExecFunWrapperArgs<FunctionTy, InArgsT> funArgs{fn, args};
 
-    gmt_execute_on_all(execFunWrapper<FunctionTy, InArgsT>,
-                       reinterpret_cast<const uint8_t *>(&funArgs),
-                       sizeof(funArgs), GMT_PREEMPTABLE);
+    executeOnAllNodes(execFunWrapper<FunctionTy, InArgsT>,
+                      reinterpret_cast<const uint8_t *>(&funArgs),
+                      sizeof(funArgs), GMT_HANDLE_NULL);
   }
 
   template <typename FunT>
@@ -208,8 +208,8 @@ struct SynchronousInterface<gmt_tag> {
     if (argsBuffer != nullptr && bufferSize)
       memcpy(buffer.get() + sizeof(fn), argsBuffer.get(), bufferSize);
 
-    gmt_execute_on_all(impl::execFunWrapper, buffer.get(), newBufferSize,
-                       GMT_PREEMPTABLE);
+    executeOnAllNodes(execFunWrapper, buffer.get(), newBufferSize,
+                      GMT_HANDLE_NULL);
   }
 
   template <typename FunT, typename InArgsT>
@@ -231,10 +231,10 @@ struct SynchronousInterface<gmt_tag> {
 
     impl::ExecFunWrapperArgs<FunctionTy, InArgsT> funArgs{fn, args};
 
-    gmt_for_loop_on_node(impl::getNodeId(loc), numIters, workload,
-                         impl::forEachWrapper<FunctionTy, InArgsT>,
-                         reinterpret_cast<const uint8_t *>(&funArgs),
-                         sizeof(funArgs));
+    forLoopOnNode(getNodeId(loc), numIters, workload,
+                  forEachWrapper<FunctionTy, InArgsT>,
+                  reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs),
+                  GMT_HANDLE_NULL);
   }
 
   template <typename FunT>
@@ -267,8 +267,8 @@ struct SynchronousInterface<gmt_tag> {
         numIters / (gmt_num_workers() * kOverSubscriptionFactor);
     workload = std::max(workload, uint32_t(1));
 
-    gmt_for_loop_on_node(getNodeId(loc), numIters, workload, forEachWrapper,
-                         buffer.get(), newBufferSize);
+    forLoopOnNode(getNodeId(loc), numIters, workload, forEachWrapper,
+                  buffer.get(), newBufferSize, GMT_HANDLE_NULL);
   }
 
   template <typename FunT, typename InArgsT>
@@ -288,9 +288,9 @@ struct SynchronousInterface<gmt_tag> {
     uint32_t workload = (numIters / gmt_num_nodes()) / gmt_num_workers();
     workload = std::max(workload, uint32_t(1));
 
-    gmt_for_loop(numIters, workload, impl::forEachWrapper<FunctionTy, InArgsT>,
+    forLoopOnAll(numIters, workload, forEachWrapper<FunctionTy, InArgsT>,
                  reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs),
-                 GMT_SPAWN_SPREAD);
+                 GMT_HANDLE_NULL);
   }
 
   template <typename FunT>
@@ -321,8 +321,8 @@ struct SynchronousInterface<gmt_tag> {
     uint32_t workload = (numIters / gmt_num_nodes()) / gmt_num_workers();
     workload = std::max(workload, uint32_t(1));
 
-    gmt_for_loop(numIters, workload, forEachWrapper, buffer.get(),
-                 newBufferSize, GMT_SPAWN_SPREAD);
+    forLoopOnAll(numIters, workload, forEachWrapper, buffer.get(),
+                 newBufferSize, GMT_HANDLE_NULL);
   }
 };
 
@@ -67,6 +67,10 @@ struct HandleTrait<gmt_tag> {
     gmt_wait_handle(H);
     H = NullValue();
   }
+
+  // Waiting tasks are suspended: they cannot block a continuation.  The
+  // handle is left untouched, other continuations may wait for it too.
+  static void WaitForDependency(HandleTy H) { gmt_wait_handle(H); }
 };
 
 template <>
@@ -0,0 +1,375 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_SHAD_RUNTIME_MAPPINGS_GMT_GMT_TRANSFER_H_
+#define INCLUDE_SHAD_RUNTIME_MAPPINGS_GMT_GMT_TRANSFER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "gmt/gmt.h"
+
+#include "shad/runtime/mappings/gmt/gmt_traits_mapping.h"
+#include "shad/runtime/mappings/gmt/gmt_utility.h"
+#include "shad/runtime/mappings/result_buffer.h"
+
+namespace shad {
+namespace rt {
+
+namespace impl {
+
+// Transfers that do not fit the arguments or the return buffer of a GMT task.
+//
+// Oversized arguments are staged on the target node before the call: the
+// target allocates a buffer, the fragments are copied in place by parallel
+// tasks, and the call receives the staged buffer instead of a copy of the
+// arguments.  Functions returning a buffer write into a ResultBuffer of
+// kMaxResultSize bytes, which faults on writes past its capacity and only
+// backs the pages written; results fitting the GMT return buffer go back
+// with the reply, larger ones are streamed in fragments into the buffer of
+// the caller before the reply.
+
+using GmtTaskTy = void (*)(const void *, uint32_t, void *, uint32_t *,
+                           gmt_handle_t);
+using GmtLoopTy = void (*)(uint64_t, uint64_t, const void *, gmt_handle_t);
+
+struct FragmentHeader {
+  uint8_t *buffer;
+  uint64_t offset;
+};
+
+inline void putFragmentWrapper(const void *args, uint32_t argsSize, void *,
+                               uint32_t *, gmt_handle_t) {
+  const FragmentHeader &header =
+      *reinterpret_cast<const FragmentHeader *>(args);
+  std::memcpy(header.buffer + header.offset,
+              reinterpret_cast<const uint8_t *>(args) + sizeof(header),
+              argsSize - sizeof(header));
+}
+
+/// @brief Copy size bytes of data to the buffer remote of a node.
+inline void putFragments(uint32_t nodeId, uint8_t *remote, const uint8_t *data,
+                         uint64_t size) {
+  if (nodeId == gmt_node_id()) {
+    std::memcpy(remote, data, size);
+    return;
+  }
+  uint32_t fragmentSize = gmt_max_args_per_task() - sizeof(FragmentHeader);
+  std::unique_ptr<uint8_t[]> message(new uint8_t[gmt_max_args_per_task()]);
+  gmt_handle_t handle = gmt_get_handle();
+  for (uint64_t offset = 0; offset < size; offset += fragmentSize) {
+    uint32_t bytes = std::min<uint64_t>(fragmentSize, size - offset);
+    new (message.get()) FragmentHeader{remote, offset};
+    std::memcpy(message.get() + sizeof(FragmentHeader), data + offset, bytes);
+    gmt_execute_on_node_with_handle(nodeId, putFragmentWrapper, message.get(),
+                                    sizeof(FragmentHeader) + bytes, nullptr,
+                                    nullptr, GMT_PREEMPTABLE, handle);
+  }
+  gmt_wait_handle(handle);
+}
+
+inline void allocateWrapper(const void *args, uint32_t, void *result,
+                            uint32_t *resultSize, gmt_handle_t) {
+  uint8_t *buffer = new uint8_t[*reinterpret_cast<const uint64_t *>(args)];
+  std::memcpy(result, &buffer, sizeof(buffer));
+  *resultSize = sizeof(buffer);
+}
+
+/// @brief Copy a payload to a buffer allocated on a node.
+///
+/// @return The buffer, owned by the task that consumes it.
+inline uint8_t *stagePayload(uint32_t nodeId, const uint8_t *payload,
+                             uint64_t size) {
+  uint8_t *remote = nullptr;
+  if (nodeId == gmt_node_id()) {
+    remote = new uint8_t[size];
+  } else {
+    uint32_t resultSize = 0;
+    gmt_execute_on_node(nodeId, allocateWrapper, &size, sizeof(size), &remote,
+                        &resultSize, GMT_PREEMPTABLE);
+  }
+  putFragments(nodeId, remote, payload, size);
+  return remote;
+}
+
+struct StagedCall {
+  GmtTaskTy task;
+  uint8_t *buffer;
+  uint32_t size;
+};
+
+inline void execStagedWrapper(const void *args, uint32_t, void *result,
+                              uint32_t *resultSize, gmt_handle_t handle) {
+  const StagedCall &call = *reinterpret_cast<const StagedCall *>(args);
+  std::unique_ptr<uint8_t[]> buffer(call.buffer);
+  call.task(buffer.get(), call.size, result, resultSize, handle);
+}
+
+/// @brief Execute task on a node, staging its payload if it does not fit
+/// the arguments of a GMT task.
+inline void executeOnNode(uint32_t nodeId, GmtTaskTy task,
+                          const uint8_t *payload, uint32_t size, void *result,
+                          uint32_t *resultSize, gmt_handle_t handle) {
+  StagedCall call;
+  if (size > gmt_max_args_per_task()) {
+    call = StagedCall{task, stagePayload(nodeId, payload, size), size};
+    task = execStagedWrapper;
+    payload = reinterpret_cast<const uint8_t *>(&call);
+    size = sizeof(call);
+  }
+  if (handle == GMT_HANDLE_NULL)
+    gmt_execute_on_node(nodeId, task, payload, size, result, resultSize,
+                        GMT_PREEMPTABLE);
+  else
+    gmt_execute_on_node_with_handle(nodeId, task, payload, size, result,
+                                    resultSize, GMT_PREEMPTABLE, handle);
+}
+
+/// @brief Execute task on all the nodes.
+inline void executeOnAllNodes(GmtTaskTy task, const uint8_t *payload,
+                              uint32_t size, gmt_handle_t handle) {
+  if (size <= gmt_max_args_per_task()) {
+    if (handle == GMT_HANDLE_NULL)
+      gmt_execute_on_all(task, payload, size, GMT_PREEMPTABLE);
+    else
+      gmt_execute_on_all_with_handle(task, payload, size, GMT_PREEMPTABLE,
+                                     handle);
+    return;
+  }
+  gmt_handle_t allHandle =
+      handle == GMT_HANDLE_NULL ? gmt_get_handle() : handle;
+  for (uint32_t nodeId = 0; nodeId < gmt_num_nodes(); ++nodeId)
+    executeOnNode(nodeId, task, payload, size, nullptr, nullptr, allHandle);
+  if (handle == GMT_HANDLE_NULL) gmt_wait_handle(allHandle);
+}
+
+/// @brief Destination of a result, on the node of the caller.
+struct ResultTarget {
+  GmtTaskTy task;
+  uint32_t nodeId;
+  uint8_t *buffer;
+  uint32_t *streamedSize;
+  /// The Handle given to the task.
+  gmt_handle_t handle;
+};
+
+struct SizeUpdate {
+  uint32_t *target;
+  uint32_t size;
+};
+
+inline void setSizeWrapper(const void *args, uint32_t, void *, uint32_t *,
+                           gmt_handle_t) {
+  const SizeUpdate &update = *reinterpret_cast<const SizeUpdate *>(args);
+  *update.target = update.size;
+}
+
+inline void execStreamedWrapper(const void *args, uint32_t argsSize,
+                                void *result, uint32_t *resultSize,
+                                gmt_handle_t) {
+  const ResultTarget &target = *reinterpret_cast<const ResultTarget *>(args);
+  ResultBuffer buffer(kMaxResultSize);
+  uint32_t size = 0;
+  target.task(reinterpret_cast<const uint8_t *>(args) + sizeof(target),
+              argsSize - sizeof(target), buffer.get(), &size, target.handle);
+  buffer.SetSize(size);
+  if (size <= gmt_max_return_size()) {
+    std::memcpy(result, buffer.get(), size);
+    *resultSize = size;
+    return;
+  }
+  putFragments(target.nodeId, target.buffer, buffer.get(), size);
+  SizeUpdate update{target.streamedSize, size};
+  gmt_execute_on_node(target.nodeId, setSizeWrapper, &update, sizeof(update),
+                      nullptr, nullptr, GMT_PREEMPTABLE);
+  *resultSize = 0;
+}
+
+// Send a message starting with a ResultTarget and wait for the result.
+inline void sendWithResult(uint32_t nodeId, uint8_t *message, uint32_t size,
+                           GmtTaskTy task, uint8_t *result,
+                           uint32_t *resultSize, gmt_handle_t handle) {
+  uint32_t inlineSize = 0;
+  uint32_t streamedSize = 0;
+  new (message)
+      ResultTarget{task, gmt_node_id(), result, &streamedSize, handle};
+  executeOnNode(nodeId, execStreamedWrapper, message, size, result,
+                &inlineSize, GMT_HANDLE_NULL);
+  if (resultSize != nullptr)
+    *resultSize = streamedSize != 0 ? streamedSize : inlineSize;
+}
+
+struct AsyncResultCall {
+  uint32_t nodeId;
+  GmtTaskTy task;
+  uint8_t *message;
+  uint32_t size;
+  uint8_t *result;
+  uint32_t *resultSize;
+  gmt_handle_t handle;
+};
+
+inline void execAsyncResultWrapper(const void *args, uint32_t, void *,
+                                   uint32_t *, gmt_handle_t) {
+  const AsyncResultCall &call =
+      *reinterpret_cast<const AsyncResultCall *>(args);
+  std::unique_ptr<uint8_t[]> message(call.message);
+  sendWithResult(call.nodeId, message.get(), call.size, call.task,
+                 call.result, call.resultSize, call.handle);
+}
+
+/// @brief Execute task on a node, writing its result to result and its size
+/// to resultSize, if not null.
+///
+/// The size of the result is known only once the task returns, and GMT
+/// overwrites the size of the result on completion: asynchronous calls are
+/// driven by a task on this node, accounted in handle, that waits for the
+/// result.
+inline void executeOnNodeWithResult(uint32_t nodeId, GmtTaskTy task,
+                                    const uint8_t *payload, uint32_t size,
+                                    uint8_t *result, uint32_t *resultSize,
+                                    gmt_handle_t handle) {
+  uint32_t messageSize = sizeof(ResultTarget) + size;
+  std::unique_ptr<uint8_t[]> message(new uint8_t[messageSize]);
+  std::memcpy(message.get() + sizeof(ResultTarget), payload, size);
+  if (handle == GMT_HANDLE_NULL) {
+    sendWithResult(nodeId, message.get(), messageSize, task, result,
+                   resultSize, handle);
+    return;
+  }
+  AsyncResultCall call{nodeId, task,       message.get(), messageSize,
+                       result, resultSize, handle};
+  gmt_execute_on_node_with_handle(gmt_node_id(), execAsyncResultWrapper,
+                                  &call, sizeof(call), nullptr, nullptr,
+                                  GMT_PREEMPTABLE, handle);
+  message.release();
+}
+
+/// @brief Execute task on a node, writing a result of resultSize bytes.
+inline void executeOnNodeWithRet(uint32_t nodeId, GmtTaskTy task,
+                                 const uint8_t *payload, uint32_t size,
+                                 void *result, uint32_t resultSize,
+                                 gmt_handle_t handle) {
+  if (resultSize <= gmt_max_return_size()) {
+    executeOnNode(nodeId, task, payload, size, result, &garbageSize, handle);
+    return;
+  }
+  executeOnNodeWithResult(nodeId, task, payload, size,
+                          reinterpret_cast<uint8_t *>(result), nullptr,
+                          handle);
+}
+
+struct StagedLoop {
+  GmtLoopTy task;
+  uint8_t *buffer;
+  uint64_t first;
+  uint64_t numIters;
+  uint32_t workload;
+  /// The Handle given to the iterations.
+  gmt_handle_t handle;
+};
+
+inline void stagedLoopWrapper(uint64_t startIt, uint64_t numIters,
+                              const void *args, gmt_handle_t) {
+  const StagedLoop &loop = *reinterpret_cast<const StagedLoop *>(args);
+  loop.task(loop.first + startIt, numIters, loop.buffer, loop.handle);
+}
+
+inline void execStagedLoopWrapper(const void *args, uint32_t, void *,
+                                  uint32_t *, gmt_handle_t) {
+  const StagedLoop &loop = *reinterpret_cast<const StagedLoop *>(args);
+  std::unique_ptr<uint8_t[]> buffer(loop.buffer);
+  gmt_for_loop_on_node(gmt_node_id(), loop.numIters, loop.workload,
+                       stagedLoopWrapper, &loop, sizeof(loop));
+}
+
+// Run the iterations [first, first + numIters) of task on a node, over a
+// payload staged there, from a task that frees it when they are done.
+inline void stagedLoopOnNode(uint32_t nodeId, uint64_t first,
+                             uint64_t numIters, uint32_t workload,
+                             GmtLoopTy task, const uint8_t *payload,
+                             uint32_t size, gmt_handle_t handle) {
+  StagedLoop loop{task,     stagePayload(nodeId, payload, size),
+                  first,    numIters,
+                  workload, handle};
+  executeOnNode(nodeId, execStagedLoopWrapper,
+                reinterpret_cast<const uint8_t *>(&loop), sizeof(loop),
+                nullptr, nullptr, handle);
+}
+
+/// @brief Run numIters iterations of task on a node.
+inline void forLoopOnNode(uint32_t nodeId, uint64_t numIters,
+                          uint32_t workload, GmtLoopTy task,
+                          const uint8_t *payload, uint32_t size,
+                          gmt_handle_t handle) {
+  if (size > gmt_max_args_per_task()) {
+    stagedLoopOnNode(nodeId, 0, numIters, workload, task, payload, size,
+                     handle);
+  } else if (handle == GMT_HANDLE_NULL) {
+    gmt_for_loop_on_node(nodeId, numIters, workload, task, payload, size);
+  } else {
+    gmt_for_loop_on_node_with_handle(nodeId, numIters, workload, task,
+                                     payload, size, handle);
+  }
+}
+
+/// @brief Run numIters iterations of task spread on all the nodes.
+inline void forLoopOnAll(uint64_t numIters, uint32_t workload,
+                         GmtLoopTy task, const uint8_t *payload,
+                         uint32_t size, gmt_handle_t handle) {
+  if (size <= gmt_max_args_per_task()) {
+    if (handle == GMT_HANDLE_NULL)
+      gmt_for_loop(numIters, workload, task, payload, size, GMT_SPAWN_SPREAD);
+    else
+      gmt_for_loop_with_handle(numIters, workload, task, payload, size,
+                               GMT_SPAWN_SPREAD, handle);
+    return;
+  }
+  // Staged payloads are per node: give every node a block of iterations.
+  gmt_handle_t allHandle =
+      handle == GMT_HANDLE_NULL ? gmt_get_handle() : handle;
+  uint32_t numNodes = gmt_num_nodes();
+  for (uint32_t nodeId = 0; nodeId < numNodes; ++nodeId) {
+    uint64_t first = numIters * nodeId / numNodes;
+    uint64_t last = numIters * (nodeId + 1) / numNodes;
+    if (first == last) continue;
+    uint32_t nodeWorkload = std::max<uint64_t>(
+        (last - first) / (gmt_num_workers() * kOverSubscriptionFactor), 1);
+    stagedLoopOnNode(nodeId, first, last - first, nodeWorkload, task, payload,
+                     size, allHandle);
+  }
+  if (handle == GMT_HANDLE_NULL) gmt_wait_handle(allHandle);
+}
+
+}  // namespace impl
+
+}  // namespace rt
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_RUNTIME_MAPPINGS_GMT_GMT_TRANSFER_H_
@@ -52,20 +52,28 @@ inline void checkLocality(const Locality &loc) {
   }
 }
 
+/// Largest arguments of a call.  Arguments larger than
+/// gmt_max_args_per_task() are staged on the target node before the call.
+static constexpr uint32_t kMaxInputSize = 1u << 30;
+
 inline void checkInputSize(size_t size) {
-  if (size > gmt_max_args_per_task()) {
+  if (size > kMaxInputSize) {
     std::stringstream ss;
-    ss << "The input size exeeds the hard limit of " << gmt_max_args_per_task()
-       << "B imposed by GMT.  A more general solution is under development.";
+    ss << "The input size exeeds the hard limit of " << kMaxInputSize
+       << "B of the staged arguments.";
     throw std::system_error(0xdeadc0de, std::generic_category(), ss.str());
   }
 }
 
+/// Capacity of the buffers written by the functions returning a buffer.
+/// Results larger than gmt_max_return_size() are streamed to the caller.
+static constexpr uint32_t kMaxResultSize = 1u << 24;
+
 inline void checkOutputSize(size_t size) {
-  if (size > gmt_max_return_size()) {
+  if (size > kMaxResultSize) {
     std::stringstream ss;
-    ss << "The output size exeeds the hard limit of " << gmt_max_return_size()
-       << "B imposed by GMT.  A more general solution is under development.";
+    ss << "The output size exeeds the hard limit of " << kMaxResultSize
+       << "B of the result buffers.";
     throw std::system_error(0xdeadc0de, std::generic_category(), ss.str());
   }
 }
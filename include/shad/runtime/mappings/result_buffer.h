@@ -0,0 +1,142 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_SHAD_RUNTIME_MAPPINGS_RESULT_BUFFER_H_
+#define INCLUDE_SHAD_RUNTIME_MAPPINGS_RESULT_BUFFER_H_
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <system_error>
+#include <vector>
+
+namespace shad {
+namespace rt {
+
+namespace impl {
+
+/// @brief Scratch buffer written by the functions returning a buffer.
+///
+/// Those functions are not told the capacity of the buffer they write: the
+/// buffer ends right before an inaccessible guard page, so that a function
+/// writing more than the capacity faults before overwriting unrelated
+/// memory.  Only the pages that are written are backed by memory, so a
+/// small result costs a single page.  Released buffers are recycled, up to
+/// kMaxFree of them, after returning to the system the pages that held
+/// more than the first one.
+class ResultBuffer {
+ public:
+  /// @brief Take a buffer of capacity bytes.
+  explicit ResultBuffer(size_t capacity)
+      : capacity_(capacity), used_(capacity) {
+    {
+      std::lock_guard<std::mutex> _(lock_);
+      for (auto it = free_.begin(); it != free_.end(); ++it) {
+        if (it->capacity != capacity) continue;
+        base_ = it->base;
+        free_.erase(it);
+        break;
+      }
+    }
+    if (base_ == nullptr) base_ = Map(capacity);
+    data_ = base_ + MappedBytes(capacity) - PageSize() - capacity;
+  }
+
+  ~ResultBuffer() {
+    size_t dataPages = MappedBytes(capacity_) - PageSize();
+    if (data_ + used_ > base_ + PageSize())
+      madvise(base_ + PageSize(), dataPages - PageSize(), MADV_DONTNEED);
+    {
+      std::lock_guard<std::mutex> _(lock_);
+      if (free_.size() < kMaxFree) {
+        free_.push_back(FreeBuffer{capacity_, base_});
+        return;
+      }
+    }
+    munmap(base_, MappedBytes(capacity_));
+  }
+
+  ResultBuffer(const ResultBuffer &) = delete;
+  ResultBuffer &operator=(const ResultBuffer &) = delete;
+
+  uint8_t *get() const { return data_; }
+
+  /// @brief Record the number of bytes written by the function.
+  void SetSize(size_t size) { used_ = size; }
+
+ private:
+  static constexpr size_t kMaxFree = 8;
+
+  struct FreeBuffer {
+    size_t capacity;
+    uint8_t *base;
+  };
+
+  static inline std::mutex lock_;
+  static inline std::vector<FreeBuffer> free_;
+
+  size_t capacity_;
+  // All the pages are released unless the size of the result is known.
+  size_t used_;
+  uint8_t *base_{nullptr};
+  uint8_t *data_{nullptr};
+
+  static size_t PageSize() {
+    static const size_t pageSize = sysconf(_SC_PAGESIZE);
+    return pageSize;
+  }
+
+  // The pages holding the capacity, followed by the guard page.
+  static size_t MappedBytes(size_t capacity) {
+    return (capacity + 2 * PageSize() - 1) / PageSize() * PageSize();
+  }
+
+  static uint8_t *Map(size_t capacity) {
+    size_t bytes = MappedBytes(capacity);
+    void *base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED)
+      throw std::system_error(errno, std::generic_category(),
+                              "Unable to map a result buffer");
+    uint8_t *guard = static_cast<uint8_t *>(base) + bytes - PageSize();
+    if (mprotect(guard, PageSize(), PROT_NONE) != 0) {
+      int error = errno;
+      munmap(base, bytes);
+      throw std::system_error(error, std::generic_category(),
+                              "Unable to protect a result buffer");
+    }
+    return static_cast<uint8_t *>(base);
+  }
+};
+
+}  // namespace impl
+
+}  // namespace rt
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_RUNTIME_MAPPINGS_RESULT_BUFFER_H_
@@ -0,0 +1,477 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_SHAD_RUNTIME_MAPPINGS_SHM_SHM_ASYNCHRONOUS_INTERFACE_H_
+#define INCLUDE_SHAD_RUNTIME_MAPPINGS_SHM_SHM_ASYNCHRONOUS_INTERFACE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include "shad/runtime/asynchronous_interface.h"
+#include "shad/runtime/handle.h"
+#include "shad/runtime/locality.h"
+#include "shad/runtime/mapping_traits.h"
+#include "shad/runtime/mappings/cpp_simple/cpp_simple_thread_pool.h"
+#include "shad/runtime/mappings/shm/shm_traits_mapping.h"
+#include "shad/runtime/mappings/shm/shm_utility.h"
+
+namespace shad {
+namespace rt {
+
+namespace impl {
+
+template <>
+struct AsynchronousInterface<shm_tag> {
+  template <typename FunT, typename InArgsT>
+  static void asyncExecuteAt(Handle &handle, const Locality &loc,
+                             FunT &&function, const InArgsT &args) {
+    checkLocality(loc);
+    using FunctionTy = void (*)(Handle &, const InArgsT &);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    if (isLocal(loc))
+      return spawn(handle, [=, &handle] { fn(handle, args); });
+
+    ExecFunWrapperArgs<FunctionTy, InArgsT> funArgs{fn, args};
+    checkInputSize(sizeof(funArgs));
+    request(handle, loc, asyncExecFunWrapper<FunctionTy, InArgsT>,
+            reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs));
+  }
+
+  template <typename FunT>
+  static void asyncExecuteAt(Handle &handle, const Locality &loc,
+                             FunT &&function,
+                             const std::shared_ptr<uint8_t> &argsBuffer,
+                             const uint32_t bufferSize) {
+    checkLocality(loc);
+    using FunctionTy = void (*)(Handle &, const uint8_t *, const uint32_t);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    if (isLocal(loc))
+      return spawn(handle,
+                   [=, &handle] { fn(handle, argsBuffer.get(), bufferSize); });
+
+    uint32_t size;
+    auto payload = packBuffer(fn, argsBuffer.get(), bufferSize, &size);
+    request(handle, loc, asyncExecFunWrapper, payload.get(), size);
+  }
+
+  template <typename FunT, typename InArgsT>
+  static void asyncExecuteAfter(Handle &predecessor, Handle &handle,
+                                FunT &&function, const InArgsT &args) {
+    using FunctionTy = void (*)(Handle &, const InArgsT &);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    if (predecessor.IsNull())
+      return spawn(handle, [=, &handle] { fn(handle, args); });
+    if (handle.IsNull()) handle.id_ = HandleTrait<shm_tag>::CreateNewHandle();
+    ThreadPool::Instance().SpawnAfter(*predecessor.id_, *handle.id_,
+                                      [=, &handle] { fn(handle, args); });
+  }
+
+  template <typename FunT, typename InArgsT>
+  static void asyncExecuteAtWithRetBuff(Handle &handle, const Locality &loc,
+                                        FunT &&function, const InArgsT &args,
+                                        uint8_t *resultBuffer,
+                                        uint32_t *resultSize) {
+    checkLocality(loc);
+    using FunctionTy =
+        void (*)(Handle &, const InArgsT &, uint8_t *, uint32_t *);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    if (isLocal(loc))
+      return spawn(handle, [=, &handle] {
+        fn(handle, args, resultBuffer, resultSize);
+      });
+
+    ExecFunWrapperArgs<FunctionTy, InArgsT> funArgs{fn, args};
+    checkInputSize(sizeof(funArgs));
+    request(handle, loc, asyncExecFunWithRetBuffWrapper<FunctionTy, InArgsT>,
+            reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs), 0,
+            0, resultBuffer, resultSize);
+  }
+
+  template <typename FunT>
+  static void asyncExecuteAtWithRetBuff(
+      Handle &handle, const Locality &loc, FunT &&function,
+      const std::shared_ptr<uint8_t> &argsBuffer, const uint32_t bufferSize,
+      uint8_t *resultBuffer, uint32_t *resultSize) {
+    checkLocality(loc);
+    using FunctionTy = void (*)(Handle &, const uint8_t *, const uint32_t,
+                                uint8_t *, uint32_t *);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    if (isLocal(loc))
+      return spawn(handle, [=, &handle] {
+        fn(handle, argsBuffer.get(), bufferSize, resultBuffer, resultSize);
+      });
+
+    uint32_t size;
+    auto payload = packBuffer(fn, argsBuffer.get(), bufferSize, &size);
+    request(handle, loc, asyncExecFunWithRetBuffWrapper, payload.get(), size,
+            0, 0, resultBuffer, resultSize);
+  }
+
+  template <typename FunT, typename InArgsT, typename ResT>
+  static void asyncExecuteAtWithRet(Handle &handle, const Locality &loc,
+                                    FunT &&function, const InArgsT &args,
+                                    ResT *result) {
+    checkLocality(loc);
+    using FunctionTy = void (*)(Handle &, const InArgsT &, ResT *);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    if (isLocal(loc))
+      return spawn(handle, [=, &handle] { fn(handle, args, result); });
+
+    ExecFunWrapperArgs<FunctionTy, InArgsT> funArgs{fn, args};
+    checkInputSize(sizeof(funArgs));
+    checkOutputSize(sizeof(ResT));
+    request(handle, loc,
+            asyncExecFunWithRetWrapper<FunctionTy, InArgsT, ResT>,
+            reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs), 0,
+            0, reinterpret_cast<uint8_t *>(result));
+  }
+
+  template <typename FunT, typename ResT>
+  static void asyncExecuteAtWithRet(Handle &handle, const Locality &loc,
+                                    FunT &&function,
+                                    const std::shared_ptr<uint8_t> &argsBuffer,
+                                    const uint32_t bufferSize, ResT *result) {
+    checkLocality(loc);
+    using FunctionTy =
+        void (*)(Handle &, const uint8_t *, const uint32_t, ResT *);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    if (isLocal(loc))
+      return spawn(handle, [=, &handle] {
+        fn(handle, argsBuffer.get(), bufferSize, result);
+      });
+
+    uint32_t size;
+    auto payload = packBuffer(fn, argsBuffer.get(), bufferSize, &size);
+    checkOutputSize(sizeof(ResT));
+    request(handle, loc, asyncExecFunWithRetWrapper<ResT>, payload.get(), size,
+            0, 0, reinterpret_cast<uint8_t *>(result));
+  }
+
+  template <typename FunT, typename InArgsT>
+  static void asyncExecuteOnAll(Handle &handle, FunT &&function,
+                                const InArgsT &args) {
+    using FunctionTy = void (*)(Handle &, const InArgsT &);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+
+    ExecFunWrapperArgs<FunctionTy, InArgsT> funArgs{fn, args};
+    checkInputSize(sizeof(funArgs));
+    requestOnAll(handle, asyncExecFunWrapper<FunctionTy, InArgsT>,
+                 reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs),
+                 0);
+    spawn(handle, [=, &handle] { fn(handle, args); });
+  }
+
+  template <typename FunT>
+  static void asyncExecuteOnAll(Handle &handle, FunT &&function,
+                                const std::shared_ptr<uint8_t> &argsBuffer,
+                                const uint32_t bufferSize) {
+    using FunctionTy = void (*)(Handle &, const uint8_t *, const uint32_t);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+
+    uint32_t size;
+    auto payload = packBuffer(fn, argsBuffer.get(), bufferSize, &size);
+    requestOnAll(handle, asyncExecFunWrapper, payload.get(), size, 0);
+    spawn(handle, [=, &handle] { fn(handle, argsBuffer.get(), bufferSize); });
+  }
+
+  template <typename FunT, typename InArgsT>
+  static void asyncForEachAt(Handle &handle, const Locality &loc,
+                             FunT &&function, const InArgsT &args,
+                             const size_t numIters) {
+    checkLocality(loc);
+    using FunctionTy = void (*)(Handle &, const InArgsT &, size_t);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    if (isLocal(loc))
+      return spawnForEach(handle, 0, numIters,
+                          [=, &handle](size_t begin, size_t end) {
+                            for (size_t i = begin; i < end; ++i)
+                              fn(handle, args, i);
+                          });
+
+    if (handle.IsNull()) handle.id_ = HandleTrait<shm_tag>::CreateNewHandle();
+    if (numIters == 0) return;
+    ExecFunWrapperArgs<FunctionTy, InArgsT> funArgs{fn, args};
+    checkInputSize(sizeof(funArgs));
+    request(handle, loc, asyncForEachWrapper<FunctionTy, InArgsT>,
+            reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs), 0,
+            numIters);
+  }
+
+  template <typename FunT>
+  static void asyncForEachAt(Handle &handle, const Locality &loc,
+                             FunT &&function,
+                             const std::shared_ptr<uint8_t> &argsBuffer,
+                             const uint32_t bufferSize, const size_t numIters) {
+    checkLocality(loc);
+    using FunctionTy =
+        void (*)(Handle &, const uint8_t *, const uint32_t, size_t);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    if (isLocal(loc))
+      return spawnForEach(handle, 0, numIters,
+                          [=, &handle](size_t begin, size_t end) {
+                            for (size_t i = begin; i < end; ++i)
+                              fn(handle, argsBuffer.get(), bufferSize, i);
+                          });
+
+    if (handle.IsNull()) handle.id_ = HandleTrait<shm_tag>::CreateNewHandle();
+    if (numIters == 0) return;
+    uint32_t size;
+    auto payload = packBuffer(fn, argsBuffer.get(), bufferSize, &size);
+    request(handle, loc, asyncForEachWrapper, payload.get(), size, 0,
+            numIters);
+  }
+
+  template <typename FunT, typename InArgsT>
+  static void asyncForEachOnAll(Handle &handle, FunT &&function,
+                                const InArgsT &args, const size_t numIters) {
+    using FunctionTy = void (*)(Handle &, const InArgsT &, size_t);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+
+    if (handle.IsNull()) handle.id_ = HandleTrait<shm_tag>::CreateNewHandle();
+    if (numIters == 0) return;
+    ExecFunWrapperArgs<FunctionTy, InArgsT> funArgs{fn, args};
+    checkInputSize(sizeof(funArgs));
+    auto local = requestOnAll(handle, asyncForEachWrapper<FunctionTy, InArgsT>,
+                              reinterpret_cast<const uint8_t *>(&funArgs),
+                              sizeof(funArgs), numIters);
+    spawnForEach(handle, local.first, local.second,
+                 [=, &handle](size_t begin, size_t end) {
+                   for (size_t i = begin; i < end; ++i) fn(handle, args, i);
+                 });
+  }
+
+  template <typename FunT>
+  static void asyncForEachOnAll(Handle &handle, FunT &&function,
+                                const std::shared_ptr<uint8_t> &argsBuffer,
+                                const uint32_t bufferSize,
+                                const size_t numIters) {
+    using FunctionTy =
+        void (*)(Handle &, const uint8_t *, const uint32_t, size_t);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+
+    if (handle.IsNull()) handle.id_ = HandleTrait<shm_tag>::CreateNewHandle();
+    if (numIters == 0) return;
+    uint32_t size;
+    auto payload = packBuffer(fn, argsBuffer.get(), bufferSize, &size);
+    auto local =
+        requestOnAll(handle, asyncForEachWrapper, payload.get(), size,
+                     numIters);
+    spawnForEach(handle, local.first, local.second,
+                 [=, &handle](size_t begin, size_t end) {
+                   for (size_t i = begin; i < end; ++i)
+                     fn(handle, argsBuffer.get(), bufferSize, i);
+                 });
+  }
+
+ private:
+  static constexpr size_t kChunksPerThread = 4;
+
+  // Tasks reference the Handle: like in the TBB mapping, it must not be
+  // destroyed before waiting for their completion.
+  template <typename TaskT>
+  static void spawn(Handle &handle, TaskT &&task) {
+    if (handle.IsNull()) handle.id_ = HandleTrait<shm_tag>::CreateNewHandle();
+    ThreadPool::Instance().Spawn(*handle.id_, std::forward<TaskT>(task));
+  }
+
+  // Split the iterations in [first, last) in chunks run as independent tasks.
+  template <typename ChunkT>
+  static void spawnForEach(Handle &handle, const size_t first,
+                           const size_t last, const ChunkT &chunk) {
+    if (handle.IsNull()) handle.id_ = HandleTrait<shm_tag>::CreateNewHandle();
+    if (first == last) return;
+    auto &pool = ThreadPool::Instance();
+    size_t numIters = last - first;
+    size_t numChunks =
+        std::min(numIters, kChunksPerThread * pool.Concurrency());
+    size_t chunkSize = (numIters + numChunks - 1) / numChunks;
+    for (size_t begin = first; begin < last; begin += chunkSize) {
+      size_t end = std::min(begin + chunkSize, last);
+      pool.Spawn(*handle.id_, [=] { chunk(begin, end); });
+    }
+  }
+
+  // Send a request accounted in handle: its reply completes it.
+  static void request(Handle &handle, const Locality &loc,
+                      ShmTrampoline trampoline, const uint8_t *payload,
+                      uint32_t size, uint64_t first = 0, uint64_t count = 0,
+                      uint8_t *result = nullptr,
+                      uint32_t *resultSize = nullptr) {
+    if (handle.IsNull()) handle.id_ = HandleTrait<shm_tag>::CreateNewHandle();
+    ShmTransport::Instance().Request(getNodeId(loc), *handle.id_, trampoline,
+                                     payload, size, first, count, result,
+                                     resultSize);
+  }
+
+  // Send a request to all the other localities, splitting numIters
+  // iterations in contiguous blocks.  Return the block of this locality.
+  static std::pair<size_t, size_t> requestOnAll(Handle &handle,
+                                                ShmTrampoline trampoline,
+                                                const uint8_t *payload,
+                                                uint32_t size,
+                                                size_t numIters) {
+    if (handle.IsNull()) handle.id_ = HandleTrait<shm_tag>::CreateNewHandle();
+    auto &transport = ShmTransport::Instance();
+    uint32_t numLocalities = transport.NumLocalities();
+    uint32_t self = transport.ThisLocality();
+    std::pair<size_t, size_t> local;
+    for (uint32_t L = 0; L < numLocalities; ++L) {
+      size_t first = numIters * L / numLocalities;
+      size_t last = numIters * (L + 1) / numLocalities;
+      if (L == self)
+        local = std::make_pair(first, last);
+      else if (numIters == 0 || first != last)
+        transport.Request(L, *handle.id_, trampoline, payload, size, first,
+                          last - first, nullptr, nullptr);
+    }
+    return local;
+  }
+
+  // The remote side of the asynchronous calls: the function receives a new
+  // Handle, whose completion is awaited before replying.
+  template <typename FunT, typename InArgsT>
+  static void asyncExecFunWrapper(const ShmMessage &, const uint8_t *payload,
+                                  ShmResult *) {
+    const ExecFunWrapperArgs<FunT, InArgsT> &funArgs =
+        *reinterpret_cast<const ExecFunWrapperArgs<FunT, InArgsT> *>(payload);
+    Handle H(HandleTrait<shm_tag>::CreateNewHandle());
+    funArgs.fun(H, funArgs.args);
+    HandleTrait<shm_tag>::WaitFor(H.id_);
+  }
+
+  static void asyncExecFunWrapper(const ShmMessage &message,
+                                  const uint8_t *payload, ShmResult *) {
+    using FunctionTy = void (*)(Handle &, const uint8_t *, const uint32_t);
+
+    FunctionTy functionPtr;
+    std::memcpy(&functionPtr, payload, sizeof(functionPtr));
+    Handle H(HandleTrait<shm_tag>::CreateNewHandle());
+    functionPtr(H, payload + sizeof(functionPtr),
+                message.payloadSize - sizeof(functionPtr));
+    HandleTrait<shm_tag>::WaitFor(H.id_);
+  }
+
+  template <typename FunT, typename InArgsT>
+  static void asyncExecFunWithRetBuffWrapper(const ShmMessage &,
+                                             const uint8_t *payload,
+                                             ShmResult *result) {
+    const ExecFunWrapperArgs<FunT, InArgsT> &funArgs =
+        *reinterpret_cast<const ExecFunWrapperArgs<FunT, InArgsT> *>(payload);
+    ResultBuffer buffer(ShmTransport::Instance().MaxPayloadSize());
+    uint32_t size = 0;
+    Handle H(HandleTrait<shm_tag>::CreateNewHandle());
+    funArgs.fun(H, funArgs.args, buffer.get(), &size);
+    HandleTrait<shm_tag>::WaitFor(H.id_);
+    copyResultBuffer(&buffer, size, result);
+  }
+
+  static void asyncExecFunWithRetBuffWrapper(const ShmMessage &message,
+                                             const uint8_t *payload,
+                                             ShmResult *result) {
+    using FunctionTy = void (*)(Handle &, const uint8_t *, const uint32_t,
+                                uint8_t *, uint32_t *);
+
+    FunctionTy functionPtr;
+    std::memcpy(&functionPtr, payload, sizeof(functionPtr));
+    ResultBuffer buffer(ShmTransport::Instance().MaxPayloadSize());
+    uint32_t size = 0;
+    Handle H(HandleTrait<shm_tag>::CreateNewHandle());
+    functionPtr(H, payload + sizeof(functionPtr),
+                message.payloadSize - sizeof(functionPtr), buffer.get(),
+                &size);
+    HandleTrait<shm_tag>::WaitFor(H.id_);
+    copyResultBuffer(&buffer, size, result);
+  }
+
+  template <typename FunT, typename InArgsT, typename ResT>
+  static void asyncExecFunWithRetWrapper(const ShmMessage &,
+                                         const uint8_t *payload,
+                                         ShmResult *result) {
+    const ExecFunWrapperArgs<FunT, InArgsT> &funArgs =
+        *reinterpret_cast<const ExecFunWrapperArgs<FunT, InArgsT> *>(payload);
+    Handle H(HandleTrait<shm_tag>::CreateNewHandle());
+    funArgs.fun(H, funArgs.args,
+                reinterpret_cast<ResT *>(result->Allocate(sizeof(ResT))));
+    HandleTrait<shm_tag>::WaitFor(H.id_);
+  }
+
+  template <typename ResT>
+  static void asyncExecFunWithRetWrapper(const ShmMessage &message,
+                                         const uint8_t *payload,
+                                         ShmResult *result) {
+    using FunctionTy =
+        void (*)(Handle &, const uint8_t *, const uint32_t, ResT *);
+
+    FunctionTy functionPtr;
+    std::memcpy(&functionPtr, payload, sizeof(functionPtr));
+    Handle H(HandleTrait<shm_tag>::CreateNewHandle());
+    functionPtr(H, payload + sizeof(functionPtr),
+                message.payloadSize - sizeof(functionPtr),
+                reinterpret_cast<ResT *>(result->Allocate(sizeof(ResT))));
+    HandleTrait<shm_tag>::WaitFor(H.id_);
+  }
+
+  template <typename FunT, typename InArgsT>
+  static void asyncForEachWrapper(const ShmMessage &message,
+                                  const uint8_t *payload, ShmResult *) {
+    const ExecFunWrapperArgs<FunT, InArgsT> &funArgs =
+        *reinterpret_cast<const ExecFunWrapperArgs<FunT, InArgsT> *>(payload);
+    Handle H(HandleTrait<shm_tag>::CreateNewHandle());
+    spawnForEach(H, message.first, message.first + message.count,
+                 [&](size_t begin, size_t end) {
+                   for (size_t i = begin; i < end; ++i)
+                     funArgs.fun(H, funArgs.args, i);
+                 });
+    HandleTrait<shm_tag>::WaitFor(H.id_);
+  }
+
+  static void asyncForEachWrapper(const ShmMessage &message,
+                                  const uint8_t *payload, ShmResult *) {
+    using FunctionTy =
+        void (*)(Handle &, const uint8_t *, const uint32_t, size_t);
+
+    FunctionTy functionPtr;
+    std::memcpy(&functionPtr, payload, sizeof(functionPtr));
+    const uint8_t *buffer = payload + sizeof(functionPtr);
+    uint32_t bufferSize = message.payloadSize - sizeof(functionPtr);
+    Handle H(HandleTrait<shm_tag>::CreateNewHandle());
+    spawnForEach(H, message.first, message.first + message.count,
+                 [&](size_t begin, size_t end) {
+                   for (size_t i = begin; i < end; ++i)
+                     functionPtr(H, buffer, bufferSize, i);
+                 });
+    HandleTrait<shm_tag>::WaitFor(H.id_);
+  }
+};
+
+}  // namespace impl
+
+}  // namespace rt
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_RUNTIME_MAPPINGS_SHM_SHM_ASYNCHRONOUS_INTERFACE_H_
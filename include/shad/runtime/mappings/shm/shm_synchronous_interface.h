@@ -0,0 +1,247 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_SHAD_RUNTIME_MAPPINGS_SHM_SHM_SYNCHRONOUS_INTERFACE_H_
+#define INCLUDE_SHAD_RUNTIME_MAPPINGS_SHM_SHM_SYNCHRONOUS_INTERFACE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "shad/runtime/locality.h"
+#include "shad/runtime/mappings/cpp_simple/cpp_simple_thread_pool.h"
+#include "shad/runtime/mappings/shm/shm_traits_mapping.h"
+#include "shad/runtime/mappings/shm/shm_utility.h"
+#include "shad/runtime/synchronous_interface.h"
+
+namespace shad {
+namespace rt {
+
+namespace impl {
+
+template <>
+struct SynchronousInterface<shm_tag> {
+  template <typename FunT, typename InArgsT>
+  static void executeAt(const Locality &loc, FunT &&function,
+                        const InArgsT &args) {
+    using FunctionTy = void (*)(const InArgsT &);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    checkLocality(loc);
+    if (isLocal(loc)) return fn(args);
+
+    ExecFunWrapperArgs<FunctionTy, InArgsT> funArgs{fn, args};
+    checkInputSize(sizeof(funArgs));
+    remoteCall(loc, execFunWrapper<FunctionTy, InArgsT>,
+               reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs));
+  }
+
+  template <typename FunT>
+  static void executeAt(const Locality &loc, FunT &&function,
+                        const std::shared_ptr<uint8_t> &argsBuffer,
+                        const uint32_t bufferSize) {
+    using FunctionTy = void (*)(const uint8_t *, const uint32_t);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    checkLocality(loc);
+    if (isLocal(loc)) return fn(argsBuffer.get(), bufferSize);
+
+    uint32_t size;
+    auto payload = packBuffer(fn, argsBuffer.get(), bufferSize, &size);
+    remoteCall(loc, execFunWrapper, payload.get(), size);
+  }
+
+  template <typename FunT, typename InArgsT>
+  static void executeAtWithRetBuff(const Locality &loc, FunT &&function,
+                                   const InArgsT &args, uint8_t *resultBuffer,
+                                   uint32_t *resultSize) {
+    using FunctionTy = void (*)(const InArgsT &, uint8_t *, uint32_t *);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    checkLocality(loc);
+    if (isLocal(loc)) return fn(args, resultBuffer, resultSize);
+
+    ExecFunWrapperArgs<FunctionTy, InArgsT> funArgs{fn, args};
+    checkInputSize(sizeof(funArgs));
+    remoteCall(loc, execFunWithRetBuffWrapper<FunctionTy, InArgsT>,
+               reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs),
+               0, 0, resultBuffer, resultSize);
+  }
+
+  template <typename FunT>
+  static void executeAtWithRetBuff(const Locality &loc, FunT &&function,
+                                   const std::shared_ptr<uint8_t> &argsBuffer,
+                                   const uint32_t bufferSize,
+                                   uint8_t *resultBuffer,
+                                   uint32_t *resultSize) {
+    using FunctionTy =
+        void (*)(const uint8_t *, const uint32_t, uint8_t *, uint32_t *);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    checkLocality(loc);
+    if (isLocal(loc))
+      return fn(argsBuffer.get(), bufferSize, resultBuffer, resultSize);
+
+    uint32_t size;
+    auto payload = packBuffer(fn, argsBuffer.get(), bufferSize, &size);
+    remoteCall(loc, execFunWithRetBuffWrapper, payload.get(), size, 0, 0,
+               resultBuffer, resultSize);
+  }
+
+  template <typename FunT, typename InArgsT, typename ResT>
+  static void executeAtWithRet(const Locality &loc, FunT &&function,
+                               const InArgsT &args, ResT *result) {
+    using FunctionTy = void (*)(const InArgsT &, ResT *);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    checkLocality(loc);
+    if (isLocal(loc)) return fn(args, result);
+
+    ExecFunWrapperArgs<FunctionTy, InArgsT> funArgs{fn, args};
+    checkInputSize(sizeof(funArgs));
+    checkOutputSize(sizeof(ResT));
+    remoteCall(loc, execFunWithRetWrapper<FunctionTy, InArgsT, ResT>,
+               reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs),
+               0, 0, reinterpret_cast<uint8_t *>(result));
+  }
+
+  template <typename FunT, typename ResT>
+  static void executeAtWithRet(const Locality &loc, FunT &&function,
+                               const std::shared_ptr<uint8_t> &argsBuffer,
+                               const uint32_t bufferSize, ResT *result) {
+    using FunctionTy = void (*)(const uint8_t *, const uint32_t, ResT *);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    checkLocality(loc);
+    if (isLocal(loc)) return fn(argsBuffer.get(), bufferSize, result);
+
+    uint32_t size;
+    auto payload = packBuffer(fn, argsBuffer.get(), bufferSize, &size);
+    checkOutputSize(sizeof(ResT));
+    remoteCall(loc, execFunWithRetWrapper<ResT>, payload.get(), size, 0, 0,
+               reinterpret_cast<uint8_t *>(result));
+  }
+
+  template <typename FunT, typename InArgsT>
+  static void executeOnAll(FunT &&function, const InArgsT &args) {
+    using FunctionTy = void (*)(const InArgsT &);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+
+    ExecFunWrapperArgs<FunctionTy, InArgsT> funArgs{fn, args};
+    checkInputSize(sizeof(funArgs));
+    callOnAll(execFunWrapper<FunctionTy, InArgsT>,
+              reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs), 0,
+              [&](size_t, size_t) { fn(args); });
+  }
+
+  template <typename FunT>
+  static void executeOnAll(FunT &&function,
+                           const std::shared_ptr<uint8_t> &argsBuffer,
+                           const uint32_t bufferSize) {
+    using FunctionTy = void (*)(const uint8_t *, const uint32_t);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+
+    uint32_t size;
+    auto payload = packBuffer(fn, argsBuffer.get(), bufferSize, &size);
+    callOnAll(execFunWrapper, payload.get(), size, 0,
+              [&](size_t, size_t) { fn(argsBuffer.get(), bufferSize); });
+  }
+
+  template <typename FunT, typename InArgsT>
+  static void forEachAt(const Locality &loc, FunT &&function,
+                        const InArgsT &args, const size_t numIters) {
+    using FunctionTy = void (*)(const InArgsT &, size_t);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    checkLocality(loc);
+    if (isLocal(loc))
+      return ThreadPool::Instance().ParallelFor(
+          numIters, [&](size_t i) { fn(args, i); });
+
+    if (numIters == 0) return;
+    ExecFunWrapperArgs<FunctionTy, InArgsT> funArgs{fn, args};
+    checkInputSize(sizeof(funArgs));
+    remoteCall(loc, forEachWrapper<FunctionTy, InArgsT>,
+               reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs),
+               0, numIters);
+  }
+
+  template <typename FunT>
+  static void forEachAt(const Locality &loc, FunT &&function,
+                        const std::shared_ptr<uint8_t> &argsBuffer,
+                        const uint32_t bufferSize, const size_t numIters) {
+    using FunctionTy = void (*)(const uint8_t *, const uint32_t, size_t);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    checkLocality(loc);
+    if (isLocal(loc))
+      return ThreadPool::Instance().ParallelFor(
+          numIters, [&](size_t i) { fn(argsBuffer.get(), bufferSize, i); });
+
+    if (numIters == 0) return;
+    uint32_t size;
+    auto payload = packBuffer(fn, argsBuffer.get(), bufferSize, &size);
+    remoteCall(loc, forEachWrapper, payload.get(), size, 0, numIters);
+  }
+
+  template <typename FunT, typename InArgsT>
+  static void forEachOnAll(FunT &&function, const InArgsT &args,
+                           const size_t numIters) {
+    using FunctionTy = void (*)(const InArgsT &, size_t);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+
+    // No need to do anything.
+    if (numIters == 0) return;
+
+    ExecFunWrapperArgs<FunctionTy, InArgsT> funArgs{fn, args};
+    checkInputSize(sizeof(funArgs));
+    callOnAll(forEachWrapper<FunctionTy, InArgsT>,
+              reinterpret_cast<const uint8_t *>(&funArgs), sizeof(funArgs),
+              numIters, [&](size_t first, size_t last) {
+                ThreadPool::Instance().ParallelFor(
+                    last - first, [&](size_t i) { fn(args, first + i); });
+              });
+  }
+
+  template <typename FunT>
+  static void forEachOnAll(FunT &&function,
+                           const std::shared_ptr<uint8_t> &argsBuffer,
+                           const uint32_t bufferSize, const size_t numIters) {
+    using FunctionTy = void (*)(const uint8_t *, const uint32_t, size_t);
+    FunctionTy fn = std::forward<decltype(function)>(function);
+
+    // No need to do anything.
+    if (numIters == 0) return;
+
+    uint32_t size;
+    auto payload = packBuffer(fn, argsBuffer.get(), bufferSize, &size);
+    callOnAll(forEachWrapper, payload.get(), size, numIters,
+              [&](size_t first, size_t last) {
+                ThreadPool::Instance().ParallelFor(
+                    last - first, [&](size_t i) {
+                      fn(argsBuffer.get(), bufferSize, first + i);
+                    });
+              });
+  }
+};
+
+}  // namespace impl
+
+}  // namespace rt
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_RUNTIME_MAPPINGS_SHM_SHM_SYNCHRONOUS_INTERFACE_H_
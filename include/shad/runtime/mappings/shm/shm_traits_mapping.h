@@ -0,0 +1,142 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_SHAD_RUNTIME_MAPPINGS_SHM_SHM_TRAITS_MAPPING_H_
+#define INCLUDE_SHAD_RUNTIME_MAPPINGS_SHM_SHM_TRAITS_MAPPING_H_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "shad/runtime/mapping_traits.h"
+#include "shad/runtime/mappings/cpp_simple/cpp_simple_thread_pool.h"
+#include "shad/runtime/mappings/shm/shm_transport.h"
+
+namespace shad {
+
+namespace rt {
+namespace impl {
+
+struct shm_tag {};
+
+// Handles are plain pointers, like the identifiers of GMT, so that the
+// structures embedding them stay memcopy-able across localities.  Like in
+// GMT, waiting for a Handle resets it and recycles its completion counter.
+template <>
+struct HandleTrait<shm_tag> {
+  using HandleTy = CppHandle *;
+  using ParameterTy = CppHandle *&;
+  using ConstParameterTy = CppHandle *const &;
+
+  static void Init(ParameterTy H, ConstParameterTy V) { H = V; }
+
+  static HandleTy NullValue() { return nullptr; }
+
+  static bool Equal(ConstParameterTy lhs, ConstParameterTy rhs) {
+    return lhs == rhs;
+  }
+
+  static std::string toString(ConstParameterTy H) {
+    return std::to_string(toUnsignedInt(H));
+  }
+
+  static uint64_t toUnsignedInt(ConstParameterTy H) {
+    return reinterpret_cast<uint64_t>(H);
+  }
+
+  static HandleTy CreateNewHandle() {
+    std::lock_guard<std::mutex> _(freeLock_);
+    if (free_.empty()) return new CppHandle();
+    HandleTy H = free_.back();
+    free_.pop_back();
+    return H;
+  }
+
+  static void WaitFor(ParameterTy H) {
+    if (H == nullptr) return;
+    // Tasks running on H may still spawn on it while we wait: reset only
+    // once the handle is drained.
+    try {
+      ThreadPool::Instance().WaitFor(*H);
+    } catch (...) {
+      Recycle(H);
+      H = nullptr;
+      throw;
+    }
+    Recycle(H);
+    H = nullptr;
+  }
+
+ private:
+  static inline std::mutex freeLock_;
+  static inline std::vector<HandleTy> free_;
+
+  static void Recycle(HandleTy H) {
+    std::lock_guard<std::mutex> _(freeLock_);
+    free_.push_back(H);
+  }
+};
+
+template <>
+struct LockTrait<shm_tag> {
+  using LockTy = std::mutex;
+
+  static void lock(LockTy &L) {
+    L.lock();
+    ThreadPool::LockAcquired();
+  }
+  static void unlock(LockTy &L) {
+    ThreadPool::LockReleased();
+    L.unlock();
+  }
+};
+
+template <>
+struct RuntimeInternalsTrait<shm_tag> {
+  static void Initialize(int argc, char *argv[]) {}
+
+  static void Finalize() {}
+
+  static size_t Concurrency() { return ThreadPool::Instance().Concurrency(); }
+  static void Yield() { std::this_thread::yield(); }
+
+  static uint32_t ThisLocality() {
+    return ShmTransport::Instance().ThisLocality();
+  }
+  static uint32_t NullLocality() { return -1; }
+  static uint32_t NumLocalities() {
+    return ShmTransport::Instance().NumLocalities();
+  }
+};
+
+}  // namespace impl
+
+using TargetSystemTag = impl::shm_tag;
+
+}  // namespace rt
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_RUNTIME_MAPPINGS_SHM_SHM_TRAITS_MAPPING_H_
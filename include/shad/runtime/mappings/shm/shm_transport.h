@@ -0,0 +1,367 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_SHAD_RUNTIME_MAPPINGS_SHM_SHM_TRANSPORT_H_
+#define INCLUDE_SHAD_RUNTIME_MAPPINGS_SHM_SHM_TRANSPORT_H_
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include "shad/runtime/mappings/cpp_simple/cpp_simple_thread_pool.h"
+
+namespace shad {
+namespace rt {
+namespace impl {
+
+/// @brief Header of the messages exchanged by the localities.
+struct ShmMessage {
+  enum Kind : uint32_t { kRequest, kReply, kShutdown };
+
+  uint32_t kind;
+  /// The locality sending the message.
+  uint32_t source;
+  /// The pending request, in the address space of the requesting locality.
+  uint64_t token;
+  /// The ShmTrampoline decoding the payload of a request.
+  uint64_t trampoline;
+  /// The range of iterations of a for-each request.
+  uint64_t first;
+  uint64_t count;
+  /// Number of bytes following the header.
+  uint32_t payloadSize;
+  /// Non-zero if the request failed: the payload is the error message.
+  uint32_t status;
+};
+
+/// @brief Result of a request, sent back with its reply.
+struct ShmResult {
+  std::unique_ptr<uint8_t[]> data;
+  uint32_t size = 0;
+
+  uint8_t *Allocate(uint32_t bytes) {
+    data.reset(new uint8_t[bytes]);
+    size = bytes;
+    return data.get();
+  }
+};
+
+/// @brief Function executing a request on the receiving locality.
+using ShmTrampoline = void (*)(const ShmMessage &, const uint8_t *,
+                               ShmResult *);
+
+/// @brief Multiple-producer single-consumer ring of messages.
+///
+/// The ring lives in memory shared by all the processes: producers serialize
+/// on a spinlock, the progress thread of the owning locality consumes.  Head
+/// and tail are byte offsets that only grow; every message is preceded by
+/// its length and padded to 8 bytes.
+struct ShmRing {
+  std::atomic<uint32_t> lock{0};
+  alignas(64) std::atomic<uint64_t> head{0};
+  alignas(64) std::atomic<uint64_t> tail{0};
+
+  uint8_t *Data() { return reinterpret_cast<uint8_t *>(this + 1); }
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "The SHM mapping needs address-free 64-bit atomics.");
+
+/// @brief Message transport among the processes of the SHM mapping.
+///
+/// Every locality is a process forked from the same executable, so code
+/// addresses are valid on all of them and requests carry plain function
+/// pointers.  Each locality owns one inbound ring; a progress thread drains
+/// it, hands requests to the ThreadPool of the process and completes the
+/// replies of the requests the process sent.
+class ShmTransport {
+ public:
+  /// @brief The transport of the process.
+  static ShmTransport &Instance() {
+    static ShmTransport transport;
+    return transport;
+  }
+
+  /// @brief Map the rings of all the localities.
+  ///
+  /// It must be called before forking the processes of the localities.
+  ///
+  /// @param numLocalities The number of localities.
+  /// @param ringCapacity The size in bytes of the inbound ring of a locality.
+  void Setup(uint32_t numLocalities, size_t ringCapacity) {
+    numLocalities_ = numLocalities;
+    capacity_ = (std::max(ringCapacity, kMinRingCapacity) + 63) & ~size_t(63);
+    stride_ = sizeof(ShmRing) + capacity_;
+    regionSize_ = stride_ * numLocalities;
+    void *region = mmap(nullptr, regionSize_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED)
+      throw std::system_error(errno, std::generic_category(),
+                              "Unable to map the SHM rings");
+    region_ = static_cast<uint8_t *>(region);
+    for (uint32_t i = 0; i < numLocalities; ++i) new (Ring(i)) ShmRing();
+  }
+
+  /// @brief Set the locality of this process.
+  void SetLocality(uint32_t locality) { thisLocality_ = locality; }
+
+  uint32_t ThisLocality() const { return thisLocality_; }
+  uint32_t NumLocalities() const { return numLocalities_; }
+
+  /// @brief Largest payload of a request or of a reply.
+  uint32_t MaxPayloadSize() const {
+    return static_cast<uint32_t>(capacity_ / 4);
+  }
+
+  /// @brief Send a request to a locality.
+  ///
+  /// The request is accounted in handle until its reply is received; the
+  /// result of the reply is copied to result and its size to resultSize,
+  /// when they are not null.
+  ///
+  /// @param locality The destination locality.
+  /// @param handle The completion counter of the request.
+  /// @param trampoline The function executing the request.
+  /// @param payload The arguments of the request.
+  /// @param size The size of the arguments.
+  /// @param first The first iteration of a for-each request.
+  /// @param count The number of iterations of a for-each request.
+  /// @param result Where the result is copied.
+  /// @param resultSize Where the size of the result is copied.
+  void Request(uint32_t locality, CppHandle &handle, ShmTrampoline trampoline,
+               const uint8_t *payload, uint32_t size, uint64_t first,
+               uint64_t count, uint8_t *result, uint32_t *resultSize) {
+    CheckMessageSize(size);
+    auto pending = new Pending{&handle, result, resultSize};
+    handle.pending.fetch_add(1, std::memory_order_relaxed);
+    ShmMessage message{ShmMessage::kRequest,
+                       thisLocality_,
+                       reinterpret_cast<uint64_t>(pending),
+                       reinterpret_cast<uint64_t>(trampoline),
+                       first,
+                       count,
+                       size,
+                       0};
+    Push(locality, message, payload);
+  }
+
+  /// @brief Stop the progress thread of a locality.
+  void Shutdown(uint32_t locality) {
+    ShmMessage message{ShmMessage::kShutdown, thisLocality_, 0, 0, 0, 0, 0, 0};
+    Push(locality, message, nullptr);
+  }
+
+  /// @brief Drain the ring of this locality until it receives a shutdown.
+  void Serve() {
+    ShmRing &ring = *Ring(thisLocality_);
+    for (size_t spins = 0;;) {
+      uint64_t head = ring.head.load(std::memory_order_relaxed);
+      if (ring.tail.load(std::memory_order_acquire) == head) {
+        Backoff(spins++);
+        continue;
+      }
+      spins = 0;
+
+      uint64_t bytes;
+      ShmMessage message;
+      CopyOut(ring, head, &bytes, sizeof(bytes));
+      CopyOut(ring, head + sizeof(bytes), &message, sizeof(message));
+      std::unique_ptr<uint8_t[]> payload(new uint8_t[message.payloadSize]);
+      CopyOut(ring, head + sizeof(bytes) + sizeof(message), payload.get(),
+              message.payloadSize);
+      ring.head.store(head + bytes, std::memory_order_release);
+
+      switch (message.kind) {
+        case ShmMessage::kShutdown:
+          return;
+        case ShmMessage::kReply:
+          Complete(message, payload.get());
+          break;
+        default:
+          Dispatch(message, std::move(payload));
+      }
+    }
+  }
+
+  ShmTransport(const ShmTransport &) = delete;
+  ShmTransport &operator=(const ShmTransport &) = delete;
+
+ private:
+  static constexpr size_t kMinRingCapacity = 1 << 16;
+
+  struct Pending {
+    CppHandle *handle;
+    uint8_t *result;
+    uint32_t *resultSize;
+  };
+
+  uint32_t thisLocality_{0};
+  uint32_t numLocalities_{1};
+  size_t capacity_{0};
+  size_t stride_{0};
+  size_t regionSize_{0};
+  uint8_t *region_{nullptr};
+  // Completion counter of the requests served by this locality.
+  CppHandle served_;
+
+  ShmTransport() = default;
+
+  ShmRing *Ring(uint32_t locality) {
+    return reinterpret_cast<ShmRing *>(region_ + stride_ * locality);
+  }
+
+  static void Backoff(size_t spins) {
+    if (spins < 64) return;
+    if (spins < 1024)
+      std::this_thread::yield();
+    else
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+
+  void CopyIn(ShmRing &ring, uint64_t position, const void *src, size_t n) {
+    size_t offset = position % capacity_;
+    size_t first = std::min(n, capacity_ - offset);
+    std::memcpy(ring.Data() + offset, src, first);
+    std::memcpy(ring.Data(), static_cast<const uint8_t *>(src) + first,
+                n - first);
+  }
+
+  void CopyOut(ShmRing &ring, uint64_t position, void *dst, size_t n) {
+    size_t offset = position % capacity_;
+    size_t first = std::min(n, capacity_ - offset);
+    std::memcpy(dst, ring.Data() + offset, first);
+    std::memcpy(static_cast<uint8_t *>(dst) + first, ring.Data(), n - first);
+  }
+
+  static uint64_t MessageBytes(uint32_t payloadSize) {
+    return (sizeof(uint64_t) + sizeof(ShmMessage) + payloadSize + 7) &
+           ~uint64_t(7);
+  }
+
+  void CheckMessageSize(uint32_t payloadSize) const {
+    if (payloadSize <= MaxPayloadSize()) return;
+    std::stringstream ss;
+    ss << "The message payload exceeds the " << MaxPayloadSize()
+       << "B limit of the SHM rings.";
+    throw std::system_error(0xdeadc0de, std::generic_category(), ss.str());
+  }
+
+  void Push(uint32_t locality, const ShmMessage &message,
+            const uint8_t *payload) {
+    uint64_t bytes = MessageBytes(message.payloadSize);
+
+    ShmRing &ring = *Ring(locality);
+    for (size_t spins = 0; ring.lock.exchange(1, std::memory_order_acquire);)
+      Backoff(spins++);
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    for (size_t spins = 0;
+         tail + bytes - ring.head.load(std::memory_order_acquire) > capacity_;)
+      Backoff(spins++);
+    CopyIn(ring, tail, &bytes, sizeof(bytes));
+    CopyIn(ring, tail + sizeof(bytes), &message, sizeof(message));
+    if (message.payloadSize != 0)
+      CopyIn(ring, tail + sizeof(bytes) + sizeof(message), payload,
+             message.payloadSize);
+    ring.tail.store(tail + bytes, std::memory_order_release);
+    ring.lock.store(0, std::memory_order_release);
+  }
+
+  void Dispatch(const ShmMessage &message,
+                std::unique_ptr<uint8_t[]> payload) {
+    ThreadPool::Instance().Spawn(served_, [this, message,
+                                           payload = std::move(payload)] {
+      ShmResult result;
+      ShmMessage reply{ShmMessage::kReply, thisLocality_, message.token, 0, 0,
+                       0, 0, 0};
+      try {
+        reinterpret_cast<ShmTrampoline>(message.trampoline)(
+            message, payload.get(), &result);
+      } catch (const std::exception &e) {
+        reply.status = 1;
+        SetError(e.what(), &result);
+      } catch (...) {
+        reply.status = 1;
+        result.size = 0;
+      }
+      // A reply larger than the ring would never fit in it, and Push would
+      // hold the ring of the requester forever.
+      if (result.size > MaxPayloadSize()) {
+        reply.status = 1;
+        std::stringstream ss;
+        ss << "The reply payload exceeds the " << MaxPayloadSize()
+           << "B limit of the SHM rings.";
+        SetError(ss.str().c_str(), &result);
+      }
+      reply.payloadSize = result.size;
+      Push(message.source, reply, result.data.get());
+    });
+  }
+
+  // Store an error message in a result, truncated to fit a reply.
+  void SetError(const char *what, ShmResult *result) const {
+    size_t length = std::min<size_t>(std::strlen(what), MaxPayloadSize());
+    std::memcpy(result->Allocate(static_cast<uint32_t>(length)), what, length);
+  }
+
+  void Complete(const ShmMessage &message, const uint8_t *payload) {
+    auto pending = reinterpret_cast<Pending *>(message.token);
+    CppHandle &handle = *pending->handle;
+    if (message.status != 0) {
+      std::string what(reinterpret_cast<const char *>(payload),
+                       message.payloadSize);
+      std::lock_guard<std::mutex> _(handle.errorLock);
+      if (!handle.error)
+        handle.error = std::make_exception_ptr(std::system_error(
+            0xdeadc0de, std::generic_category(),
+            "Locality " + std::to_string(message.source) + ": " + what));
+    } else {
+      if (pending->result != nullptr && message.payloadSize != 0)
+        std::memcpy(pending->result, payload, message.payloadSize);
+      if (pending->resultSize != nullptr)
+        *pending->resultSize = message.payloadSize;
+    }
+    delete pending;
+    ThreadPool::Instance().Complete(handle);
+  }
+};
+
+}  // namespace impl
+}  // namespace rt
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_RUNTIME_MAPPINGS_SHM_SHM_TRANSPORT_H_
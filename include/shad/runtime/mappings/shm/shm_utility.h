@@ -0,0 +1,269 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_SHAD_RUNTIME_MAPPINGS_SHM_SHM_UTILITY_H_
+#define INCLUDE_SHAD_RUNTIME_MAPPINGS_SHM_SHM_UTILITY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <system_error>
+
+#include "shad/runtime/locality.h"
+#include "shad/runtime/mappings/cpp_simple/cpp_simple_thread_pool.h"
+#include "shad/runtime/mappings/result_buffer.h"
+#include "shad/runtime/mappings/shm/shm_transport.h"
+
+namespace shad {
+namespace rt {
+
+namespace impl {
+
+inline uint32_t getNodeId(const Locality &loc) {
+  return static_cast<uint32_t>(loc);
+}
+
+inline bool isLocal(const Locality &loc) {
+  return getNodeId(loc) == ShmTransport::Instance().ThisLocality();
+}
+
+inline void checkLocality(const Locality &loc) {
+  uint32_t nodeID = getNodeId(loc);
+  if (nodeID >= ShmTransport::Instance().NumLocalities()) {
+    std::stringstream ss;
+    ss << "The system does not include " << loc;
+    throw std::system_error(0xdeadc0de, std::generic_category(), ss.str());
+  }
+}
+
+inline void checkInputSize(size_t size) {
+  uint32_t limit = ShmTransport::Instance().MaxPayloadSize();
+  if (size > limit) {
+    std::stringstream ss;
+    ss << "The input size exeeds the limit of " << limit
+       << "B imposed by the SHM rings.  Increase SHAD_SHM_RING_SIZE.";
+    throw std::system_error(0xdeadc0de, std::generic_category(), ss.str());
+  }
+}
+
+inline void checkOutputSize(size_t size) {
+  uint32_t limit = ShmTransport::Instance().MaxPayloadSize();
+  if (size > limit) {
+    std::stringstream ss;
+    ss << "The output size exeeds the limit of " << limit
+       << "B imposed by the SHM rings.  Increase SHAD_SHM_RING_SIZE.";
+    throw std::system_error(0xdeadc0de, std::generic_category(), ss.str());
+  }
+}
+
+/// @brief Structure to build the function closure to be sent.
+template <typename FunT, typename InArgsT>
+struct ExecFunWrapperArgs {
+  FunT fun;
+  InArgsT args;
+};
+
+/// @brief Build the payload of a request with a buffer of arguments.
+///
+/// @param fn The function pointer, stored first.
+/// @param argsBuffer The buffer of arguments, stored after the function.
+/// @param bufferSize The size of the buffer.
+/// @param[out] size The size of the payload.
+/// @return The payload.
+template <typename FunctionTy>
+std::unique_ptr<uint8_t[]> packBuffer(FunctionTy fn, const uint8_t *argsBuffer,
+                                      uint32_t bufferSize, uint32_t *size) {
+  checkInputSize(bufferSize + sizeof(fn));
+  *size = bufferSize + sizeof(fn);
+  std::unique_ptr<uint8_t[]> payload(new uint8_t[*size]);
+  std::memcpy(payload.get(), &fn, sizeof(fn));
+  if (argsBuffer != nullptr && bufferSize != 0)
+    std::memcpy(payload.get() + sizeof(fn), argsBuffer, bufferSize);
+  return payload;
+}
+
+/// @brief Send a request and wait for its reply.
+inline void remoteCall(const Locality &loc, ShmTrampoline trampoline,
+                       const uint8_t *payload, uint32_t size,
+                       uint64_t first = 0, uint64_t count = 0,
+                       uint8_t *result = nullptr,
+                       uint32_t *resultSize = nullptr) {
+  CppHandle handle;
+  ShmTransport::Instance().Request(getNodeId(loc), handle, trampoline, payload,
+                                   size, first, count, result, resultSize);
+  ThreadPool::Instance().WaitFor(handle);
+}
+
+/// @brief Send a request to all the localities and wait for their replies.
+///
+/// The numIters iterations of a for-each are split in contiguous blocks, one
+/// per locality.  The block of this locality is run by local(first, last)
+/// while the other localities serve their requests.
+///
+/// @param trampoline The function executing the request.
+/// @param payload The arguments of the request.
+/// @param size The size of the arguments.
+/// @param numIters The number of iterations, zero if not a for-each.
+/// @param local The function executing the request on this locality.
+template <typename LocalT>
+void callOnAll(ShmTrampoline trampoline, const uint8_t *payload,
+               uint32_t size, size_t numIters, const LocalT &local) {
+  auto &transport = ShmTransport::Instance();
+  uint32_t numLocalities = transport.NumLocalities();
+  uint32_t self = transport.ThisLocality();
+  auto block = [&](uint32_t L, size_t *first, size_t *last) {
+    *first = numIters * L / numLocalities;
+    *last = numIters * (L + 1) / numLocalities;
+  };
+
+  CppHandle handle;
+  size_t first, last;
+  for (uint32_t L = 0; L < numLocalities; ++L) {
+    block(L, &first, &last);
+    if (L == self || (numIters != 0 && first == last)) continue;
+    transport.Request(L, handle, trampoline, payload, size, first,
+                      last - first, nullptr, nullptr);
+  }
+  try {
+    block(self, &first, &last);
+    local(first, last);
+  } catch (...) {
+    // The pending requests reference the handle on this stack.
+    try {
+      ThreadPool::Instance().WaitFor(handle);
+    } catch (...) {
+    }
+    throw;
+  }
+  ThreadPool::Instance().WaitFor(handle);
+}
+
+template <typename FunT, typename InArgsT>
+void execFunWrapper(const ShmMessage &, const uint8_t *payload, ShmResult *) {
+  const ExecFunWrapperArgs<FunT, InArgsT> &funArgs =
+      *reinterpret_cast<const ExecFunWrapperArgs<FunT, InArgsT> *>(payload);
+  funArgs.fun(funArgs.args);
+}
+
+inline void execFunWrapper(const ShmMessage &message, const uint8_t *payload,
+                           ShmResult *) {
+  using FunctionTy = void (*)(const uint8_t *, const uint32_t);
+
+  FunctionTy functionPtr;
+  std::memcpy(&functionPtr, payload, sizeof(functionPtr));
+  functionPtr(payload + sizeof(functionPtr),
+              message.payloadSize - sizeof(functionPtr));
+}
+
+// Buffer results are written to a ResultBuffer holding the largest result a
+// reply can carry, and copied to the reply once their size is known.  The
+// buffer is not reused across calls on a thread: the thread runs other
+// requests while the function waits for nested calls.
+inline void copyResultBuffer(ResultBuffer *buffer, uint32_t size,
+                             ShmResult *result) {
+  buffer->SetSize(size);
+  checkOutputSize(size);
+  if (size != 0) std::memcpy(result->Allocate(size), buffer->get(), size);
+}
+
+template <typename FunT, typename InArgsT>
+void execFunWithRetBuffWrapper(const ShmMessage &, const uint8_t *payload,
+                               ShmResult *result) {
+  const ExecFunWrapperArgs<FunT, InArgsT> &funArgs =
+      *reinterpret_cast<const ExecFunWrapperArgs<FunT, InArgsT> *>(payload);
+  ResultBuffer buffer(ShmTransport::Instance().MaxPayloadSize());
+  uint32_t size = 0;
+  funArgs.fun(funArgs.args, buffer.get(), &size);
+  copyResultBuffer(&buffer, size, result);
+}
+
+inline void execFunWithRetBuffWrapper(const ShmMessage &message,
+                                      const uint8_t *payload,
+                                      ShmResult *result) {
+  using FunctionTy =
+      void (*)(const uint8_t *, const uint32_t, uint8_t *, uint32_t *);
+
+  FunctionTy functionPtr;
+  std::memcpy(&functionPtr, payload, sizeof(functionPtr));
+  ResultBuffer buffer(ShmTransport::Instance().MaxPayloadSize());
+  uint32_t size = 0;
+  functionPtr(payload + sizeof(functionPtr),
+              message.payloadSize - sizeof(functionPtr), buffer.get(), &size);
+  copyResultBuffer(&buffer, size, result);
+}
+
+template <typename FunT, typename InArgsT, typename ResT>
+void execFunWithRetWrapper(const ShmMessage &, const uint8_t *payload,
+                           ShmResult *result) {
+  const ExecFunWrapperArgs<FunT, InArgsT> &funArgs =
+      *reinterpret_cast<const ExecFunWrapperArgs<FunT, InArgsT> *>(payload);
+  funArgs.fun(funArgs.args,
+              reinterpret_cast<ResT *>(result->Allocate(sizeof(ResT))));
+}
+
+template <typename ResT>
+void execFunWithRetWrapper(const ShmMessage &message, const uint8_t *payload,
+                           ShmResult *result) {
+  using FunctionTy = void (*)(const uint8_t *, const uint32_t, ResT *);
+
+  FunctionTy functionPtr;
+  std::memcpy(&functionPtr, payload, sizeof(functionPtr));
+  functionPtr(payload + sizeof(functionPtr),
+              message.payloadSize - sizeof(functionPtr),
+              reinterpret_cast<ResT *>(result->Allocate(sizeof(ResT))));
+}
+
+template <typename FunT, typename InArgsT>
+void forEachWrapper(const ShmMessage &message, const uint8_t *payload,
+                    ShmResult *) {
+  const ExecFunWrapperArgs<FunT, InArgsT> &funArgs =
+      *reinterpret_cast<const ExecFunWrapperArgs<FunT, InArgsT> *>(payload);
+  uint64_t first = message.first;
+  ThreadPool::Instance().ParallelFor(message.count, [&](size_t i) {
+    funArgs.fun(funArgs.args, first + i);
+  });
+}
+
+inline void forEachWrapper(const ShmMessage &message, const uint8_t *payload,
+                           ShmResult *) {
+  using FunctionTy = void (*)(const uint8_t *, const uint32_t, size_t);
+
+  FunctionTy functionPtr;
+  std::memcpy(&functionPtr, payload, sizeof(functionPtr));
+  const uint8_t *buffer = payload + sizeof(functionPtr);
+  uint32_t bufferSize = message.payloadSize - sizeof(functionPtr);
+  uint64_t first = message.first;
+  ThreadPool::Instance().ParallelFor(message.count, [&](size_t i) {
+    functionPtr(buffer, bufferSize, first + i);
+  });
+}
+
+}  // namespace impl
+
+}  // namespace rt
+}  // namespace shad
+
+#endif  // INCLUDE_SHAD_RUNTIME_MAPPINGS_SHM_SHM_UTILITY_H_
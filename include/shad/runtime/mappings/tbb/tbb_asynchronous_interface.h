@@ -75,6 +75,30 @@ struct AsynchronousInterface<tbb_tag> {
     handle.id_->run([=, &handle] { fn(handle, argsBuffer.get(), bufferSize); });
   }
 
+  // The continuation waits for predecessor in an isolated region.
+  template <typename FunT, typename InArgsT>
+  static void asyncExecuteAfter(Handle &predecessor, Handle &handle,
+                                FunT &&function, const InArgsT &args) {
+    using FunctionTy = void (*)(Handle &, const InArgsT &);
+    // The continuation waits on a copy of the predecessor, which the caller
+    // keeps using and may wait for or reuse.
+    struct ContinuationArgs {
+      HandleTrait<tbb_tag>::HandleTy predecessor;
+      FunctionTy fn;
+      InArgsT args;
+    };
+    FunctionTy fn = std::forward<decltype(function)>(function);
+    Locality here(RuntimeInternalsTrait<tbb_tag>::ThisLocality());
+    if (predecessor.IsNull()) return asyncExecuteAt(handle, here, fn, args);
+    asyncExecuteAt(
+        handle, here,
+        [](Handle &successor, const ContinuationArgs &continuation) {
+          HandleTrait<tbb_tag>::WaitForDependency(continuation.predecessor);
+          continuation.fn(successor, continuation.args);
+        },
+        ContinuationArgs{predecessor.id_, fn, args});
+  }
+
   template <typename FunT, typename InArgsT>
   static void asyncExecuteAtWithRetBuff(Handle &handle, const Locality &loc,
                                         FunT &&function, const InArgsT &args,
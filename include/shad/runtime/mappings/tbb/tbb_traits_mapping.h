@@ -73,6 +73,12 @@ struct HandleTrait<tbb_tag> {
     if (H == nullptr) return;
     H->wait();
   }
+
+  // Isolated, the wait cannot steal a continuation waiting for this one.
+  static void WaitForDependency(ConstParameterTy H) {
+    if (H == nullptr) return;
+    tbb::this_task_arena::isolate([&H] { H->wait(); });
+  }
 };
 
 template <>
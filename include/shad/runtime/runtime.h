@@ -34,6 +34,7 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <type_traits>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -531,6 +532,27 @@ void forEachAt(const Locality &loc, FunT &&func,
                                                          bufferSize, numIters);
 }
 
+namespace impl {
+
+/// @brief Execute function(i) for i in [0, numIters) in parallel on this
+/// Locality and wait for completion.
+///
+/// The iterations are split into tasks by the runtime mapping, as for
+/// forEachAt.
+///
+/// @tparam FunT The type of the function.  It can be any callable.
+/// @param numIters The number of iterations.
+/// @param function The function executed at every iteration.
+template <typename FunT>
+void parallelFor(size_t numIters, const FunT &function) {
+  auto iterLambda = [](const FunT *const &function, size_t i) {
+    (*function)(i);
+  };
+  forEachAt(thisLocality(), iterLambda, &function, numIters);
+}
+
+}  // namespace impl
+
 /// @brief Execute a parallel loop on the whole system.
 ///
 /// Typical Usage:
@@ -1175,6 +1197,147 @@ void asyncForEachOnAll(Handle &handle, FunT &&func,
 inline void waitForCompletion(Handle &handle) {
   impl::HandleTrait<TargetSystemTag>::WaitFor(handle.id_);
 }
+
+/// @brief Execute a function once a set of tasks has completed.
+///
+/// The continuation is accounted in next: the caller keeps issuing work
+/// while the tasks of handle complete, and waits only on next.  Chaining the
+/// phases of an algorithm this way lets the tasks of a phase start as soon
+/// as the ones they depend on are done, instead of at a global barrier.
+///
+/// Typical Usage:
+/// @code
+/// void phase2(Handle & handle, const Args & args) {  /* do something */ }
+///
+/// Handle phase1Handle, phase2Handle;
+/// for (auto & locality : allLocalities())
+///   asyncExecuteAt(phase1Handle, locality, phase1, args);
+/// then(phase1Handle, phase2Handle, phase2, args);
+/// /* do something else */
+/// waitForCompletion(phase2Handle);
+/// @endcode
+///
+/// The continuation is stored on handle and spawned when its last pending
+/// task completes: no thread blocks waiting for handle.  If a task of handle
+/// fails, the continuation does not run and waiting on next throws, as
+/// waiting on handle does.
+///
+/// @warning The continuation fires the first time handle has no pending
+/// task: the tasks of handle must be spawned before calling then.
+///
+/// @tparam FunT The type of the function to be executed.  The function
+/// prototype must be:
+/// @code
+/// void(Handle &, const InArgsT &);
+/// @endcode
+///
+/// @tparam InArgsT The type of the argument accepted by the function.  The type
+/// can be a structure or a class but with the restriction that must be
+/// memcopy-able.
+///
+/// @param handle The Handle of the tasks to wait for.
+/// @param next The Handle accounting the continuation.
+/// @param func The function to execute on this locality.
+/// @param args The arguments to be passed to the function.
+template <typename FunT, typename InArgsT>
+void then(Handle &handle, Handle &next, FunT &&func, const InArgsT &args) {
+  impl::AsynchronousInterface<TargetSystemTag>::asyncExecuteAfter(
+      handle, next, std::forward<FunT>(func), args);
+}
+
+/// @brief Join several sets of tasks in a single one.
+///
+/// Accounts in joined a task completing when the tasks of all handles have
+/// completed, so that a continuation of joined depends on all of them.
+///
+/// Typical Usage:
+/// @code
+/// Handle left, right, joined, next;
+/// /* spawn tasks on left and right */
+/// whenAll(joined, left, right);
+/// then(joined, next, merge, args);
+/// waitForCompletion(next);
+/// @endcode
+///
+/// @warning As for then, the tasks of the handles must be spawned before
+/// calling whenAll.
+///
+/// @param joined The Handle accounting the completion of all the handles.
+/// @param handles The Handles of the tasks to wait for.
+template <typename... HandlesT>
+void whenAll(Handle &joined, HandlesT &... handles) {
+  static_assert(std::conjunction<std::is_same<HandlesT, Handle>...>::value,
+                "whenAll joins Handles only");
+  (then(handles, joined, [](Handle &, const bool &) {}, true), ...);
+}
+
+/// @brief Result of a function executed asynchronously.
+///
+/// A Future owns the Handle and the storage of the result of the execution
+/// started by asyncExecuteAtWithRet(Future<ResT> &, ...).  As the tasks
+/// reference both, a Future can be neither copied nor moved and must outlive
+/// the execution.
+///
+/// Typical Usage:
+/// @code
+/// Future<size_t> size;
+/// asyncExecuteAtWithRet(size, locality, task, args);
+/// /* do something else */
+/// std::cout << size.Get() << std::endl;
+/// @endcode
+///
+/// @tparam ResT The type of the result value.  The type can be a structure or a
+/// class but with the restriction that must be memcopy-able.
+template <typename ResT>
+class Future {
+ public:
+  Future() = default;
+  Future(const Future &) = delete;
+  Future &operator=(const Future &) = delete;
+
+  /// @brief Wait for the execution and get its result.
+  /// @return The result of the function.
+  const ResT &Get() {
+    if (!handle_.IsNull()) waitForCompletion(handle_);
+    return result_;
+  }
+
+  /// @brief The Handle of the execution, to chain continuations to it.
+  Handle &GetHandle() { return handle_; }
+
+ private:
+  template <typename FunT, typename InArgsT, typename T>
+  friend void asyncExecuteAtWithRet(Future<T> &future, const Locality &loc,
+                                    FunT &&func, const InArgsT &args);
+
+  Handle handle_;
+  ResT result_{};
+};
+
+/// @brief Execute a function on a selected locality asynchronously and return a
+/// Future of its result.
+///
+/// @tparam FunT The type of the function to be executed.  The function
+/// prototype must be:
+/// @code
+/// void(Handle &, const InArgsT &, ResT *);
+/// @endcode
+///
+/// @tparam InArgsT The type of the argument accepted by the function.  The type
+/// can be a structure or a class but with the restriction that must be
+/// memcopy-able.
+///
+/// @tparam ResT The type of the result value.
+///
+/// @param future The Future receiving the result.
+/// @param loc The Locality where the function must be executed.
+/// @param func The function to execute.
+/// @param args The arguments to be passed to the function.
+template <typename FunT, typename InArgsT, typename ResT>
+void asyncExecuteAtWithRet(Future<ResT> &future, const Locality &loc,
+                           FunT &&func, const InArgsT &args) {
+  asyncExecuteAtWithRet(future.handle_, loc, func, args, &future.result_);
+}
 /// @}
 
 }  // namespace rt
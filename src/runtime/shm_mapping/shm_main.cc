@@ -0,0 +1,110 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "shad/runtime/mappings/cpp_simple/cpp_simple_thread_pool.h"
+#include "shad/runtime/mappings/shm/shm_transport.h"
+
+namespace shad {
+
+extern int main(int argc, char *argv[]);
+
+}  // namespace shad
+
+namespace {
+
+size_t getEnv(const char *name, size_t defaultValue) {
+  const char *value = std::getenv(name);
+  if (value == nullptr || *value == '\0') return defaultValue;
+  return std::strtoull(value, nullptr, 10);
+}
+
+}  // namespace
+
+// Locality 0 runs shad::main, the other localities serve its requests until
+// it returns.  The processes are forked before any thread is started.
+int main(int argc, char *argv[]) {
+  using shad::rt::impl::ShmTransport;
+  using shad::rt::impl::ThreadPool;
+
+  uint32_t numLocalities =
+      std::max<size_t>(getEnv("SHAD_SHM_NUM_LOCALITIES", 2), 1);
+  size_t ringSize = getEnv("SHAD_SHM_RING_SIZE", 8 << 20);
+  size_t hwThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  ThreadPool::Configure(getEnv("SHAD_SHM_NUM_THREADS",
+                               std::max<size_t>(hwThreads / numLocalities, 1)));
+
+  ShmTransport &transport = ShmTransport::Instance();
+  transport.Setup(numLocalities, ringSize);
+
+  std::fflush(nullptr);
+  pid_t parent = getpid();
+  std::vector<pid_t> children;
+  uint32_t thisLocality = 0;
+  for (uint32_t L = 1; L < numLocalities; ++L) {
+    pid_t pid = fork();
+    if (pid == -1) {
+      std::perror("SHAD: unable to fork the SHM localities");
+      for (pid_t child : children) kill(child, SIGKILL);
+      return EXIT_FAILURE;
+    }
+    if (pid == 0) {
+      prctl(PR_SET_PDEATHSIG, SIGKILL);
+      if (getppid() != parent) return EXIT_FAILURE;
+      children.clear();
+      thisLocality = L;
+      break;
+    }
+    children.push_back(pid);
+  }
+
+  transport.SetLocality(thisLocality);
+  std::thread progress([&transport] { transport.Serve(); });
+
+  int result = EXIT_SUCCESS;
+  if (thisLocality == 0) {
+    result = shad::main(argc, argv);
+    for (uint32_t L = 0; L < numLocalities; ++L) transport.Shutdown(L);
+  }
+  progress.join();
+
+  for (pid_t child : children) {
+    int status;
+    if (waitpid(child, &status, 0) == -1 || !WIFEXITED(status) ||
+        WEXITSTATUS(status) != EXIT_SUCCESS)
+      result = result != EXIT_SUCCESS ? result : EXIT_FAILURE;
+  }
+  return result;
+}
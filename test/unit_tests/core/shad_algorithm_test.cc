@@ -370,6 +370,38 @@ TYPED_TEST(ATF, shad_find) {
       shad_test_stl::find_<it_t, value_t>, 1);
 }
 
+template <typename T>
+struct greater_than {
+  bool operator()(const T &x) const { return x > threshold; }
+  T threshold;
+};
+
+// fine-grained intra-node parallelism
+TYPED_TEST(ATF, shad_fine_grain) {
+  using value_t = typename TypeParam::value_type;
+  auto policy = [] { return shad::distributed_parallel_tag{16}; };
+  auto first = this->in->begin(), last = this->in->end();
+
+  // the first match wins over the matches in the following partitions
+  ASSERT_EQ(shad::find(policy(), first, last, 1400), first + 700);
+  ASSERT_EQ(shad::find_if(policy(), first, last, greater_than<value_t>{99}),
+            first + 50);
+  ASSERT_EQ(shad::find_if_not(policy(), first, last,
+                              shad_test_stl::is_even<value_t>{}),
+            last);
+  ASSERT_TRUE(
+      shad::any_of(policy(), first, last, greater_than<value_t>{2000}));
+  ASSERT_FALSE(shad::all_of(policy(), first, last, greater_than<value_t>{0}));
+  ASSERT_EQ(
+      shad::count_if(policy(), first, last, greater_than<value_t>{1023}),
+      512);
+
+  auto other = shad_test_stl::create_array_<TypeParam, true>{}();
+  ASSERT_TRUE(shad::equal(policy(), first, last, other->begin()));
+  other->at(1000) = 1;
+  ASSERT_FALSE(shad::equal(policy(), first, last, other->begin()));
+}
+
 // todo find_end
 // todo find_first_of
 // todo adjacent_find
@@ -478,6 +510,121 @@ TYPED_TEST(ATF, shad_replace_if) {
       shad_test_stl::ordered_checksum<it_t>, pred, 3);
 }
 
+// sort, stable_sort, partial_sort, nth_element
+template <typename T>
+void scramble(std::shared_ptr<T> in, size_t modulo) {
+  // 7919 is coprime with the container size
+  for (size_t i = 0; i < in->size(); ++i)
+    in->at(i) = ((i * 7919) % in->size()) % modulo;
+}
+
+template <typename T, typename Compare>
+void check_sorted(std::shared_ptr<T> in, Compare comp) {
+  auto prev = in->begin();
+  for (auto it = prev; it != in->end(); prev = it++)
+    ASSERT_FALSE(comp(*it, *prev));
+}
+
+TYPED_TEST(ATF, shad_sort) {
+  using val_t = typename TypeParam::value_type;
+  auto n = this->in->size();
+
+  scramble(this->in, n);
+  shad::sort(shad::distributed_sequential_tag{}, this->in->begin(),
+             this->in->end());
+  for (size_t i = 0; i < n; ++i) ASSERT_EQ(this->in->at(i), i);
+
+  scramble(this->in, n);
+  shad::sort(shad::distributed_parallel_tag{}, this->in->begin(),
+             this->in->end());
+  for (size_t i = 0; i < n; ++i) ASSERT_EQ(this->in->at(i), i);
+
+  scramble(this->in, n);
+  shad::sort(shad::distributed_parallel_tag{}, this->in->begin(),
+             this->in->end(), std::greater<val_t>());
+  for (size_t i = 0; i < n; ++i) ASSERT_EQ(this->in->at(i), n - i - 1);
+
+  // duplicate keys
+  scramble(this->in, 7);
+  shad::sort(shad::distributed_parallel_tag{}, this->in->begin(),
+             this->in->end());
+  check_sorted(this->in, std::less<val_t>());
+  ASSERT_EQ(shad::count(shad::distributed_parallel_tag{}, this->in->begin(),
+                        this->in->end(), 0),
+            (n + 6) / 7);
+
+  // sub-range
+  scramble(this->in, n);
+  auto first = this->in->begin() + 3, last = this->in->end() - 5;
+  std::vector<val_t> expected(first, last);
+  std::sort(expected.begin(), expected.end());
+  shad::sort(shad::distributed_parallel_tag{}, first, last);
+  ASSERT_EQ(std::vector<val_t>(first, last), expected);
+}
+
+TYPED_TEST(ATF, shad_stable_sort) {
+  using val_t = typename TypeParam::value_type;
+  auto n = this->in->size();
+
+  // only the key (the value divided by 16) is compared: the payload (the
+  // value modulo 16) tells whether the relative order is preserved
+  auto key_less = [](const val_t& a, const val_t& b) { return a / 16 < b / 16; };
+  auto key_payload_less = [](const val_t& a, const val_t& b) { return a < b; };
+  for (size_t i = 0; i < n; ++i) this->in->at(i) = ((n - i) % 8) * 16 + i % 16;
+  std::vector<val_t> expected(this->in->begin(), this->in->end());
+  std::stable_sort(expected.begin(), expected.end(), key_less);
+
+  shad::stable_sort(shad::distributed_sequential_tag{}, this->in->begin(),
+                    this->in->end(), key_less);
+  ASSERT_EQ(std::vector<val_t>(this->in->begin(), this->in->end()), expected);
+
+  for (size_t i = 0; i < n; ++i) this->in->at(i) = ((n - i) % 8) * 16 + i % 16;
+  shad::stable_sort(shad::distributed_parallel_tag{}, this->in->begin(),
+                    this->in->end(), key_less);
+  ASSERT_EQ(std::vector<val_t>(this->in->begin(), this->in->end()), expected);
+
+  scramble(this->in, n);
+  shad::stable_sort(shad::distributed_parallel_tag{}, this->in->begin(),
+                    this->in->end());
+  check_sorted(this->in, key_payload_less);
+}
+
+TYPED_TEST(ATF, shad_partial_sort) {
+  using val_t = typename TypeParam::value_type;
+  auto n = this->in->size();
+  size_t m = n / 3;
+
+  scramble(this->in, n);
+  shad::partial_sort(shad::distributed_sequential_tag{}, this->in->begin(),
+                     this->in->begin() + m, this->in->end());
+  for (size_t i = 0; i < m; ++i) ASSERT_EQ(this->in->at(i), i);
+
+  scramble(this->in, n);
+  shad::partial_sort(shad::distributed_parallel_tag{}, this->in->begin(),
+                     this->in->begin() + m, this->in->end(),
+                     std::greater<val_t>());
+  for (size_t i = 0; i < m; ++i) ASSERT_EQ(this->in->at(i), n - i - 1);
+  for (size_t i = m; i < n; ++i) ASSERT_LT(this->in->at(i), n - m);
+}
+
+TYPED_TEST(ATF, shad_nth_element) {
+  using val_t = typename TypeParam::value_type;
+  auto n = this->in->size();
+  size_t m = n / 3;
+
+  scramble(this->in, n);
+  shad::nth_element(shad::distributed_sequential_tag{}, this->in->begin(),
+                    this->in->begin() + m, this->in->end());
+  ASSERT_EQ(this->in->at(m), m);
+
+  scramble(this->in, n);
+  shad::nth_element(shad::distributed_parallel_tag{}, this->in->begin(),
+                    this->in->begin() + m, this->in->end());
+  ASSERT_EQ(this->in->at(m), m);
+  for (size_t i = 0; i < m; ++i) ASSERT_LT(this->in->at(i), m);
+  for (size_t i = m + 1; i < n; ++i) ASSERT_GT(this->in->at(i), m);
+}
+
 ///////////////////////////////////////
 //
 // shad::unordered_set
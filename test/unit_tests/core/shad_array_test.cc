@@ -22,8 +22,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstring>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -165,10 +167,85 @@ TYPED_TEST_P(ArrayTest, IteratorMovements) {
   }
 }
 
+TYPED_TEST_P(ArrayTest, ReadCache) {
+  this->array_.enable_read_cache();
+  size_t offset = 0;
+  for (auto value : this->array_) ASSERT_EQ(value, offset++);
+
+  for (size_t i = 0; i < this->array_.size(); ++i)
+    this->array_[i] = this->array_.size() - i;
+  this->array_.invalidate_read_cache();
+  for (size_t i = 0; i < this->array_.size(); ++i)
+    ASSERT_EQ(this->array_[i], this->array_.size() - i);
+  this->array_.disable_read_cache();
+}
+
 REGISTER_TYPED_TEST_CASE_P(ArrayTest, HasTypeInterface, Size, AccessMethods,
-                           IteratorMovements);
+                           IteratorMovements, ReadCache);
 
 using ArrayTestTypes =
     ::testing::Types<ArrayTestPair<size_t, 900>, ArrayTestPair<size_t, 901>,
                      ArrayTestPair<size_t, 902>, ArrayTestPair<size_t, 42>>;
 INSTANTIATE_TYPED_TEST_CASE_P(ShadArray, ArrayTest, ArrayTestTypes);
+
+class ArrayReadCacheTest : public ::testing::Test {
+ public:
+  using CacheType = shad::impl::ArrayReadCache<size_t>;
+  static constexpr size_t kChunkSize = CacheType::kBlockSize * 10 + 7;
+
+  void SetUp() {
+    fetches_ = 0;
+    for (size_t l = 0; l < 2; ++l) {
+      chunks_[l].resize(kChunkSize);
+      for (size_t i = 0; i < kChunkSize; ++i)
+        chunks_[l][i] = l * kChunkSize + i;
+    }
+  }
+
+  CacheType MakeCache(size_t prefetchWindow) {
+    return CacheType(
+        [this](shad::rt::Handle &, const shad::rt::Locality &loc, size_t first,
+               size_t count, uint8_t *out, uint32_t *bytes) {
+          ++fetches_;
+          auto &chunk = chunks_[static_cast<uint32_t>(loc)];
+          *bytes = count * sizeof(size_t);
+          std::memcpy(out, chunk.data() + first, *bytes);
+        },
+        [](const shad::rt::Locality &) { return kChunkSize; }, prefetchWindow);
+  }
+
+  size_t fetches_;
+  std::vector<size_t> chunks_[2];
+};
+
+constexpr size_t ArrayReadCacheTest::kChunkSize;
+
+TEST_F(ArrayReadCacheTest, SequentialScans) {
+  auto cache = MakeCache(2);
+  shad::rt::Locality loc(1);
+  for (size_t i = 0; i < kChunkSize; ++i)
+    ASSERT_EQ(cache.Get(loc, i), kChunkSize + i);
+  // One fetch per block, and the scan turns into hits after two misses.
+  ASSERT_EQ(fetches_, 11);
+  ASSERT_EQ(cache.Misses(), 2);
+
+  cache.Invalidate();
+  fetches_ = 0;
+  for (size_t i = kChunkSize; i > 0; --i)
+    ASSERT_EQ(cache.Get(loc, i - 1), kChunkSize + i - 1);
+  ASSERT_EQ(fetches_, 11);
+}
+
+TEST_F(ArrayReadCacheTest, UpdateAndInvalidate) {
+  auto cache = MakeCache(0);
+  shad::rt::Locality loc(0);
+  ASSERT_EQ(cache.Get(loc, 5), 5);
+  cache.Update(loc, 5, 42);
+  ASSERT_EQ(cache.Get(loc, 5), 42);
+  chunks_[0][6] = 43;
+  ASSERT_EQ(cache.Get(loc, 6), 6);
+  cache.Invalidate();
+  ASSERT_EQ(cache.Get(loc, 6), 43);
+  ASSERT_EQ(cache.Get(loc, 5), 5);
+  ASSERT_EQ(fetches_, 2);
+}
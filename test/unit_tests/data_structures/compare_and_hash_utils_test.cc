@@ -0,0 +1,96 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "shad/data_structures/compare_and_hash_utils.h"
+
+namespace {
+
+struct CompositeKey {
+  uint64_t words[4];
+};
+
+}  // namespace
+
+TEST(CompareAndHashUtilsTest, WordHashEveryByteMatters) {
+  CompositeKey key = {{1, 2, 3, 4}};
+  uint64_t reference = shad::hash<CompositeKey>{}(key);
+  ASSERT_EQ(reference, shad::hash<CompositeKey>{}(key));
+  ASSERT_NE(reference, shad::WordHashFunction(key, 42));
+
+  auto bytes = reinterpret_cast<uint8_t *>(&key);
+  for (size_t i = 0; i < sizeof(key); ++i) {
+    bytes[i] ^= 1;
+    ASSERT_NE(reference, shad::hash<CompositeKey>{}(key)) << "byte " << i;
+    bytes[i] ^= 1;
+  }
+}
+
+TEST(CompareAndHashUtilsTest, WordHashVectorHashesContent) {
+  for (size_t length = 0; length <= 40; ++length) {
+    std::vector<uint8_t> content(length);
+    for (size_t i = 0; i < length; ++i) content[i] = i * 7 + 1;
+    std::vector<uint8_t> copy(content);
+    ASSERT_EQ(shad::WordHashFunction(content, 0),
+              shad::WordHashFunction(copy, 0));
+    if (length == 0) continue;
+    copy.back() ^= 0x80;
+    ASSERT_NE(shad::WordHashFunction(content, 0),
+              shad::WordHashFunction(copy, 0));
+  }
+}
+
+TEST(CompareAndHashUtilsTest, HashBatch) {
+  std::vector<CompositeKey> keys(100);
+  for (uint64_t i = 0; i < keys.size(); ++i) keys[i] = {{i, i, 2 * i, 3 * i}};
+  std::vector<uint64_t> hashes(keys.size());
+  shad::HashBatch(keys.data(), keys.size(), hashes.data());
+  for (size_t i = 0; i < keys.size(); ++i)
+    ASSERT_EQ(hashes[i], shad::hash<CompositeKey>{}(keys[i]));
+}
+
+TEST(CompareAndHashUtilsTest, BucketsIndependentOfRouting) {
+  // All the keys routed to Locality 0 out of 4 share their low bits, which
+  // must not crowd them into a fraction of the buckets.
+  constexpr size_t kNumLocalities = 4;
+  constexpr size_t kNumBuckets = 64;
+  constexpr size_t kNumKeys = kNumBuckets * 64;
+  std::array<size_t, kNumBuckets> load{};
+  for (uint64_t i = 0; i < kNumKeys; ++i) {
+    uint64_t key = i * kNumLocalities;
+    size_t bucket = shad::impl::BucketOf(shad::hash<uint64_t>{}(key),
+                                         kNumBuckets);
+    ASSERT_LT(bucket, kNumBuckets);
+    ++load[bucket];
+  }
+  for (size_t b = 0; b < kNumBuckets; ++b) {
+    ASSERT_GT(load[b], kNumKeys / kNumBuckets / 2) << "bucket " << b;
+    ASSERT_LT(load[b], kNumKeys / kNumBuckets * 2) << "bucket " << b;
+  }
+}
@@ -181,6 +181,16 @@ TEST_F(HashmapTest, InsertLookupTest) {
   HashmapType::Destroy(mapPtr->GetGlobalID());
 }
 
+TEST_F(HashmapTest, ApproximateSizeTest) {
+  auto mapPtr = HashmapType::Create(kToInsert);
+  for (uint64_t i = 1; i <= kToInsert; i++) {
+    DoInsert(mapPtr->GetGlobalID(), i, i + 11);
+  }
+  ASSERT_EQ(mapPtr->Size(), kToInsert);
+  ASSERT_NEAR(mapPtr->ApproximateSize(), kToInsert, kToInsert / 4);
+  HashmapType::Destroy(mapPtr->GetGlobalID());
+}
+
 TEST_F(HashmapTest, AsyncInsertLookupTest) {
   auto mapPtr = HashmapType::Create(kToInsert);
   shad::rt::Handle handle;
@@ -263,6 +273,48 @@ TEST_F(HashmapTest, BufferedAsyncInsertAsyncLookupTest) {
   HashmapType::Destroy(mapPtr->GetGlobalID());
 }
 
+TEST_F(HashmapTest, ConcurrentBufferedAsyncInsertTest) {
+  auto mapPtr = HashmapType::Create(kToInsert);
+  shad::rt::Handle handle;
+  shad::rt::asyncForEachAt(
+      handle, shad::rt::thisLocality(),
+      [](shad::rt::Handle &handle, const HashmapType::ObjectID &oid,
+         size_t i) { DoBufferedAsyncInsert(handle, oid, i, i + 11); },
+      mapPtr->GetGlobalID(), kToInsert);
+  shad::rt::waitForCompletion(handle);
+  mapPtr->WaitForBufferedInsert();
+  ASSERT_EQ(mapPtr->Size(), kToInsert);
+  for (uint64_t i = 0; i < kToInsert; i++) {
+    Value value;
+    ASSERT_TRUE(DoLookup(mapPtr->GetGlobalID(), i, &value));
+    CheckValue(&value, i + 11);
+  }
+  HashmapType::Destroy(mapPtr->GetGlobalID());
+}
+
+TEST_F(HashmapTest, InsertLookupBatchTest) {
+  auto mapPtr = HashmapType::Create(kToInsert);
+  std::vector<Key> keys(2 * kToInsert);
+  std::vector<Value> values(kToInsert);
+  for (uint64_t i = 0; i < 2 * kToInsert; i++) {
+    FillKey(&keys[i], i);
+    if (i < kToInsert) FillValue(&values[i], i + 11);
+  }
+  shad::rt::Handle handle;
+  mapPtr->AsyncInsertBatch(handle, keys.data(), values.data(), kToInsert / 2);
+  shad::rt::waitForCompletion(handle);
+  mapPtr->InsertBatch(keys.data() + kToInsert / 2,
+                      values.data() + kToInsert / 2, kToInsert - kToInsert / 2);
+  ASSERT_EQ(mapPtr->Size(), kToInsert);
+  std::vector<HashmapType::LookupResult> results(2 * kToInsert);
+  mapPtr->LookupBatch(keys.data(), 2 * kToInsert, results.data());
+  for (uint64_t i = 0; i < 2 * kToInsert; i++) {
+    ASSERT_EQ(results[i].found, i < kToInsert);
+    if (i < kToInsert) CheckValue(&results[i].value, i + 11);
+  }
+  HashmapType::Destroy(mapPtr->GetGlobalID());
+}
+
 TEST_F(HashmapTest, FEBufferedAsyncInsertAsyncLookupTest) {
   auto mapPtr = HashmapType::Create(kToInsert);
   shad::rt::Handle handle;
@@ -411,6 +463,28 @@ TEST_F(HashmapTest, ForEachEntry) {
   HashmapType::Destroy(mapPtr->GetGlobalID());
 }
 
+TEST_F(HashmapTest, Iterator) {
+  auto mapPtr = HashmapType::Create(kToInsert);
+  auto args = std::make_tuple(mapPtr->GetGlobalID(), 0lu);
+  shad::rt::Handle handle;
+  shad::rt::asyncForEachOnAll(handle, InsertTestParallelFunc, args, kToInsert);
+  shad::rt::waitForCompletion(handle);
+  std::vector<bool> visited(kToInsert, false);
+  size_t numVisited = 0;
+  for (auto it = mapPtr->begin(); it != mapPtr->end(); ++it) {
+    auto entry = *it;
+    uint64_t seed = GetSeed(&entry.first);
+    ASSERT_LT(seed, kToInsert);
+    ASSERT_FALSE(visited[seed]);
+    CheckKey(&entry.first, seed);
+    CheckValue(&entry.second, GetSeed(&entry.second));
+    visited[seed] = true;
+    ++numVisited;
+  }
+  ASSERT_EQ(numVisited, kToInsert);
+  HashmapType::Destroy(mapPtr->GetGlobalID());
+}
+
 TEST_F(HashmapTest, AsyncForEachEntry) {
   auto mapPtr = HashmapType::Create(kToInsert);
   auto args = std::make_tuple(mapPtr->GetGlobalID(), 0lu);
@@ -570,3 +644,168 @@ TEST_F(HashmapTest, AsyncApply) {
   shad::rt::waitForCompletion(handle);
   HashmapType::Destroy(mapPtr->GetGlobalID());
 }
+
+TEST(FlatHashmapTest, InsertLookupErase) {
+  using FlatHashmapType =
+      shad::Hashmap<uint64_t, uint64_t, shad::MemCmp<uint64_t>,
+                    shad::Overwriter<uint64_t>, shad::LocalFlatHashmap>;
+  const uint64_t kToInsert = 4096;
+  auto mapPtr = FlatHashmapType::Create(kToInsert / 8);
+  shad::rt::Handle handle;
+  for (uint64_t i = 0; i < kToInsert; i++) mapPtr->AsyncInsert(handle, i, i);
+  shad::rt::waitForCompletion(handle);
+  ASSERT_EQ(mapPtr->Size(), kToInsert);
+
+  uint64_t value;
+  for (uint64_t i = 0; i < kToInsert; i++) {
+    ASSERT_TRUE(mapPtr->Lookup(i, &value));
+    ASSERT_EQ(value, i);
+  }
+
+  uint64_t checksum = 0;
+  for (auto entry : *mapPtr) checksum += entry.first + entry.second;
+  ASSERT_EQ(checksum, kToInsert * (kToInsert - 1));
+
+  for (uint64_t i = 0; i < kToInsert; i += 2) mapPtr->Erase(i);
+  ASSERT_EQ(mapPtr->Size(), kToInsert / 2);
+  for (uint64_t i = 0; i < kToInsert; i++)
+    ASSERT_EQ(mapPtr->Lookup(i, &value), (i % 2) != 0);
+  FlatHashmapType::Destroy(mapPtr->GetGlobalID());
+}
+
+TEST(HashmapReplicationTest, LookupsSeeWrites) {
+  using MapT = shad::Hashmap<uint64_t, uint64_t>;
+  const uint64_t kNumKeys = 256;
+  auto mapPtr = MapT::Create(kNumKeys);
+  mapPtr->EnableReplication(64, 2);
+  for (uint64_t i = 0; i < kNumKeys; i++) mapPtr->Insert(i, i);
+
+  uint64_t value;
+  shad::rt::Handle handle;
+  std::vector<MapT::LookupResult> results(kNumKeys);
+  for (size_t round = 0; round < 4; ++round) {
+    for (uint64_t i = 0; i < kNumKeys; i++) {
+      ASSERT_TRUE(mapPtr->Lookup(i, &value));
+      ASSERT_EQ(value, i);
+      mapPtr->AsyncLookup(handle, i, &results[i]);
+    }
+    shad::rt::waitForCompletion(handle);
+    for (uint64_t i = 0; i < kNumKeys; i++) {
+      ASSERT_TRUE(results[i].found);
+      ASSERT_EQ(results[i].value, i);
+    }
+  }
+
+  for (uint64_t i = 0; i < kNumKeys; i += 2) mapPtr->Insert(i, i + 1);
+  for (uint64_t i = 1; i < kNumKeys; i += 2) mapPtr->AsyncErase(handle, i);
+  shad::rt::waitForCompletion(handle);
+  for (uint64_t i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(mapPtr->Lookup(i, &value), i % 2 == 0);
+    if (i % 2 == 0) {
+      ASSERT_EQ(value, i + 1);
+    }
+  }
+
+  mapPtr->InvalidateReplicas();
+  mapPtr->DisableReplication();
+  for (uint64_t i = 0; i < kNumKeys; i += 2) {
+    ASSERT_TRUE(mapPtr->Lookup(i, &value));
+    ASSERT_EQ(value, i + 1);
+  }
+  MapT::Destroy(mapPtr->GetGlobalID());
+}
+
+static void IncrementValue(const uint64_t &, uint64_t &value) { ++value; }
+
+static void AsyncIncrementValue(shad::rt::Handle &, const uint64_t &,
+                                uint64_t &value) {
+  ++value;
+}
+
+TEST(HashmapReplicationTest, AllWritesDropReplicas) {
+  using MapT = shad::Hashmap<uint64_t, uint64_t>;
+  const uint64_t kNumKeys = 256;
+  auto mapPtr = MapT::Create(kNumKeys);
+  mapPtr->EnableReplication(64, 2);
+
+  // Reads the keys until they are hot and replicated.
+  auto checkValues = [&](uint64_t offset) {
+    uint64_t value;
+    for (size_t round = 0; round < 4; ++round) {
+      for (uint64_t i = 0; i < kNumKeys; i++) {
+        ASSERT_TRUE(mapPtr->Lookup(i, &value));
+        ASSERT_EQ(value, i + offset);
+      }
+    }
+  };
+  std::vector<uint64_t> keys(kNumKeys), values(kNumKeys);
+  for (uint64_t i = 0; i < kNumKeys; i++) {
+    keys[i] = i;
+    values[i] = i;
+  }
+  mapPtr->InsertBatch(keys.data(), values.data(), kNumKeys);
+  checkValues(0);
+
+  for (uint64_t i = 0; i < kNumKeys; i++) values[i] = i + 1;
+  mapPtr->InsertBatch(keys.data(), values.data(), kNumKeys);
+  checkValues(1);
+
+  for (uint64_t i = 0; i < kNumKeys; i++) mapPtr->BufferedInsert(i, i + 2);
+  mapPtr->WaitForBufferedInsert();
+  checkValues(2);
+
+  for (uint64_t i = 0; i < kNumKeys; i++) mapPtr->Apply(i, IncrementValue);
+  checkValues(3);
+
+  shad::rt::Handle handle;
+  for (uint64_t i = 0; i < kNumKeys; i++)
+    mapPtr->AsyncApply(handle, i, AsyncIncrementValue);
+  shad::rt::waitForCompletion(handle);
+  checkValues(4);
+
+  mapPtr->ForEachEntry(IncrementValue);
+  checkValues(5);
+
+  mapPtr->AsyncForEachEntry(handle, AsyncIncrementValue);
+  shad::rt::waitForCompletion(handle);
+  checkValues(6);
+
+  mapPtr->DisableReplication();
+  MapT::Destroy(mapPtr->GetGlobalID());
+}
+
+TEST(HashmapReplicationTest, HotKeyReplicas) {
+  using ReplicasT = shad::impl::HotKeyReplicas<uint64_t, uint64_t,
+                                               shad::MemCmp<uint64_t>>;
+  ReplicasT replicas(16, 3);
+  ASSERT_FALSE(replicas.CountAccess(7));
+  ASSERT_FALSE(replicas.CountAccess(7));
+  ASSERT_TRUE(replicas.CountAccess(7));
+  ASSERT_FALSE(replicas.CountAccess(7));
+
+  // A replicated key keeps its counter until it is written.
+  for (uint64_t key = 100; key < 1000; ++key) replicas.CountAccess(key);
+  uint64_t version = replicas.Version();
+  uint64_t dropVersion = replicas.Unreplicate(7);
+  ASSERT_GT(dropVersion, version);
+  ASSERT_EQ(replicas.Unreplicate(7), 0u);
+
+  uint64_t value;
+  ASSERT_FALSE(replicas.Lookup(7, &value));
+  replicas.Store(0, version, 7, 70);
+  ASSERT_TRUE(replicas.Lookup(7, &value));
+  ASSERT_EQ(value, 70);
+  replicas.Drop(0, dropVersion, 8);
+  ASSERT_TRUE(replicas.Lookup(7, &value));
+  replicas.Drop(0, dropVersion, 7);
+  ASSERT_FALSE(replicas.Lookup(7, &value));
+
+  // Replicas sent before the drop are discarded.
+  replicas.Store(0, version, 7, 70);
+  ASSERT_FALSE(replicas.Lookup(7, &value));
+
+  replicas.Store(0, dropVersion, 7, 70);
+  ASSERT_TRUE(replicas.Lookup(7, &value));
+  replicas.Clear();
+  ASSERT_FALSE(replicas.Lookup(7, &value));
+}
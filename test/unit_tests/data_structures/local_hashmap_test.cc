@@ -36,6 +36,16 @@ class LocalHashmapTest : public ::testing::Test {
   void TearDown() {}
   static const uint64_t kToInsert = 4096;
   static const uint64_t kNumBuckets = kToInsert / 16;
+
+  // The first count keys stored in bucket bid out of kNumBuckets.
+  static std::vector<uint64_t> KeysInBucket(uint64_t bid, size_t count) {
+    std::vector<uint64_t> keys;
+    for (uint64_t x = 1; keys.size() < count; ++x) {
+      if (shad::impl::BucketOf(shad::hash<uint64_t>{}(x), kNumBuckets) == bid)
+        keys.push_back(x);
+    }
+    return keys;
+  }
   static const uint64_t kKeysPerEntry = 3;
   static const uint64_t kValuesPerEntry = 5;
   static const uint64_t kMagicValue = 9999;
@@ -199,6 +209,30 @@ TEST_F(LocalHashmapTest, InsertReturnTest) {
   }
 }
 
+TEST_F(LocalHashmapTest, InsertEntries) {
+  struct Entry {
+    Key key;
+    Value value;
+  };
+  // Every key is inserted twice and the second value overwrites the first.
+  std::vector<Entry> entries(2 * kToInsert);
+  for (uint64_t i = 1; i <= kToInsert; i++) {
+    FillKey(&entries[i - 1].key, i);
+    FillValue(&entries[i - 1].value, i);
+    FillKey(&entries[kToInsert + i - 1].key, i);
+    FillValue(&entries[kToInsert + i - 1].value, i + 11);
+  }
+  hmap.InsertEntries(entries.data(), entries.size());
+  size_t toinsert = kToInsert;
+  ASSERT_EQ(hmap.Size(), toinsert);
+
+  Value *values;
+  for (uint64_t i = 1; i <= kToInsert; i++) {
+    ASSERT_TRUE(DoLookup(&hmap, i, &values));
+    CheckValue(values, i + 11);
+  }
+}
+
 TEST_F(LocalHashmapTest, AsyncInsertLookupTest) {
   HashmapType hmap(kNumBuckets);
   uint64_t i;
@@ -586,8 +620,7 @@ TEST_F(LocalHashmapTest, LocalIteratorPartitions) {
   for (uint64_t bid = 0; bid < kNumBuckets; bid += kNumBuckets / 8) {
     map.Clear();
     exp_checksum = 0;
-    for (auto i = kToInsert; i > 0; --i) {
-      auto x = i * kNumBuckets + bid;
+    for (auto x : KeysInBucket(bid, kToInsert)) {
       map.Insert(x, x);
       exp_checksum += x;
     }
@@ -605,12 +638,11 @@ TEST_F(LocalHashmapTest, LocalIteratorPartitions) {
   // some empty buckets
   map.Clear();
   exp_checksum = 0;
-  uint64_t bid = 0;
-  for (auto i = kToInsert; i > 0; --i) {
-    auto x = i * kNumBuckets + bid;
-    map.Insert(x, x);
-    exp_checksum += x;
-    bid = (bid + (kNumBuckets / 8)) % kNumBuckets;
+  for (uint64_t bid = 0; bid < kNumBuckets; bid += kNumBuckets / 8) {
+    for (auto x : KeysInBucket(bid, kToInsert / 8)) {
+      map.Insert(x, x);
+      exp_checksum += x;
+    }
   }
   for (uint64_t n_parts = 1; n_parts <= 2 * kNumBuckets; ++n_parts) {
     obs_checksum = 0;
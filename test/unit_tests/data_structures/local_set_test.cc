@@ -36,6 +36,16 @@ class LocalSetTest : public ::testing::Test {
   void TearDown() {}
   static const uint64_t kToInsert = 4096;
   static const uint64_t kNumBuckets = kToInsert / 16;
+
+  // The first count keys stored in bucket bid out of kNumBuckets.
+  static std::vector<uint64_t> KeysInBucket(uint64_t bid, size_t count) {
+    std::vector<uint64_t> keys;
+    for (uint64_t x = 1; keys.size() < count; ++x) {
+      if (shad::impl::BucketOf(shad::hash<uint64_t>{}(x), kNumBuckets) == bid)
+        keys.push_back(x);
+    }
+    return keys;
+  }
   static const uint64_t kElementsPerEntry = 3;
   static const uint64_t kMagicValue = 9999;
 
@@ -149,6 +159,22 @@ TEST_F(LocalSetTest, InsertReturnTest) {
   }
 }
 
+TEST_F(LocalSetTest, InsertElements) {
+  shad::LocalSet<Entry> set(kNumBuckets);
+  // Every element is inserted twice.
+  std::vector<Entry> elements(2 * kToInsert);
+  for (uint64_t i = 1; i <= kToInsert; i++) {
+    FillEntry(&elements[i - 1], i);
+    FillEntry(&elements[kToInsert + i - 1], i);
+  }
+  set.InsertElements(elements.data(), elements.size());
+  size_t toinsert = kToInsert;
+  ASSERT_EQ(set.Size(), toinsert);
+  for (uint64_t i = 1; i <= kToInsert; i++) {
+    ASSERT_TRUE(DoFind(&set, i));
+  }
+}
+
 TEST_F(LocalSetTest, AsyncInsertFindTest) {
   shad::LocalSet<Entry> set(kNumBuckets);
   uint64_t i;
@@ -356,8 +382,7 @@ TEST_F(LocalSetTest, LocalIteratorPartitions) {
   for (uint64_t bid = 0; bid < kNumBuckets; bid += kNumBuckets / 8) {
     set.Reset(kToInsert);
     exp_checksum = 0;
-    for (auto i = kToInsert; i > 0; --i) {
-      auto x = i * kNumBuckets + bid;
+    for (auto x : KeysInBucket(bid, kToInsert)) {
       set.Insert(x);
       exp_checksum += x;
     }
@@ -375,12 +400,11 @@ TEST_F(LocalSetTest, LocalIteratorPartitions) {
   // some empty buckets
   set.Reset(kToInsert);
   exp_checksum = 0;
-  uint64_t bid = 0;
-  for (auto i = kToInsert; i > 0; --i) {
-    auto x = i * kNumBuckets + bid;
-    set.Insert(x);
-    exp_checksum += x;
-    bid = (bid + (kNumBuckets / 8)) % kNumBuckets;
+  for (uint64_t bid = 0; bid < kNumBuckets; bid += kNumBuckets / 8) {
+    for (auto x : KeysInBucket(bid, kToInsert / 8)) {
+      set.Insert(x);
+      exp_checksum += x;
+    }
   }
   for (uint64_t n_parts = 1; n_parts <= 2 * kNumBuckets; ++n_parts) {
     obs_checksum = 0;
@@ -0,0 +1,151 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "shad/data_structures/hashmap.h"
+#include "shad/data_structures/partitioners.h"
+#include "shad/data_structures/set.h"
+#include "shad/runtime/runtime.h"
+
+namespace {
+
+constexpr uint64_t kNumKeys = 4096;
+
+uint32_t HighBitsOwner(const uint64_t &key, uint32_t numLocalities) {
+  return (key >> 8) % numLocalities;
+}
+
+template <typename PartitionerT>
+void CheckHashmap(const PartitionerT &partitioner) {
+  using MapT = shad::Hashmap<uint64_t, uint64_t, shad::MemCmp<uint64_t>,
+                             shad::Overwriter<uint64_t>, shad::LocalHashmap,
+                             PartitionerT>;
+  auto mapPtr = MapT::Create(kNumKeys, partitioner);
+  std::vector<uint64_t> keys(2 * kNumKeys), values(kNumKeys);
+  for (uint64_t i = 0; i < 2 * kNumKeys; ++i) keys[i] = i * 3;
+  for (uint64_t i = 0; i < kNumKeys; ++i) values[i] = i + 11;
+  mapPtr->InsertBatch(keys.data(), values.data(), kNumKeys / 2);
+  for (uint64_t i = kNumKeys / 2; i < kNumKeys; ++i)
+    mapPtr->Insert(keys[i], values[i]);
+  ASSERT_EQ(mapPtr->Size(), kNumKeys);
+
+  std::vector<typename MapT::LookupResult> results(2 * kNumKeys);
+  mapPtr->LookupBatch(keys.data(), 2 * kNumKeys, results.data());
+  uint64_t value;
+  for (uint64_t i = 0; i < 2 * kNumKeys; ++i) {
+    ASSERT_EQ(results[i].found, i < kNumKeys);
+    ASSERT_EQ(mapPtr->Lookup(keys[i], &value), i < kNumKeys);
+    if (i < kNumKeys) {
+      ASSERT_EQ(value, i + 11);
+    }
+    uint32_t owner = partitioner(keys[i], shad::rt::numLocalities());
+    ASSERT_EQ(mapPtr->GetOwner(keys[i]), shad::rt::Locality(owner));
+  }
+  MapT::Destroy(mapPtr->GetGlobalID());
+}
+
+template <typename PartitionerT>
+void CheckSet(const PartitionerT &partitioner) {
+  using SetT = shad::Set<uint64_t, shad::MemCmp<uint64_t>, PartitionerT>;
+  auto setPtr = SetT::Create(kNumKeys, partitioner);
+  std::vector<uint64_t> elements(2 * kNumKeys);
+  for (uint64_t i = 0; i < 2 * kNumKeys; ++i) elements[i] = i * 3;
+  setPtr->InsertBatch(elements.data(), kNumKeys / 2);
+  for (uint64_t i = kNumKeys / 2; i < kNumKeys; ++i)
+    setPtr->Insert(elements[i]);
+  ASSERT_EQ(setPtr->Size(), kNumKeys);
+
+  std::unique_ptr<bool[]> found(new bool[2 * kNumKeys]);
+  setPtr->FindBatch(elements.data(), 2 * kNumKeys, found.get());
+  for (uint64_t i = 0; i < 2 * kNumKeys; ++i) {
+    ASSERT_EQ(found[i], i < kNumKeys);
+    ASSERT_EQ(setPtr->Find(elements[i]), i < kNumKeys);
+  }
+  SetT::Destroy(setPtr->GetGlobalID());
+}
+
+}  // namespace
+
+TEST(PartitionersTest, JumpConsistentMovesKeysOnlyToNewLocality) {
+  shad::JumpConsistentPartitioner<uint64_t> partitioner;
+  for (uint32_t n = 1; n < 16; ++n) {
+    std::vector<size_t> load(n + 1, 0);
+    for (uint64_t key = 0; key < kNumKeys; ++key) {
+      uint32_t before = partitioner(key, n);
+      uint32_t after = partitioner(key, n + 1);
+      ASSERT_LT(before, n);
+      ASSERT_TRUE(after == before || after == n);
+      ++load[after];
+    }
+    for (auto l : load) ASSERT_GT(l, kNumKeys / (n + 1) / 2);
+  }
+}
+
+TEST(PartitionersTest, RangeFromSample) {
+  std::vector<uint64_t> sample;
+  for (uint64_t i = 0; i < 1000; ++i) sample.push_back((i * 7919) % 1000);
+  auto partitioner = shad::RangePartitioner<uint64_t>::FromSample(
+      sample.data(), sample.size(), 4);
+  std::vector<size_t> load(4, 0);
+  uint32_t previous = 0;
+  for (uint64_t key = 0; key < 1000; ++key) {
+    uint32_t owner = partitioner(key, 4);
+    ASSERT_GE(owner, previous);
+    previous = owner;
+    ++load[owner];
+  }
+  for (auto l : load) ASSERT_EQ(l, 250);
+  ASSERT_EQ(partitioner(1000000, 4), 3);
+  ASSERT_EQ(shad::RangePartitioner<uint64_t>()(42, 4), 0);
+  ASSERT_THROW((shad::RangePartitioner<uint64_t, std::less<uint64_t>, 2>(
+                   sample.data(), 3)),
+               std::invalid_argument);
+}
+
+TEST(PartitionersTest, Hashmap) {
+  CheckHashmap(shad::ModuloPartitioner<uint64_t>());
+  CheckHashmap(shad::JumpConsistentPartitioner<uint64_t>());
+  CheckHashmap(shad::FunctionPartitioner<uint64_t>{HighBitsOwner});
+  std::vector<uint64_t> sample;
+  for (uint64_t i = 0; i < kNumKeys; i += 5) sample.push_back(i * 3);
+  CheckHashmap(shad::RangePartitioner<uint64_t>::FromSample(sample.data(),
+                                                            sample.size()));
+}
+
+TEST(PartitionersTest, Set) {
+  CheckSet(shad::ModuloPartitioner<uint64_t>());
+  CheckSet(shad::JumpConsistentPartitioner<uint64_t>());
+  CheckSet(shad::FunctionPartitioner<uint64_t>{HighBitsOwner});
+  std::vector<uint64_t> sample;
+  for (uint64_t i = 0; i < kNumKeys; i += 5) sample.push_back(i * 3);
+  CheckSet(shad::RangePartitioner<uint64_t>::FromSample(sample.data(),
+                                                        sample.size()));
+}
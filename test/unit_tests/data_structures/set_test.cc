@@ -22,6 +22,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <memory>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -128,6 +129,24 @@ TEST_F(SetTest, InsertFindTest) {
   shad::Set<Entry>::Destroy(oid);
 }
 
+TEST_F(SetTest, InsertFindBatchTest) {
+  auto setPtr = shad::Set<Entry>::Create(kToInsert);
+  auto oid = setPtr->GetGlobalID();
+  std::vector<Entry> entries(2 * kToInsert);
+  for (uint64_t i = 0; i < 2 * kToInsert; i++) {
+    FillEntry(&entries[i], i + 1);
+  }
+  setPtr->InsertBatch(entries.data(), kToInsert);
+  size_t toinsert = kToInsert;
+  ASSERT_EQ(setPtr->Size(), toinsert);
+  std::unique_ptr<bool[]> found(new bool[2 * kToInsert]);
+  setPtr->FindBatch(entries.data(), 2 * kToInsert, found.get());
+  for (uint64_t i = 0; i < 2 * kToInsert; i++) {
+    ASSERT_EQ(found[i], i < kToInsert);
+  }
+  shad::Set<Entry>::Destroy(oid);
+}
+
 TEST_F(SetTest, AsyncInsertFindTest) {
   auto setPtr = shad::Set<Entry>::Create(kToInsert);
   auto oid = setPtr->GetGlobalID();
@@ -294,6 +313,29 @@ TEST_F(SetTest, ForEachElement) {
   shad::Set<Entry>::Destroy(oid);
 }
 
+TEST_F(SetTest, Iterator) {
+  auto setPtr = shad::Set<Entry>::Create(kToInsert);
+  auto oid = setPtr->GetGlobalID();
+  auto args = std::make_tuple(oid, 0lu);
+  shad::rt::Handle handle;
+  shad::rt::asyncForEachAt(handle, shad::rt::thisLocality(),
+                           InsertTestParallelFunc, args, kToInsert);
+  shad::rt::waitForCompletion(handle);
+  std::vector<bool> visited(kToInsert, false);
+  size_t numVisited = 0;
+  for (auto it = setPtr->begin(); it != setPtr->end(); ++it) {
+    Entry entry = *it;
+    uint64_t seed = GetSeed(&entry);
+    ASSERT_TRUE(seed < kToInsert);
+    ASSERT_FALSE(visited[seed]);
+    CheckElement(&entry, seed);
+    visited[seed] = true;
+    ++numVisited;
+  }
+  ASSERT_TRUE(numVisited == kToInsert);
+  shad::Set<Entry>::Destroy(oid);
+}
+
 TEST_F(SetTest, AsyncForEachElement) {
   auto setPtr = shad::Set<Entry>::Create(kToInsert);
   auto oid = setPtr->GetGlobalID();
@@ -430,3 +430,77 @@ TEST_F(VectorTest, AsyncInsertAsyncForEachInRangeAndAsyncGet) {
     ASSERT_EQ(values[i], i + 1 + (3 * kNumElements));
   }
 }
+
+TEST_F(VectorTest, PushBackRange) {
+  auto edsPtr = shad::Vector<size_t>::Create(3);
+  std::vector<size_t> values(kNumElements * 4);
+  std::generate(std::begin(values), std::end(values),
+                GenerateSequence<size_t>(3));
+
+  ASSERT_EQ(edsPtr->PushBackRange(values.begin(), values.begin() + 5), 3);
+  ASSERT_EQ(edsPtr->PushBackRange(values.begin() + 5, values.end()), 8);
+  ASSERT_EQ(edsPtr->Size(), values.size() + 3);
+  ASSERT_GE(edsPtr->Capacity(), values.size() + 3);
+  for (size_t i = 0; i < values.size(); i++) {
+    ASSERT_EQ(edsPtr->At(i + 3), i + 3);
+  }
+
+  shad::rt::Handle handle;
+  auto first = edsPtr->AsyncPushBackRange(handle, values.begin(),
+                                          values.begin() + 10);
+  shad::rt::waitForCompletion(handle);
+  ASSERT_EQ(first, values.size() + 3);
+  ASSERT_EQ(edsPtr->Back(), 12);
+  shad::Vector<size_t>::Destroy(edsPtr->GetGlobalID());
+}
+
+TEST_F(VectorTest, ConcurrentPushBackRange) {
+  static const size_t kNumProducers = 16;
+  static const size_t kChunk = 1000;
+  auto edsPtr = shad::Vector<size_t>::Create(0);
+  auto firstPtr = shad::Vector<size_t>::Create(kNumProducers);
+
+  using ObjectID = shad::Vector<size_t>::ObjectID;
+  shad::rt::forEachAt(
+      shad::rt::thisLocality(),
+      [](const std::pair<ObjectID, ObjectID> &oids, size_t producer) {
+        std::vector<size_t> values(kChunk);
+        std::generate(std::begin(values), std::end(values),
+                      GenerateSequence<size_t>(producer * kChunk));
+        auto first = shad::Vector<size_t>::GetPtr(oids.first)
+                         ->PushBackRange(values.begin(), values.end());
+        shad::Vector<size_t>::GetPtr(oids.second)->InsertAt(producer, first);
+      },
+      std::make_pair(edsPtr->GetGlobalID(), firstPtr->GetGlobalID()),
+      kNumProducers);
+
+  ASSERT_EQ(edsPtr->Size(), kNumProducers * kChunk);
+  for (size_t producer = 0; producer < kNumProducers; producer++) {
+    size_t first = firstPtr->At(producer);
+    for (size_t i = 0; i < kChunk; i++) {
+      ASSERT_EQ(edsPtr->At(first + i), producer * kChunk + i);
+    }
+  }
+  shad::Vector<size_t>::Destroy(edsPtr->GetGlobalID());
+  shad::Vector<size_t>::Destroy(firstPtr->GetGlobalID());
+}
+
+TEST_F(VectorTest, BufferedPushBack) {
+  auto edsPtr = shad::Vector<size_t>::Create(0);
+  const size_t kNumValues = kNumElements * 3;
+  for (size_t i = 0; i < kNumValues; i++) {
+    edsPtr->BufferedPushBack(i);
+  }
+  edsPtr->WaitForBufferedInsert();
+
+  ASSERT_EQ(edsPtr->Size(), kNumValues);
+  std::vector<size_t> values(kNumValues);
+  for (size_t i = 0; i < kNumValues; i++) {
+    values[i] = edsPtr->At(i);
+  }
+  std::sort(std::begin(values), std::end(values));
+  for (size_t i = 0; i < kNumValues; i++) {
+    ASSERT_EQ(values[i], i);
+  }
+  shad::Vector<size_t>::Destroy(edsPtr->GetGlobalID());
+}
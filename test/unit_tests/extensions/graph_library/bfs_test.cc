@@ -0,0 +1,120 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <queue>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "shad/extensions/graph_library/algorithms/bfs.h"
+#include "shad/extensions/graph_library/algorithms/sssp.h"
+#include "shad/extensions/graph_library/edge_index.h"
+#include "shad/runtime/runtime.h"
+
+using EIType = shad::EdgeIndex<uint64_t, uint64_t>;
+
+static const size_t kNumVertices = 5000;
+// Vertices in [kNumConnected, kNumVertices) have no edges.
+static const size_t kNumConnected = 4900;
+
+class BFSTest : public ::testing::Test {
+ public:
+  BFSTest() {}
+  void SetUp() {
+    adjacency_.assign(kNumVertices, {});
+    auto addEdge = [&](uint64_t u, uint64_t v) {
+      adjacency_[u].push_back(v);
+      adjacency_[v].push_back(u);
+    };
+    for (uint64_t v = 0; v + 1 < kNumConnected; ++v) {
+      if (v % 100 != 99) addEdge(v, v + 1);
+      addEdge(v, (v * 7 + 3) % kNumConnected);
+    }
+
+    eiPtr_ = EIType::Create(kNumVertices);
+    for (uint64_t u = 0; u < kNumVertices; ++u)
+      for (auto v : adjacency_[u]) eiPtr_->BufferedInsert(u, v);
+    eiPtr_->WaitForBufferedInsert();
+  }
+  void TearDown() { EIType::Destroy(eiPtr_->GetGlobalID()); }
+
+  std::vector<size_t> ReferenceBFS(uint64_t src) {
+    std::vector<size_t> levels(kNumVertices,
+                               std::numeric_limits<size_t>::max());
+    std::queue<uint64_t> queue;
+    levels[src] = 0;
+    queue.push(src);
+    while (!queue.empty()) {
+      uint64_t u = queue.front();
+      queue.pop();
+      for (auto v : adjacency_[u]) {
+        if (levels[v] != std::numeric_limits<size_t>::max()) continue;
+        levels[v] = levels[u] + 1;
+        queue.push(v);
+      }
+    }
+    return levels;
+  }
+
+  void CheckBFS(uint64_t src, bool symmetric) {
+    auto result = shad::BFS<EIType>(eiPtr_->GetGlobalID(), src, kNumVertices,
+                                    symmetric);
+    auto expected = ReferenceBFS(src);
+    for (uint64_t v = 0; v < kNumVertices; ++v) {
+      ASSERT_EQ(result.distances->At(v), expected[v]);
+      uint64_t parent = result.parents->At(v);
+      if (expected[v] == std::numeric_limits<size_t>::max()) {
+        ASSERT_EQ(parent, std::numeric_limits<uint64_t>::max());
+      } else if (v == src) {
+        ASSERT_EQ(parent, src);
+      } else {
+        ASSERT_EQ(expected[parent] + 1, expected[v]);
+        auto &neighbors = adjacency_[parent];
+        ASSERT_NE(std::find(neighbors.begin(), neighbors.end(), v),
+                  neighbors.end());
+      }
+    }
+    shad::Array<size_t>::Destroy(result.distances->GetGlobalID());
+    shad::Array<uint64_t>::Destroy(result.parents->GetGlobalID());
+  }
+
+  std::vector<std::vector<uint64_t>> adjacency_;
+  EIType::EdgeListPtr eiPtr_;
+};
+
+TEST_F(BFSTest, TopDownTest) { CheckBFS(42, false); }
+
+TEST_F(BFSTest, DirectionOptimizingTest) {
+  CheckBFS(42, true);
+  CheckBFS(kNumConnected + 1, true);
+}
+
+TEST_F(BFSTest, PathLengthTest) {
+  auto expected = ReferenceBFS(7);
+  for (uint64_t v : {uint64_t(7), uint64_t(8), uint64_t(1234),
+                     uint64_t(kNumConnected - 1), uint64_t(kNumConnected)})
+    ASSERT_EQ((sssp_length<EIType, uint64_t>(eiPtr_->GetGlobalID(), 7, v)),
+              expected[v]);
+}
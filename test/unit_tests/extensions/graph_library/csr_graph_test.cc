@@ -0,0 +1,142 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "shad/extensions/graph_library/csr_graph.h"
+#include "shad/extensions/graph_library/edge_index.h"
+#include "shad/runtime/runtime.h"
+
+#include "visit_counters.h"
+
+using EIType = shad::EdgeIndex<uint64_t, uint64_t>;
+using CSRType = shad::CSRGraph<uint64_t, uint64_t>;
+
+static const size_t kToInsert = 4096;
+static const size_t kMaxNLSize = 64;
+
+using shad_test::counters;
+using shad_test::ResetCounters;
+using shad_test::TotalCount;
+
+enum Counter { kEdges, kVertices, kNeighbors };
+
+class CSRGraphTest : public ::testing::Test {
+ public:
+  CSRGraphTest() {}
+  void SetUp() {
+    expectedNumEdges_ = 0;
+    for (size_t i = 0; i < kToInsert; i++)
+      expectedNumEdges_ += std::max<size_t>(i % kMaxNLSize, 1);
+  }
+  void TearDown() {}
+
+  static void CheckGraph(CSRType *graph, size_t expectedNumEdges) {
+    ASSERT_EQ(graph->Size(), kToInsert);
+    ASSERT_EQ(graph->NumEdges(), expectedNumEdges);
+    for (size_t i = 0; i < kToInsert; i += 17) {
+      size_t nsize = std::max<size_t>(i % kMaxNLSize, 1);
+      ASSERT_EQ(graph->GetDegree(i), nsize);
+
+      ResetCounters();
+      graph->ForEachNeighbor(
+          i, [](const uint64_t &src, const uint64_t &dest) {
+            // Neighbors are visited in order on the locality owning src.
+            ASSERT_EQ(dest, src + counters[kNeighbors]++);
+          });
+      ASSERT_EQ(TotalCount(kNeighbors), nsize);
+    }
+    ASSERT_EQ(graph->GetDegree(kToInsert), 0);
+  }
+
+  size_t expectedNumEdges_;
+};
+
+TEST_F(CSRGraphTest, FreezeTest) {
+  auto eidxPtr = EIType::Create(kToInsert);
+  shad::rt::forEachOnAll(
+      [](const EIType::ObjectID &oid, size_t i) {
+        auto eiptr = EIType::GetPtr(oid);
+        size_t nsize = std::max<size_t>(i % kMaxNLSize, 1);
+        // Insert in reverse order to exercise the sorting.
+        for (size_t j = nsize; j > 0; j--) eiptr->Insert(i, i + j - 1);
+      },
+      eidxPtr->GetGlobalID(), kToInsert);
+
+  auto csrPtr = CSRType::Freeze(eidxPtr);
+  CheckGraph(csrPtr.get(), expectedNumEdges_);
+  ASSERT_EQ(eidxPtr->NumEdges(), expectedNumEdges_);
+
+  ResetCounters();
+  auto edgeLambda = [](const uint64_t &src, const uint64_t &dest) {
+    ASSERT_GE(dest, src);
+    counters[kEdges]++;
+  };
+  auto vertexLambda = [](const uint64_t &src) { counters[kVertices]++; };
+  csrPtr->ForEachEdge(edgeLambda);
+  csrPtr->ForEachVertex(vertexLambda);
+  ASSERT_EQ(TotalCount(kEdges), expectedNumEdges_);
+  ASSERT_EQ(TotalCount(kVertices), kToInsert);
+
+  ResetCounters();
+  shad::rt::Handle handle;
+  csrPtr->AsyncForEachEdge(
+      handle, [](shad::rt::Handle &, const uint64_t &src,
+                 const uint64_t &dest) { counters[kEdges]++; });
+  csrPtr->AsyncForEachVertex(
+      handle,
+      [](shad::rt::Handle &, const uint64_t &src) { counters[kVertices]++; });
+  shad::rt::waitForCompletion(handle);
+  ASSERT_EQ(TotalCount(kEdges), expectedNumEdges_);
+  ASSERT_EQ(TotalCount(kVertices), kToInsert);
+
+  CSRType::Destroy(csrPtr->GetGlobalID());
+  EIType::Destroy(eidxPtr->GetGlobalID());
+}
+
+TEST_F(CSRGraphTest, InsertEdgesTest) {
+  std::vector<uint64_t> srcs;
+  std::vector<uint64_t> dests;
+  for (size_t i = 0; i < kToInsert; i++) {
+    size_t nsize = std::max<size_t>(i % kMaxNLSize, 1);
+    for (size_t j = 0; j < nsize; j++) {
+      srcs.push_back(i);
+      dests.push_back(i + j);
+    }
+  }
+
+  auto csrPtr = CSRType::Create();
+  // Stream the edges in two batches, finalizing in between.
+  size_t half = srcs.size() / 2;
+  csrPtr->InsertEdges(srcs.data(), dests.data(), half);
+  csrPtr->Finalize();
+  ASSERT_EQ(csrPtr->NumEdges(), half);
+  csrPtr->InsertEdges(srcs.data() + half, dests.data() + half,
+                      srcs.size() - half);
+  csrPtr->Finalize();
+  CheckGraph(csrPtr.get(), expectedNumEdges_);
+  CSRType::Destroy(csrPtr->GetGlobalID());
+}
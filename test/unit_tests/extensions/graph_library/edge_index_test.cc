@@ -22,6 +22,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <stdexcept>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -29,6 +30,8 @@
 #include "shad/extensions/graph_library/edge_index.h"
 #include "shad/runtime/runtime.h"
 
+#include "visit_counters.h"
+
 using EIType = shad::EdgeIndex<uint64_t, int>;
 
 static const size_t kToInsert = 4096;
@@ -424,3 +427,142 @@ TEST_F(EdgeIndexTest, AsyncInsertAsyncForeachEdgeTest) {
   shad::rt::waitForCompletion(handle);
   EIType::Destroy(oid);
 }
+
+static const size_t kHubDegree = 2048;
+static const size_t kSplitThreshold = kMaxNLSize;
+
+TEST_F(EdgeIndexTest, SplitHighDegreeVerticesTest) {
+  auto eidxPtr = EIType::Create(kToInsert);
+  auto oid = eidxPtr->GetGlobalID();
+  shad::rt::forEachOnAll(
+      [](const EIType::ObjectID &oid, size_t i) {
+        auto eiptr = EIType::GetPtr(oid);
+        size_t nsize =
+            i == 0 ? kHubDegree : std::max<size_t>(i % kMaxNLSize, 1);
+        for (size_t j = 0; j < nsize; j++) {
+          eiptr->Insert(i, i + j);
+        }
+      },
+      oid, kToInsert);
+  size_t expectedNumEdges = expectedNumEdges_ - 1 + kHubDegree;
+  ASSERT_EQ(eidxPtr->SplitHighDegreeVertices(kSplitThreshold), 1);
+  ASSERT_TRUE(eidxPtr->IsSplitVertex(0));
+  ASSERT_FALSE(eidxPtr->IsSplitVertex(1));
+  ASSERT_EQ(eidxPtr->SplitHighDegreeVertices(kSplitThreshold), 0);
+  ASSERT_EQ(eidxPtr->Size(), kToInsert);
+  ASSERT_EQ(eidxPtr->NumEdges(), expectedNumEdges);
+  ASSERT_EQ(eidxPtr->GetDegree(0), kHubDegree);
+
+  auto countLambda = [](const uint64_t &src, const int &dest) {
+    ASSERT_TRUE(dest >= src && dest < (src + kHubDegree));
+    shad_test::counters[0].fetch_add(1);
+  };
+  shad_test::ResetCounters();
+  eidxPtr->ForEachNeighbor(0, countLambda);
+  ASSERT_EQ(shad_test::TotalCount(0), kHubDegree);
+
+  auto edgeLambda = [](const uint64_t &src, const int &dest) {
+    shad_test::counters[0].fetch_add(1);
+  };
+  shad_test::ResetCounters();
+  eidxPtr->ForEachEdge(edgeLambda);
+  ASSERT_EQ(shad_test::TotalCount(0), expectedNumEdges);
+
+  shad::rt::Handle handle;
+  for (size_t j = 0; j < kHubDegree; j++) {
+    eidxPtr->AsyncInsert(handle, 0, kHubDegree + j);
+  }
+  shad::rt::waitForCompletion(handle);
+  ASSERT_EQ(eidxPtr->GetDegree(0), 2 * kHubDegree);
+  for (size_t j = 0; j < kHubDegree; j++) {
+    eidxPtr->Erase(0, kHubDegree + j);
+  }
+  ASSERT_EQ(eidxPtr->GetDegree(0), kHubDegree);
+
+  auto asyncCountLambda = [](shad::rt::Handle &, const uint64_t &src,
+                             const int &dest) {
+    shad_test::counters[0].fetch_add(1);
+  };
+  shad_test::ResetCounters();
+  eidxPtr->AsyncForEachNeighbor(handle, 0, asyncCountLambda);
+  shad::rt::waitForCompletion(handle);
+  ASSERT_EQ(shad_test::TotalCount(0), kHubDegree);
+
+  std::vector<int> list(kSplitThreshold / 2);
+  for (size_t j = 0; j < list.size(); j++) {
+    list[j] = j;
+  }
+  eidxPtr->InsertEdgeList(0, list.data(), list.size());
+  ASSERT_TRUE(eidxPtr->IsSplitVertex(0));
+  ASSERT_EQ(eidxPtr->GetDegree(0), list.size());
+  ASSERT_EQ(eidxPtr->Size(), kToInsert);
+
+  for (size_t j = 0; j < list.size(); j++) {
+    list[j] = kHubDegree + j;
+  }
+  eidxPtr->AsyncInsertEdgeList(handle, 0, list.data(), list.size(), false);
+  shad::rt::waitForCompletion(handle);
+  ASSERT_EQ(eidxPtr->GetDegree(0), 2 * list.size());
+  eidxPtr->AsyncInsertEdgeList(handle, 0, list.data(), list.size());
+  shad::rt::waitForCompletion(handle);
+  ASSERT_EQ(eidxPtr->GetDegree(0), list.size());
+  ASSERT_TRUE(eidxPtr->HasSplitVertices());
+  ASSERT_THROW(eidxPtr->GetLocalIndexPtr(), std::invalid_argument);
+  EIType::Destroy(oid);
+}
+
+TEST_F(EdgeIndexTest, DeltaLogTest) {
+  auto eidxPtr = EIType::Create(kToInsert);
+  auto oid = eidxPtr->GetGlobalID();
+  eidxPtr->EnableDeltaLog(kToInsert);
+  shad::rt::Handle handle;
+  shad::rt::asyncForEachOnAll(
+      handle,
+      [](shad::rt::Handle &handle, const EIType::ObjectID &oid, size_t i) {
+        auto eiptr = EIType::GetPtr(oid);
+        size_t nsize = std::max<size_t>(i % kMaxNLSize, 1);
+        for (size_t j = 0; j < nsize; j++) {
+          if ((i % 2) != 0u)
+            eiptr->BufferedAsyncInsert(handle, i, i + j);
+          else
+            eiptr->AsyncInsert(handle, i, i + j);
+        }
+      },
+      oid, kToInsert);
+  shad::rt::waitForCompletion(handle);
+  eidxPtr->WaitForBufferedInsert();
+  ASSERT_EQ(eidxPtr->Size(), kToInsert);
+  ASSERT_EQ(eidxPtr->NumEdges(), expectedNumEdges_);
+
+  shad::rt::forEachOnAll(
+      [](const EIType::ObjectID &oid, size_t i) {
+        auto eiptr = EIType::GetPtr(oid);
+        size_t nsize = std::max<size_t>(i % kMaxNLSize, 1);
+        for (size_t j = 0; j < nsize; j++) {
+          eiptr->Insert(i, i + j);
+          if ((j % 2) != 0u) {
+            eiptr->Erase(i, i + j);
+          }
+        }
+      },
+      oid, kToInsert);
+  eidxPtr->Compact();
+  ASSERT_EQ(eidxPtr->NumEdges(), expectedNumEdgesAfterErase_);
+
+  auto countLambda = [](const uint64_t &src, const int &dest) {
+    ASSERT_EQ((dest - src) % 2, 0);
+    shad_test::counters[0].fetch_add(1);
+  };
+  shad_test::ResetCounters();
+  eidxPtr->Insert(kMaxNLSize - 1, 3 * kMaxNLSize - 1);
+  eidxPtr->ForEachNeighbor(kMaxNLSize - 1, countLambda);
+  ASSERT_EQ(shad_test::TotalCount(0), kMaxNLSize / 2 + 1);
+  ASSERT_EQ(eidxPtr->GetDegree(kMaxNLSize - 1), kMaxNLSize / 2 + 1);
+
+  eidxPtr->Erase(kMaxNLSize - 1, 3 * kMaxNLSize - 1);
+  eidxPtr->DisableDeltaLog();
+  ASSERT_EQ(eidxPtr->NumEdges(), expectedNumEdgesAfterErase_);
+  eidxPtr->Insert(kMaxNLSize - 1, 3 * kMaxNLSize - 1);
+  ASSERT_EQ(eidxPtr->GetDegree(kMaxNLSize - 1), kMaxNLSize / 2 + 1);
+  EIType::Destroy(oid);
+}
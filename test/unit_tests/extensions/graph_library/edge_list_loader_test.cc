@@ -0,0 +1,117 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "shad/extensions/graph_library/edge_index.h"
+#include "shad/extensions/graph_library/edge_list_loader.h"
+#include "shad/runtime/runtime.h"
+
+using EIType = shad::EdgeIndex<uint64_t, uint64_t>;
+
+static const size_t kNumVertices = 20000;
+static const size_t kMaxNLSize = 16;
+
+class EdgeListLoaderTest : public ::testing::Test {
+ public:
+  EdgeListLoaderTest() {}
+  void SetUp() {
+    path_ = ::testing::TempDir() + "shad_edge_list_loader_test";
+    expectedNumEdges_ = 0;
+    for (size_t i = 0; i < kNumVertices; i++)
+      expectedNumEdges_ += i % kMaxNLSize;
+  }
+  void TearDown() { std::remove(path_.c_str()); }
+
+  static void CheckIndex(EIType *eiPtr, size_t expectedNumEdges) {
+    ASSERT_EQ(eiPtr->NumEdges(), expectedNumEdges);
+    for (size_t i = 0; i < kNumVertices; i += 7)
+      ASSERT_EQ(eiPtr->GetDegree(i), i % kMaxNLSize);
+    uint64_t src = 1234;
+    eiPtr->ForEachNeighbor(src, [](const uint64_t &src, const uint64_t &dest) {
+      ASSERT_GT(dest, src);
+      ASSERT_LE(dest, src + kMaxNLSize);
+    });
+  }
+
+  std::string path_;
+  size_t expectedNumEdges_;
+};
+
+TEST_F(EdgeListLoaderTest, METISTest) {
+  {
+    std::ofstream out(path_);
+    out << "% a comment\n" << kNumVertices << " " << expectedNumEdges_ << "\n";
+    for (size_t i = 0; i < kNumVertices; i++) {
+      if (i % 1000 == 0) out << "% another comment\n";
+      for (size_t j = 1; j <= i % kMaxNLSize; j++)
+        out << (j > 1 ? " " : "") << i + j + 1;
+      out << "\n";
+    }
+  }
+  auto eiPtr = shad::LoadEdgeIndex<EIType>(path_, shad::EdgeListFormat::kMETIS);
+  CheckIndex(eiPtr.get(), expectedNumEdges_);
+  EIType::Destroy(eiPtr->GetGlobalID());
+}
+
+TEST_F(EdgeListLoaderTest, EdgeListAndBinaryTest) {
+  {
+    std::ofstream out(path_);
+    out << "# src dest\n";
+    for (size_t i = 0; i < kNumVertices; i++)
+      for (size_t j = 1; j <= i % kMaxNLSize; j++)
+        out << i << "\t" << i + j << "\r\n";
+  }
+  auto eiPtr = shad::LoadEdgeIndex<EIType>(
+      path_, shad::EdgeListFormat::kEdgeList, kNumVertices);
+  CheckIndex(eiPtr.get(), expectedNumEdges_);
+
+  shad::WriteBinaryEdgeList(path_, eiPtr);
+  auto binaryPtr = shad::LoadEdgeIndex<EIType>(
+      path_, shad::EdgeListFormat::kBinary, kNumVertices);
+  CheckIndex(binaryPtr.get(), expectedNumEdges_);
+
+  EIType::Destroy(eiPtr->GetGlobalID());
+  EIType::Destroy(binaryPtr->GetGlobalID());
+}
+
+TEST_F(EdgeListLoaderTest, ErrorsTest) {
+  ASSERT_THROW(shad::LoadEdgeIndex<EIType>(path_ + "_missing",
+                                           shad::EdgeListFormat::kMETIS),
+               std::system_error);
+  {
+    std::ofstream out(path_);
+    out << "0 1\n";
+  }
+  ASSERT_THROW(shad::LoadEdgeIndex<EIType>(path_, shad::EdgeListFormat::kBinary,
+                                           kNumVertices),
+               std::invalid_argument);
+  ASSERT_THROW(
+      shad::LoadEdgeIndex<EIType>(path_, shad::EdgeListFormat::kEdgeList),
+      std::invalid_argument);
+}
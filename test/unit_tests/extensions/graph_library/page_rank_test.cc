@@ -0,0 +1,112 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+
+
+#include <cmath>
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "shad/extensions/graph_library/algorithms/page_rank.h"
+#include "shad/extensions/graph_library/edge_index.h"
+#include "shad/runtime/runtime.h"
+
+using EIType = shad::EdgeIndex<uint64_t, uint64_t>;
+
+static const size_t kNumVertices = 3000;
+
+class PageRankTest : public ::testing::Test {
+ public:
+  PageRankTest() {}
+  void SetUp() {
+    adjacency_.assign(kNumVertices, {});
+    // Every tenth vertex is dangling.
+    for (uint64_t u = 0; u < kNumVertices; ++u) {
+      if (u % 10 == 9) continue;
+      adjacency_[u].insert((u * 7 + 3) % kNumVertices);
+      adjacency_[u].insert((u + 1) % kNumVertices);
+      if (u % 3 == 0) adjacency_[u].insert(u / 2);
+    }
+
+    eiPtr_ = EIType::Create(kNumVertices);
+    for (uint64_t u = 0; u < kNumVertices; ++u)
+      for (auto v : adjacency_[u]) eiPtr_->BufferedInsert(u, v);
+    eiPtr_->WaitForBufferedInsert();
+  }
+  void TearDown() { EIType::Destroy(eiPtr_->GetGlobalID()); }
+
+  std::vector<double> ReferencePageRank(double damping, size_t iterations,
+                                        const std::vector<uint64_t> &seeds) {
+    std::vector<double> teleport(kNumVertices,
+                                 seeds.empty() ? 1.0 / kNumVertices : 0);
+    for (auto s : seeds) teleport[s] = 1.0 / seeds.size();
+    std::vector<double> scores(teleport);
+    for (size_t i = 0; i < iterations; ++i) {
+      std::vector<double> sums(kNumVertices, 0);
+      double dangling = 0;
+      for (uint64_t u = 0; u < kNumVertices; ++u) {
+        if (adjacency_[u].empty()) dangling += scores[u];
+        for (auto v : adjacency_[u])
+          sums[v] += scores[u] / adjacency_[u].size();
+      }
+      for (uint64_t v = 0; v < kNumVertices; ++v)
+        scores[v] = (1 - damping) * teleport[v] +
+                    damping * (sums[v] + dangling * teleport[v]);
+    }
+    return scores;
+  }
+
+  void CheckPageRank(const std::vector<uint64_t> &seeds) {
+    const double kDamping = 0.85;
+    const size_t kIterations = 15;
+    auto scores = shad::PageRank<EIType>(eiPtr_->GetGlobalID(), kNumVertices,
+                                         kDamping, kIterations, 0, seeds);
+    auto expected = ReferencePageRank(kDamping, kIterations, seeds);
+    double total = 0;
+    for (uint64_t v = 0; v < kNumVertices; ++v) {
+      ASSERT_NEAR(scores->At(v), expected[v], 1e-12);
+      total += scores->At(v);
+    }
+    ASSERT_NEAR(total, 1.0, 1e-9);
+    shad::Array<double>::Destroy(scores->GetGlobalID());
+  }
+
+  std::vector<std::set<uint64_t>> adjacency_;
+  EIType::EdgeListPtr eiPtr_;
+};
+
+TEST_F(PageRankTest, UniformTest) { CheckPageRank({}); }
+
+TEST_F(PageRankTest, PersonalizedTest) { CheckPageRank({1, 500, 2999}); }
+
+TEST_F(PageRankTest, ConvergenceTest) {
+  auto scores = shad::PageRank<EIType>(eiPtr_->GetGlobalID(), kNumVertices,
+                                       0.85, 1000, 1e-10);
+  auto expected = ReferencePageRank(0.85, 200, {});
+  for (uint64_t v = 0; v < kNumVertices; ++v)
+    ASSERT_NEAR(scores->At(v), expected[v], 1e-9);
+  shad::Array<double>::Destroy(scores->GetGlobalID());
+}
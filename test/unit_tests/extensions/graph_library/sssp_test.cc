@@ -0,0 +1,105 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "shad/extensions/graph_library/algorithms/sssp.h"
+#include "shad/extensions/graph_library/edge_index.h"
+#include "shad/runtime/runtime.h"
+
+using EdgeT = shad::WeightedEdge<uint64_t, uint64_t>;
+using EIType = shad::EdgeIndex<uint64_t, EdgeT>;
+
+static const size_t kNumVertices = 3000;
+
+class DeltaSteppingTest : public ::testing::Test {
+ public:
+  DeltaSteppingTest() {}
+  void SetUp() {
+    adjacency_.assign(kNumVertices, {});
+    eiPtr_ = EIType::Create(kNumVertices);
+    // A directed graph; the last vertex is unreachable.
+    for (uint64_t u = 0; u + 1 < kNumVertices; ++u) {
+      for (uint64_t k = 1; k <= 3; ++k) {
+        uint64_t v = (u * 13 + k * 101) % (kNumVertices - 1);
+        uint64_t w = (u * 31 + k * 17) % 50 + 1;
+        adjacency_[u].emplace_back(v, w);
+        eiPtr_->BufferedInsert(u, EdgeT{v, w});
+      }
+    }
+    eiPtr_->WaitForBufferedInsert();
+  }
+  void TearDown() { EIType::Destroy(eiPtr_->GetGlobalID()); }
+
+  std::vector<uint64_t> Dijkstra(uint64_t src) {
+    std::vector<uint64_t> dist(kNumVertices,
+                               std::numeric_limits<uint64_t>::max());
+    using Item = std::pair<uint64_t, uint64_t>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+    dist[src] = 0;
+    queue.emplace(0, src);
+    while (!queue.empty()) {
+      auto item = queue.top();
+      queue.pop();
+      if (item.first != dist[item.second]) continue;
+      for (auto &edge : adjacency_[item.second]) {
+        uint64_t d = item.first + edge.second;
+        if (d >= dist[edge.first]) continue;
+        dist[edge.first] = d;
+        queue.emplace(d, edge.first);
+      }
+    }
+    return dist;
+  }
+
+  std::vector<std::vector<std::pair<uint64_t, uint64_t>>> adjacency_;
+  EIType::EdgeListPtr eiPtr_;
+};
+
+TEST_F(DeltaSteppingTest, DistancesTest) {
+  auto expected = Dijkstra(5);
+  for (uint64_t delta : {1, 10, 1000}) {
+    auto result = shad::DeltaStepping<EIType>(eiPtr_->GetGlobalID(), 5,
+                                              kNumVertices, delta);
+    for (uint64_t v = 0; v < kNumVertices; ++v) {
+      ASSERT_EQ(result.distances->At(v), expected[v]);
+      if (v == 5 || expected[v] == std::numeric_limits<uint64_t>::max())
+        continue;
+      uint64_t parent = result.parents->At(v);
+      bool found = false;
+      for (auto &edge : adjacency_[parent])
+        found |= edge.first == v && expected[parent] + edge.second ==
+                                        expected[v];
+      ASSERT_TRUE(found);
+    }
+    shad::Array<uint64_t>::Destroy(result.distances->GetGlobalID());
+    shad::Array<uint64_t>::Destroy(result.parents->GetGlobalID());
+  }
+}
@@ -0,0 +1,115 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+
+
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "shad/extensions/graph_library/algorithms/triangle_count.h"
+#include "shad/extensions/graph_library/edge_index.h"
+#include "shad/runtime/runtime.h"
+
+using EIType = shad::EdgeIndex<uint64_t, uint64_t>;
+
+static const size_t kNumVertices = 2000;
+
+class TriangleCountTest : public ::testing::Test {
+ public:
+  TriangleCountTest() {}
+  void SetUp() {
+    adjacency_.assign(kNumVertices, {});
+    auto addEdge = [&](uint64_t u, uint64_t v) {
+      if (u == v) return;
+      adjacency_[u].insert(v);
+      adjacency_[v].insert(u);
+    };
+    for (uint64_t v = 0; v < kNumVertices; ++v) {
+      addEdge(v, (v + 1) % kNumVertices);
+      addEdge(v, (v + 2) % kNumVertices);
+      addEdge(v, (v * 13 + 5) % kNumVertices);
+    }
+    // A hub adjacent to a third of the vertices.
+    for (uint64_t v = 1; v < kNumVertices; v += 3) addEdge(0, v);
+  }
+
+  shad::TriangleStats Reference() {
+    shad::TriangleStats stats{0, 0};
+    for (uint64_t u = 0; u < kNumVertices; ++u) {
+      size_t degree = adjacency_[u].size();
+      stats.wedges += degree * (degree - 1) / 2;
+      for (auto v : adjacency_[u]) {
+        if (v <= u) continue;
+        for (auto w : adjacency_[v])
+          if (w > v && adjacency_[u].count(w)) ++stats.triangles;
+      }
+    }
+    return stats;
+  }
+
+  void Check(bool bothDirections) {
+    auto eiPtr = EIType::Create(kNumVertices);
+    for (uint64_t u = 0; u < kNumVertices; ++u)
+      for (auto v : adjacency_[u])
+        if (bothDirections || v < u) eiPtr->BufferedInsert(u, v);
+    // Self loops and duplicates are ignored.
+    eiPtr->BufferedInsert(7, 7);
+    eiPtr->BufferedInsert(1, 0);
+    eiPtr->WaitForBufferedInsert();
+
+    auto stats = shad::TriangleCount<EIType>(eiPtr->GetGlobalID(),
+                                             kNumVertices);
+    auto expected = Reference();
+    ASSERT_GT(expected.triangles, 0);
+    ASSERT_EQ(stats.triangles, expected.triangles);
+    ASSERT_EQ(stats.wedges, expected.wedges);
+    ASSERT_DOUBLE_EQ(stats.ClusteringCoefficient(),
+                     expected.ClusteringCoefficient());
+    EIType::Destroy(eiPtr->GetGlobalID());
+  }
+
+  std::vector<std::set<uint64_t>> adjacency_;
+};
+
+TEST_F(TriangleCountTest, SymmetricTest) { Check(true); }
+
+TEST_F(TriangleCountTest, LowerTriangularTest) { Check(false); }
+
+TEST(IntersectionSizeTest, MergeAndGalloping) {
+  std::vector<uint64_t> evens, multiples, few = {3, 6, 600, 999, 5000};
+  for (uint64_t i = 0; i < 1000; i += 2) evens.push_back(i);
+  for (uint64_t i = 0; i < 1000; i += 3) multiples.push_back(i);
+  auto intersect = [](const std::vector<uint64_t> &a,
+                      const std::vector<uint64_t> &b) {
+    return shad::impl::IntersectionSize(a.data(), a.data() + a.size(),
+                                        b.data(), b.data() + b.size());
+  };
+  ASSERT_EQ(intersect(evens, multiples), 167);
+  ASSERT_EQ(intersect(multiples, evens), 167);
+  ASSERT_EQ(intersect(few, evens), 2);
+  ASSERT_EQ(intersect(multiples, few), 4);
+  ASSERT_EQ(intersect(few, {}), 0);
+}
@@ -0,0 +1,64 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TEST_UNIT_TESTS_EXTENSIONS_GRAPH_LIBRARY_VISIT_COUNTERS_H_
+#define TEST_UNIT_TESTS_EXTENSIONS_GRAPH_LIBRARY_VISIT_COUNTERS_H_
+
+#include <atomic>
+#include <cstddef>
+
+#include "shad/runtime/runtime.h"
+
+namespace shad_test {
+
+// Counters of the visits performed by the visitors of a test.  A visitor
+// updates the counters of the locality it runs on, which may be any of them:
+// reset and sum the counters of all of the localities.
+constexpr size_t kNumCounters = 4;
+inline std::atomic<size_t> counters[kNumCounters];
+
+inline void ResetCounters() {
+  shad::rt::executeOnAll(
+      [](const bool &) {
+        for (auto &counter : counters) counter = 0;
+      },
+      true);
+}
+
+inline size_t TotalCount(size_t id) {
+  size_t total = 0;
+  for (auto &locality : shad::rt::allLocalities()) {
+    size_t count = 0;
+    shad::rt::executeAtWithRet(
+        locality,
+        [](const size_t &id, size_t *count) { *count = counters[id]; }, id,
+        &count);
+    total += count;
+  }
+  return total;
+}
+
+}  // namespace shad_test
+
+#endif  // TEST_UNIT_TESTS_EXTENSIONS_GRAPH_LIBRARY_VISIT_COUNTERS_H_
@@ -0,0 +1,157 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "gtest/gtest.h"
+
+#include "shad/runtime/collectives.h"
+#include "shad/runtime/runtime.h"
+
+class CollectivesTest : public ::testing::Test {
+ public:
+  static std::atomic<int> Counter;
+  static std::atomic<size_t> Value;
+
+  void SetUp() {
+    for (auto &loc : shad::rt::allLocalities()) {
+      shad::rt::executeAt(loc,
+                          [](const bool &) {
+                            Counter = 0;
+                            Value = 0;
+                          },
+                          false);
+    }
+  }
+
+  void TearDown() {}
+};
+
+std::atomic<int> CollectivesTest::Counter(0);
+std::atomic<size_t> CollectivesTest::Value(0);
+
+// The contiguous range of localities covered by a partial result.
+struct Interval {
+  uint32_t first;
+  uint32_t last;
+  bool ordered;
+};
+
+struct ConcatIntervals {
+  Interval operator()(const Interval &lhs, const Interval &rhs) const {
+    return Interval{lhs.first, rhs.last,
+                    lhs.ordered && rhs.ordered && lhs.last == rhs.first};
+  }
+};
+
+static size_t LocalityValue() {
+  return static_cast<uint32_t>(shad::rt::thisLocality()) + 1;
+}
+
+TEST_F(CollectivesTest, TreeBroadcast) {
+  shad::rt::treeBroadcast(shad::rt::localities_range(),
+                          [](const int &value) { Counter += value; }, 2);
+
+  for (auto &loc : shad::rt::allLocalities()) {
+    shad::rt::executeAt(loc, [](const bool &) { ASSERT_EQ(Counter, 2); },
+                        false);
+  }
+}
+
+TEST_F(CollectivesTest, TreeReduce) {
+  size_t numLocalities = shad::rt::numLocalities();
+  size_t sum = shad::rt::treeReduce(
+      shad::rt::localities_range(),
+      [](const bool &) { return LocalityValue(); }, std::plus<size_t>{},
+      size_t(10), false);
+  ASSERT_EQ(sum, 10 + numLocalities * (numLocalities + 1) / 2);
+
+  Interval interval = shad::rt::treeReduce(
+      shad::rt::localities_range(),
+      [](const bool &) {
+        uint32_t id = static_cast<uint32_t>(shad::rt::thisLocality());
+        return Interval{id, id + 1, true};
+      },
+      ConcatIntervals{}, Interval{0, 0, true}, false);
+  ASSERT_TRUE(interval.ordered);
+  ASSERT_EQ(interval.first, 0);
+  ASSERT_EQ(interval.last, numLocalities);
+}
+
+TEST_F(CollectivesTest, TreeAllReduce) {
+  size_t numLocalities = shad::rt::numLocalities();
+  size_t sum = shad::rt::treeAllReduce(
+      shad::rt::localities_range(),
+      [](const bool &) { return LocalityValue(); }, std::plus<size_t>{},
+      [](const bool &, const size_t &result) { Value = result; }, size_t(0),
+      false);
+  ASSERT_EQ(sum, numLocalities * (numLocalities + 1) / 2);
+
+  for (auto &loc : shad::rt::allLocalities()) {
+    shad::rt::executeAt(loc,
+                        [](const size_t &expected) {
+                          ASSERT_EQ(Value, expected);
+                        },
+                        sum);
+  }
+}
+
+TEST_F(CollectivesTest, TreeExclusiveScan) {
+  size_t numLocalities = shad::rt::numLocalities();
+  size_t total = shad::rt::treeExclusiveScan(
+      shad::rt::localities_range(),
+      [](const bool &) { return LocalityValue(); }, std::plus<size_t>{},
+      [](const bool &, const size_t &prefix) { Value = prefix; }, size_t(7),
+      false);
+  ASSERT_EQ(total, 7 + numLocalities * (numLocalities + 1) / 2);
+
+  for (auto &loc : shad::rt::allLocalities()) {
+    shad::rt::executeAt(loc,
+                        [](const bool &) {
+                          size_t id = LocalityValue() - 1;
+                          ASSERT_EQ(Value, 7 + id * (id + 1) / 2);
+                        },
+                        false);
+  }
+
+  Interval interval = shad::rt::treeExclusiveScan(
+      shad::rt::localities_range(),
+      [](const bool &) {
+        uint32_t id = static_cast<uint32_t>(shad::rt::thisLocality());
+        return Interval{id, id + 1, true};
+      },
+      ConcatIntervals{},
+      [](const bool &, const Interval &prefix) {
+        uint32_t id = static_cast<uint32_t>(shad::rt::thisLocality());
+        ASSERT_TRUE(prefix.ordered);
+        ASSERT_EQ(prefix.last, id);
+      },
+      Interval{0, 0, true}, false);
+  ASSERT_TRUE(interval.ordered);
+  ASSERT_EQ(interval.last, numLocalities);
+}
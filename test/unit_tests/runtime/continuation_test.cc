@@ -0,0 +1,186 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//                                     SHAD
+//
+//      The Scalable High-performance Algorithms and Data Structure Library
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2018 Battelle Memorial Institute
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "shad/runtime/runtime.h"
+
+static std::atomic<size_t> counter;
+static const size_t kNumIters = 100;
+static const size_t kNumChains = 64;
+static const size_t kChainLength = 8;
+
+static void resetCounter(const bool &) { counter = 0; }
+
+static void asyncIncrCounter(shad::rt::Handle &, const size_t &value) {
+  counter += value;
+}
+
+static void readCounter(const bool &, size_t *res) { *res = counter; }
+
+static size_t totalCount() {
+  size_t total = 0;
+  for (auto &loc : shad::rt::allLocalities()) {
+    size_t count;
+    shad::rt::executeAtWithRet(loc, readCounter, true, &count);
+    total += count;
+  }
+  return total;
+}
+
+// Stores in *res the total of the counters when it runs.
+static void storeTotalCount(shad::rt::Handle &, size_t *const &res) {
+  *res = totalCount();
+}
+
+class ContinuationTest : public ::testing::Test {
+ public:
+  void SetUp() { shad::rt::executeOnAll(resetCounter, true); }
+};
+
+TEST_F(ContinuationTest, Then) {
+  shad::rt::Handle handle;
+  for (auto &loc : shad::rt::allLocalities())
+    for (size_t i = 0; i < kNumIters; ++i)
+      shad::rt::asyncExecuteAt(handle, loc, asyncIncrCounter, size_t(1));
+
+  size_t total = 0;
+  shad::rt::Handle next;
+  shad::rt::then(handle, next, storeTotalCount, &total);
+  shad::rt::waitForCompletion(next);
+  ASSERT_EQ(total, kNumIters * shad::rt::numLocalities());
+}
+
+TEST_F(ContinuationTest, ThenEmptyHandle) {
+  shad::rt::Handle handle;
+  size_t total = 1;
+  shad::rt::Handle next;
+  shad::rt::then(handle, next, storeTotalCount, &total);
+  shad::rt::waitForCompletion(next);
+  ASSERT_EQ(total, 0);
+}
+
+static void asyncFail(shad::rt::Handle &, const size_t &) {
+  throw std::runtime_error("failed");
+}
+
+TEST_F(ContinuationTest, ThenFailure) {
+  shad::rt::Handle handle;
+  shad::rt::asyncExecuteAt(handle, shad::rt::thisLocality(), asyncFail,
+                           size_t(0));
+  size_t total = 1;
+  shad::rt::Handle next;
+  shad::rt::then(handle, next, storeTotalCount, &total);
+  // Both the continuation and the failed tasks report the failure.
+  ASSERT_THROW(shad::rt::waitForCompletion(next), std::exception);
+  ASSERT_THROW(shad::rt::waitForCompletion(handle), std::exception);
+  ASSERT_EQ(total, 1);
+}
+
+struct StepArgs {
+  size_t *step;
+  size_t expected;
+};
+
+// Advances the step of a chain, checking that the previous one is done.
+static void chainStep(shad::rt::Handle &handle, const StepArgs &args) {
+  ASSERT_EQ(*args.step, args.expected);
+  shad::rt::asyncExecuteAt(handle, shad::rt::thisLocality(), asyncIncrCounter,
+                           size_t(1));
+  ++*args.step;
+}
+
+TEST_F(ContinuationTest, Chains) {
+  // Continuations waiting for other continuations must not deadlock.
+  std::vector<std::vector<shad::rt::Handle>> handles(
+      kNumChains, std::vector<shad::rt::Handle>(kChainLength + 1));
+  std::vector<size_t> steps(kNumChains, 0);
+  for (size_t c = 0; c < kNumChains; ++c) {
+    shad::rt::asyncExecuteAt(handles[c][0], shad::rt::thisLocality(),
+                             asyncIncrCounter, size_t(1));
+    for (size_t s = 0; s < kChainLength; ++s)
+      shad::rt::then(handles[c][s], handles[c][s + 1], chainStep,
+                     StepArgs{&steps[c], s});
+  }
+  for (size_t c = 0; c < kNumChains; ++c) {
+    shad::rt::waitForCompletion(handles[c][kChainLength]);
+    ASSERT_EQ(steps[c], kChainLength);
+  }
+  ASSERT_EQ(totalCount(), kNumChains * (kChainLength + 1));
+}
+
+TEST_F(ContinuationTest, WhenAll) {
+  shad::rt::Handle left, right;
+  for (auto &loc : shad::rt::allLocalities()) {
+    for (size_t i = 0; i < kNumIters; ++i) {
+      shad::rt::asyncExecuteAt(left, loc, asyncIncrCounter, size_t(1));
+      shad::rt::asyncExecuteAt(right, loc, asyncIncrCounter, size_t(2));
+    }
+  }
+
+  size_t total = 0;
+  shad::rt::Handle joined, next;
+  shad::rt::whenAll(joined, left, right);
+  shad::rt::then(joined, next, storeTotalCount, &total);
+  shad::rt::waitForCompletion(next);
+  ASSERT_EQ(total, 3 * kNumIters * shad::rt::numLocalities());
+}
+
+static void asyncLocalityId(shad::rt::Handle &, const size_t &offset,
+                            size_t *res) {
+  *res = offset + static_cast<uint32_t>(shad::rt::thisLocality());
+}
+
+TEST_F(ContinuationTest, Future) {
+  std::vector<shad::rt::Future<size_t>> futures(shad::rt::numLocalities());
+  for (auto &loc : shad::rt::allLocalities())
+    shad::rt::asyncExecuteAtWithRet(futures[static_cast<uint32_t>(loc)], loc,
+                                    asyncLocalityId, kNumIters);
+
+  for (auto &loc : shad::rt::allLocalities()) {
+    uint32_t id = static_cast<uint32_t>(loc);
+    ASSERT_EQ(futures[id].Get(), kNumIters + id);
+    ASSERT_EQ(futures[id].Get(), kNumIters + id);
+  }
+}
+
+static void addFuture(shad::rt::Handle &handle,
+                      shad::rt::Future<size_t> *const &future) {
+  asyncIncrCounter(handle, future->Get());
+}
+
+TEST_F(ContinuationTest, ThenFuture) {
+  shad::rt::Future<size_t> future;
+  shad::rt::asyncExecuteAtWithRet(future, shad::rt::Locality(0),
+                                  asyncLocalityId, kNumIters);
+  shad::rt::Handle next;
+  shad::rt::then(future.GetHandle(), next, addFuture, &future);
+  shad::rt::waitForCompletion(next);
+  ASSERT_EQ(totalCount(), kNumIters);
+}
@@ -585,6 +585,29 @@ TEST_F(ForEachTest, AsyncZeroIterations) {
   shad::rt::executeOnAll([](const bool &) { ASSERT_EQ(Counter, 0); }, false);
 }
 
+TEST_F(ForEachTest, AsyncForEachNestedSpawn) {
+  static constexpr size_t kNumIters = 1024;
+  shad::rt::Handle handle;
+
+  shad::rt::asyncForEachAt(
+      handle, shad::rt::thisLocality(),
+      [](shad::rt::Handle &handle, const TestStruct &args, size_t i) {
+        ASSERT_LT(i, kNumIters);
+        Counter += args.valueA;
+        shad::rt::asyncExecuteAt(
+            handle, shad::rt::thisLocality(),
+            [](shad::rt::Handle &, const TestStruct &args) {
+              Counter += args.valueB;
+            },
+            args);
+      },
+      TestStruct{1, 2}, kNumIters);
+
+  shad::rt::waitForCompletion(handle);
+
+  ASSERT_EQ(Counter, 3 * kNumIters);
+}
+
 TEST_F(ForEachTest, NotExistingLocality) {
   shad::rt::Locality badLocality(shad::rt::numLocalities() + 1);
 